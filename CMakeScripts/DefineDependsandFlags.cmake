@@ -143,6 +143,11 @@ list(APPEND INKSCAPE_INCS_SYS ${INKSCAPE_DEP_INCLUDE_DIRS})
 
 add_definitions(${INKSCAPE_DEP_CFLAGS_OTHER})
 
+# Threads other than the main one register with the collector to use collectable memory, see
+# Inkscape::GC::ThreadScope, so everything including gc.h must see its thread support. Threads
+# are never created through the collector's wrappers.
+add_definitions(-DGC_THREADS -DGC_NO_THREAD_REDIRECTS)
+
 if(WITH_JEMALLOC)
     find_package(JeMalloc)
     if (JEMALLOC_FOUND)
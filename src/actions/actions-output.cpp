@@ -229,6 +229,27 @@ export_png_antialias(const Glib::VariantBase&  value, InkscapeApplication *app)
     app->file_export()->export_png_antialias = i.get();
 }
 
+void
+export_png_sizes(const Glib::VariantBase&  value, InkscapeApplication *app)
+{
+    Glib::Variant<std::string> s = Glib::VariantBase::cast_dynamic<Glib::Variant<std::string> >(value);
+    app->file_export()->export_png_sizes = s.get();
+}
+
+void
+export_tiles(const Glib::VariantBase&  value, InkscapeApplication *app)
+{
+    Glib::Variant<std::string> s = Glib::VariantBase::cast_dynamic<Glib::Variant<std::string> >(value);
+    app->file_export()->export_tiles = s.get();
+}
+
+void
+export_tile_size(const Glib::VariantBase&  value, InkscapeApplication *app)
+{
+    Glib::Variant<int> i = Glib::VariantBase::cast_dynamic<Glib::Variant<int> >(value);
+    app->file_export()->export_tile_size = i.get();
+}
+
 void
 export_do(InkscapeApplication *app)
 {
@@ -278,6 +299,9 @@ std::vector<std::vector<Glib::ustring>> raw_data_output =
     {"app.export-png-use-dithering",  N_("Export PNG Dithering"),      SECTION, N_("Set dithering for PNG export")                       },
     {"app.export-png-compression",    N_("Export PNG Compression"),    SECTION, N_("Set compression level for PNG export")               },
     {"app.export-png-antialias",      N_("Export PNG Antialiasing"),   SECTION, N_("Set antialiasing level for PNG export")              },
+    {"app.export-png-sizes",          N_("Export PNG Sizes"),          SECTION, N_("Set widths and resolutions to export PNG at in one go") },
+    {"app.export-tiles",              N_("Export Tiles"),              SECTION, N_("Export PNG as a pyramid of tiles for map viewers")   },
+    {"app.export-tile-size",          N_("Export Tile Size"),          SECTION, N_("Set size of the tiles of a tile pyramid export")     },
 
     {"app.export-do",                 N_("Do Export"),                 SECTION, N_("Do export")                                          }
     // clang-format on
@@ -314,7 +338,10 @@ std::vector<std::vector<Glib::ustring>> hint_data_output =
     {"app.export-png-color-mode",     N_("Enter string for PNG Color Mode, one of Gray_1/Gray_2/Gray_4/Gray_8/Gray_16/RGB_8/RGB_16/GrayAlpha_8/GrayAlpha_16/RGBA_8/RGBA_16")},
     {"app.export-png-use-dithering",  N_("Enter 1/0 for Yes/No to use dithering")          },
     {"app.export-png-compression",    N_("Enter integer for PNG compression level (0 (none) to 9 (max))")},
-    {"app.export-png-antialias",      N_("Enter integer for PNG antialiasing level (0 (none) to 3 (best))")}
+    {"app.export-png-antialias",      N_("Enter integer for PNG antialiasing level (0 (none) to 3 (best))")},
+    {"app.export-png-sizes",          N_("Enter comma separated widths in pixels or resolutions like 96dpi, e.g. 16,32,1024,192dpi")},
+    {"app.export-tiles",              N_("Enter string for tile layout, xyz or deepzoom, or nothing to export a single PNG")},
+    {"app.export-tile-size",          N_("Enter integer for tile size in pixels")                        }
     // clang-format on
 };
 
@@ -363,6 +390,9 @@ add_actions_output(InkscapeApplication* app)
     gapp->add_action_with_parameter( "export-png-use-dithering", Bool,   sigc::bind(sigc::ptr_fun(&export_png_use_dithering), app));
     gapp->add_action_with_parameter( "export-png-compression",   Int,    sigc::bind(sigc::ptr_fun(&export_png_compression),   app));
     gapp->add_action_with_parameter( "export-png-antialias",     Int,    sigc::bind(sigc::ptr_fun(&export_png_antialias),     app));
+    gapp->add_action_with_parameter( "export-png-sizes",         String, sigc::bind(sigc::ptr_fun(&export_png_sizes),         app));
+    gapp->add_action_with_parameter( "export-tiles",             String, sigc::bind(sigc::ptr_fun(&export_tiles),             app));
+    gapp->add_action_with_parameter( "export-tile-size",         Int,    sigc::bind(sigc::ptr_fun(&export_tile_size),         app));
 
     // Extra
     gapp->add_action(                "export-do",                        sigc::bind(sigc::ptr_fun(&export_do),           app));
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * A 3D lookup table approximating an lcms2 display transform.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "lut.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+namespace Inkscape::Colors::CMS {
+
+namespace {
+
+/**
+ * The 8 bit input level of grid point k. The transform can only be sampled at whole
+ * levels, so the grid is very slightly non-uniform unless 255 is a multiple of size - 1.
+ */
+int grid_level(unsigned k, unsigned size)
+{
+    return std::lround(k * 255.0 / (size - 1));
+}
+
+} // namespace
+
+/**
+ * Sample the transform into a cube of size³ entries.
+ *
+ * @arg handle - An lcms2 transform with TYPE_BGRA_8 input and output.
+ * @arg size - The number of samples along each axis, at least 2.
+ */
+Lut3D::Lut3D(cmsHTRANSFORM handle, unsigned size)
+    : _size(std::clamp(size, 2u, 256u))
+{
+    // Find the cell and the position inside it for every input level.
+    for (unsigned k = 0, v = 0; k < _size - 1; k++) {
+        int const lo = grid_level(k, _size);
+        int const hi = grid_level(k + 1, _size);
+        for (; (int)v <= hi && v < 256; v++) {
+            _index[v] = k;
+            _frac[v] = ((v - lo) * 256 + (hi - lo) / 2) / (hi - lo);
+        }
+    }
+
+    unsigned const count = _size * _size * _size;
+    std::vector<unsigned char> in(count * 4);
+    std::vector<unsigned char> out(count * 4);
+
+    auto px = in.data();
+    for (unsigned r = 0; r < _size; r++) {
+        for (unsigned g = 0; g < _size; g++) {
+            for (unsigned b = 0; b < _size; b++) {
+                *px++ = grid_level(b, _size);
+                *px++ = grid_level(g, _size);
+                *px++ = grid_level(r, _size);
+                *px++ = 255;
+            }
+        }
+    }
+    cmsDoTransform(handle, in.data(), out.data(), count);
+
+    _table.resize(count);
+    for (unsigned i = 0; i < count; i++) {
+        _table[i] = {out[i * 4] << 8, out[i * 4 + 1] << 8, out[i * 4 + 2] << 8, 0};
+    }
+
+    _max_error = _measure_error(handle);
+}
+
+/**
+ * Transform count BGRA pixels, in may be the same as out. Like the lcms2 transform,
+ * the alpha channel of the output is left untouched.
+ */
+void Lut3D::apply(unsigned char const *in, unsigned char *out, unsigned count) const
+{
+    int const stride_g = _size;
+    int const stride_r = _size * _size;
+
+    for (unsigned n = 0; n < count; n++, in += 4, out += 4) {
+        int const fb = _frac[in[0]];
+        int const fg = _frac[in[1]];
+        int const fr = _frac[in[2]];
+        auto const base = _table.data() + _index[in[2]] * stride_r + _index[in[1]] * stride_g + _index[in[0]];
+
+        auto const &c000 = base[0];
+        auto const &c111 = base[stride_r + stride_g + 1];
+
+        // Pick the tetrahedron of the cube which contains the point. Each case walks
+        // from c000 to c111 along the axes in order of decreasing fraction.
+        Sample const *c1, *c2;
+        int f0, f1, f2;
+        if (fr >= fg) {
+            if (fg >= fb) {
+                c1 = &base[stride_r], c2 = &base[stride_r + stride_g], f0 = fr, f1 = fg, f2 = fb;
+            } else if (fr >= fb) {
+                c1 = &base[stride_r], c2 = &base[stride_r + 1], f0 = fr, f1 = fb, f2 = fg;
+            } else {
+                c1 = &base[1], c2 = &base[stride_r + 1], f0 = fb, f1 = fr, f2 = fg;
+            }
+        } else {
+            if (fr >= fb) {
+                c1 = &base[stride_g], c2 = &base[stride_r + stride_g], f0 = fg, f1 = fr, f2 = fb;
+            } else if (fg >= fb) {
+                c1 = &base[stride_g], c2 = &base[stride_g + 1], f0 = fg, f1 = fb, f2 = fr;
+            } else {
+                c1 = &base[1], c2 = &base[stride_g + 1], f0 = fb, f1 = fg, f2 = fr;
+            }
+        }
+
+        // Fixed size lanes, which compilers turn into a single SIMD multiply-add chain.
+        Sample acc;
+        for (int i = 0; i < 4; i++) {
+            acc[i] = (c000[i] << 8) + f0 * ((*c1)[i] - c000[i]) + f1 * ((*c2)[i] - (*c1)[i]) +
+                     f2 * (c111[i] - (*c2)[i]) + (1 << 15);
+        }
+        for (int i = 0; i < 3; i++) {
+            out[i] = std::clamp(acc[i] >> 16, 0, 255);
+        }
+    }
+}
+
+/**
+ * The largest max_error() worth using a table of this size for. Interpolation errors grow
+ * with the spacing of the grid, so coarser tables are allowed more: two levels at 65³ and
+ * four at 33³, which any smooth transform stays within.
+ */
+int Lut3D::default_tolerance(unsigned size)
+{
+    if (size < 2) {
+        return 0;
+    }
+    return std::max(2, (int)std::ceil(128.0 / (size - 1)));
+}
+
+/**
+ * Compare the table with lcms2 on a lattice of inputs which mostly fall between grid points.
+ */
+int Lut3D::_measure_error(cmsHTRANSFORM handle) const
+{
+    std::vector<unsigned char> levels;
+    for (int v = 0; v < 255; v += 7) {
+        levels.push_back(v);
+    }
+    levels.push_back(255);
+
+    std::vector<unsigned char> in;
+    in.reserve(levels.size() * levels.size() * levels.size() * 4);
+    for (auto r : levels) {
+        for (auto g : levels) {
+            for (auto b : levels) {
+                in.insert(in.end(), {b, g, r, 255});
+            }
+        }
+    }
+    unsigned const count = in.size() / 4;
+    std::vector<unsigned char> expected(in.size());
+    std::vector<unsigned char> actual(in.size());
+    cmsDoTransform(handle, in.data(), expected.data(), count);
+    apply(in.data(), actual.data(), count);
+
+    int max_error = 0;
+    for (unsigned i = 0; i < count; i++) {
+        for (int c = 0; c < 3; c++) {
+            max_error = std::max(max_error, std::abs(expected[i * 4 + c] - actual[i * 4 + c]));
+        }
+    }
+    return max_error;
+}
+
+} // namespace Inkscape::Colors::CMS
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * A 3D lookup table approximating an lcms2 display transform.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#ifndef SEEN_COLORS_CMS_LUT_H
+#define SEEN_COLORS_CMS_LUT_H
+
+#include <array>
+#include <cstdint>
+#include <lcms2.h> // cmsHTRANSFORM
+#include <vector>
+
+namespace Inkscape::Colors::CMS {
+
+/**
+ * A cube of size³ samples of an 8 bit BGRA transform, read back with tetrahedral
+ * interpolation. Transforming a pixel costs four table reads and a few integer
+ * multiplies instead of running the whole lcms2 pipeline, which makes it suitable
+ * for correcting every rendered canvas tile.
+ *
+ * The accuracy is measured against lcms2 when the table is built, see max_error().
+ */
+class Lut3D
+{
+public:
+    Lut3D(cmsHTRANSFORM handle, unsigned size);
+
+    void apply(unsigned char const *in, unsigned char *out, unsigned count) const;
+
+    unsigned size() const { return _size; }
+
+    /// The largest difference to lcms2 found in any channel, in 8 bit levels.
+    int max_error() const { return _max_error; }
+
+    static int default_tolerance(unsigned size);
+
+private:
+    int _measure_error(cmsHTRANSFORM handle) const;
+
+    // One BGR sample (the fourth lane is padding), scaled so 255 maps to 255 << 8.
+    using Sample = std::array<std::int32_t, 4>;
+
+    unsigned _size;
+    std::vector<Sample> _table;
+
+    // Per input level: the table cell and the 0..256 position within it.
+    std::array<std::int32_t, 256> _index;
+    std::array<std::int32_t, 256> _frac;
+
+    int _max_error = 0;
+};
+
+} // namespace Inkscape::Colors::CMS
+
+#endif // SEEN_COLORS_CMS_LUT_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -244,11 +244,13 @@ const std::shared_ptr<Transform> &System::getDisplayTransform()
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
     bool display = prefs->getIntLimited("/options/displayprofile/enabled", false);
     int display_intent = prefs->getIntLimited("/options/displayprofile/intent", 0, 0, 3);
+    int display_lut = prefs->getIntLimited("/options/displayprofile/lut_size", 0, 0, 129);
 
-    if (_display != display || _display_intent != display_intent) {
+    if (_display != display || _display_intent != display_intent || _display_lut != display_lut) {
         need_to_update = true;
         _display = display;
         _display_intent = display_intent;
+        _display_lut = display_lut;
     }
 
     auto display_profile = display ? getDisplayProfile(need_to_update) : nullptr;
@@ -256,6 +258,10 @@ const std::shared_ptr<Transform> &System::getDisplayTransform()
     if (need_to_update) {
         if (display_profile) {
             _display_transform = Transform::create_for_cairo(Profile::create_srgb(), display_profile);
+            if (_display_transform && display_lut) {
+                // Every canvas tile goes through this, so trade a little accuracy for speed.
+                _display_transform->enable_lut(display_lut);
+            }
         } else {
             _display_transform = nullptr;
         }
@@ -71,6 +71,7 @@ private:
     std::shared_ptr<Transform> _display_transform;
     bool _display = false;
     int _display_intent = -1;
+    int _display_lut = 0;
 
     Inkscape::PrefObserver _prefs_observer;
 };
@@ -12,10 +12,12 @@
 
 #include <boost/range/adaptor/reversed.hpp>
 #include <cairo.h>
+#include <glib.h>
 #include <numeric>
 #include <string>
 
 #include "colors/color.h"
+#include "lut.h"
 #include "profile.h"
 
 namespace Inkscape::Colors::CMS {
@@ -141,7 +143,40 @@ void Transform::do_transform(unsigned char *inBuf, unsigned char *outBuf, unsign
         throw ColorError("Using a color-channel transform object to do a cairo transform operation!");
     }
 
-    cmsDoTransform(_handle, inBuf, outBuf, size);
+    if (_lut) {
+        _lut->apply(inBuf, outBuf, size);
+    } else {
+        cmsDoTransform(_handle, inBuf, outBuf, size);
+    }
+}
+
+/**
+ * Approximate this cairo transform with a precomputed 3D lookup table from now on.
+ *
+ * This must be done before the transform is shared with other threads.
+ *
+ * @arg size - The number of samples along each axis of the table, zero turns it off.
+ * @arg tolerance - The largest difference to the lcms2 result allowed, in 8 bit levels.
+ *                  By default it depends on the size, see Lut3D::default_tolerance().
+ *
+ * @returns true if the lookup table is in use.
+ */
+bool Transform::enable_lut(unsigned size, std::optional<int> tolerance)
+{
+    _lut.reset();
+    if (size < 2 || (cmsGetTransformInputFormat(_handle) & TYPE_BGRA_8) != TYPE_BGRA_8 ||
+        (cmsGetTransformOutputFormat(_handle) & TYPE_BGRA_8) != TYPE_BGRA_8) {
+        return false;
+    }
+
+    auto lut = std::make_shared<Lut3D const>(_handle, size);
+    if (lut->max_error() > tolerance.value_or(Lut3D::default_tolerance(size))) {
+        g_warning("Color management lookup table is off by up to %d levels, using lcms2 directly.",
+                  lut->max_error());
+        return false;
+    }
+    _lut = std::move(lut);
+    return true;
 }
 
 /**
@@ -12,12 +12,14 @@
 #include <cassert>
 #include <lcms2.h> // cmsHTRANSFORM
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "colors/spaces/enum.h"
 
 namespace Inkscape::Colors::CMS {
 
+class Lut3D;
 class Profile;
 class Transform
 {
@@ -60,9 +62,13 @@ public:
     void set_gamut_warn(std::vector<double> const &input);
     bool check_gamut(std::vector<double> const &input) const;
 
+    bool enable_lut(unsigned size, std::optional<int> tolerance = {});
+    std::shared_ptr<Lut3D const> const &get_lut() const { return _lut; }
+
 private:
     cmsHTRANSFORM _handle;
     cmsContext _context;
+    std::shared_ptr<Lut3D const> _lut;
 
     static unsigned int lcms_intent(RenderingIntent intent, unsigned int &flags);
 
@@ -20,6 +20,7 @@
 #include <2geom/line.h>
 
 #include "conn-avoid-ref.h"
+#include "conn-router.h"
 #include "desktop.h"
 #include "document-undo.h"
 #include "document.h"
@@ -28,9 +29,6 @@
 
 #include "display/curve.h"
 
-#include "3rdparty/adaptagrams/libavoid/router.h"
-#include "3rdparty/adaptagrams/libavoid/shape.h"
-
 #include "object/sp-namedview.h"
 #include "object/sp-shape.h"
 
@@ -40,13 +38,13 @@
 
 using Inkscape::DocumentUndo;
 
-using Avoid::Router;
+using Inkscape::ConnectorRouter;
 
 static Avoid::Polygon avoid_item_poly(SPItem const *item);
 
 
 SPAvoidRef::SPAvoidRef(SPItem *spitem)
-    : shapeRef(nullptr)
+    : shapeId(0)
     , item(spitem)
     , setting(false)
     , new_setting(false)
@@ -60,13 +58,13 @@ SPAvoidRef::~SPAvoidRef()
     _transformed_connection.disconnect();
 
     // If the document is being destroyed then the router instance
-    // and the ShapeRefs will have been destroyed with it.
-    Router *router = item->document->getRouter();
+    // and the shapes will have been destroyed with it.
+    ConnectorRouter *router = item->document->getRouter();
 
-    if (shapeRef && router) {
-        router->deleteShape(shapeRef);
+    if (shapeId && router) {
+        router->removeShape(shapeId);
     }
-    shapeRef = nullptr;
+    shapeId = 0;
 }
 
 
@@ -103,7 +101,7 @@ void SPAvoidRef::handleSettingChange()
     }
     setting = new_setting;
 
-    Router *router = item->document->getRouter();
+    ConnectorRouter *router = item->document->getRouter();
 
     _transformed_connection.disconnect();
     if (new_setting) {
@@ -112,68 +110,17 @@ void SPAvoidRef::handleSettingChange()
             _transformed_connection = item->connectTransformed(
                     sigc::ptr_fun(&avoid_item_move));
 
-            char const *id = item->getAttribute("id");
-            g_assert(id != nullptr);
-
-            // Get a unique ID for the item.
-            GQuark itemID = g_quark_from_string(id);
-
-            shapeRef = new Avoid::ShapeRef(router, poly, itemID);
+            shapeId = router->addShape(poly);
         }
     }
-    else if (shapeRef)
+    else if (shapeId)
     {
-        router->deleteShape(shapeRef);
-        shapeRef = nullptr;
-    }
-}
-
-
-std::vector<SPItem *> SPAvoidRef::getAttachedShapes(const unsigned int type)
-{
-    std::vector<SPItem *> list;
-
-    Avoid::IntList shapes;
-    GQuark shapeId = g_quark_from_string(item->getId());
-    item->document->getRouter()->attachedShapes(shapes, shapeId, type);
-
-    for (auto const shape: shapes) {
-        auto const connId = g_quark_to_string(shape);
-        SPObject *obj = item->document->getObjectById(connId);
-        if (obj == nullptr) {
-            g_warning("getAttachedShapes: Object with id=\"%s\" is not "
-                      "found. Skipping.", connId);
-            continue;
-        }
-        auto shapeItem = cast<SPItem>(obj);
-        list.push_back(shapeItem);
+        router->removeShape(shapeId);
+        shapeId = 0;
     }
-    return list;
 }
 
 
-std::vector<SPItem *> SPAvoidRef::getAttachedConnectors(const unsigned int type)
-{
-    std::vector<SPItem *> list;
-
-    Avoid::IntList conns;
-    GQuark shapeId = g_quark_from_string(item->getId());
-    item->document->getRouter()->attachedConns(conns, shapeId, type);
-
-    for (auto const conn: conns) {
-        auto const connId = g_quark_to_string(conn);
-        SPObject *obj = item->document->getObjectById(connId);
-        if (obj == nullptr) {
-            g_warning("getAttachedConnectors: Object with id=\"%s\" is not "
-                      "found. Skipping.", connId);
-            continue;
-        }
-        auto connItem = cast<SPItem>(obj);
-        list.push_back(connItem);
-    }
-    return list;
-}
-
 Geom::Point SPAvoidRef::getConnectionPointPos()
 {
     g_assert(item);
@@ -341,7 +288,7 @@ static inline void get_avoided_items_rec(std::vector<SPItem *> &list, SPObject *
             !desktop->layerManager().isLayer(cast<SPItem>(&child)) &&
             !cast_unsafe<SPItem>(&child)->isLocked() &&
             !desktop->itemIsHidden(cast<SPItem>(&child)) &&
-            (!initialised || cast<SPItem>(&child)->getAvoidRef().shapeRef)
+            (!initialised || cast<SPItem>(&child)->getAvoidRef().shapeId)
             )
         {
             list.push_back(cast<SPItem>(&child));
@@ -356,13 +303,13 @@ static inline void get_avoided_items_rec(std::vector<SPItem *> &list, SPObject *
 
 void avoid_item_move(Geom::Affine const */*mp*/, SPItem *moved_item)
 {
-    Avoid::ShapeRef *shapeRef = moved_item->getAvoidRef().shapeRef;
-    g_assert(shapeRef);
+    unsigned const shapeId = moved_item->getAvoidRef().shapeId;
+    g_assert(shapeId);
 
-    Router *router = moved_item->document->getRouter();
+    ConnectorRouter *router = moved_item->document->getRouter();
     Avoid::Polygon poly = avoid_item_poly(moved_item);
     if (!poly.empty()) {
-        router->moveShape(shapeRef, poly);
+        router->moveShape(shapeId, poly);
     }
 }
 
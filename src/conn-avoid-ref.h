@@ -21,29 +21,20 @@
 class  SPDesktop;
 class SPObject;
 class  SPItem;
-namespace Avoid { class ShapeRef; }
 
 class SPAvoidRef {
 public:
     SPAvoidRef(SPItem *spitem);
     virtual ~SPAvoidRef();
 
-    // libavoid's internal representation of the item.
-    Avoid::ShapeRef *shapeRef;
+    // The id of the item's obstacle in the document's ConnectorRouter, or 0.
+    unsigned shapeId;
 
     void setAvoid(char const *value);
     void handleSettingChange();
 
     Geom::Point getConnectionPointPos();
 
-    // Returns a list of SPItems of all connectors/shapes attached to
-    // this object.  Pass one of the following for 'type':
-    //     Avoid::runningTo
-    //     Avoid::runningFrom
-    //     Avoid::runningToAndFrom
-    std::vector<SPItem *> getAttachedShapes(const unsigned int type);
-    std::vector<SPItem *> getAttachedConnectors(const unsigned int type);
-
 private:
     SPItem *item;
 
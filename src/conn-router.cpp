@@ -0,0 +1,433 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Connector routing with libavoid on a background thread.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "conn-router.h"
+
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "3rdparty/adaptagrams/libavoid/router.h"
+#include "3rdparty/adaptagrams/libavoid/shape.h"
+
+namespace Inkscape {
+
+namespace {
+
+Avoid::PolyLine straight_line(Avoid::Point const &src, Avoid::Point const &dst)
+{
+    Avoid::PolyLine line(2);
+    line.ps[0] = src;
+    line.ps[1] = dst;
+    return line;
+}
+
+} // namespace
+
+void ConnectorRouter::Transaction::merge(Transaction &&newer)
+{
+    generation = newer.generation;
+    for (auto &[id, change] : newer.shapes) {
+        shapes[id] = std::move(change);
+    }
+    for (auto &[id, change] : newer.connectors) {
+        auto &merged = connectors[id];
+        // Keep a request to reroute when the newer change doesn't repeat it.
+        bool const invalidate = merged && change && merged->invalidate;
+        merged = std::move(change);
+        if (invalidate) {
+            merged->invalidate = true;
+        }
+    }
+}
+
+ConnectorRouter::ConnectorRouter()
+    : _router(std::make_unique<Avoid::Router>(Avoid::PolyLineRouting | Avoid::OrthogonalRouting))
+{
+    // Penalise libavoid for choosing paths with needless extra segments.
+    // This results in much better looking orthogonal connector paths.
+    _router->setRoutingPenalty(Avoid::segmentPenalty);
+
+    std::tie(_source, _dest) = Async::Channel::create();
+}
+
+ConnectorRouter::~ConnectorRouter()
+{
+    if (_thread.joinable()) {
+        {
+            auto lock = std::lock_guard(_mutex);
+            _stop = true;
+        }
+        _cond.notify_all();
+        _thread.join();
+    }
+    _dest.close();
+}
+
+/**
+ * Add an obstacle for connectors to avoid.
+ * @return The id to refer to it with.
+ */
+unsigned ConnectorRouter::addShape(Avoid::Polygon const &poly)
+{
+    auto const id = _next_id++;
+    _shapes.emplace(id, poly);
+    _changes.shapes[id] = poly;
+    return id;
+}
+
+void ConnectorRouter::moveShape(unsigned shape, Avoid::Polygon const &poly)
+{
+    auto it = _shapes.find(shape);
+    if (it == _shapes.end()) {
+        return;
+    }
+    it->second = poly;
+    _changes.shapes[shape] = poly;
+}
+
+void ConnectorRouter::removeShape(unsigned shape)
+{
+    if (_shapes.erase(shape)) {
+        _changes.shapes[shape].reset();
+    }
+}
+
+/**
+ * Add a connector routed around the obstacles. Its route is unknown until its endpoints
+ * have been set.
+ * @arg callback - Called with data whenever the connector gets a new route, unless null.
+ * @return The id to refer to it with.
+ */
+unsigned ConnectorRouter::addConnector(Avoid::ConnType type, Callback callback, void *data)
+{
+    auto const id = _next_id++;
+    _connectors.emplace(id, Connector{.type = type, .callback = callback, .data = data});
+    _changeConnector(id);
+    return id;
+}
+
+void ConnectorRouter::setConnectorType(unsigned conn, Avoid::ConnType type)
+{
+    auto it = _connectors.find(conn);
+    if (it == _connectors.end() || it->second.type == type) {
+        return;
+    }
+    it->second.type = type;
+    _changeConnector(conn);
+}
+
+void ConnectorRouter::setEndpoints(unsigned conn, Avoid::Point const &src, Avoid::Point const &dst)
+{
+    auto it = _connectors.find(conn);
+    if (it == _connectors.end()) {
+        return;
+    }
+    auto &connector = it->second;
+    if (connector.initialised && connector.src == src && connector.dst == dst) {
+        return;
+    }
+    connector.initialised = true;
+    connector.src = src;
+    connector.dst = dst;
+    connector.route = straight_line(src, dst);
+    connector.preview = true;
+    connector.preview_shown = false;
+    _changeConnector(conn);
+}
+
+/**
+ * Have the connector rerouted by the next transaction, even if nothing it depends on changed.
+ */
+void ConnectorRouter::invalidate(unsigned conn)
+{
+    if (_connectors.contains(conn)) {
+        _changeConnector(conn).invalidate = true;
+    }
+}
+
+void ConnectorRouter::removeConnector(unsigned conn)
+{
+    if (_connectors.erase(conn)) {
+        _changes.connectors[conn].reset();
+    }
+}
+
+bool ConnectorRouter::isInitialised(unsigned conn) const
+{
+    auto it = _connectors.find(conn);
+    return it != _connectors.end() && it->second.initialised;
+}
+
+bool ConnectorRouter::isPreview(unsigned conn) const
+{
+    auto it = _connectors.find(conn);
+    return it != _connectors.end() && it->second.preview;
+}
+
+/**
+ * Return the current route of the connector, in document coordinates.
+ */
+Avoid::PolyLine const &ConnectorRouter::route(unsigned conn) const
+{
+    static Avoid::PolyLine const none;
+    auto it = _connectors.find(conn);
+    return it != _connectors.end() ? it->second.route : none;
+}
+
+/**
+ * Hand the changes made since the last call to the worker, and deliver the routes if they
+ * are ready within preview_delay. Otherwise, the connectors whose endpoints moved are
+ * redrawn as straight lines, and the routes are delivered once they are ready.
+ */
+void ConnectorRouter::reroute()
+{
+    if (!_submit()) {
+        _deliver();
+        return;
+    }
+
+    bool done;
+    {
+        auto lock = std::unique_lock(_mutex);
+        done = _cond.wait_for(lock, preview_delay, [this] { return _routed_generation == _generation; });
+    }
+    _deliver();
+    if (!done) {
+        _showPreviews();
+    }
+}
+
+/**
+ * Hand over the pending changes, wait for all routes and deliver them.
+ */
+void ConnectorRouter::finish()
+{
+    _submit();
+    {
+        auto lock = std::unique_lock(_mutex);
+        _cond.wait(lock, [this] { return _routed_generation == _generation; });
+    }
+    _deliver();
+}
+
+/**
+ * Hand the changes made since the last call to the worker, merging them into the
+ * transaction waiting for it if there is one.
+ * @return Whether there were any changes.
+ */
+bool ConnectorRouter::_submit()
+{
+    if (_changes.empty()) {
+        return false;
+    }
+
+    _changes.generation = ++_generation;
+    {
+        auto lock = std::lock_guard(_mutex);
+        if (_pending) {
+            _pending->merge(std::move(_changes));
+        } else {
+            _pending = std::move(_changes);
+        }
+    }
+    _changes = {};
+
+    // Most documents never route anything, so the worker is only started when needed.
+    if (!_thread.joinable()) {
+        _thread = std::thread([this] { _run(); });
+    }
+    _cond.notify_all();
+    return true;
+}
+
+/**
+ * Return the change to send for the connector, updated to its current state.
+ */
+ConnectorRouter::ConnectorChange &ConnectorRouter::_changeConnector(unsigned conn)
+{
+    auto &connector = _connectors.at(conn);
+    connector.changed = _generation + 1;
+
+    auto &change = _changes.connectors[conn];
+    bool const invalidate = change && change->invalidate;
+    change = ConnectorChange{.type = connector.type, .initialised = connector.initialised,
+                             .invalidate = invalidate, .src = connector.src, .dst = connector.dst};
+    return *change;
+}
+
+/**
+ * Call the callbacks of connectors whose straight line preview hasn't been shown yet.
+ */
+void ConnectorRouter::_showPreviews()
+{
+    std::vector<unsigned> ids;
+    for (auto &[id, connector] : _connectors) {
+        if (connector.preview && !connector.preview_shown && connector.callback) {
+            connector.preview_shown = true;
+            ids.push_back(id);
+        }
+    }
+
+    // Callbacks may add or remove connectors.
+    for (auto id : ids) {
+        auto it = _connectors.find(id);
+        if (it != _connectors.end() && it->second.preview) {
+            it->second.callback(it->second.data);
+        }
+    }
+}
+
+/**
+ * Take over the routes from the worker and call the callbacks of their connectors.
+ */
+void ConnectorRouter::_deliver()
+{
+    std::map<unsigned, Avoid::PolyLine> results;
+    std::uint64_t generation;
+    {
+        auto lock = std::lock_guard(_mutex);
+        results = std::move(_results);
+        _results.clear();
+        generation = _routed_generation;
+    }
+
+    std::vector<unsigned> ids;
+    for (auto &[id, route] : results) {
+        auto it = _connectors.find(id);
+        if (it == _connectors.end()) {
+            continue;
+        }
+        auto &connector = it->second;
+        if (connector.changed > generation) {
+            // Changed since; keep the preview until the route for the change arrives.
+            continue;
+        }
+        connector.route = std::move(route);
+        connector.preview = false;
+        if (connector.callback) {
+            ids.push_back(id);
+        }
+    }
+
+    for (auto id : ids) {
+        auto it = _connectors.find(id);
+        if (it != _connectors.end()) {
+            it->second.callback(it->second.data);
+        }
+    }
+}
+
+void ConnectorRouter::_run()
+{
+    auto lock = std::unique_lock(_mutex);
+    while (true) {
+        _cond.wait(lock, [this] { return _stop || _pending; });
+        if (_stop) {
+            return;
+        }
+
+        auto transaction = std::move(*_pending);
+        _pending.reset();
+        lock.unlock();
+
+        _apply(transaction);
+        if (_router->processTransaction()) {
+            for (auto const &[id, conn_ref] : _conn_refs) {
+                if (conn_ref->needsRepaint()) {
+                    _rerouted.insert(id);
+                }
+            }
+        }
+
+        lock.lock();
+        if (_pending) {
+            // A newer transaction wins; its routes are delivered together with these.
+            continue;
+        }
+        _rerouted.insert(_touched.begin(), _touched.end());
+        for (auto id : _rerouted) {
+            auto const &route = _conn_refs.at(id)->displayRoute();
+            auto &published = _published[id];
+            if (_touched.contains(id) || published != route.ps) {
+                published = route.ps;
+                _results[id] = route;
+            }
+        }
+        _rerouted.clear();
+        _touched.clear();
+        _routed_generation = transaction.generation;
+        _cond.notify_all();
+        if (!_results.empty()) {
+            _source.run([this] { _deliver(); });
+        }
+    }
+}
+
+/**
+ * Make the changes of a transaction to the router.
+ */
+void ConnectorRouter::_apply(Transaction &transaction)
+{
+    for (auto &[id, poly] : transaction.shapes) {
+        auto it = _shape_refs.find(id);
+        if (!poly) {
+            if (it != _shape_refs.end()) {
+                _router->deleteShape(it->second);
+                _shape_refs.erase(it);
+            }
+        } else if (it == _shape_refs.end()) {
+            _shape_refs.emplace(id, new Avoid::ShapeRef(_router.get(), *poly, id));
+        } else {
+            _router->moveShape(it->second, *poly);
+        }
+    }
+
+    for (auto const &[id, change] : transaction.connectors) {
+        auto it = _conn_refs.find(id);
+        if (!change) {
+            if (it != _conn_refs.end()) {
+                _router->deleteConnector(it->second);
+                _conn_refs.erase(it);
+                _rerouted.erase(id);
+                _touched.erase(id);
+                _published.erase(id);
+            }
+            continue;
+        }
+        if (it == _conn_refs.end()) {
+            it = _conn_refs.emplace(id, new Avoid::ConnRef(_router.get(), id)).first;
+        }
+        auto conn_ref = it->second;
+        _touched.insert(id);
+        if (conn_ref->routingType() != change->type) {
+            conn_ref->setRoutingType(change->type);
+        }
+        if (change->invalidate) {
+            conn_ref->makePathInvalid();
+        }
+        if (change->initialised) {
+            conn_ref->setEndpoints(change->src, change->dst);
+        }
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Connector routing with libavoid on a background thread.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_CONN_ROUTER_H
+#define SEEN_INKSCAPE_CONN_ROUTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "3rdparty/adaptagrams/libavoid/connector.h"
+#include "3rdparty/adaptagrams/libavoid/geomtypes.h"
+#include "async/channel.h"
+
+namespace Avoid {
+class Router;
+class ShapeRef;
+} // namespace Avoid
+
+namespace Inkscape {
+
+/**
+ * @brief The obstacles and connectors of a document, routed by libavoid on a worker thread
+ *
+ * The document's items register their obstacle shapes and connector endpoints here instead
+ * of with a libavoid Router directly. Changes are collected on the main thread and handed to
+ * the worker by reroute(). The worker owns the only Router and keeps it between transactions,
+ * so libavoid only updates the visibility of moved obstacles and only reroutes the polyline
+ * connectors they affect (it reroutes all orthogonal ones). Either way, only connectors whose
+ * route actually changed get it delivered and have their callback called.
+ *
+ * - Transactions handed over while the worker is still busy are merged into one, and the
+ *   routes of a transaction are not delivered if a newer one is already waiting: the latest
+ *   transaction wins, so dragging an obstacle never queues up outdated work.
+ * - A connector whose endpoints moved gets a straight line between them as its route until
+ *   its new route arrives. reroute() waits for the worker for a short while first, so that
+ *   small diagrams are routed as before without the preview showing up.
+ * - finish() waits for all routes, for when the document has to be up to date.
+ *
+ * The worker is started when the first transaction is handed over, so documents which never
+ * route anything don't have one.
+ *
+ * All methods must be called from the main thread. Routes are delivered there through the
+ * main loop, or from within reroute() and finish().
+ */
+class ConnectorRouter
+{
+public:
+    using Callback = void (*)(void *);
+
+    ConnectorRouter();
+    ~ConnectorRouter();
+
+    ConnectorRouter(ConnectorRouter const &) = delete;
+    ConnectorRouter &operator=(ConnectorRouter const &) = delete;
+
+    unsigned addShape(Avoid::Polygon const &poly);
+    void moveShape(unsigned shape, Avoid::Polygon const &poly);
+    void removeShape(unsigned shape);
+
+    unsigned addConnector(Avoid::ConnType type, Callback callback, void *data);
+    void setConnectorType(unsigned conn, Avoid::ConnType type);
+    void setEndpoints(unsigned conn, Avoid::Point const &src, Avoid::Point const &dst);
+    void invalidate(unsigned conn);
+    void removeConnector(unsigned conn);
+
+    /// Whether the endpoints of the connector have been set.
+    bool isInitialised(unsigned conn) const;
+    /// Whether the route of the connector is a straight line waiting to be replaced.
+    bool isPreview(unsigned conn) const;
+    Avoid::PolyLine const &route(unsigned conn) const;
+
+    void reroute();
+    void finish();
+
+    /// How long reroute() waits for the routes before showing previews.
+    static constexpr auto preview_delay = std::chrono::milliseconds(10);
+
+private:
+    struct Connector
+    {
+        Avoid::ConnType type;
+        Callback callback;
+        void *data;
+        bool initialised = false;
+        bool preview = false;
+        bool preview_shown = false;
+        Avoid::Point src;
+        Avoid::Point dst;
+        Avoid::PolyLine route;
+        std::uint64_t changed = 0; ///< The transaction with its latest change.
+    };
+
+    struct ConnectorChange
+    {
+        Avoid::ConnType type;
+        bool initialised;
+        bool invalidate;
+        Avoid::Point src;
+        Avoid::Point dst;
+    };
+
+    /// The changes handed to the worker. An empty optional stands for a removal.
+    struct Transaction
+    {
+        std::uint64_t generation = 0;
+        std::map<unsigned, std::optional<Avoid::Polygon>> shapes;
+        std::map<unsigned, std::optional<ConnectorChange>> connectors;
+
+        bool empty() const { return shapes.empty() && connectors.empty(); }
+        void merge(Transaction &&newer);
+    };
+
+    ConnectorChange &_changeConnector(unsigned conn);
+    bool _submit();
+    void _showPreviews();
+    void _deliver();
+
+    // Worker thread.
+    void _run();
+    void _apply(Transaction &transaction);
+
+    // Main thread only.
+    unsigned _next_id = 1;
+    std::uint64_t _generation = 0;
+    std::unordered_map<unsigned, Avoid::Polygon> _shapes;
+    std::unordered_map<unsigned, Connector> _connectors;
+    Transaction _changes;
+
+    // Worker thread only.
+    std::unique_ptr<Avoid::Router> _router;
+    std::unordered_map<unsigned, Avoid::ShapeRef *> _shape_refs;
+    std::unordered_map<unsigned, Avoid::ConnRef *> _conn_refs;
+    std::unordered_set<unsigned> _rerouted; ///< Rerouted by libavoid since the last delivery.
+    std::unordered_set<unsigned> _touched;  ///< Changed by the main thread since then.
+    std::unordered_map<unsigned, std::vector<Avoid::Point>> _published;
+
+    // Shared, guarded by the mutex.
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::optional<Transaction> _pending;
+    std::map<unsigned, Avoid::PolyLine> _results;
+    std::uint64_t _routed_generation = 0;
+    bool _stop = false;
+
+    Async::Channel::Source _source;
+    Async::Channel::Dest _dest;
+    std::thread _thread;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_CONN_ROUTER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Index of the style sheet rules of a document by the selectors they can match.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "rule-index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <glib.h>
+
+#include "3rdparty/libcroco/src/cr-cascade.h"
+#include "3rdparty/libcroco/src/cr-sel-eng.h"
+#include "3rdparty/libcroco/src/cr-statement.h"
+#include "xml/node.h"
+
+namespace Inkscape::CSS {
+namespace {
+
+/// Results are shared between at most this many distinct elements, so that changing ids and
+/// classes doesn't grow the cache without bounds.
+constexpr std::size_t MAX_CACHED_RESULTS = 4096;
+
+/// Bucket keys ignore case, so buckets hold a superset of the rules that can match.
+std::string fold(std::string_view s)
+{
+    std::string folded(s);
+    for (auto &c : folded) {
+        c = g_ascii_tolower(c);
+    }
+    return folded;
+}
+
+char const *string_of(CRString const *s)
+{
+    return s && s->stryng && s->stryng->str ? s->stryng->str : nullptr;
+}
+
+/// The element name without its namespace prefix, as libcroco's node interface reports it.
+std::string_view local_name(XML::Node const *node)
+{
+    std::string_view name = node->name() ? node->name() : "";
+    if (auto const colon = name.rfind(':'); colon != name.npos) {
+        name.remove_prefix(colon + 1);
+    }
+    return name;
+}
+
+template <typename F>
+void for_each_class(char const *classes, F &&f)
+{
+    std::string_view rest = classes ? classes : "";
+    while (!rest.empty()) {
+        auto const begin = rest.find_first_not_of(" \t\r\n\f");
+        if (begin == rest.npos) {
+            break;
+        }
+        rest.remove_prefix(begin);
+        auto const end = std::min(rest.find_first_of(" \t\r\n\f"), rest.size());
+        f(rest.substr(0, end));
+        rest.remove_prefix(end);
+    }
+}
+
+} // namespace
+
+void RuleIndex::invalidate()
+{
+    _rules.clear();
+    _by_id.clear();
+    _by_class.clear();
+    _by_name.clear();
+    _universal.clear();
+    _cache.clear();
+    _built = false;
+}
+
+void RuleIndex::_build(CRCascade *cascade)
+{
+    invalidate();
+    _built = true;
+    _supported = !cr_cascade_get_sheet(cascade, ORIGIN_UA) && !cr_cascade_get_sheet(cascade, ORIGIN_USER);
+
+    for (auto sheet = cr_cascade_get_sheet(cascade, ORIGIN_AUTHOR); sheet && _supported; sheet = sheet->next) {
+        for (auto statement = sheet->statements; statement; statement = statement->next) {
+            switch (statement->type) {
+                case RULESET_STMT:
+                    _addRuleset(statement);
+                    break;
+                case AT_MEDIA_RULE_STMT:
+                case AT_IMPORT_RULE_STMT:
+                    _supported = false;
+                    break;
+                default:
+                    // Never matched by libcroco either.
+                    break;
+            }
+        }
+    }
+
+    if (!_supported) {
+        invalidate();
+        _built = true;
+    }
+}
+
+void RuleIndex::_addRuleset(CRStatement *statement)
+{
+    if (!statement->kind.ruleset) {
+        return;
+    }
+
+    for (auto sel = statement->kind.ruleset->sel_list; sel; sel = sel->next) {
+        if (!sel->simple_sel) {
+            continue;
+        }
+
+        auto rightmost = sel->simple_sel;
+        while (rightmost->next) {
+            rightmost = rightmost->next;
+        }
+
+        cr_simple_sel_compute_specificity(sel->simple_sel);
+        auto &rule = _rules.emplace_back(Rule{statement, sel->simple_sel, sel->simple_sel->specificity,
+                                              rightmost == sel->simple_sel});
+
+        char const *id = nullptr;
+        char const *class_name = nullptr;
+        for (auto add = rightmost->add_sel; add; add = add->next) {
+            switch (add->type) {
+                case ID_ADD_SELECTOR:
+                    id = id ? id : string_of(add->content.id_name);
+                    break;
+                case CLASS_ADD_SELECTOR:
+                    class_name = class_name ? class_name : string_of(add->content.class_name);
+                    break;
+                default:
+                    rule.cacheable = false;
+                    break;
+            }
+        }
+
+        auto const index = static_cast<unsigned>(_rules.size() - 1);
+        auto const name = rightmost->type_mask & UNIVERSAL_SELECTOR ? nullptr : string_of(rightmost->name);
+        if (id) {
+            _by_id[fold(id)].push_back(index);
+        } else if (class_name) {
+            _by_class[fold(class_name)].push_back(index);
+        } else if (name) {
+            _by_name[fold(name)].push_back(index);
+        } else {
+            _universal.push_back(index);
+        }
+    }
+}
+
+/**
+ * The rules that can match the node, in cascade order.
+ */
+std::vector<unsigned> RuleIndex::_candidates(XML::Node const *node) const
+{
+    auto candidates = _universal;
+    auto add = [&] (Buckets const &buckets, std::string_view key) {
+        if (auto const it = buckets.find(fold(key)); it != buckets.end()) {
+            candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        }
+    };
+
+    add(_by_name, local_name(node));
+    if (auto const id = node->attribute("id")) {
+        add(_by_id, id);
+    }
+    for_each_class(node->attribute("class"), [&] (std::string_view class_name) {
+        add(_by_class, class_name);
+    });
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+/**
+ * The style sheet declarations that apply to the node, or null if the cascade has to be
+ * matched by libcroco.
+ */
+std::shared_ptr<RuleIndex::Declarations const> RuleIndex::match(CRCascade *cascade, CRSelEng *sel_eng,
+                                                                 XML::Node const *node)
+{
+    if (!_built) {
+        _build(cascade);
+    }
+    if (!_supported) {
+        return {};
+    }
+
+    auto const candidates = _candidates(node);
+    bool const cacheable = std::all_of(candidates.begin(), candidates.end(), [this] (unsigned i) {
+        return _rules[i].cacheable;
+    });
+
+    std::string key;
+    if (cacheable) {
+        auto value = [node] (char const *attribute) {
+            auto const s = node->attribute(attribute);
+            return s ? s : "";
+        };
+        key = std::string(node->name() ? node->name() : "") + '\n' + value("id") + '\n' + value("class");
+        if (auto const it = _cache.find(key); it != _cache.end()) {
+            return it->second;
+        }
+    }
+
+    // Match like cr_sel_eng_get_matched_rulesets_real(): a ruleset is listed once for each of
+    // its selectors that match, and takes the specificity of the last of them.
+    std::vector<CRStatement *> matched;
+    std::vector<std::pair<CRStatement *, unsigned long>> specificities;
+    for (auto const i : candidates) {
+        auto const &rule = _rules[i];
+        gboolean result = FALSE;
+        if (cr_sel_eng_matches_node(sel_eng, rule.selector, node, &result) != CR_OK || !result) {
+            continue;
+        }
+        matched.push_back(rule.statement);
+        auto const it = std::find_if(specificities.begin(), specificities.end(),
+                                     [&] (auto const &s) { return s.first == rule.statement; });
+        if (it != specificities.end()) {
+            it->second = rule.specificity;
+        } else {
+            specificities.emplace_back(rule.statement, rule.specificity);
+        }
+    }
+
+    auto specificity = [&] (CRStatement const *statement) {
+        return std::find_if(specificities.begin(), specificities.end(),
+                            [&] (auto const &s) { return s.first == statement; })->second;
+    };
+
+    // Collect the declarations like put_css_properties_in_props_list() does: a property
+    // declared again by a ruleset of at least the same specificity moves to the end, unless
+    // the earlier declaration is important.
+    struct Entry
+    {
+        CRDeclaration *decl;
+        char const *property;
+        unsigned long specificity;
+    };
+    std::vector<Entry> entries;
+    for (auto const statement : matched) {
+        if (!statement->parent_sheet) {
+            continue;
+        }
+        auto const spec = specificity(statement);
+        for (auto decl = statement->kind.ruleset->decl_list; decl; decl = decl->next) {
+            auto const property = string_of(decl->property);
+            if (!property) {
+                continue;
+            }
+            auto const it = std::find_if(entries.begin(), entries.end(),
+                                         [&] (Entry const &e) { return !std::strcmp(e.property, property); });
+            if (it != entries.end()) {
+                if (spec < it->specificity || it->decl->important) {
+                    continue;
+                }
+                entries.erase(it);
+            }
+            entries.push_back({decl, property, spec});
+        }
+    }
+
+    auto result = std::make_shared<Declarations>();
+    result->reserve(entries.size());
+    for (auto const &entry : entries) {
+        result->push_back(entry.decl);
+    }
+
+    if (cacheable) {
+        if (_cache.size() >= MAX_CACHED_RESULTS) {
+            _cache.clear();
+        }
+        _cache.emplace(std::move(key), result);
+    }
+    return result;
+}
+
+} // namespace Inkscape::CSS
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Index of the style sheet rules of a document by the selectors they can match.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_CSS_RULE_INDEX_H
+#define INKSCAPE_CSS_RULE_INDEX_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using CRCascade = struct _CRCascade;
+using CRDeclaration = struct _CRDeclaration;
+using CRSelEng = struct _CRSelEng;
+using CRSimpleSel = struct _CRSimpleSel;
+using CRStatement = struct _CRStatement;
+
+namespace Inkscape::XML {
+class Node;
+} // namespace Inkscape::XML
+
+namespace Inkscape::CSS {
+
+/** Finds the style sheet declarations that apply to an element, without testing the element
+ *  against every rule of the document.
+ *
+ *  Like browsers do, the selectors are bucketed by the id, class or element name their
+ *  rightmost compound selector requires, so an element is only tested against the rules of
+ *  its own buckets and those that can match any element. Elements whose candidate rules
+ *  only look at their name, id and classes share their result, which is cached until the
+ *  style sheets change.
+ *
+ *  The result is the same list of declarations, in the same order, as libcroco's
+ *  cr_sel_eng_get_matched_properties_from_cascade() gives. Cascades the index doesn't handle,
+ *  those with @media or @import rules, or with style sheets of other origins than the author,
+ *  make match() return null, and have to be matched by libcroco.
+ */
+class RuleIndex
+{
+public:
+    using Declarations = std::vector<CRDeclaration *>;
+
+    RuleIndex() = default;
+    RuleIndex(RuleIndex const &) = delete;
+    RuleIndex &operator=(RuleIndex const &) = delete;
+
+    /// Forget the index, to be called whenever a style sheet of the cascade changes.
+    void invalidate();
+
+    std::shared_ptr<Declarations const> match(CRCascade *cascade, CRSelEng *sel_eng, XML::Node const *node);
+
+    /// Number of results shared between elements, for testing.
+    std::size_t cachedResults() const { return _cache.size(); }
+
+private:
+    struct Rule
+    {
+        CRStatement *statement;
+        CRSimpleSel *selector;
+        unsigned long specificity;
+        bool cacheable; ///< Whether the rule only depends on the name, id and classes of an element.
+    };
+
+    using Buckets = std::unordered_map<std::string, std::vector<unsigned>>;
+
+    void _build(CRCascade *cascade);
+    void _addRuleset(CRStatement *statement);
+    std::vector<unsigned> _candidates(XML::Node const *node) const;
+
+    std::vector<Rule> _rules; ///< In cascade order.
+    Buckets _by_id;
+    Buckets _by_class;
+    Buckets _by_name;
+    std::vector<unsigned> _universal;
+    bool _built = false;
+    bool _supported = false;
+
+    std::unordered_map<std::string, std::shared_ptr<Declarations const>> _cache;
+};
+
+} // namespace Inkscape::CSS
+
+#endif // INKSCAPE_CSS_RULE_INDEX_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
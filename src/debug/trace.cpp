@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Inkscape::Debug::Trace - performance traces in the Chrome trace format
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "debug/trace.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include <glib.h>
+
+#include "util/json-string.h"
+
+namespace Inkscape {
+
+namespace Debug {
+
+std::atomic<bool> Trace::_active = false;
+
+namespace {
+
+enum class Phase : char
+{
+    COMPLETE = 'X',
+    COUNTER = 'C',
+    INSTANT = 'i'
+};
+
+struct Record
+{
+    Phase phase;
+    char const *category;
+    char const *name;
+    std::int64_t time;     ///< Nanoseconds since the clock origin.
+    std::int64_t duration; ///< Nanoseconds, for complete events.
+    double value;          ///< For counters.
+    std::string detail;
+};
+
+/// The records of one thread. Only that thread appends to it, so its mutex is uncontended
+/// except while the trace is written out.
+struct Buffer
+{
+    std::mutex mutex;
+    std::vector<Record> records;
+    std::string name;
+    int tid;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Buffer>> buffers; ///< Outlive their threads.
+    int next_tid = 1;
+    std::string filename;
+};
+
+Registry &registry()
+{
+    // Never destroyed, since threads may still record while static objects are destroyed.
+    static auto const instance = new Registry;
+    return *instance;
+}
+
+thread_local std::shared_ptr<Buffer> thread_buffer;
+thread_local std::string thread_name;
+
+std::int64_t now()
+{
+    static auto const origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+Buffer &buffer()
+{
+    if (!thread_buffer) {
+        thread_buffer = std::make_shared<Buffer>();
+        thread_buffer->name = thread_name;
+        auto &reg = registry();
+        auto lock = std::lock_guard(reg.mutex);
+        thread_buffer->tid = reg.next_tid++;
+        reg.buffers.push_back(thread_buffer);
+    }
+    return *thread_buffer;
+}
+
+void append(Record record)
+{
+    auto &buf = buffer();
+    auto lock = std::lock_guard(buf.mutex);
+    buf.records.push_back(std::move(record));
+}
+
+/// Write a time in the microseconds the format uses.
+void write_time(std::ostream &os, std::int64_t ns)
+{
+    os << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+}
+
+void do_shutdown()
+{
+    Trace::shutdown();
+}
+
+}
+
+/**
+ * Start recording a trace for the whole session if INKSCAPE_TRACE names a file.
+ */
+void Trace::init()
+{
+    auto &reg = registry();
+    if (auto const filename = std::getenv("INKSCAPE_TRACE"); filename && *filename && reg.filename.empty()) {
+        reg.filename = filename;
+        setThreadName("main");
+        start();
+        std::atexit(&do_shutdown);
+    }
+}
+
+/**
+ * Write the session trace started by init(), if there is one.
+ */
+void Trace::shutdown()
+{
+    auto &reg = registry();
+    if (reg.filename.empty()) {
+        return;
+    }
+    stop();
+    std::ofstream stream(reg.filename);
+    if (stream.is_open()) {
+        write(stream);
+    } else {
+        g_warning("Could not write trace to %s", reg.filename.c_str());
+    }
+    reg.filename.clear();
+}
+
+void Trace::start()
+{
+    now(); // Fix the origin of the clock before the first record.
+    _active.store(true, std::memory_order_relaxed);
+}
+
+void Trace::stop()
+{
+    _active.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * Forget everything recorded so far.
+ */
+void Trace::clear()
+{
+    auto &reg = registry();
+    auto lock = std::lock_guard(reg.mutex);
+    for (auto const &buf : reg.buffers) {
+        auto buf_lock = std::lock_guard(buf->mutex);
+        buf->records.clear();
+    }
+}
+
+/**
+ * Name the current thread in traces. May be called before recording starts.
+ */
+void Trace::setThreadName(std::string name)
+{
+    if (thread_buffer) {
+        auto lock = std::lock_guard(thread_buffer->mutex);
+        thread_buffer->name = name;
+    }
+    thread_name = std::move(name);
+}
+
+/**
+ * Write everything recorded so far as a JSON trace.
+ */
+void Trace::write(std::ostream &os)
+{
+    auto &reg = registry();
+    auto lock = std::lock_guard(reg.mutex);
+
+    os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    os << R"({"ph": "M", "pid": 1, "tid": 0, "name": "process_name", "args": {"name": "inkscape"}})";
+
+    for (auto const &buf : reg.buffers) {
+        auto buf_lock = std::lock_guard(buf->mutex);
+
+        auto const name = buf->name.empty() ? "thread " + std::to_string(buf->tid) : buf->name;
+        os << ",\n{\"ph\": \"M\", \"pid\": 1, \"tid\": " << buf->tid << ", \"name\": \"thread_name\", \"args\": {\"name\": ";
+        Util::write_json_string(os, name);
+        os << "}}";
+
+        for (auto const &record : buf->records) {
+            os << ",\n{\"ph\": \"" << static_cast<char>(record.phase) << "\", \"pid\": 1, \"tid\": " << buf->tid
+               << ", \"cat\": ";
+            Util::write_json_string(os, record.category);
+            os << ", \"name\": ";
+            Util::write_json_string(os, record.name);
+            os << ", \"ts\": ";
+            write_time(os, record.time);
+            switch (record.phase) {
+                case Phase::COMPLETE:
+                    os << ", \"dur\": ";
+                    write_time(os, record.duration);
+                    break;
+                case Phase::INSTANT:
+                    os << ", \"s\": \"t\"";
+                    break;
+                case Phase::COUNTER:
+                    os << ", \"args\": {\"value\": " << record.value << "}";
+                    break;
+            }
+            if (!record.detail.empty()) {
+                os << ", \"args\": {\"detail\": ";
+                Util::write_json_string(os, record.detail);
+                os << "}";
+            }
+            os << "}";
+        }
+    }
+
+    os << "\n]}\n";
+}
+
+void Trace::_counter(char const *category, char const *name, double value)
+{
+    append({Phase::COUNTER, category, name, now(), 0, value, {}});
+}
+
+void Trace::_instant(char const *category, char const *name, char const *detail)
+{
+    append({Phase::INSTANT, category, name, now(), 0, 0.0, detail ? detail : ""});
+}
+
+void Trace::Span::_begin(char const *category, char const *name, char const *detail)
+{
+    _category = category;
+    _name = name;
+    if (detail) {
+        _detail = detail;
+    }
+    _start = now();
+}
+
+void Trace::Span::_end()
+{
+    // Spans still open when recording stops are dropped.
+    if (active()) {
+        auto const end = now();
+        append({Phase::COMPLETE, _category, _name, _start, end - _start, 0.0, std::move(_detail)});
+    }
+}
+
+}
+
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
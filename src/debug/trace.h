@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Inkscape::Debug::Trace - performance traces in the Chrome trace format
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DEBUG_TRACE_H
+#define SEEN_INKSCAPE_DEBUG_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace Inkscape {
+
+namespace Debug {
+
+/**
+ * Records timed spans, counters and instant events from any thread, and writes them out as
+ * a trace that can be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Setting INKSCAPE_TRACE to a file name records a trace for the whole session, written to the
+ * file on exit. While no trace is being recorded, spans and counters cost a relaxed atomic
+ * load. While one is, each thread appends to a buffer of its own, so threads don't contend.
+ *
+ * Categories and names must be string literals, or otherwise outlive the trace. Details are
+ * copied, and only while recording.
+ *
+ *     void Layout::calculateFlow()
+ *     {
+ *         auto span = Debug::Trace::Span("text", "layout");
+ *         ...
+ *     }
+ */
+class Trace
+{
+public:
+    static void init();
+    static void shutdown();
+
+    static void start();
+    static void stop();
+    static void clear();
+    static void write(std::ostream &os);
+
+    static bool active() { return _active.load(std::memory_order_relaxed); }
+
+    static void counter(char const *category, char const *name, double value)
+    {
+        if (active()) {
+            _counter(category, name, value);
+        }
+    }
+
+    static void instant(char const *category, char const *name, char const *detail = nullptr)
+    {
+        if (active()) {
+            _instant(category, name, detail);
+        }
+    }
+
+    static void setThreadName(std::string name);
+
+    /**
+     * A span covering the lifetime of the object on the current thread.
+     */
+    class Span
+    {
+    public:
+        Span(char const *category, char const *name, char const *detail = nullptr)
+        {
+            if (active()) {
+                _begin(category, name, detail);
+            }
+        }
+        ~Span()
+        {
+            if (_category) {
+                _end();
+            }
+        }
+        Span(Span const &) = delete;
+        Span &operator=(Span const &) = delete;
+
+    private:
+        void _begin(char const *category, char const *name, char const *detail);
+        void _end();
+
+        char const *_category = nullptr;
+        char const *_name = nullptr;
+        std::string _detail;
+        std::int64_t _start = 0;
+    };
+
+private:
+    static void _counter(char const *category, char const *name, double value);
+    static void _instant(char const *category, char const *name, char const *detail);
+
+    static std::atomic<bool> _active;
+};
+
+}
+
+}
+
+#endif
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Bounding volume hierarchy over the boxes of a list of items.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "bounding-box-tree.h"
+
+#include <algorithm>
+
+namespace Inkscape {
+namespace {
+
+/// Most boxes a leaf holds; testing a few boxes in a row is cheaper than descending further.
+constexpr unsigned LEAF_SIZE = 8;
+
+/// Regroup the boxes once more than this fraction of them moved.
+constexpr double MAX_MOVED = 0.25;
+
+} // namespace
+
+/**
+ * Set the boxes of the items, in order. Empty boxes are never returned by queries.
+ */
+void BoundingBoxTree::setBoxes(std::vector<Geom::OptIntRect> boxes)
+{
+    if (boxes.size() != _boxes.size() || _nodes.empty()) {
+        _boxes = std::move(boxes);
+        _build();
+        return;
+    }
+
+    std::size_t moved = 0;
+    bool appeared = false;
+    for (std::size_t i = 0; i < boxes.size(); i++) {
+        if (boxes[i] != _boxes[i]) {
+            moved++;
+            appeared |= boxes[i] && !_boxes[i];
+        }
+    }
+    if (moved == 0) {
+        return;
+    }
+
+    _boxes = std::move(boxes);
+    if (appeared || moved > MAX_MOVED * _boxes.size()) {
+        // Boxes that were empty aren't in the tree at all.
+        _build();
+    } else {
+        _refit(0);
+    }
+}
+
+void BoundingBoxTree::clear()
+{
+    _boxes.clear();
+    _order.clear();
+    _nodes.clear();
+}
+
+/**
+ * The indices of the items whose boxes intersect an area, in increasing order.
+ */
+std::vector<unsigned> BoundingBoxTree::query(Geom::IntRect const &area) const
+{
+    std::vector<unsigned> result;
+    if (_nodes.empty()) {
+        return result;
+    }
+
+    unsigned stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        auto const &node = _nodes[stack[--top]];
+        if (!node.box || !node.box->intersects(area)) {
+            continue;
+        }
+        if (node.children) {
+            stack[top++] = node.children;
+            stack[top++] = node.children + 1;
+            continue;
+        }
+        for (auto i = node.begin; i < node.end; i++) {
+            auto const index = _order[i];
+            if (_boxes[index] && _boxes[index]->intersects(area)) {
+                result.push_back(index);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void BoundingBoxTree::_build()
+{
+    _order.clear();
+    _nodes.clear();
+    for (unsigned i = 0; i < _boxes.size(); i++) {
+        if (_boxes[i]) {
+            _order.push_back(i);
+        }
+    }
+    if (_order.empty()) {
+        return;
+    }
+    _nodes.reserve(4 * _order.size() / LEAF_SIZE + 1);
+    _nodes.resize(1);
+    _buildNode(0, 0, _order.size());
+}
+
+/**
+ * Group the boxes of a range of _order below a node, splitting them at the median of their
+ * centers along the longer side of the range of centers.
+ */
+void BoundingBoxTree::_buildNode(unsigned node, unsigned begin, unsigned end)
+{
+    Geom::OptIntRect box, centers;
+    for (auto i = begin; i < end; i++) {
+        auto const &b = *_boxes[_order[i]];
+        box.unionWith(b);
+        centers.unionWith(Geom::IntRect(b.midpoint(), b.midpoint()));
+    }
+    _nodes[node] = {box, begin, end};
+
+    if (end - begin <= LEAF_SIZE) {
+        return;
+    }
+
+    auto const dim = centers->width() >= centers->height() ? Geom::X : Geom::Y;
+    auto const middle = begin + (end - begin) / 2;
+    std::nth_element(_order.begin() + begin, _order.begin() + middle, _order.begin() + end, [&] (unsigned a, unsigned b) {
+        return _boxes[a]->midpoint()[dim] < _boxes[b]->midpoint()[dim];
+    });
+
+    unsigned const children = _nodes.size();
+    _nodes[node].children = children;
+    _nodes.resize(children + 2);
+    _buildNode(children, begin, middle);
+    _buildNode(children + 1, middle, end);
+}
+
+Geom::OptIntRect BoundingBoxTree::_refit(unsigned node)
+{
+    Geom::OptIntRect box;
+    if (auto const children = _nodes[node].children) {
+        box.unionWith(_refit(children));
+        box.unionWith(_refit(children + 1));
+    } else {
+        for (auto i = _nodes[node].begin; i < _nodes[node].end; i++) {
+            box.unionWith(_boxes[_order[i]]);
+        }
+    }
+    _nodes[node].box = box;
+    return box;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Bounding volume hierarchy over the boxes of a list of items.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_BOUNDING_BOX_TREE_H
+#define INKSCAPE_DISPLAY_BOUNDING_BOX_TREE_H
+
+#include <vector>
+#include <2geom/int-rect.h>
+
+namespace Inkscape {
+
+/**
+ * @brief Finds which of a list of boxes intersect an area
+ *
+ * The boxes are grouped into a binary tree of nested boxes, so that a query only visits the
+ * branches intersecting its area rather than every box. Items are identified by their index
+ * in the list, and returned in the order of the list.
+ *
+ * When the boxes change, the tree is refitted around them without regrouping, unless so many
+ * of them moved that the grouping is likely to have become poor.
+ */
+class BoundingBoxTree
+{
+public:
+    void setBoxes(std::vector<Geom::OptIntRect> boxes);
+    void clear();
+
+    bool empty() const { return _boxes.empty(); }
+    std::size_t size() const { return _boxes.size(); }
+
+    std::vector<unsigned> query(Geom::IntRect const &area) const;
+
+private:
+    struct Node
+    {
+        Geom::OptIntRect box;
+        unsigned begin; ///< Range of _order covered.
+        unsigned end;
+        unsigned children = 0; ///< Index of the first of two child nodes, or 0 for leaves.
+    };
+
+    void _build();
+    void _buildNode(unsigned node, unsigned begin, unsigned end);
+    Geom::OptIntRect _refit(unsigned node);
+
+    std::vector<Geom::OptIntRect> _boxes;
+    std::vector<unsigned> _order; ///< Indices of the non-empty boxes, grouped by leaf.
+    std::vector<Node> _nodes;     ///< The root first.
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_BOUNDING_BOX_TREE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -21,6 +21,7 @@ static const int POOL_THRESHOLD = 2048;
 #include <algorithm>
 #include <cairo.h>
 #include <cmath>
+#include <vector>
 
 #include "display/cairo-utils.h"
 #include "display/dispatch-pool.h"
@@ -221,6 +222,29 @@ void ink_cairo_surface_synthesize(cairo_surface_t *out, Synth synth)
     ink_cairo_surface_synthesize(out, area, synth);
 }
 
+/**
+ * Synthesize an ARGB32 surface a row at a time, for functors which compute a whole row
+ * faster than its pixels one by one, e.g. in loops the compiler can vectorise.
+ * The functor gets called with the row number and a pointer to the first pixel of the row.
+ * Rows are spread over the dispatch pool like ink_cairo_surface_synthesize() does.
+ */
+template <typename Synth>
+void ink_cairo_surface_synthesize_rows(cairo_surface_t *out, Synth &&synth)
+{
+    cairo_surface_flush(out);
+    int w = cairo_image_surface_get_width(out);
+    int h = cairo_image_surface_get_height(out);
+    int stride = cairo_image_surface_get_stride(out);
+    unsigned char *data = cairo_image_surface_get_data(out);
+
+    auto const pool = get_global_dispatch_pool();
+    pool->dispatch_threshold(h, (w * h) > POOL_THRESHOLD, [&](int i, int) {
+        synth(i, reinterpret_cast<guint32 *>(data + i * stride));
+    });
+
+    cairo_surface_mark_dirty(out);
+}
+
 struct SurfaceSynth {
     SurfaceSynth(cairo_surface_t *surface)
         : _px(cairo_image_surface_get_data(surface))
@@ -456,6 +480,57 @@ struct SurfaceSynth {
         return normal;
     }
 
+    // retrieve the alpha values of a row
+    void alphaRow(int y, float *out) const {
+        unsigned char const *row = _px + y*_stride;
+        if (_alpha) {
+            for (int x = 0; x < _w; ++x) {
+                out[x] = row[x];
+            }
+        } else {
+            guint32 const *px = reinterpret_cast<guint32 const *>(row);
+            for (int x = 0; x < _w; ++x) {
+                out[x] = px[x] >> 24;
+            }
+        }
+    }
+
+    // compute the surface normals of a row like surfaceNormalAt() does, in single precision,
+    // one array per component
+    void surfaceNormalRow(int y, double scale, float *nx, float *ny, float *nz) const {
+        auto const at = [&] (int x) {
+            NR::Fvector normal = surfaceNormalAt(x, y, scale);
+            nx[x] = normal[X_3D];
+            ny[x] = normal[Y_3D];
+            nz[x] = normal[Z_3D];
+        };
+        if (y == 0 || y == _h - 1 || _w < 3) {
+            for (int x = 0; x < _w; ++x) {
+                at(x);
+            }
+            return;
+        }
+
+        // interior pixels, with the same Sobel kernels as surfaceNormalAt()
+        std::vector<float> rows(3 * _w);
+        float *a0 = rows.data(), *a1 = a0 + _w, *a2 = a1 + _w;
+        alphaRow(y - 1, a0);
+        alphaRow(y, a1);
+        alphaRow(y + 1, a2);
+        float const f = -scale / 255.0 / 4.0;
+        for (int x = 1; x < _w - 1; ++x) {
+            float const gx = (a0[x+1] - a0[x-1]) + 2.0f * (a1[x+1] - a1[x-1]) + (a2[x+1] - a2[x-1]);
+            float const gy = (a2[x-1] - a0[x-1]) + 2.0f * (a2[x] - a0[x]) + (a2[x+1] - a0[x+1]);
+            float const vx = gx * f, vy = gy * f;
+            float const inv = 1.0f / std::sqrt(vx * vx + vy * vy + 1.0f);
+            nx[x] = vx * inv;
+            ny[x] = vy * inv;
+            nz[x] = inv;
+        }
+        at(0);
+        at(_w - 1);
+    }
+
     unsigned char *_px;
     int _w, _h, _stride;
     bool _alpha;
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Average colors of many areas of a rendered drawing.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "color-sampler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cairomm/surface.h>
+
+#include "display/cairo-utils.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+
+namespace Inkscape {
+namespace {
+
+int floor_div(int a, int b)
+{
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+} // namespace
+
+/**
+ * Build the table of an ARGB32 image surface whose top left pixel is at origin.
+ */
+SummedAreaTable::SummedAreaTable(cairo_surface_t *surface, Geom::IntPoint const &origin)
+{
+    assert(cairo_image_surface_get_format(surface) == CAIRO_FORMAT_ARGB32);
+    cairo_surface_flush(surface);
+
+    int const width = cairo_image_surface_get_width(surface);
+    int const height = cairo_image_surface_get_height(surface);
+    int const stride = cairo_image_surface_get_stride(surface);
+    auto const data = cairo_image_surface_get_data(surface);
+
+    _area = Geom::IntRect::from_xywh(origin.x(), origin.y(), width, height);
+    _table.assign((width + 1) * (height + 1), Sums{});
+
+    for (int y = 0; y < height; y++) {
+        auto const px = reinterpret_cast<guint32 const *>(data + y * stride);
+        auto const above = _table.data() + y * (width + 1);
+        auto const row = above + width + 1;
+        Sums line{};
+        for (int x = 0; x < width; x++) {
+            EXTRACT_ARGB32(px[x], a, r, g, b)
+            line[0] += r;
+            line[1] += g;
+            line[2] += b;
+            line[3] += a;
+            for (int c = 0; c < 4; c++) {
+                row[x + 1][c] = above[x + 1][c] + line[c];
+            }
+        }
+    }
+}
+
+/**
+ * Sum the channels over the part of rect inside the table.
+ */
+SummedAreaTable::Sums SummedAreaTable::sum(Geom::IntRect const &rect) const
+{
+    auto const part = rect & _area;
+    if (!part || part->hasZeroArea()) {
+        return {};
+    }
+
+    int const x0 = part->left() - _area.left();
+    int const y0 = part->top() - _area.top();
+    int const x1 = part->right() - _area.left();
+    int const y1 = part->bottom() - _area.top();
+
+    Sums result;
+    for (int c = 0; c < 4; c++) {
+        result[c] = _at(x1, y1)[c] - _at(x0, y1)[c] - _at(x1, y0)[c] + _at(x0, y0)[c];
+    }
+    return result;
+}
+
+/**
+ * Turn the sums over count pixels into an average color, in the same way as
+ * ink_cairo_surface_average_color(). Fully transparent areas give transparent black.
+ */
+Colors::Color SummedAreaTable::average(Sums const &sums, std::uint64_t count)
+{
+    if (sums[3] == 0 || count == 0) {
+        return Colors::Color(0x0);
+    }
+    double const a = sums[3];
+    auto color = Colors::Color(Colors::Space::Type::RGB, {sums[0] / a, sums[1] / a, sums[2] / a, a / 255.0 / count});
+    color.normalize();
+    return color;
+}
+
+/**
+ * @arg drawing - The drawing to sample, which must be up to date.
+ * @arg tile_size - The width and height in pixels of the tiles it is rendered in.
+ * @arg max_tiles - The number of tiles to keep.
+ */
+ColorSampler::ColorSampler(Drawing const &drawing, int tile_size, std::size_t max_tiles)
+    : _drawing(drawing)
+    , _tile_size(std::max(tile_size, 1))
+    , _max_tiles(std::max<std::size_t>(max_tiles, 1))
+{}
+
+/**
+ * Return the average color of the drawing over area, given in drawing pixels.
+ */
+Colors::Color ColorSampler::average(Geom::IntRect const &area)
+{
+    SummedAreaTable::Sums total{};
+
+    int const i0 = floor_div(area.left(), _tile_size);
+    int const j0 = floor_div(area.top(), _tile_size);
+    int const i1 = floor_div(area.right() - 1, _tile_size);
+    int const j1 = floor_div(area.bottom() - 1, _tile_size);
+
+    for (int j = j0; j <= j1; j++) {
+        for (int i = i0; i <= i1; i++) {
+            auto const sums = _tile({i, j}).sum(area);
+            for (int c = 0; c < 4; c++) {
+                total[c] += sums[c];
+            }
+        }
+    }
+
+    return SummedAreaTable::average(total, std::uint64_t(area.width()) * area.height());
+}
+
+/**
+ * Return the table of a tile, rendering it if it is not kept.
+ */
+SummedAreaTable const &ColorSampler::_tile(Geom::IntPoint const &index)
+{
+    auto it = std::find_if(_tiles.begin(), _tiles.end(), [&] (auto const &t) { return t.index == index; });
+    if (it != _tiles.end()) {
+        if (it != _tiles.begin()) {
+            _tiles.splice(_tiles.begin(), _tiles, it);
+        }
+        return _tiles.front().table;
+    }
+
+    auto const rect = Geom::IntRect::from_xywh(index.x() * _tile_size, index.y() * _tile_size, _tile_size, _tile_size);
+    auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, _tile_size, _tile_size);
+    auto dc = DrawingContext(surface->cobj(), rect.min());
+    _drawing.render(dc, rect);
+
+    if (_tiles.size() >= _max_tiles) {
+        _tiles.pop_back();
+    }
+    _tiles.push_front({index, SummedAreaTable(surface->cobj(), rect.min())});
+    return _tiles.front().table;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Average colors of many areas of a rendered drawing.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_COLOR_SAMPLER_H
+#define INKSCAPE_DISPLAY_COLOR_SAMPLER_H
+
+#include <array>
+#include <cairo.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <vector>
+#include <2geom/int-rect.h>
+
+#include "colors/color.h"
+
+namespace Inkscape {
+
+class Drawing;
+
+/**
+ * @brief Summed-area table of a premultiplied ARGB32 image.
+ *
+ * Once built, the sum of every channel over any rectangle costs four lookups, whatever
+ * its size. The sums are kept in 32 bits and wrap around, which still gives exact results
+ * for rectangles of up to 2^24 pixels.
+ */
+class SummedAreaTable
+{
+public:
+    /// Per channel sums, in the order red, green, blue, alpha.
+    using Sums = std::array<std::uint32_t, 4>;
+
+    SummedAreaTable() = default;
+    SummedAreaTable(cairo_surface_t *surface, Geom::IntPoint const &origin);
+
+    /// The area covered by the table, in the coordinates of the surface origin.
+    Geom::IntRect const &area() const { return _area; }
+
+    Sums sum(Geom::IntRect const &rect) const;
+
+    static Colors::Color average(Sums const &sums, std::uint64_t count);
+
+private:
+    Sums const &_at(int x, int y) const { return _table[y * (_area.width() + 1) + x]; }
+
+    Geom::IntRect _area;
+    std::vector<Sums> _table; ///< One row and column larger than the area, the first ones being zero.
+};
+
+/**
+ * @brief Average colors of areas of a drawing, rendering each part of it only once.
+ *
+ * The drawing is rendered on demand in square tiles, each turned into a summed-area table,
+ * so asking for the average color of thousands of small areas costs about as much as
+ * rendering their union once. The least recently used tiles are dropped once there are
+ * more than max_tiles of them; queries tend to move steadily across the drawing, so this
+ * rarely causes a tile to be rendered twice.
+ *
+ * The drawing must not change while the sampler is in use.
+ */
+class ColorSampler
+{
+public:
+    explicit ColorSampler(Drawing const &drawing, int tile_size = 256, std::size_t max_tiles = 64);
+
+    Colors::Color average(Geom::IntRect const &area);
+
+private:
+    SummedAreaTable const &_tile(Geom::IntPoint const &index);
+
+    struct Tile
+    {
+        Geom::IntPoint index;
+        SummedAreaTable table;
+    };
+
+    Drawing const &_drawing;
+    int _tile_size;
+    std::size_t _max_tiles;
+    std::list<Tile> _tiles; ///< Most recently used first.
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_COLOR_SAMPLER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
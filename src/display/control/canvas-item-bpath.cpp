@@ -21,6 +21,7 @@
 #include "display/curve.h"
 #include "display/cairo-utils.h"
 #include "helper/geom.h" // bounds_exact_transformed()
+#include "ui/widget/canvas.h"
 
 namespace Inkscape {
 
@@ -67,6 +68,23 @@ void CanvasItemBpath::set_bpath(Geom::PathVector path, bool phantom_line)
     });
 }
 
+/**
+ * Set a control bpath differing from the current one only within an area. Path and area are in
+ * document coordinates. Only that area is redrawn, unless the bpath grows out of its bounds.
+ */
+void CanvasItemBpath::set_bpath(Geom::PathVector path, Geom::Rect const &changed)
+{
+    defer([=, this, path = std::move(path)] () mutable {
+        _path = std::move(path);
+        auto const area = (changed * affine()).expandedBy(get_effective_outline() / 2 + 2);
+        if (_bounds && _bounds->contains(area)) {
+            get_canvas()->redraw_area(area);
+        } else {
+            request_update();
+        }
+    });
+}
+
 /**
  * Set the fill color and fill rule.
  */
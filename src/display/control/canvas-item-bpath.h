@@ -38,6 +38,7 @@ public:
     // Geometry
     void set_bpath(SPCurve const *curve, bool phantom_line = false);
     void set_bpath(Geom::PathVector path, bool phantom_line = false);
+    void set_bpath(Geom::PathVector path, Geom::Rect const &changed);
 
     double closest_distance_to(Geom::Point const &p) const;
 
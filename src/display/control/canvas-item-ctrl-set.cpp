@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * A canvas item drawing many control nodes at once.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "canvas-item-ctrl-set.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <cairomm/context.h>
+
+#include "ctrl-handle-rendering.h"
+#include "preferences.h"
+#include "ui/widget/canvas.h"
+
+namespace Inkscape {
+namespace {
+
+constexpr int MIN_INDEX = 1;
+constexpr int MAX_INDEX = 15;
+
+} // namespace
+
+CanvasItemCtrlSet::CanvasItemCtrlSet(CanvasItemGroup *group)
+    : CanvasItem(group)
+    , _size_index(Preferences::get()->getIntLimited("/options/grabsize/value", 3, MIN_INDEX, MAX_INDEX))
+{
+    _name = "CanvasItemCtrlSet";
+    _pickable = true;
+}
+
+/**
+ * Add a ctrl, shown on top of the others. Point is in document coordinates.
+ */
+unsigned CanvasItemCtrlSet::add(CanvasItemCtrlType type, Geom::Point const &position)
+{
+    unsigned id;
+    if (!_free_ids.empty()) {
+        id = _free_ids.back();
+        _free_ids.pop_back();
+    } else {
+        id = _id_count++;
+    }
+
+    defer([=, this] {
+        if (id >= _ctrls.size()) {
+            _ctrls.resize(id + 1);
+        }
+        auto &ctrl = _ctrls[id];
+        ctrl = {.dirty = ctrl.dirty}; // The old box stays in the grid until the next update.
+        ctrl.position = position;
+        ctrl.handle.type = type;
+        ctrl.used = true;
+        ctrl.z = ++_top_z;
+        _mark_dirty(id);
+    });
+
+    return id;
+}
+
+/**
+ * Remove a ctrl. Its id may be given to the next ctrl added.
+ */
+void CanvasItemCtrlSet::remove(unsigned id)
+{
+    _free_ids.push_back(id);
+
+    defer([=, this] {
+        _ctrls[id].used = false;
+        _mark_dirty(id);
+    });
+}
+
+/**
+ * Set the position of a ctrl. Point is in document coordinates.
+ */
+void CanvasItemCtrlSet::set_position(unsigned id, Geom::Point const &position)
+{
+    defer([=, this] {
+        if (_ctrls[id].position == position) return;
+        _ctrls[id].position = position;
+        _mark_dirty(id);
+    });
+}
+
+void CanvasItemCtrlSet::set_state(unsigned id, Handles::TypeState const &state)
+{
+    defer([=, this] {
+        if (_ctrls[id].handle == state) return;
+        _ctrls[id].handle = state;
+        _mark_dirty(id); // Geometry could change with the style.
+    });
+}
+
+void CanvasItemCtrlSet::set_size(unsigned id, HandleSize rel_size)
+{
+    defer([=, this] {
+        if (_ctrls[id].rel_size == rel_size) return;
+        _ctrls[id].rel_size = rel_size;
+        _mark_dirty(id);
+    });
+}
+
+void CanvasItemCtrlSet::set_visible(unsigned id, bool visible)
+{
+    defer([=, this] {
+        if (_ctrls[id].visible == visible) return;
+        _ctrls[id].visible = visible;
+        _mark_dirty(id);
+    });
+}
+
+/**
+ * Show a ctrl below all the others.
+ */
+void CanvasItemCtrlSet::lower_to_bottom(unsigned id)
+{
+    defer([=, this] {
+        _ctrls[id].z = --_bottom_z;
+        _mark_dirty(id);
+    });
+}
+
+void CanvasItemCtrlSet::set_size_via_index(int size_index)
+{
+    defer([=, this] {
+        size_index = std::clamp(size_index, MIN_INDEX, MAX_INDEX);
+        if (_size_index == size_index) return;
+        _size_index = size_index;
+        _all_dirty = true;
+        request_update();
+    });
+}
+
+/**
+ * The id of the topmost ctrl containing a point in canvas units, if any. If tolerance is
+ * nonzero, a ctrl contains the points within tolerance of its center instead.
+ */
+std::optional<unsigned> CanvasItemCtrlSet::find(Geom::Point const &p, double tolerance) const
+{
+    return _grid.find(p, tolerance);
+}
+
+bool CanvasItemCtrlSet::contains(Geom::Point const &p, double tolerance)
+{
+    return find(p, tolerance).has_value();
+}
+
+void CanvasItemCtrlSet::_mark_dirty(unsigned id)
+{
+    auto &ctrl = _ctrls[id];
+    if (!ctrl.dirty) {
+        ctrl.dirty = true;
+        _dirty.push_back(id);
+    }
+    request_update();
+}
+
+int CanvasItemCtrlSet::_get_size(Ctrl const &ctrl) const
+{
+    return std::clamp(_size_index + static_cast<int>(ctrl.rel_size), MIN_INDEX, MAX_INDEX);
+}
+
+float CanvasItemCtrlSet::_get_width(Ctrl const &ctrl) const
+{
+    auto const &style = _context->handlesCss()->style_map.at(ctrl.handle);
+    return _get_size(ctrl) * style.scale() + style.size_extra();
+}
+
+float CanvasItemCtrlSet::_get_stroke_width(Ctrl const &ctrl) const
+{
+    auto const &style = _context->handlesCss()->style_map.at(ctrl.handle);
+    return style.stroke_width() * (1.0f + _get_size(ctrl) * style.stroke_scale());
+}
+
+float CanvasItemCtrlSet::_get_total_width(Ctrl const &ctrl) const
+{
+    auto const &style = _context->handlesCss()->style_map.at(ctrl.handle);
+    return _get_width(ctrl) + _get_stroke_width(ctrl) + 2 * style.outline_width();
+}
+
+/**
+ * Compute where a ctrl is drawn, returning its box in canvas coordinates if it is shown.
+ */
+Geom::OptRect CanvasItemCtrlSet::_place(Ctrl &ctrl) const
+{
+    // Setting the position to (inf, inf) to hide it is a pervasive hack we need to support.
+    if (!ctrl.used || !ctrl.visible || !ctrl.position.isFinite()) {
+        return {};
+    }
+
+    double const width = _get_total_width(ctrl);
+    ctrl.pos = ctrl.position * affine() - Geom::Point(width / 2, width / 2);
+    return Geom::Rect::from_xywh(ctrl.pos, {width, width}).roundOutwards();
+}
+
+/**
+ * Place the changed ctrls and redraw where they were and are. When the zoom, the handle size
+ * or the styles change, every ctrl is placed again.
+ */
+void CanvasItemCtrlSet::_update(bool propagate)
+{
+    if (_all_dirty || propagate || !_bounds || affine() != _affine) {
+        request_redraw();
+        _affine = affine();
+        _grid.clear();
+        _bounds = {};
+        for (unsigned id = 0; id < _ctrls.size(); id++) {
+            auto &ctrl = _ctrls[id];
+            ctrl.dirty = false;
+            auto const box = _place(ctrl);
+            _grid.place(id, box, ctrl.z);
+            _bounds.unionWith(box);
+        }
+        _dirty.clear();
+        _all_dirty = false;
+        request_redraw();
+        return;
+    }
+
+    for (auto id : _dirty) {
+        auto &ctrl = _ctrls[id];
+        ctrl.dirty = false;
+        if (auto const old_box = _grid.box(id)) {
+            get_canvas()->redraw_area(*old_box);
+        }
+        auto const box = _place(ctrl);
+        _grid.place(id, box, ctrl.z);
+        if (box) {
+            get_canvas()->redraw_area(*box);
+            _bounds.unionWith(box);
+        }
+    }
+    _dirty.clear();
+}
+
+/**
+ * Render the ctrls meeting the buffer, from the bottom up. Ctrls looking the same share one
+ * pixmap.
+ */
+void CanvasItemCtrlSet::_render(CanvasItemBuffer &buf) const
+{
+    // take size in logical pixels and make it fit physical pixel grid
+    auto const device_scale = buf.device_scale;
+    auto pixel_fit = [=] (float v) { return std::round(v * device_scale) / device_scale; };
+
+    std::map<std::pair<Handles::TypeState, HandleSize>, std::shared_ptr<Cairo::ImageSurface const>> pixmaps;
+    for (auto id : _grid.query(buf.rect)) {
+        auto const &ctrl = _ctrls[id];
+        auto &pixmap = pixmaps[{ctrl.handle, ctrl.rel_size}];
+        if (!pixmap) {
+            auto const width = _get_width(ctrl);
+            if (width < 1) {
+                continue; // Nothing to render
+            }
+            auto const &style = _context->handlesCss()->style_map.at(ctrl.handle);
+            pixmap = Handles::draw({
+                .shape = style.shape(),
+                .fill = style.getFill(),
+                .stroke = style.getStroke(),
+                .outline = style.getOutline(),
+                .stroke_width = pixel_fit(_get_stroke_width(ctrl)),
+                .outline_width = pixel_fit(style.outline_width()),
+                .width = static_cast<int>(std::round(_get_total_width(ctrl) * device_scale)),
+                .size = std::floor(width * device_scale) / device_scale,
+                .angle = 0,
+                .device_scale = device_scale
+            });
+            if (!pixmap) {
+                continue;
+            }
+        }
+
+        // Round to the device pixel at the very last minute so we get less bluring
+        auto const [x, y] = Geom::Point{(ctrl.pos * device_scale).round()} / device_scale - buf.rect.min();
+        cairo_set_source_surface(buf.cr->cobj(), const_cast<cairo_surface_t *>(pixmap->cobj()), x, y); // C API is const-incorrect.
+        buf.cr->paint();
+    }
+}
+
+void CanvasItemCtrlSet::_invalidate_ctrl_handles()
+{
+    assert(!_context->snapshotted()); // precondition
+    _all_dirty = true;
+    request_update();
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifndef SEEN_CANVAS_ITEM_CTRL_SET_H
+#define SEEN_CANVAS_ITEM_CTRL_SET_H
+
+/**
+ * A canvas item drawing many control nodes at once.
+ */
+
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <2geom/point.h>
+
+#include "canvas-item.h"
+#include "canvas-item-ctrl.h"
+#include "ctrl-grid.h"
+#include "ctrl-handle-styling.h"
+
+namespace Inkscape {
+
+/**
+ * Draws a set of ctrls from an array in one pass, rather than as one canvas item each.
+ *
+ * Ctrls are identified by the index add() returns, and are centered on their positions, as
+ * nodes are. Their boxes are kept in a CtrlGrid, so that drawing a tile or finding the
+ * ctrl under the pointer only looks at the ctrls near it. Like CanvasItemCtrl, the ctrls
+ * take their shapes and colors from the handle styles.
+ *
+ * Events over any ctrl go to the set; find() tells which ctrl they are over.
+ */
+class CanvasItemCtrlSet final : public CanvasItem
+{
+public:
+    CanvasItemCtrlSet(CanvasItemGroup *group);
+
+    // Ctrls
+    unsigned add(CanvasItemCtrlType type, Geom::Point const &position);
+    void remove(unsigned id);
+    void set_position(unsigned id, Geom::Point const &position);
+    void set_state(unsigned id, Handles::TypeState const &state);
+    void set_size(unsigned id, HandleSize rel_size);
+    void set_visible(unsigned id, bool visible);
+    void lower_to_bottom(unsigned id);
+    void set_size_via_index(int size_index);
+    using CanvasItem::set_visible;
+
+    // Selection
+    std::optional<unsigned> find(Geom::Point const &p, double tolerance = 0) const;
+    bool contains(Geom::Point const &p, double tolerance = 0) override;
+
+protected:
+    ~CanvasItemCtrlSet() override = default;
+
+    void _update(bool propagate) override;
+    void _render(CanvasItemBuffer &buf) const override;
+    void _invalidate_ctrl_handles() override;
+
+private:
+    struct Ctrl
+    {
+        Geom::Point position; ///< In document coordinates.
+        Handles::TypeState handle;
+        HandleSize rel_size = HandleSize::NORMAL;
+        bool used = false;
+        bool visible = true;
+        bool dirty = false;
+        std::int64_t z = 0;   ///< Drawing order; the highest is on top.
+        Geom::Point pos;      ///< Top left corner in canvas coordinates.
+    };
+
+    void _mark_dirty(unsigned id);
+    Geom::OptRect _place(Ctrl &ctrl) const;
+    float _get_width(Ctrl const &ctrl) const;
+    float _get_stroke_width(Ctrl const &ctrl) const;
+    float _get_total_width(Ctrl const &ctrl) const;
+    int _get_size(Ctrl const &ctrl) const;
+
+    // Only touched by the main thread, so that ids are known before deferred changes happen.
+    std::vector<unsigned> _free_ids;
+    unsigned _id_count = 0;
+
+    std::vector<Ctrl> _ctrls;
+    std::vector<unsigned> _dirty;
+    bool _all_dirty = true;
+    Geom::Affine _affine;
+    std::int64_t _top_z = 0;
+    std::int64_t _bottom_z = 0;
+    int _size_index;
+
+    /// Where the ctrls were placed by the last update.
+    CtrlGrid _grid;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_CANVAS_ITEM_CTRL_SET_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -114,6 +114,9 @@ void CanvasItemDrawing::_render(Inkscape::CanvasItemBuffer &buf) const
 {
     auto dc = Inkscape::DrawingContext(buf.cr->cobj(), buf.rect.min());
     _drawing->render(dc, buf.rect, buf.outline_pass * DrawingItem::RENDER_OUTLINE);
+    if (!buf.outline_pass) {
+        _drawing->renderPickIds(buf.rect);
+    }
 }
 
 /**
@@ -17,6 +17,7 @@
 #include "canvas-item.h"
 #include "canvas-item-group.h"
 #include "canvas-item-ctrl.h"
+#include "canvas-item-ctrl-set.h"
 
 #include "ui/widget/canvas.h"
 
@@ -341,6 +342,8 @@ void CanvasItem::update_canvas_item_ctrl_sizes(int size_index)
     if (auto ctrl = dynamic_cast<CanvasItemCtrl*>(this)) {
         // We can't use set_size_default as the preference file is updated ->after<- the signal is emitted!
         ctrl->set_size_via_index(size_index);
+    } else if (auto set = dynamic_cast<CanvasItemCtrlSet*>(this)) {
+        set->set_size_via_index(size_index);
     } else if (auto group = dynamic_cast<CanvasItemGroup*>(this)) {
         for (auto &item : group->items) {
             item.update_canvas_item_ctrl_sizes(size_index);
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * The boxes of a set of ctrls, by the cells of a grid.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "ctrl-grid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Inkscape {
+namespace {
+
+std::uint64_t cell_key(int x, int y)
+{
+    return std::uint64_t{static_cast<std::uint32_t>(x)} << 32 | static_cast<std::uint32_t>(y);
+}
+
+int cell_of(double coord)
+{
+    return std::floor(coord / CtrlGrid::CELL_SIZE);
+}
+
+/// Call a function with the key of each cell a rectangle meets.
+template <typename F>
+void for_each_cell(Geom::Rect const &rect, F &&f)
+{
+    for (int y = cell_of(rect.top()); y <= cell_of(rect.bottom()); y++) {
+        for (int x = cell_of(rect.left()); x <= cell_of(rect.right()); x++) {
+            f(cell_key(x, y));
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * Move a ctrl to a box in canvas coordinates, or hide it if the box is empty, and stack it at
+ * the given z.
+ */
+void CtrlGrid::place(unsigned id, Geom::OptRect const &box, std::int64_t z)
+{
+    if (id >= _entries.size()) {
+        _entries.resize(id + 1);
+    }
+    auto &entry = _entries[id];
+    entry.z = z;
+    if (entry.box == box) {
+        return;
+    }
+    _remove(id);
+    entry.box = box;
+    _add(id);
+}
+
+/**
+ * Forget all ctrls.
+ */
+void CtrlGrid::clear()
+{
+    _entries.clear();
+    _cells.clear();
+}
+
+/**
+ * The box of a ctrl, if it is shown.
+ */
+Geom::OptRect CtrlGrid::box(unsigned id) const
+{
+    return id < _entries.size() ? _entries[id].box : Geom::OptRect();
+}
+
+/**
+ * The id of the topmost ctrl containing a point in canvas units, if any. If tolerance is
+ * nonzero, a ctrl contains the points within tolerance of its center instead.
+ */
+std::optional<unsigned> CtrlGrid::find(Geom::Point const &p, double tolerance) const
+{
+    std::optional<unsigned> found;
+    for_each_cell(Geom::Rect(p, p).expandedBy(tolerance), [&] (std::uint64_t key) {
+        auto const it = _cells.find(key);
+        if (it == _cells.end()) {
+            return;
+        }
+        for (auto id : it->second) {
+            auto const &entry = _entries[id];
+            bool const hit = tolerance == 0 ? entry.box->interiorContains(p)
+                                            : Geom::distance(p, entry.box->midpoint()) <= tolerance;
+            if (hit && (!found || entry.z > _entries[*found].z)) {
+                found = id;
+            }
+        }
+    });
+    return found;
+}
+
+/**
+ * The ids of the ctrls in the cells an area meets, from the bottom up. They include every
+ * ctrl whose box meets the area.
+ */
+std::vector<unsigned> CtrlGrid::query(Geom::Rect const &area) const
+{
+    std::vector<unsigned> ids;
+    for_each_cell(area, [&] (std::uint64_t key) {
+        if (auto const it = _cells.find(key); it != _cells.end()) {
+            ids.insert(ids.end(), it->second.begin(), it->second.end());
+        }
+    });
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    std::sort(ids.begin(), ids.end(), [this] (unsigned a, unsigned b) { return _entries[a].z < _entries[b].z; });
+    return ids;
+}
+
+void CtrlGrid::_add(unsigned id)
+{
+    auto const &box = _entries[id].box;
+    if (!box) {
+        return;
+    }
+    for_each_cell(*box, [&] (std::uint64_t key) {
+        _cells[key].push_back(id);
+    });
+}
+
+void CtrlGrid::_remove(unsigned id)
+{
+    auto const &box = _entries[id].box;
+    if (!box) {
+        return;
+    }
+    for_each_cell(*box, [&] (std::uint64_t key) {
+        auto const it = _cells.find(key);
+        assert(it != _cells.end());
+        auto &ids = it->second;
+        ids.erase(std::find(ids.begin(), ids.end(), id));
+        if (ids.empty()) {
+            _cells.erase(it);
+        }
+    });
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifndef SEEN_CTRL_GRID_H
+#define SEEN_CTRL_GRID_H
+
+/**
+ * The boxes of a set of ctrls, by the cells of a grid.
+ */
+
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <2geom/rect.h>
+
+namespace Inkscape {
+
+/**
+ * Where the ctrls of a CanvasItemCtrlSet are and which is on top, so that finding the ctrl
+ * under the pointer or those in a tile only looks at the ctrls near it.
+ *
+ * Ctrls are identified by small integers and kept in a uniform grid of cells, each listing
+ * the ctrls whose boxes meet it. Ctrls are stacked by their z, the highest on top.
+ */
+class CtrlGrid
+{
+public:
+    /// Width of the cells, in canvas pixels; a few times the size of a ctrl.
+    static constexpr int CELL_SIZE = 32;
+
+    void place(unsigned id, Geom::OptRect const &box, std::int64_t z);
+    void clear();
+
+    Geom::OptRect box(unsigned id) const;
+    std::optional<unsigned> find(Geom::Point const &p, double tolerance = 0) const;
+    std::vector<unsigned> query(Geom::Rect const &area) const;
+
+private:
+    struct Entry
+    {
+        Geom::OptRect box;
+        std::int64_t z = 0;
+    };
+
+    void _add(unsigned id);
+    void _remove(unsigned id);
+
+    std::vector<Entry> _entries; ///< By id.
+
+    /// The ctrls whose boxes meet each cell, by packed cell coordinates.
+    std::unordered_map<std::uint64_t, std::vector<unsigned>> _cells;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_CTRL_GRID_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Rasterised coverage of the fill or the stroke of a shape.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "coverage-mask.h"
+
+#include <cairo.h>
+
+#include "display/drawing-context.h"
+#include "ui/util.h"
+
+namespace Inkscape {
+namespace {
+
+/// The column or row of the chunks a coordinate falls in.
+int cell_of(int coord)
+{
+    return coord >= 0 ? coord / CoverageMask::CHUNK_SIZE : -((-coord - 1) / CoverageMask::CHUNK_SIZE) - 1;
+}
+
+} // namespace
+
+CoverageMask::Chunk::Chunk(Geom::IntRect const &rect, int device_scale)
+    : _rect(rect)
+    , _surface(createSurface(rect, device_scale))
+    , _clean(Cairo::Region::create())
+{
+}
+
+/**
+ * Put the chunk, the one of a cell of a mask, at the front of the list of the chunks of a
+ * drawing, as the most recently used. Called once by the tile that made it. The lock of the
+ * drawing's masks must be held.
+ */
+void CoverageMask::Chunk::list(ChunkList &chunks, CoverageMask *mask, Cell const &cell)
+{
+    chunks.emplace_front(mask, cell);
+    _entry = chunks.begin();
+}
+
+/**
+ * Move the chunk to the front of the list of the chunks of a drawing, unless it was evicted or
+ * isn't listed yet. The lock of the drawing's masks must be held.
+ */
+void CoverageMask::Chunk::use(ChunkList &chunks)
+{
+    if (_entry) {
+        chunks.splice(chunks.begin(), chunks, *_entry);
+    }
+}
+
+/**
+ * Take the chunk off the list of the chunks of a drawing, for good. The lock of the drawing's
+ * masks must be held.
+ */
+void CoverageMask::Chunk::unlist(ChunkList &chunks)
+{
+    if (_entry) {
+        chunks.erase(*_entry);
+        _entry.reset();
+    }
+}
+
+/**
+ * Whether all of an area, or of its part within the chunk, has been rasterised. The lock of the
+ * mask must be held.
+ */
+bool CoverageMask::Chunk::isClean(Geom::IntRect const &area) const
+{
+    auto const part = area & _rect;
+    return !part || _clean->contains_rectangle(geom_to_cairo(*part)) == Cairo::Region::Overlap::IN;
+}
+
+/**
+ * Copy the coverage of an area in mask coordinates, rasterised on a surface made by
+ * createSurface(), into the part of the chunk within it. The lock of the mask must be held.
+ */
+void CoverageMask::Chunk::store(Cairo::RefPtr<Cairo::ImageSurface> const &coverage, Geom::IntRect const &area)
+{
+    auto const part = area & _rect;
+    if (!part) {
+        return;
+    }
+
+    auto const cr = cairo_create(_surface->cobj());
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(cr, coverage->cobj(), area.left() - _rect.left(), area.top() - _rect.top());
+    cairo_rectangle(cr, part->left() - _rect.left(), part->top() - _rect.top(), part->width(), part->height());
+    cairo_fill(cr);
+    cairo_destroy(cr);
+
+    _clean->do_union(geom_to_cairo(*part));
+}
+
+/**
+ * Paint the source of a context in screen coordinates through the part of the chunk within an
+ * area of the screen, for a shape shifted by whole pixels from where the mask was made. The lock
+ * of the mask must be held.
+ */
+void CoverageMask::Chunk::paint(DrawingContext &dc, Geom::IntRect const &area, Geom::IntPoint const &shift) const
+{
+    auto const part = area & (_rect + shift);
+    if (!part) {
+        return;
+    }
+
+    Inkscape::DrawingContext::Save save(dc);
+    dc.rectangle(*part);
+    dc.clip();
+    cairo_mask_surface(dc.raw(), _surface->cobj(), _rect.left() + shift.x(), _rect.top() + shift.y());
+}
+
+/**
+ * Mark an area in mask coordinates as needing to be rasterised again. The lock of the mask must
+ * be held.
+ */
+void CoverageMask::Chunk::invalidate(Geom::IntRect const &area)
+{
+    _clean->subtract(geom_to_cairo(area));
+}
+
+/**
+ * Make an empty mask for a shape drawn with the given transform from item to screen.
+ */
+CoverageMask::CoverageMask(Geom::Affine const &ctm, int device_scale)
+    : _key(ctm)
+    , _origin(ctm.translation().round())
+    , _device_scale(device_scale)
+{
+    _key.setTranslation(ctm.translation() - Geom::Point(_origin));
+}
+
+/**
+ * Create an alpha-only surface for an area, initially covering none of it.
+ */
+Cairo::RefPtr<Cairo::ImageSurface> CoverageMask::createSurface(Geom::IntRect const &rect, int device_scale)
+{
+    auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::A8, rect.width() * device_scale, rect.height() * device_scale);
+    cairo_surface_set_device_scale(surface->cobj(), device_scale, device_scale);
+    return surface;
+}
+
+/**
+ * The memory a chunk takes.
+ */
+std::size_t CoverageMask::chunkBytes(int device_scale)
+{
+    auto const stride = cairo_format_stride_for_width(CAIRO_FORMAT_A8, CHUNK_SIZE * device_scale);
+    return std::size_t(stride) * CHUNK_SIZE * device_scale;
+}
+
+/**
+ * The cells of the chunks meeting an area in mask coordinates.
+ */
+std::vector<CoverageMask::Cell> CoverageMask::cells(Geom::IntRect const &area)
+{
+    std::vector<Cell> result;
+    for (int row = cell_of(area.top()); row <= cell_of(area.bottom() - 1); row++) {
+        for (int column = cell_of(area.left()); column <= cell_of(area.right() - 1); column++) {
+            result.emplace_back(column, row);
+        }
+    }
+    return result;
+}
+
+/**
+ * Whether the mask can be used for the shape drawn with another transform: one differing from
+ * the transform it was made for by a translation of whole pixels.
+ */
+bool CoverageMask::fits(Geom::Affine const &ctm) const
+{
+    auto key = ctm;
+    key.setTranslation(ctm.translation() - Geom::Point(ctm.translation().round()));
+    return Geom::are_near(key, _key, 1e-6);
+}
+
+/**
+ * How far the shape drawn with a transform that fits() is shifted from where the mask was made,
+ * that is, the translation from mask coordinates to screen coordinates.
+ */
+Geom::IntPoint CoverageMask::shift(Geom::Affine const &ctm) const
+{
+    return ctm.translation().round() - _origin;
+}
+
+/**
+ * The chunk of a cell, or null if it hasn't been made or has been evicted. The lock must be held.
+ */
+std::shared_ptr<CoverageMask::Chunk> CoverageMask::chunk(Cell const &cell) const
+{
+    auto const it = _chunks.find(cell);
+    return it == _chunks.end() ? nullptr : it->second;
+}
+
+/**
+ * Make the chunk of a cell, unless another tile made it first. Returns the chunk, and whether
+ * it was made. The lock must be held.
+ */
+std::pair<std::shared_ptr<CoverageMask::Chunk>, bool> CoverageMask::addChunk(Cell const &cell)
+{
+    auto &chunk = _chunks[cell];
+    if (chunk) {
+        return {chunk, false};
+    }
+    auto const rect = Geom::IntRect::from_xywh(cell.first * CHUNK_SIZE, cell.second * CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE);
+    chunk = std::make_shared<Chunk>(rect, _device_scale);
+    return {chunk, true};
+}
+
+/**
+ * Throw away the chunk of a cell, taking it off the list of the chunks of the drawing, and
+ * return the memory it took. Tiles still drawing through it keep it until they are done. The
+ * lock and the lock of the drawing's masks must be held.
+ */
+std::size_t CoverageMask::evictChunk(Cell const &cell, ChunkList &chunks)
+{
+    auto const it = _chunks.find(cell);
+    if (it == _chunks.end()) {
+        return 0;
+    }
+    it->second->unlist(chunks);
+    _chunks.erase(it);
+    return chunkBytes(_device_scale);
+}
+
+/**
+ * Throw away all the chunks, as evictChunk() does, returning the memory they took.
+ */
+std::size_t CoverageMask::evictChunks(ChunkList &chunks)
+{
+    auto const result = bytes();
+    for (auto const &[cell, chunk] : _chunks) {
+        chunk->unlist(chunks);
+    }
+    _chunks.clear();
+    return result;
+}
+
+/**
+ * Mark an area in mask coordinates as needing to be rasterised again, because the part of the
+ * path within it changed. The lock must be held.
+ */
+void CoverageMask::invalidate(Geom::IntRect const &area)
+{
+    for (auto const &[cell, chunk] : _chunks) {
+        chunk->invalidate(area);
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Rasterised coverage of the fill or the stroke of a shape.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_COVERAGE_MASK_H
+#define INKSCAPE_DISPLAY_COVERAGE_MASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <cairomm/region.h>
+#include <cairomm/surface.h>
+#include <2geom/affine.h>
+#include <2geom/int-rect.h>
+
+namespace Inkscape {
+
+class DrawingContext;
+
+/**
+ * @brief How much of each pixel the fill or the stroke of a shape covers, at one zoom.
+ *
+ * Alpha-only chunks on a grid of CHUNK_SIZE pixels over the shape. They are made and their
+ * parts rasterised as the tiles meeting them are drawn, and afterwards the tiles are drawn by
+ * compositing the paint through them, without rasterising the path again. The drawing keeps the
+ * chunks of all its shapes in a ChunkList, and evicts the least recently used ones from its end
+ * to keep them within its budget.
+ *
+ * The chunks are in mask coordinates, the screen coordinates of the transform the mask was made
+ * for. Moving the shape by whole pixels only shifts them. The shape throws the mask away when
+ * its path or style change, or its transform changes otherwise, which includes zooming.
+ */
+class CoverageMask
+{
+public:
+    static constexpr int CHUNK_SIZE = 256;
+    using Cell = std::pair<int, int>; ///< The column and row of a chunk.
+    using ChunkList = std::list<std::pair<CoverageMask *, Cell>>; ///< The most recently used first.
+
+    class Chunk
+    {
+    public:
+        Chunk(Geom::IntRect const &rect, int device_scale);
+        Chunk(Chunk const &) = delete;
+        Chunk &operator=(Chunk const &) = delete;
+
+        Geom::IntRect const &rect() const { return _rect; }
+
+        void list(ChunkList &chunks, CoverageMask *mask, Cell const &cell);
+        void use(ChunkList &chunks);
+        void unlist(ChunkList &chunks);
+
+        bool isClean(Geom::IntRect const &area) const;
+        void store(Cairo::RefPtr<Cairo::ImageSurface> const &coverage, Geom::IntRect const &area);
+        void paint(DrawingContext &dc, Geom::IntRect const &area, Geom::IntPoint const &shift) const;
+        void invalidate(Geom::IntRect const &area);
+
+    private:
+        Geom::IntRect _rect;
+        Cairo::RefPtr<Cairo::ImageSurface> _surface;
+        Cairo::RefPtr<Cairo::Region> _clean; ///< The parts that have been rasterised.
+        std::optional<ChunkList::iterator> _entry; ///< In the list of the drawing, unless evicted.
+    };
+
+    CoverageMask(Geom::Affine const &ctm, int device_scale);
+    CoverageMask(CoverageMask const &) = delete;
+    CoverageMask &operator=(CoverageMask const &) = delete;
+
+    static Cairo::RefPtr<Cairo::ImageSurface> createSurface(Geom::IntRect const &rect, int device_scale);
+    static std::size_t chunkBytes(int device_scale);
+    static std::vector<Cell> cells(Geom::IntRect const &area);
+
+    int deviceScale() const { return _device_scale; }
+    bool fits(Geom::Affine const &ctm) const;
+    Geom::IntPoint shift(Geom::Affine const &ctm) const;
+
+    /// Must be held while using the mask, as the tiles of a shape may be drawn in parallel.
+    std::unique_lock<std::mutex> lock() const { return std::unique_lock(_mutex); }
+
+    std::shared_ptr<Chunk> chunk(Cell const &cell) const;
+    std::pair<std::shared_ptr<Chunk>, bool> addChunk(Cell const &cell);
+    std::size_t evictChunk(Cell const &cell, ChunkList &chunks);
+    std::size_t evictChunks(ChunkList &chunks);
+    std::size_t bytes() const { return _chunks.size() * chunkBytes(_device_scale); }
+    void invalidate(Geom::IntRect const &area);
+
+private:
+    Geom::Affine _key; ///< The transform made for, with only the sub-pixel part of its translation.
+    Geom::IntPoint _origin; ///< The whole pixels of the translation of that transform.
+    int _device_scale;
+    std::map<Cell, std::shared_ptr<Chunk>> _chunks;
+    mutable std::mutex _mutex;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_COVERAGE_MASK_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
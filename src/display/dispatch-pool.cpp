@@ -7,6 +7,10 @@
 
 #include "dispatch-pool.h"
 
+#include <string>
+
+#include "debug/trace.h"
+
 namespace Inkscape {
 
 dispatch_pool::dispatch_pool(int size)
@@ -40,6 +44,24 @@ dispatch_pool::~dispatch_pool()
 void dispatch_pool::dispatch(int count, dispatch_func function)
 {
     std::scoped_lock lk(_dispatch_lock);
+    run_dispatch(count, std::move(function));
+}
+
+/**
+ * Like dispatch(), but returns false without running anything if another dispatch is in progress.
+ */
+bool dispatch_pool::try_dispatch(int count, dispatch_func function)
+{
+    std::unique_lock lk(_dispatch_lock, std::try_to_lock);
+    if (!lk) {
+        return false;
+    }
+    run_dispatch(count, std::move(function));
+    return true;
+}
+
+void dispatch_pool::run_dispatch(int count, dispatch_func function)
+{
     std::unique_lock lk2(_lock);
 
     _available_work = global_id{};
@@ -61,6 +83,8 @@ void dispatch_pool::thread_func(local_id id)
 {
     int const thread_count = size();
 
+    Debug::Trace::setThreadName("dispatch worker " + std::to_string(id));
+
     std::unique_lock lk(_lock);
 
     // TODO C++20: no need for _shutdown member once stop_token is available
@@ -97,6 +121,7 @@ void dispatch_pool::execute_batch(std::unique_lock<std::mutex> &lk, local_id id,
         _available_cv.notify_one();
 
         // Execute the function
+        auto span = Debug::Trace::Span("dispatch", "batch");
         for (global_id index = start; index < end; index++) {
             _function(index, id);
         }
@@ -50,7 +50,9 @@ namespace Inkscape {
  * how many threads it has been created with.
  *
  * By design, only one dispatch may run at a time. It is safe to call dispatch() from multiple
- * threads without extra locking.
+ * threads without extra locking. Callers which would rather do the work themselves than wait
+ * for another dispatch to finish can use try_dispatch(). A dispatch must not be started from
+ * inside a job of the same pool.
  *
  * Terminology used is designed to loosely follow that of OpenCL kernels or GL/VK compute shaders:
  * - Global ID within a dispatch refers to the 0-based counter value for a given job.
@@ -72,6 +74,7 @@ public:
     ~dispatch_pool();
 
     void dispatch(int count, dispatch_func function);
+    bool try_dispatch(int count, dispatch_func function);
 
     template <typename F>
     void dispatch_threshold(int count, bool threshold, F &&function)
@@ -92,6 +95,7 @@ public:
     }
 
 private:
+    void run_dispatch(int count, dispatch_func function);
     void thread_func(local_id id);
     void execute_batch(std::unique_lock<std::mutex> &lk, local_id id, int thread_count);
 
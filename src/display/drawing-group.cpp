@@ -11,14 +11,33 @@
  */
 
 #include "drawing-group.h"
+
 #include "cairo-utils.h"
 #include "drawing-context.h"
+#include "drawing-pick-buffer.h"
 #include "drawing-surface.h"
 #include "drawing-text.h"
 #include "drawing.h"
 #include "style.h"
 
 namespace Inkscape {
+namespace {
+
+/// Groups with fewer children test the box of each of them.
+constexpr std::size_t CHILD_INDEX_THRESHOLD = 64;
+
+/// The area in which any of the ways of rendering or picking a child might find it.
+Geom::OptIntRect child_index_box(DrawingItem const &child)
+{
+    auto box = child.drawbox();
+    box.unionWith(child.bbox());
+    if (auto glyphs = cast<DrawingGlyphs>(&child)) {
+        box.unionWith(glyphs->getPickBox());
+    }
+    return box;
+}
+
+} // namespace
 
 DrawingGroup::DrawingGroup(Drawing &drawing)
     : DrawingItem(drawing) {}
@@ -30,7 +49,11 @@ DrawingGroup::DrawingGroup(Drawing &drawing)
 void DrawingGroup::setPickChildren(bool pick_children)
 {
     defer([=, this] {
+        if (pick_children == _pick_children) return;
         _pick_children = pick_children;
+        if (auto buffer = _drawing.pickBuffer(); buffer && _drawbox) {
+            buffer->invalidate(*_drawbox);
+        }
     });
 }
 
@@ -71,15 +94,61 @@ unsigned DrawingGroup::_updateItem(Geom::IntRect const &area, UpdateContext cons
         _contains_unisolated_blend |= c.unisolatedBlend();
     }
 
+    _updateChildIndex();
+
     return STATE_ALL;
 }
 
+/**
+ * Bring the index of the children up to date with their boxes. It is only regrouped when the
+ * children changed or many of them moved.
+ */
+void DrawingGroup::_updateChildIndex()
+{
+    if (_children.size() < CHILD_INDEX_THRESHOLD || !_drawing.childIndexing()) {
+        _indexed_children.clear();
+        _child_index.clear();
+        return;
+    }
+
+    std::vector<DrawingItem *> children;
+    std::vector<Geom::OptIntRect> boxes;
+    children.reserve(_children.size());
+    boxes.reserve(_children.size());
+    for (auto &c : _children) {
+        children.push_back(&c);
+        boxes.push_back(child_index_box(c));
+    }
+
+    if (children != _indexed_children) {
+        _indexed_children = std::move(children);
+        _child_index.clear();
+    }
+    _child_index.setBoxes(std::move(boxes));
+}
+
+/**
+ * Drop the index of the children until the next update, since it lists them by their position.
+ */
+void DrawingGroup::_childrenChanged()
+{
+    _indexed_children.clear();
+    _child_index.clear();
+    _markForUpdate(STATE_ALL, false);
+}
+
 unsigned DrawingGroup::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const
 {
     if (!stop_at) {
         // normal rendering
-        for (auto &i : _children) {
-            i.render(dc, rc, area, flags, stop_at);
+        if (!_indexed_children.empty() && !(flags & RENDER_OUTLINE)) {
+            for (auto index : _child_index.query(area)) {
+                _indexed_children[index]->render(dc, rc, area, flags, stop_at);
+            }
+        } else {
+            for (auto &i : _children) {
+                i.render(dc, rc, area, flags, stop_at);
+            }
         }
     } else {
         // background rendering
@@ -108,6 +177,17 @@ void DrawingGroup::_clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRec
 
 DrawingItem *DrawingGroup::_pickItem(Geom::Point const &p, double delta, unsigned flags)
 {
+    if (!_indexed_children.empty()) {
+        auto area = Geom::Rect(p, p);
+        area.expandBy(delta);
+        for (auto index : _child_index.query(area.roundOutwards())) {
+            if (auto picked = _indexed_children[index]->pick(p, delta, flags)) {
+                return _pick_children ? picked : this;
+            }
+        }
+        return nullptr;
+    }
+
     for (auto &i : _children) {
         DrawingItem *picked = i.pick(p, delta, flags);
         if (picked) {
@@ -117,6 +197,22 @@ DrawingItem *DrawingGroup::_pickItem(Geom::Point const &p, double delta, unsigne
     return nullptr;
 }
 
+void DrawingGroup::_renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                                  DrawingItem const *target) const
+{
+    // pick() returns the first child hit, so it is painted last.
+    if (!_indexed_children.empty()) {
+        auto const indices = _child_index.query(area);
+        for (auto it = indices.rbegin(); it != indices.rend(); ++it) {
+            _indexed_children[*it]->renderPickIds(dc, area, buffer, target);
+        }
+        return;
+    }
+    for (auto it = _children.rbegin(); it != _children.rend(); ++it) {
+        it->renderPickIds(dc, area, buffer, target);
+    }
+}
+
 } // namespace Inkscape
 
 /*
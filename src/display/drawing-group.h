@@ -13,6 +13,9 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_GROUP_H
 #define INKSCAPE_DISPLAY_DRAWING_GROUP_H
 
+#include <vector>
+
+#include "display/bounding-box-tree.h"
 #include "display/drawing-item.h"
 
 namespace Inkscape {
@@ -36,9 +39,19 @@ protected:
     unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
     void _clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const override;
     DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
+    void _renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                        DrawingItem const *target) const override;
     bool _canClip() const override { return true; }
+    void _childrenChanged() override;
+
+    void _updateChildIndex();
 
     std::unique_ptr<Geom::Affine> _child_transform;
+
+    /// For groups with many children, the children indexed by their boxes, so that rendering
+    /// and picking only visit those in the area. Empty while not up to date.
+    std::vector<DrawingItem *> _indexed_children;
+    BoundingBoxTree _child_index;
 };
 
 } // namespace Inkscape
@@ -16,6 +16,8 @@
 #include "display/drawing-group.h"
 #include "display/drawing-item.h"
 #include "display/drawing-pattern.h"
+#include "display/drawing-pick-buffer.h"
+#include "display/drawing-profiler.h"
 #include "display/drawing-surface.h"
 #include "display/drawing-text.h"
 #include "display/drawing.h"
@@ -112,6 +114,13 @@ DrawingItem::~DrawingItem()
     // Remove from the set of cached items and delete cache.
     _setCached(false, true);
 
+    if (auto profiler = _drawing.profiler()) {
+        profiler->forget(this);
+    }
+    if (auto buffer = _drawing.pickBuffer()) {
+        buffer->forget(this);
+    }
+
     _children.clear_and_dispose([] (auto c) { delete c; });
     delete _clip;
     delete _mask;
@@ -148,6 +157,7 @@ void DrawingItem::appendChild(DrawingItem *item)
 
     defer([=, this] {
         _children.push_back(*item);
+        _childrenChanged();
 
         // This ensures that _markForUpdate() called on the child will recurse to this item
         item->_state = STATE_ALL;
@@ -168,6 +178,7 @@ void DrawingItem::prependChild(DrawingItem *item)
 
     defer([=, this] {
         _children.push_front(*item);
+        _childrenChanged();
         item->_state = STATE_ALL;
         item->_markForUpdate(STATE_ALL, true);
     });
@@ -180,6 +191,7 @@ void DrawingItem::clearChildren()
         if (_children.empty()) return;
         _markForRendering();
         _children.clear_and_dispose([] (auto c) { delete c; });
+        _childrenChanged();
         _markForUpdate(STATE_ALL, false);
     });
 }
@@ -245,7 +257,11 @@ void DrawingItem::setVisible(bool visible)
 void DrawingItem::setSensitive(bool sensitive)
 {
     defer([=, this] { // Must be deferred, since in bitfield.
+        if (sensitive == _sensitive) return;
         _sensitive = sensitive;
+        if (auto buffer = _drawing.pickBuffer(); buffer && _drawbox) {
+            buffer->invalidate(*_drawbox);
+        }
     });
 }
 
@@ -414,6 +430,7 @@ void DrawingItem::setZOrder(unsigned zorder)
         auto it2 = _parent->_children.begin();
         std::advance(it2, std::min<unsigned>(zorder, _parent->_children.size()));
         _parent->_children.insert(it2, *this);
+        _parent->_childrenChanged();
         _markForRendering();
     });
 }
@@ -481,6 +498,8 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
         if (!area.intersects(outline ? _bbox : _drawbox)) return;
     }
 
+    auto const profile = DrawingProfiler::Timer(_drawing.profiler(), this, DrawingProfiler::UPDATE);
+
     // compute which elements need an update
     unsigned to_update = _state ^ flags;
 
@@ -535,7 +554,6 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
         if (_cache && _cache->surface) {
             _cache->surface->markDirty();
         }
-        _dropPatternCache();
     }
 
     // Decide whether this node should be a totally-invalidating node.
@@ -670,7 +688,7 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
         }
         if (!totally_invalidated) {
             if (!is<DrawingGroup>(this) || (_filter && filters) || totally_invalidate) {
-                _markForRendering();
+                _markForRendering(true);
             }
         }
     }
@@ -751,6 +769,9 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
     // Device scale for HiDPI screens (typically 1 or 2)
     int const device_scale = dc.surface()->device_scale();
 
+    auto profile = DrawingProfiler::Timer(_drawing.profiler(), this, DrawingProfiler::RENDER);
+    profile.addPixels(std::uint64_t(carea->area()) * device_scale * device_scale);
+
     std::unique_lock<std::mutex> lock;
 
     // Render from cache if possible, unless requested not to (hatches).
@@ -765,6 +786,7 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
             dc.setOperator(ink_css_blend_to_cairo_operator(_blend_mode));
             _cache->surface->paintFromCache(dc, carea, forcecache);
             if (!carea) {
+                profile.cacheHit();
                 dc.setSource(0, 0, 0, 0);
                 return RENDER_OK;
             }
@@ -876,6 +898,7 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
 
     // 4. Apply filter.
     if (_filter && render_filters) {
+        auto const filter_profile = DrawingProfiler::Timer(_drawing.profiler(), this, DrawingProfiler::FILTER);
         bool rendered = false;
         if (_filter->uses_background() && _background_accumulate) {
             auto bg_root = this;
@@ -1073,6 +1096,46 @@ DrawingItem *DrawingItem::pick(Geom::Point const &p, double delta, unsigned flag
     return nullptr;
 }
 
+/**
+ * Paint each pixel of an area with the id of the item pick() returns there without tolerance,
+ * for a DrawingPickBuffer. Items paint in reverse order of picking, so that the item pick()
+ * tries first ends up on top. The drawing must be up to date.
+ * @param target The item to paint the pixels of this item as, if not this item itself.
+ */
+void DrawingItem::renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                                DrawingItem const *target) const
+{
+    if (!_visible || !_sensitive || !(_state & STATE_PICK)) {
+        return;
+    }
+    auto const box = Geom::intersect(area, _drawbox);
+    if (!box) {
+        return;
+    }
+
+    if (!target && !_pick_children) {
+        target = this;
+    }
+
+    if (_clip || _mask) {
+        // Whether the clip or mask lets picks through is left to pick().
+        buffer.paintUnknown(dc, *box);
+        return;
+    }
+
+    _renderPickIds(dc, *box, buffer, target);
+}
+
+/**
+ * Paint the pixels where this item is picked. Items which don't know where that is, like
+ * images picked by the alpha of their pixels, leave it to pick().
+ */
+void DrawingItem::_renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                                 DrawingItem const *target) const
+{
+    buffer.paintUnknown(dc, area);
+}
+
 // For debugging
 Glib::ustring DrawingItem::name() const
 {
@@ -1107,13 +1170,29 @@ void DrawingItem::recursivePrintTree(unsigned level) const
  * This is called whenever the object changes its visible appearance.
  * For some cases (such as setting opacity) this is enough, but for others
  * _markForUpdate() also needs to be called.
+ *
+ * During an update, the item may only have been moved, e.g. by a zoom, which
+ * does not change what the pattern tiles containing it look like. In that case
+ * from_update is set and pattern caches are left alone; real changes to the
+ * content have already dropped them through _markForUpdate().
  */
-void DrawingItem::_markForRendering()
+void DrawingItem::_markForRendering(bool from_update)
 {
     bool outline = _drawing.renderMode() == RenderMode::OUTLINE || _drawing.outlineOverlay();
     Geom::OptIntRect dirty = outline ? _bbox : _drawbox;
     if (!dirty) return;
 
+    _markAreaForRendering(*dirty, from_update);
+}
+
+/**
+ * Marks only part of the item for redrawing, for changes known not to reach beyond it.
+ * The area is in screen coordinates.
+ */
+void DrawingItem::_markAreaForRendering(Geom::IntRect const &area, bool from_update)
+{
+    Geom::OptIntRect dirty = area;
+
     // dirty the caches of all parents
     DrawingItem *bkg_root = nullptr;
 
@@ -1124,7 +1203,9 @@ void DrawingItem::_markForRendering()
         if (i->_cache && i->_cache->surface) {
             i->_cache->surface->markDirty(*dirty);
         }
-        i->_dropPatternCache();
+        if (!from_update) {
+            i->_dropPatternCache();
+        }
         if (i->_background_accumulate) {
             bkg_root = i;
         }
@@ -1137,6 +1218,10 @@ void DrawingItem::_markForRendering()
     if (auto canvasitem = drawing().getCanvasItemDrawing()) {
         canvasitem->get_canvas()->redraw_area(*dirty);
     }
+
+    if (auto buffer = _drawing.pickBuffer()) {
+        buffer->invalidate(*dirty);
+    }
 }
 
 void DrawingItem::_invalidateFilterBackground(Geom::IntRect const &area)
@@ -1178,6 +1263,10 @@ void DrawingItem::_markForUpdate(unsigned flags, bool propagate)
         _state &= ~flags;
         if (oldstate != _state && _parent) {
             // If we actually reset anything in state, recurse on the parent.
+            if (flags & STATE_RENDER) {
+                // The appearance of a descendant changed, so tiles of any pattern containing it are stale.
+                _parent->_dropPatternCache();
+            }
             _parent->_markForUpdate(flags, false);
         } else {
             // If nothing changed, it means our ancestors are already invalidated
@@ -1286,6 +1375,7 @@ void DrawingItem::unlink()
             case ChildType::NORMAL: {
                 auto it = _parent->_children.iterator_to(*this);
                 _parent->_children.erase(it);
+                _parent->_childrenChanged();
                 break;
             }
             case ChildType::CLIP:
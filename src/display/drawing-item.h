@@ -39,6 +39,7 @@ class Drawing;
 class DrawingCache;
 class DrawingItem;
 class DrawingPattern;
+class DrawingPickBuffer;
 class DrawingContext;
 
 namespace Filters { class Filter; }
@@ -161,6 +162,8 @@ public:
     unsigned render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags = 0) const;
     void clip(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const;
     DrawingItem *pick(Geom::Point const &p, double delta, unsigned flags = 0);
+    void renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                       DrawingItem const *target = nullptr) const;
 
     Glib::ustring name() const; // For debugging
     void recursivePrintTree(unsigned level = 0) const;  // For debugging
@@ -184,7 +187,8 @@ protected:
     virtual ~DrawingItem(); // Private to prevent deletion of items that are still in use by a snapshot.
     void _renderOutline(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags) const;
     void _markForUpdate(unsigned state, bool propagate);
-    void _markForRendering();
+    void _markForRendering(bool from_update = false);
+    void _markAreaForRendering(Geom::IntRect const &area, bool from_update = false);
     void _invalidateFilterBackground(Geom::IntRect const &area);
     double _cacheScore();
     Geom::OptIntRect _cacheRect() const;
@@ -193,8 +197,11 @@ protected:
     virtual unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const { return RENDER_OK; }
     virtual void _clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const {}
     virtual DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) { return nullptr; }
+    virtual void _renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                                DrawingItem const *target) const;
     virtual bool _canClip() const { return false; }
     virtual void _dropPatternCache() {}
+    virtual void _childrenChanged() {}
 
     Drawing &_drawing;
     DrawingItem *_parent;
@@ -49,6 +49,9 @@ public:
     /// Return whether create_pattern() uses its cairo_t argument. Such pattern cannot be cached, but recreated each time.
     /// Fixme: The only reson this exists is to work around https://gitlab.freedesktop.org/cairo/cairo/-/issues/146.
     virtual bool uses_cairo_ctx() const { return false; }
+
+    /// Return whether the pattern depends on the bounding box passed to create_pattern().
+    virtual bool uses_bbox() const { return false; }
 };
 
 // Todo: Remove, merging with existing implementation for solid colours.
@@ -79,6 +82,7 @@ protected:
         , transform(transform) {}
 
     bool ditherable() const override { return true; }
+    bool uses_bbox() const override { return units == SP_GRADIENT_UNITS_OBJECTBOUNDINGBOX; }
 
     /// Perform some common initialization steps on the given Cairo pattern.
     void common_setup(cairo_pattern_t *pat, Geom::OptRect const &bbox, double opacity) const;
@@ -19,23 +19,29 @@
 #include "drawing-surface.h"
 #include "drawing.h"
 #include "helper/geom.h"
+#include "pattern-cache.h"
 #include "ui/util.h"
 
 namespace Inkscape {
 
 auto constexpr PATTERN_MATRIX_EPSILON = 1e-18;
 
-DrawingPattern::Surface::Surface(Geom::IntRect const &rect, int device_scale)
-    : rect(rect)
-    , surface(Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, rect.width() * device_scale, rect.height() * device_scale))
-{
-    cairo_surface_set_device_scale(surface->cobj(), device_scale, device_scale);
-}
+// Steps per octave at which the canvas renders pattern tiles, so that tiles can be reused between
+// nearby zoom levels.
+auto constexpr PATTERN_SCALE_STEPS = 4;
 
 DrawingPattern::DrawingPattern(Drawing &drawing)
     : DrawingGroup(drawing)
     , _overflow_steps(1)
+    , _tile_cache(std::make_shared<PatternCache>())
+{
+}
+
+DrawingPattern::~DrawingPattern()
 {
+    // The cache outlives us if it is shared. Don't leave tiles behind that nothing may ever drop,
+    // as the content can change while this drawing has no view of the pattern.
+    _tile_cache->drop(&drawing());
 }
 
 void DrawingPattern::setPatternToUserTransform(Geom::Affine const &transform)
@@ -54,6 +60,9 @@ void DrawingPattern::setPatternToUserTransform(Geom::Affine const &transform)
 void DrawingPattern::setTileRect(Geom::Rect const &tile_rect)
 {
     defer([=, this] {
+        if (_tile_rect == tile_rect) {
+            return;
+        }
         _tile_rect = tile_rect;
         _markForUpdate(STATE_ALL, true);
     });
@@ -68,6 +77,13 @@ void DrawingPattern::setOverflow(Geom::Affine const &initial_transform, int step
     });
 }
 
+void DrawingPattern::setTileCache(std::shared_ptr<PatternCache> cache)
+{
+    defer([this, cache = std::move(cache)] {
+        _tile_cache = cache;
+    });
+}
+
 cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect const &area, float opacity, int device_scale) const
 {
     if (opacity < 1e-3) {
@@ -134,7 +150,7 @@ cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect
     };
 
     // Paint the periodic tiling of a into b, and remove the painted region from dirty.
-    auto wrapped_paint = [&, this] (Surface const &a, Geom::IntRect &b, Cairo::RefPtr<Cairo::Context> const &cr, Cairo::RefPtr<Cairo::Region> const &dirty) {
+    auto wrapped_paint = [&, this] (PatternCache::Surface const &a, Geom::IntRect &b, Cairo::RefPtr<Cairo::Context> const &cr, Cairo::RefPtr<Cairo::Region> const &dirty) {
         auto const [min, max] = overlapping_translates(a.rect, b);
         for (int x = min.x(); x <= max.x(); x += _pattern_resolution.x()) {
             for (int y = min.y(); y <= max.y(); y += _pattern_resolution.y()) {
@@ -150,11 +166,29 @@ cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect
     auto const area_orig = (Geom::Rect(area) * screen_to_tile).roundOutwards();
     auto const area_tile = canonicalised(area_orig);
 
+    // Everything apart from the content which determines what the tiles look like.
+    auto key = PatternCache::Key{
+        .drawing = &drawing(),
+        .generation = drawing().patternGeneration(),
+        .resolution = _pattern_resolution,
+        .tile_rect = *_tile_rect,
+        .child_transform = _child_transform ? *_child_transform : Geom::identity(),
+        .overflow_initial_transform = _overflow_initial_transform,
+        .overflow_step_transform = _overflow_step_transform,
+        .overflow_steps = _overflow_steps,
+        .opacity = opacity,
+        .device_scale = device_scale,
+        .antialiasing = rc.antialiasing_override ? (int)*rc.antialiasing_override : -1,
+        .dithering = rc.dithering
+    };
+
     // Simplest solution for now to protecting pattern cache is a mutex. This makes all
     // pattern rendering single-threaded, however patterns are typically not the bottleneck.
-    auto lock = std::lock_guard(mutables);
+    auto lock = _tile_cache->lock();
+    auto &entry = _tile_cache->get(key);
+    auto &surfaces = entry.surfaces;
 
-    auto get_surface = [&, this] () -> std::pair<Surface*, Cairo::RefPtr<Cairo::Region>> {
+    auto get_surface = [&, this] () -> std::pair<PatternCache::Surface*, Cairo::RefPtr<Cairo::Region>> {
         // If there is a rectangle containing the requested area, just use that.
         for (auto &s : surfaces) {
             if (wrapped_contains(s.rect, area_tile)) {
@@ -163,7 +197,7 @@ cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect
         }
 
         // Otherwise, recursively merge the requested area with all overlapping or touching rectangles, and paint the missing part.
-        std::vector<Surface> merged;
+        std::vector<PatternCache::Surface> merged;
         auto expanded = area_tile;
 
         while (true) {
@@ -188,7 +222,7 @@ cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect
         expanded = canonicalised(expanded);
 
         // Create a new surface covering the expanded rectangle.
-        auto surface = Surface(expanded, device_scale);
+        auto surface = PatternCache::Surface(expanded, device_scale);
         auto cr = Cairo::Context::create(surface.surface);
         cr->translate(-surface.rect.left(), -surface.rect.top());
 
@@ -258,6 +292,7 @@ cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect
             }
         }
         dirty.reset();
+        _tile_cache->commit(entry);
     }
 
     // Debug: Show pattern tile.
@@ -276,8 +311,8 @@ cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect
 
 unsigned DrawingPattern::_updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset)
 {
-    _dropPatternCache();
-
+    // Rendered tiles are kept in the tile cache keyed by resolution, so there is nothing to drop here.
+    // They are only thrown away by _dropPatternCache() when the content changes.
     if (!_tile_rect || _tile_rect->hasZeroArea()) {
         return STATE_NONE;
     }
@@ -286,6 +321,11 @@ unsigned DrawingPattern::_updateItem(Geom::IntRect const &area, UpdateContext co
     double const det_ctm = ctx.ctm.det();
     double const det_ps2user = _pattern_to_user ? _pattern_to_user->det() : 1.0;
     double scale = std::sqrt(std::abs(det_ctm * det_ps2user));
+    if (drawing().getCanvasItemDrawing() && scale > 0.0) {
+        // On the canvas, round the scale up to the next step, so zooming in and out
+        // finds tiles of the same resolution in the cache.
+        scale = std::exp2(std::ceil(std::log2(scale) * PATTERN_SCALE_STEPS) / PATTERN_SCALE_STEPS);
+    }
     // Fixme: When scale is too big (zooming in a pattern), Cairo doesn't render the pattern.
     // More precisely it fails when setting pattern matrix in DrawingPattern::renderPattern.
     // Correct solution should make use of visible area and change pattern tile rect accordingly.
@@ -301,7 +341,7 @@ unsigned DrawingPattern::_updateItem(Geom::IntRect const &area, UpdateContext co
 
 void DrawingPattern::_dropPatternCache()
 {
-    surfaces.clear();
+    _tile_cache->drop(&drawing());
 }
 
 } // namespace Inkscape
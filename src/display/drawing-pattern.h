@@ -13,14 +13,15 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_PATTERN_H
 #define INKSCAPE_DISPLAY_DRAWING_PATTERN_H
 
-#include <mutex>
-#include <cairomm/surface.h>
+#include <memory>
 #include "drawing-group.h"
 
 using cairo_pattern_t = struct _cairo_pattern;
 
 namespace Inkscape {
 
+class PatternCache;
+
 /**
  * @brief Drawing tree node used for rendering paints.
  *
@@ -55,6 +56,12 @@ public:
      */
     void setOverflow(Geom::Affine const &initial_transform, int steps, Geom::Affine const &step_transform);
 
+    /**
+     * Share rendered tiles with other DrawingPatterns showing the same pattern.
+     * By default, every DrawingPattern has a cache of its own.
+     */
+    void setTileCache(std::shared_ptr<PatternCache> cache);
+
     /**
      * Render the pattern.
      *
@@ -63,7 +70,7 @@ public:
     cairo_pattern_t *renderPattern(RenderContext &rc, Geom::IntRect const &area, float opacity, int device_scale) const;
 
 protected:
-    ~DrawingPattern() override = default;
+    ~DrawingPattern() override;
 
     unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) override;
 
@@ -81,17 +88,9 @@ protected:
     // Set on update.
     Geom::IntPoint _pattern_resolution;
 
-    struct Surface
-    {
-        Surface(Geom::IntRect const &rect, int device_scale);
-        Geom::IntRect rect;
-        Cairo::RefPtr<Cairo::ImageSurface> surface;
-    };
-
-    mutable std::mutex mutables;
-
-    // Parts of the pattern tile that have been rendered. Read/written on render, cleared on update.
-    mutable std::vector<Surface> surfaces;
+    // Parts of the pattern tile that have been rendered. Read/written on render, cleared when the
+    // pattern content changes.
+    std::shared_ptr<PatternCache> _tile_cache;
 };
 
 } // namespace Inkscape
@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Buffer of the items picked at each pixel of a drawing.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "drawing-pick-buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cairo.h>
+
+#include "debug/trace.h"
+#include "display/drawing-context.h"
+#include "display/drawing-item.h"
+
+namespace Inkscape {
+namespace {
+
+/// Areas rendered longest ago are forgotten beyond this many pixels, 32 MiB worth of them.
+constexpr std::size_t MAX_PIXELS = 8 << 20;
+
+/// The id painted where only geometric picking knows the item. Ids are the 24 bits of an opaque
+/// color, so that ids survive painting unchanged; 0 is left for transparent pixels.
+constexpr std::uint32_t UNKNOWN_ID = 0xffffff;
+
+} // namespace
+
+/**
+ * Render the ids of the items picked in an area of the drawing, which must be up to date,
+ * unless they are known already.
+ */
+void DrawingPickBuffer::render(DrawingItem const &root, Geom::IntRect const &area)
+{
+    auto span = Debug::Trace::Span("drawing", "render pick ids");
+
+    std::list<Pending>::iterator pending;
+    {
+        auto lock = std::lock_guard(_mutex);
+        if (std::any_of(_chunks.begin(), _chunks.end(), [&] (Chunk const &c) { return c.rect.contains(area); })) {
+            return; // Already known.
+        }
+        pending = _pending.insert(_pending.end(), Pending{area});
+    }
+
+    Chunk chunk{area, std::vector<std::uint32_t>(area.area(), 0)};
+    auto const surface = cairo_image_surface_create_for_data(reinterpret_cast<unsigned char *>(chunk.pixels.data()),
+                                                             CAIRO_FORMAT_ARGB32, area.width(), area.height(),
+                                                             area.width() * sizeof(std::uint32_t));
+    {
+        auto dc = DrawingContext(surface, area.min());
+        cairo_set_antialias(dc.raw(), CAIRO_ANTIALIAS_NONE);
+        root.renderPickIds(dc, area, *this);
+    }
+    cairo_surface_destroy(surface);
+
+    auto lock = std::lock_guard(_mutex);
+    bool const stale = pending->stale;
+    _pending.erase(pending);
+    if (stale) {
+        return;
+    }
+
+    // The new chunk replaces the older ones it covers.
+    auto const end = std::remove_if(_chunks.begin(), _chunks.end(), [&] (Chunk const &c) {
+        return area.contains(c.rect);
+    });
+    for (auto it = end; it != _chunks.end(); ++it) {
+        _pixels -= it->pixels.size();
+    }
+    _chunks.erase(end, _chunks.end());
+
+    _pixels += chunk.pixels.size();
+    _chunks.push_back(std::move(chunk));
+    while (_pixels > MAX_PIXELS && _chunks.size() > 1) {
+        _pixels -= _chunks.front().pixels.size();
+        _chunks.pop_front();
+    }
+}
+
+/**
+ * The item picking returns at a point, if all the pixels within the tolerance show the same
+ * one, or null if that isn't known.
+ */
+DrawingItem *DrawingPickBuffer::lookup(Geom::Point const &p, double delta) const
+{
+    auto const pixels = Geom::IntRect(Geom::IntPoint(std::floor(p.x() - delta), std::floor(p.y() - delta)),
+                                      Geom::IntPoint(std::floor(p.x() + delta), std::floor(p.y() + delta)) + Geom::IntPoint(1, 1));
+
+    auto lock = std::lock_guard(_mutex);
+    for (auto it = _chunks.rbegin(); it != _chunks.rend(); ++it) {
+        if (!it->rect.contains(pixels)) {
+            continue;
+        }
+        auto const stride = it->rect.width();
+        auto const offset = pixels.min() - it->rect.min();
+        auto const value = it->pixels[offset.y() * stride + offset.x()];
+        auto const id = value & 0xffffff;
+        if (!(value >> 24) || id == UNKNOWN_ID) {
+            return nullptr;
+        }
+        for (int y = 0; y < pixels.height(); y++) {
+            auto const row = it->pixels.data() + (offset.y() + y) * stride + offset.x();
+            if (!std::all_of(row, row + pixels.width(), [&] (auto v) { return v == value; })) {
+                return nullptr;
+            }
+        }
+        return _items[id - 1];
+    }
+    return nullptr;
+}
+
+/**
+ * Forget an area whose items changed.
+ */
+void DrawingPickBuffer::invalidate(Geom::IntRect const &area)
+{
+    auto lock = std::lock_guard(_mutex);
+    for (auto &pending : _pending) {
+        if (pending.rect.intersects(area)) {
+            pending.stale = true;
+        }
+    }
+    auto const end = std::remove_if(_chunks.begin(), _chunks.end(), [&] (Chunk const &c) {
+        return c.rect.intersects(area);
+    });
+    for (auto it = end; it != _chunks.end(); ++it) {
+        _pixels -= it->pixels.size();
+    }
+    _chunks.erase(end, _chunks.end());
+}
+
+/**
+ * Forget an item about to be destroyed. Its pixels become unknown.
+ */
+void DrawingPickBuffer::forget(DrawingItem const *item)
+{
+    auto lock = std::lock_guard(_mutex);
+    if (auto const it = _ids.find(item); it != _ids.end()) {
+        _items[it->second - 1] = nullptr;
+        _ids.erase(it);
+    }
+}
+
+/**
+ * Forget everything, for when all of the drawing changes.
+ */
+void DrawingPickBuffer::clear()
+{
+    auto lock = std::lock_guard(_mutex);
+    for (auto &pending : _pending) {
+        pending.stale = true;
+    }
+    _chunks.clear();
+    _pixels = 0;
+    _items.clear();
+    _ids.clear();
+}
+
+std::size_t DrawingPickBuffer::pixels() const
+{
+    auto lock = std::lock_guard(_mutex);
+    return _pixels;
+}
+
+/**
+ * Paint with the id of an item, giving it one if it has none yet.
+ */
+void DrawingPickBuffer::setSource(DrawingContext &dc, DrawingItem const *target)
+{
+    std::uint32_t id = UNKNOWN_ID;
+    {
+        auto lock = std::lock_guard(_mutex);
+        if (auto const it = _ids.find(target); it != _ids.end()) {
+            id = it->second;
+        } else if (_items.size() + 1 < UNKNOWN_ID) {
+            _items.push_back(const_cast<DrawingItem *>(target));
+            id = _items.size();
+            _ids.emplace(target, id);
+        }
+    }
+    dc.setSource(id << 8 | 0xff);
+}
+
+/**
+ * Mark an area as only known by geometric picking.
+ */
+void DrawingPickBuffer::paintUnknown(DrawingContext &dc, Geom::IntRect const &area)
+{
+    dc.setSource(UNKNOWN_ID << 8 | 0xff);
+    dc.rectangle(area);
+    dc.fill();
+}
+
+/**
+ * Mark the pixels within the border of the current path, or of a line of the given half width
+ * along it, as only known by geometric picking. Keeps the path.
+ */
+void DrawingPickBuffer::strokeUnknown(DrawingContext &dc, double half_width)
+{
+    dc.setSource(UNKNOWN_ID << 8 | 0xff);
+    dc.setLineWidth(2 * (half_width + BORDER));
+    dc.strokePreserve();
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
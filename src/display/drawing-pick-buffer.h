@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Buffer of the items picked at each pixel of a drawing.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_DRAWING_PICK_BUFFER_H
+#define INKSCAPE_DISPLAY_DRAWING_PICK_BUFFER_H
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <2geom/int-rect.h>
+#include <2geom/point.h>
+
+namespace Inkscape {
+
+class DrawingContext;
+class DrawingItem;
+
+/**
+ * @brief Which item picking returns at each pixel of the areas rendered last
+ *
+ * Picking an item tests the geometry of every item whose bounding box contains the point,
+ * which is slow for dense drawings and huge paths. Next to its tiles, the canvas can render
+ * the areas of its drawing a second time with each item painted in a flat color that
+ * identifies what DrawingItem::pick() returns there, so that most picks become a lookup.
+ *
+ * A pick is only known this way where all the pixels within its tolerance show the same item.
+ * Ids are painted without antialiasing, so a pixel only shows the item at its center; items
+ * paint a border of unknown pixels along their edges, which covers all of them where they are
+ * thinner than the border. Elsewhere, and at the pixels of items whose picking isn't painted, like clipped items and
+ * images, lookup() returns null and picking falls back to the geometry. Areas are forgotten
+ * as soon as the items in them change, and items as soon as they are destroyed.
+ *
+ * Areas may be rendered from several threads at once.
+ */
+class DrawingPickBuffer
+{
+public:
+    DrawingPickBuffer() = default;
+    DrawingPickBuffer(DrawingPickBuffer const &) = delete;
+    DrawingPickBuffer &operator=(DrawingPickBuffer const &) = delete;
+
+    void render(DrawingItem const &root, Geom::IntRect const &area);
+    DrawingItem *lookup(Geom::Point const &p, double delta = 0) const;
+
+    void invalidate(Geom::IntRect const &area);
+    void forget(DrawingItem const *item);
+    void clear();
+
+    /// Number of pixels currently known, for testing.
+    std::size_t pixels() const;
+
+    /// Distance from their edges within which items paint pixels as unknown. Pixels an edge
+    /// goes through have their center within half a diagonal of it.
+    static constexpr double BORDER = 1.0;
+
+    // For DrawingItem::renderPickIds()
+    void setSource(DrawingContext &dc, DrawingItem const *target);
+    void paintUnknown(DrawingContext &dc, Geom::IntRect const &area);
+    void strokeUnknown(DrawingContext &dc, double half_width = 0);
+
+private:
+    struct Chunk
+    {
+        Geom::IntRect rect;
+        std::vector<std::uint32_t> pixels; ///< ARGB32, with the id in the color.
+    };
+
+    struct Pending
+    {
+        Geom::IntRect rect;
+        bool stale = false; ///< Invalidated while rendering.
+    };
+
+    mutable std::mutex _mutex;
+    std::deque<Chunk> _chunks; ///< Oldest first.
+    std::size_t _pixels = 0;
+    std::list<Pending> _pending;
+    std::vector<DrawingItem *> _items; ///< By id - 1.
+    std::unordered_map<DrawingItem const *, std::uint32_t> _ids;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_DRAWING_PICK_BUFFER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
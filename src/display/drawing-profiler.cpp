@@ -0,0 +1,320 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Per-item rendering statistics of a drawing.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "drawing-profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+#include "drawing-context.h"
+#include "drawing-item.h"
+#include "object/sp-item.h"
+#include "util/json-string.h"
+
+namespace Inkscape {
+
+namespace {
+
+/// The innermost timer running on this thread.
+thread_local DrawingProfiler::Timer *current_timer = nullptr;
+
+void write_stats(std::ostream &os, DrawingProfiler::Stats const &stats)
+{
+    os << "\"update_ms\": " << stats.update_time * 1000
+       << ", \"render_ms\": " << stats.render_time * 1000
+       << ", \"filter_ms\": " << stats.filter_time * 1000
+       << ", \"updates\": " << stats.updates
+       << ", \"renders\": " << stats.renders
+       << ", \"cache_hits\": " << stats.cache_hits
+       << ", \"pixels\": " << stats.pixels;
+}
+
+} // namespace
+
+void DrawingProfiler::Stats::add(Stats const &other)
+{
+    update_time += other.update_time;
+    render_time += other.render_time;
+    filter_time += other.filter_time;
+    updates += other.updates;
+    renders += other.renders;
+    cache_hits += other.cache_hits;
+    pixels += other.pixels;
+}
+
+void DrawingProfiler::Timer::_start(DrawingItem const *item, Kind kind)
+{
+    _item = item;
+    _kind = kind;
+    if (_kind != FILTER) {
+        _outer = current_timer;
+        current_timer = this;
+    }
+    _begin = std::chrono::steady_clock::now();
+}
+
+void DrawingProfiler::Timer::_stop()
+{
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - _begin).count();
+    if (_kind == FILTER) {
+        // Part of the render time of the item, so nothing to exclude.
+        _profiler->_record(_item, _kind, elapsed, 0, false);
+        return;
+    }
+
+    current_timer = _outer;
+    if (_outer && _outer->_kind == _kind) {
+        _outer->_children += elapsed;
+    }
+    _profiler->_record(_item, _kind, std::max(elapsed - _children, 0.0), _pixels, _cache_hit);
+}
+
+void DrawingProfiler::_record(DrawingItem const *item, Kind kind, double seconds, std::uint64_t pixels, bool cache_hit)
+{
+    auto lock = std::lock_guard(_mutex);
+    auto &stats = _frame_stats[item];
+    switch (kind) {
+        case UPDATE:
+            stats.update_time += seconds;
+            stats.updates++;
+            break;
+        case RENDER:
+            stats.render_time += seconds;
+            stats.renders++;
+            stats.cache_hits += cache_hit;
+            stats.pixels += pixels;
+            break;
+        case FILTER:
+            stats.filter_time += seconds;
+            break;
+    }
+}
+
+/**
+ * Start a frame. Does nothing if one was started already.
+ */
+void DrawingProfiler::beginFrame()
+{
+    if (!_in_frame) {
+        _in_frame = true;
+        _frame_begin = std::chrono::steady_clock::now();
+    }
+}
+
+/**
+ * End the current frame, adding what the items recorded during it to their statistics.
+ */
+void DrawingProfiler::endFrame()
+{
+    auto const now = std::chrono::steady_clock::now();
+
+    std::unordered_map<DrawingItem const *, Stats> recorded;
+    {
+        auto lock = std::lock_guard(_mutex);
+        recorded.swap(_frame_stats);
+    }
+    if (!_in_frame && recorded.empty()) {
+        return;
+    }
+
+    Frame frame;
+    frame.duration = _in_frame ? std::chrono::duration<double>(now - _frame_begin).count() : 0.0;
+    frame.items = recorded.size();
+    for (auto const &[item, stats] : recorded) {
+        auto &entry = _items[item];
+        if (!entry.described) {
+            _describe(item, entry);
+        }
+        entry.stats.add(stats);
+        entry.frames++;
+        entry.drawbox = item->drawbox();
+        frame.total.add(stats);
+    }
+    _total.add(frame.total);
+    _total_duration += frame.duration;
+    if (_frames.size() < max_frames) {
+        _frames.push_back(frame);
+    } else {
+        _frames[_frame_count % max_frames] = frame;
+    }
+    _frame_count++;
+    _in_frame = false;
+}
+
+/**
+ * Forget everything recorded so far.
+ */
+void DrawingProfiler::clear()
+{
+    {
+        auto lock = std::lock_guard(_mutex);
+        _frame_stats.clear();
+    }
+    _items.clear();
+    _destroyed_items = 0;
+    _destroyed = {};
+    _frames.clear();
+    _frame_count = 0;
+    _total_duration = 0;
+    _total = {};
+    _in_frame = false;
+}
+
+/**
+ * Return the last frames, at most max_frames of them, the oldest first.
+ */
+std::vector<DrawingProfiler::Frame> DrawingProfiler::frames() const
+{
+    auto const oldest = _frames.begin() + (_frames.size() < max_frames ? 0 : _frame_count % max_frames);
+    std::vector<Frame> result(oldest, _frames.end());
+    result.insert(result.end(), _frames.begin(), oldest);
+    return result;
+}
+
+/**
+ * Return the statistics of an item over all finished frames.
+ */
+DrawingProfiler::Stats DrawingProfiler::itemStats(DrawingItem const *item) const
+{
+    auto it = _items.find(item);
+    return it != _items.end() ? it->second.stats : Stats();
+}
+
+/**
+ * Called by items that are about to be destroyed. Their statistics are added to those of the
+ * other destroyed items, which the report shows as a whole.
+ */
+void DrawingProfiler::forget(DrawingItem const *item)
+{
+    {
+        auto lock = std::lock_guard(_mutex);
+        _frame_stats.erase(item);
+    }
+    auto it = _items.find(item);
+    if (it != _items.end()) {
+        _destroyed_items++;
+        _destroyed.add(it->second.stats);
+        _items.erase(it);
+    }
+}
+
+void DrawingProfiler::_describe(DrawingItem const *item, Entry &entry)
+{
+    entry.described = true;
+    if (auto const object = item->getItem()) {
+        if (auto const id = object->getId()) {
+            entry.id = id;
+        }
+        if (object->getRepr()) {
+            entry.type = object->getTagName();
+        }
+    }
+}
+
+/**
+ * Paint the bounding boxes of the items that took time to render, in colours going from
+ * translucent yellow for cheap items to opaque red for the most expensive one. The cost of
+ * an item is its average render time per frame.
+ */
+void DrawingProfiler::paintOverlay(DrawingContext &dc, Geom::IntRect const &area) const
+{
+    std::vector<std::pair<double, Geom::IntRect>> costs;
+    double highest = 0;
+    for (auto const &[item, entry] : _items) {
+        auto const box = item->drawbox() & area;
+        if (!box || entry.frames == 0) {
+            continue;
+        }
+        double const cost = entry.stats.render_time / entry.frames;
+        costs.emplace_back(cost, *box);
+        highest = std::max(highest, cost);
+    }
+    if (highest <= 0) {
+        return;
+    }
+
+    // The most expensive items go on top.
+    std::sort(costs.begin(), costs.end(), [] (auto const &a, auto const &b) { return a.first < b.first; });
+
+    dc.save();
+    dc.setOperator(CAIRO_OPERATOR_OVER);
+    for (auto const &[cost, box] : costs) {
+        double const heat = std::sqrt(cost / highest);
+        if (heat < 0.1) {
+            continue;
+        }
+        dc.rectangle(box);
+        dc.setSource(1.0, 1.0 - heat, 0.0, 0.15 + 0.5 * heat);
+        dc.fill();
+    }
+    dc.restore();
+}
+
+/**
+ * Write the frames and the statistics of every living item as JSON, the most expensive items
+ * first, along with the total of the destroyed ones. Times are in milliseconds.
+ */
+void DrawingProfiler::writeReport(std::ostream &os) const
+{
+    std::vector<Entry const *> entries;
+    for (auto const &[item, entry] : _items) {
+        entries.push_back(&entry);
+    }
+    std::stable_sort(entries.begin(), entries.end(), [] (Entry const *a, Entry const *b) {
+        return a->stats.render_time + a->stats.update_time > b->stats.render_time + b->stats.update_time;
+    });
+
+    os << "{\n  \"total\": {\"frames\": " << _frame_count << ", \"duration_ms\": " << _total_duration * 1000 << ", ";
+    write_stats(os, _total);
+    os << "},\n  \"destroyed\": {\"items\": " << _destroyed_items << ", ";
+    write_stats(os, _destroyed);
+    os << "},\n  \"frames\": [";
+    auto const frames = this->frames();
+    for (std::size_t i = 0; i < frames.size(); i++) {
+        auto const &frame = frames[i];
+        os << (i ? ",\n" : "\n") << "    {\"duration_ms\": " << frame.duration * 1000 << ", \"items\": " << frame.items << ", ";
+        write_stats(os, frame.total);
+        os << "}";
+    }
+    os << "\n  ],\n  \"items\": [";
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        auto const &entry = *entries[i];
+        os << (i ? ",\n" : "\n") << "    {\"id\": ";
+        Util::write_json_string(os, entry.id);
+        os << ", \"type\": ";
+        Util::write_json_string(os, entry.type);
+        os << ", \"bbox\": ";
+        if (entry.drawbox) {
+            os << "[" << entry.drawbox->left() << ", " << entry.drawbox->top() << ", "
+               << entry.drawbox->right() << ", " << entry.drawbox->bottom() << "]";
+        } else {
+            os << "null";
+        }
+        os << ", \"frames\": " << entry.frames << ", ";
+        write_stats(os, entry.stats);
+        os << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
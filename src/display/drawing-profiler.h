@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Per-item rendering statistics of a drawing.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_DRAWING_PROFILER_H
+#define INKSCAPE_DISPLAY_DRAWING_PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <2geom/int-rect.h>
+
+namespace Inkscape {
+
+class DrawingContext;
+class DrawingItem;
+
+/**
+ * @brief Where the time goes when rendering a drawing
+ *
+ * Once set on a Drawing with Drawing::setProfiler(), its items record how long they take to
+ * update and render, how long their filters take, how often they are painted from their
+ * cache and how many pixels they render. The times of an item exclude those of its children,
+ * so that the objects that are expensive themselves stand out rather than their groups.
+ *
+ * The statistics are collected per frame, between beginFrame() and endFrame(), and summed up
+ * over all frames. Only the last max_frames frames are kept, and the statistics of destroyed
+ * items are added up into a single total, so that a profiler can be left running for a whole
+ * session. They can be written out as a JSON report, or painted on top of the drawing
+ * as a heat map of its expensive objects.
+ *
+ * Items may record from several threads at once. The other methods must be called from the
+ * main thread, while the drawing isn't rendering.
+ */
+class DrawingProfiler
+{
+public:
+    struct Stats
+    {
+        double update_time = 0; ///< Seconds spent updating the item, excluding its children.
+        double render_time = 0; ///< Seconds spent rendering the item, excluding its children.
+        double filter_time = 0; ///< Seconds spent in its filter, included in render_time.
+        unsigned updates = 0;
+        unsigned renders = 0;
+        unsigned cache_hits = 0;  ///< Renders served entirely from the item's cache.
+        std::uint64_t pixels = 0; ///< Device pixels rendered.
+
+        void add(Stats const &other);
+    };
+
+    struct Frame
+    {
+        double duration = 0; ///< Wall clock time between beginFrame() and endFrame().
+        unsigned items = 0;  ///< Number of items that recorded something.
+        Stats total;
+    };
+
+    static constexpr std::size_t max_frames = 1000;
+
+    DrawingProfiler() = default;
+    DrawingProfiler(DrawingProfiler const &) = delete;
+    DrawingProfiler &operator=(DrawingProfiler const &) = delete;
+
+    void beginFrame();
+    void endFrame();
+    void clear();
+
+    std::vector<Frame> frames() const;
+    std::size_t frameCount() const { return _frame_count; }
+    double totalDuration() const { return _total_duration; }
+    Stats itemStats(DrawingItem const *item) const;
+    Stats totalStats() const { return _total; }
+    std::size_t destroyedItems() const { return _destroyed_items; }
+    Stats destroyedStats() const { return _destroyed; }
+
+    void forget(DrawingItem const *item);
+
+    void setOverlay(bool overlay) { _overlay = overlay; }
+    bool overlay() const { return _overlay; }
+    void paintOverlay(DrawingContext &dc, Geom::IntRect const &area) const;
+
+    void writeReport(std::ostream &os) const;
+
+    enum Kind
+    {
+        UPDATE,
+        RENDER,
+        FILTER
+    };
+
+    /**
+     * Measures an update, render or filter of an item for as long as it lives. Does nothing
+     * when the profiler is null, so that items can create one unconditionally.
+     */
+    class Timer
+    {
+    public:
+        Timer(DrawingProfiler *profiler, DrawingItem const *item, Kind kind)
+            : _profiler(profiler)
+        {
+            if (_profiler) {
+                _start(item, kind);
+            }
+        }
+        ~Timer()
+        {
+            if (_profiler) {
+                _stop();
+            }
+        }
+        Timer(Timer const &) = delete;
+        Timer &operator=(Timer const &) = delete;
+
+        void addPixels(std::uint64_t pixels) { _pixels += pixels; }
+        void cacheHit() { _cache_hit = true; }
+
+    private:
+        void _start(DrawingItem const *item, Kind kind);
+        void _stop();
+
+        DrawingProfiler *_profiler;
+        DrawingItem const *_item = nullptr;
+        Kind _kind = RENDER;
+        std::chrono::steady_clock::time_point _begin;
+        double _children = 0; ///< Time spent in nested timers of the same kind.
+        Timer *_outer = nullptr;
+        std::uint64_t _pixels = 0;
+        bool _cache_hit = false;
+    };
+
+private:
+    struct Entry
+    {
+        Stats stats;
+        std::string id;   ///< Id of the object shown by the item.
+        std::string type; ///< Element name of the object shown by the item.
+        Geom::OptIntRect drawbox;
+        unsigned frames = 0; ///< Number of frames the item recorded something in.
+        bool described = false;
+    };
+
+    void _record(DrawingItem const *item, Kind kind, double seconds, std::uint64_t pixels, bool cache_hit);
+    static void _describe(DrawingItem const *item, Entry &entry);
+
+    mutable std::mutex _mutex;
+    std::unordered_map<DrawingItem const *, Stats> _frame_stats; ///< Guarded by the mutex.
+
+    std::unordered_map<DrawingItem const *, Entry> _items;
+    std::size_t _destroyed_items = 0; ///< Number of recorded items that were destroyed.
+    Stats _destroyed;                 ///< Sum of the statistics of the destroyed items.
+    std::vector<Frame> _frames; ///< Ring of the last frames, the oldest at _frame_count % max_frames.
+    std::size_t _frame_count = 0;
+    double _total_duration = 0;
+    Stats _total;
+    std::chrono::steady_clock::time_point _frame_begin;
+    bool _in_frame = false;
+    bool _overlay = false;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_DRAWING_PROFILER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -18,9 +18,11 @@
 
 #include "style.h"
 
+#include "cairo-utils.h"
 #include "curve.h"
 #include "drawing.h"
 #include "drawing-context.h"
+#include "drawing-pick-buffer.h"
 #include "drawing-shape.h"
 #include "control/canvas-item-drawing.h"
 
@@ -29,6 +31,12 @@
 #include "ui/widget/canvas.h" // Canvas area
 
 namespace Inkscape {
+namespace {
+
+/// Paths with fewer curves are about as quick to rasterise as to composite through a mask.
+constexpr std::size_t MASK_MIN_CURVES = 32;
+
+} // namespace
 
 DrawingShape::DrawingShape(Drawing &drawing)
     : DrawingItem(drawing)
@@ -42,15 +50,61 @@ DrawingShape::DrawingShape(Drawing &drawing)
 {
 }
 
+DrawingShape::~DrawingShape()
+{
+    _dropMasks();
+}
+
 void DrawingShape::setPath(std::shared_ptr<SPCurve const> curve)
 {
     defer([this, curve = std::move(curve)] () mutable {
         _markForRendering();
+        // The path is set again when only the transform changes, which keeps the masks.
+        if (curve != _curve) {
+            _dropMasks();
+        }
         _curve = std::move(curve);
         _markForUpdate(STATE_ALL, false);
     });
 }
 
+/**
+ * Replace the path by one differing from it only within an area, given in item coordinates.
+ * Only that area is redrawn, which keeps dragging a few nodes of a long path cheap. Shapes
+ * drawn with markers, clips, masks, filters, dashes, patterns or paint fitted to their bounding
+ * box may change elsewhere, and are redrawn whole.
+ */
+void DrawingShape::patchPath(std::shared_ptr<SPCurve const> curve, Geom::Rect const &changed)
+{
+    defer([this, curve = std::move(curve), changed] () mutable {
+        auto const uses_bbox = [] (NRStyleData::Paint const &paint) {
+            return paint.type == NRStyleData::PaintType::SERVER && (!paint.server || paint.server->uses_bbox());
+        };
+        if (!_children.empty() || _clip || _mask || _filter || !(_state & STATE_BBOX) ||
+            !_nrstyle.data.dash.empty() || uses_bbox(_nrstyle.data.fill) || uses_bbox(_nrstyle.data.stroke))
+        {
+            _markForRendering();
+            _dropMasks();
+            _curve = std::move(curve);
+            _markForUpdate(STATE_ALL, false);
+            return;
+        }
+
+        _curve = std::move(curve);
+        auto area = changed * _ctm;
+        area.expandBy(_strokeExpansion(_ctm));
+        _markAreaForRendering(area.roundOutwards());
+        for (auto const &mask : _masks) {
+            if (mask) {
+                auto lock = mask->lock();
+                mask->invalidate(area.roundOutwards() - mask->shift(_ctm));
+            }
+        }
+        // The fill and stroke are unchanged, so keep the Cairo data.
+        _markForUpdate(STATE_BBOX | STATE_CACHE, false);
+    });
+}
+
 void DrawingShape::setStyle(SPStyle const *style, SPStyle const *context_style)
 {
     DrawingItem::setStyle(style, context_style);
@@ -70,6 +124,7 @@ void DrawingShape::setStyle(SPStyle const *style, SPStyle const *context_style)
 
     defer([=, this, nrstyle = NRStyleData(_style, _context_style)] () mutable {
         _nrstyle.set(std::move(nrstyle));
+        _dropMasks();
         style_vector_effect_stroke = vector_effect_stroke;
         style_stroke_extensions_hairline = stroke_extensions_hairline;
         style_clip_rule = clip_rule;
@@ -84,6 +139,7 @@ void DrawingShape::setChildrenStyle(SPStyle const *context_style)
 
     defer([this, nrstyle = NRStyleData(_style, _context_style)] () mutable {
         _nrstyle.set(std::move(nrstyle));
+        _dropMasks();
     });
 }
 
@@ -109,53 +165,297 @@ unsigned DrawingShape::_updateItem(Geom::IntRect const &area, UpdateContext cons
             return {};
         }
 
-        float stroke_max = 0.0f;
+        rect->expandBy(_strokeExpansion(ctx.ctm));
+        return rect->roundOutwards();
+    };
+
+    // The path, its style or its transform changed; flatten it again on the next render.
+    if (!(_state & STATE_BBOX)) {
+        _flattened_lock.reset();
+        _flattened.reset();
+    }
 
-        // Get the normal stroke.
-        if (_drawing.renderMode() != RenderMode::OUTLINE && _nrstyle.data.stroke.type != NRStyleData::PaintType::NONE) {
-            // Expand by stroke width.
-            stroke_max = _nrstyle.data.stroke_width * 0.5f;
+    if (flags & STATE_BBOX) {
+        _bbox = calc_curve_bbox();
 
-            // Scale by view transformation, unless vector effect stroke.
-            if (!style_vector_effect_stroke) {
-                stroke_max *= max_expansion(ctx.ctm);
-            }
+        for (auto &c : _children) {
+            _bbox.unionWith(c.bbox());
+        }
+    }
 
-            // Cap minimum line width if asked.
-            if (_drawing.renderMode() == RenderMode::VISIBLE_HAIRLINES || style_stroke_extensions_hairline) {
-                stroke_max = std::max(stroke_max, 0.5f);
-            }
+    // Moving by whole pixels keeps the masks; setPath() and setStyle() drop them.
+    for (auto const &mask : _masks) {
+        if (mask && !mask->fits(ctx.ctm)) {
+            _dropMasks();
+            break;
         }
+    }
+
+    return _state | flags;
+}
+
+/**
+ * How far the stroke, or the outline, reaches outside the path, in screen units.
+ */
+double DrawingShape::_strokeExpansion(Geom::Affine const &ctm) const
+{
+    float stroke_max = 0.0f;
 
-        // Get the outline stroke.
-        if (_drawing.renderMode() == RenderMode::OUTLINE || _drawing.outlineOverlay()) {
+    // Get the normal stroke.
+    if (_drawing.renderMode() != RenderMode::OUTLINE && _nrstyle.data.stroke.type != NRStyleData::PaintType::NONE) {
+        // Expand by stroke width.
+        stroke_max = _nrstyle.data.stroke_width * 0.5f;
+
+        // Scale by view transformation, unless vector effect stroke.
+        if (!style_vector_effect_stroke) {
+            stroke_max *= max_expansion(ctm);
+        }
+
+        // Cap minimum line width if asked.
+        if (_drawing.renderMode() == RenderMode::VISIBLE_HAIRLINES || style_stroke_extensions_hairline) {
             stroke_max = std::max(stroke_max, 0.5f);
         }
+    }
 
-        if (stroke_max > 0.0f) {
-            // Expand by mitres, if present.
-            if (_nrstyle.data.line_join == CAIRO_LINE_JOIN_MITER && _nrstyle.data.miter_limit >= 1.0f) {
-                stroke_max *= _nrstyle.data.miter_limit;
-            }
+    // Get the outline stroke.
+    if (_drawing.renderMode() == RenderMode::OUTLINE || _drawing.outlineOverlay()) {
+        stroke_max = std::max(stroke_max, 0.5f);
+    }
+
+    // Expand by mitres, if present.
+    if (_nrstyle.data.line_join == CAIRO_LINE_JOIN_MITER && _nrstyle.data.miter_limit >= 1.0f) {
+        stroke_max *= _nrstyle.data.miter_limit;
+    }
+
+    // Only expand if non-zero.
+    return stroke_max > 0.01 ? stroke_max : 0.0;
+}
+
+/**
+ * The area, in screen coordinates, the path must be kept exact in to draw the given area,
+ * or none if all of it must be. The stroke reaches further out, and dashes need all of it.
+ */
+Geom::OptRect DrawingShape::_cullArea(Geom::IntRect const &area, bool stroke) const
+{
+    // Leave room for antialiasing and thin outlines.
+    auto const rect = Geom::Rect(area).expandedBy(1);
+    if (!stroke) {
+        return rect;
+    }
+    if (!_nrstyle.data.dash.empty()) {
+        return {};
+    }
+    // Square caps reach out diagonally by the half width times the square root of two.
+    return rect.expandedBy(_strokeExpansion(_ctm) * M_SQRT2);
+}
+
+/**
+ * Append the path to a context in item coordinates. It is flattened once for all the tiles and
+ * frames at the current zoom, and the parts away from the area, if one is given, left out.
+ */
+void DrawingShape::_feedPath(DrawingContext &dc, Geom::OptRect const &area) const
+{
+    _flattened_lock.init([this] {
+        if (!_ctm.isSingular()) {
+            _flattened = FlattenedPath::create(_curve->get_pathvector(), _ctm);
+        }
+    });
+
+    if (!_flattened) {
+        dc.path(_curve->get_pathvector());
+        return;
+    }
+
+    // The path stays in place when the transform is restored.
+    Inkscape::DrawingContext::Save save(dc);
+    dc.transform(_ctm.inverse());
+    _flattened->feed(dc, area);
+}
+
+/**
+ * Fill and stroke the path on a context in item coordinates, within a saved state. If coverage
+ * is set, they are drawn opaque, to show where they cover the pixels.
+ */
+void DrawingShape::_fillAndStroke(DrawingContext &dc, CairoPatternUniqPtr const &fill, CairoPatternUniqPtr const &stroke,
+                                  unsigned flags, bool coverage) const
+{
+    if (fill) {
+        _nrstyle.applyFill(dc, fill);
+        if (coverage) {
+            dc.setSource(0, 0, 0, 1);
+        }
+        dc.fillPreserve();
+    }
+    if (stroke) {
+        if (style_vector_effect_stroke) {
+            dc.restore();
+            dc.save();
+        }
+        _nrstyle.applyStroke(dc, stroke);
+        if (coverage) {
+            dc.setSource(0, 0, 0, 1);
+        }
 
-            // Apply expansion if non-zero.
-            if (stroke_max > 0.01) {
-                rect->expandBy(stroke_max);
+        // If the draw mode is set to visible hairlines, don't let anything get smaller
+        // than half a pixel.
+        if (flags & RENDER_VISIBLE_HAIRLINES) {
+            double dx = 1.0, dy = 0.0;
+            dc.device_to_user_distance(dx, dy);
+            auto half_pixel_size = std::hypot(dx, dy) * 0.5;
+            if (_nrstyle.data.stroke_width < half_pixel_size) {
+                dc.setLineWidth(half_pixel_size);
             }
         }
 
-        return rect->roundOutwards();
+        dc.strokePreserve();
+    }
+}
+
+/**
+ * Whether to draw the fill and the stroke through coverage masks, on a context in item
+ * coordinates. Only worth it for long paths, and only possible for contexts in screen
+ * coordinates, as the tiles of the canvas are; patterns draw their content scaled.
+ */
+bool DrawingShape::_useMasks(DrawingContext &dc, unsigned flags) const
+{
+    if (_drawing._mask_budget == 0 || (flags & RENDER_BYPASS_CACHE)
+        || _curve->get_pathvector().curveCount() < MASK_MIN_CURVES)
+    {
+        return false;
+    }
+
+    cairo_matrix_t matrix;
+    cairo_get_matrix(dc.raw(), &matrix);
+    return Geom::are_near(ink_matrix_to_2geom(matrix).withoutTranslation(), _ctm.withoutTranslation());
+}
+
+/**
+ * The coverage mask of the fill or the stroke, made empty on first use. Returns null if it was
+ * made for another device scale.
+ */
+CoverageMask *DrawingShape::_coverageMask(MaskLayer layer, int device_scale) const
+{
+    _mask_locks[layer].init([&, this] {
+        // The drawing looks through the masks of all shapes to evict their chunks.
+        auto lock = std::unique_lock(_drawing._mask_mutex);
+        _masks[layer] = std::make_unique<CoverageMask>(_ctm, device_scale);
+        _drawing._masked_items.insert(const_cast<DrawingShape *>(this));
+        _masks_added = true;
+    });
+
+    auto const mask = _masks[layer].get();
+    return mask && mask->deviceScale() == device_scale ? mask : nullptr;
+}
+
+/**
+ * Paint the fill or the stroke through the chunks of its coverage mask, making them and
+ * rasterising the parts of them the area needs first, or draw it directly if there is no room
+ * for them. The context is in item coordinates, within a saved state.
+ */
+void DrawingShape::_paintLayer(DrawingContext &dc, MaskLayer layer, CairoPatternUniqPtr const &paint,
+                               Geom::IntRect const &area, unsigned flags) const
+{
+    auto const none = CairoPatternUniqPtr();
+    auto const &fill = layer == MASK_FILL ? paint : none;
+    auto const &stroke = layer == MASK_STROKE ? paint : none;
+
+    auto draw_directly = [&] {
+        _feedPath(dc, _cullArea(area, layer == MASK_STROKE));
+        _fillAndStroke(dc, fill, stroke, flags, false);
+        dc.newPath(); // clear path
     };
 
-    if (flags & STATE_BBOX) {
-        _bbox = calc_curve_bbox();
+    auto const mask = _coverageMask(layer, dc.surface()->device_scale());
+    if (!mask) {
+        draw_directly();
+        return;
+    }
 
-        for (auto &c : _children) {
-            _bbox.unionWith(c.bbox());
+    auto const shift = mask->shift(_ctm);
+    auto const mask_area = area - shift;
+    auto const chunk_bytes = CoverageMask::chunkBytes(mask->deviceScale());
+    std::vector<std::shared_ptr<CoverageMask::Chunk>> chunks;
+    bool clean = true;
+    for (auto const &cell : CoverageMask::cells(mask_area)) {
+        auto lock = mask->lock();
+        auto chunk = mask->chunk(cell);
+        if (!chunk) {
+            // Reserve the memory without the lock, as the drawing may evict chunks of this mask.
+            lock.unlock();
+            if (!_drawing._reserveMaskBytes(chunk_bytes)) {
+                draw_directly();
+                return;
+            }
+            lock.lock();
+            auto const [made, is_new] = mask->addChunk(cell);
+            chunk = made;
+            lock.unlock();
+            if (is_new) {
+                _drawing._addMaskChunk(mask, cell, *chunk);
+            } else {
+                // Another tile made it meanwhile.
+                _drawing._releaseMaskBytes(chunk_bytes);
+            }
+            lock.lock();
         }
+        clean = clean && chunk->isClean(mask_area);
+        chunks.push_back(std::move(chunk));
     }
+    _drawing._useMaskChunks(chunks);
 
-    return _state | flags;
+    if (!clean) {
+        // Rasterise without the lock, as the other tiles of the shape may be drawn meanwhile.
+        auto const coverage = CoverageMask::createSurface(area, mask->deviceScale());
+        {
+            auto ct = DrawingContext(coverage->cobj(), area.min());
+            cairo_set_antialias(ct.raw(), cairo_get_antialias(dc.raw()));
+            Inkscape::DrawingContext::Save save(ct);
+            ct.transform(_ctm);
+            _feedPath(ct, _cullArea(area, layer == MASK_STROKE));
+            _fillAndStroke(ct, fill, stroke, flags, true);
+        }
+        coverage->flush();
+        auto lock = mask->lock();
+        for (auto const &chunk : chunks) {
+            chunk->store(coverage, mask_area);
+        }
+    }
+
+    // The paint is set up in item coordinates, unless it is a non-scaling stroke, and stays
+    // in place when the mask is painted in screen coordinates.
+    Inkscape::DrawingContext::Save save(dc);
+    bool const screen_paint = layer == MASK_STROKE && style_vector_effect_stroke;
+    if (screen_paint) {
+        dc.transform(_ctm.inverse());
+    }
+    if (layer == MASK_FILL) {
+        _nrstyle.applyFill(dc, paint);
+    } else {
+        _nrstyle.applyStroke(dc, paint);
+    }
+    if (!screen_paint) {
+        dc.transform(_ctm.inverse());
+    }
+    auto lock = mask->lock();
+    for (auto const &chunk : chunks) {
+        chunk->paint(dc, area, shift);
+    }
+}
+
+/**
+ * Throw away the coverage masks, to be made again on the next render.
+ */
+void DrawingShape::_dropMasks()
+{
+    if (!_masks_added) {
+        return;
+    }
+
+    _drawing._removeMasks(this);
+    for (auto &lock : _mask_locks) {
+        lock.reset();
+    }
+    _masks_added = false;
 }
 
 void DrawingShape::_renderFill(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const
@@ -166,7 +466,7 @@ void DrawingShape::_renderFill(DrawingContext &dc, RenderContext &rc, Geom::IntR
     auto has_fill = _nrstyle.prepareFill(dc, rc, area, _item_bbox, _fill_pattern);
 
     if (has_fill) {
-        dc.path(_curve->get_pathvector());
+        _feedPath(dc, _cullArea(area, false));
         _nrstyle.applyFill(dc, has_fill);
         dc.fillPreserve();
         dc.newPath(); // clear path
@@ -184,8 +484,7 @@ void DrawingShape::_renderStroke(DrawingContext &dc, RenderContext &rc, Geom::In
     }
 
     if (has_stroke) {
-        // TODO: remove segments outside of bbox when no dashes present
-        dc.path(_curve->get_pathvector());
+        _feedPath(dc, _cullArea(area, true));
         if (style_vector_effect_stroke) {
             dc.restore();
             dc.save();
@@ -232,7 +531,7 @@ unsigned DrawingShape::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
         {
             Inkscape::DrawingContext::Save save(dc);
             dc.transform(_ctm);
-            dc.path(_curve->get_pathvector());
+            _feedPath(dc, _cullArea(*visible, false));
         }
         {
             Inkscape::DrawingContext::Save save(dc);
@@ -262,33 +561,16 @@ unsigned DrawingShape::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
             if (!_nrstyle.data.hairline && _nrstyle.data.stroke_width == 0) {
                 has_stroke.reset();
             }
-            if (has_fill || has_stroke) {
-                dc.path(_curve->get_pathvector());
-                // TODO: remove segments outside of bbox when no dashes present
+            if ((has_fill || has_stroke) && _useMasks(dc, flags)) {
                 if (has_fill) {
-                    _nrstyle.applyFill(dc, has_fill);
-                    dc.fillPreserve();
-                }
-                if (style_vector_effect_stroke) {
-                    dc.restore();
-                    dc.save();
+                    _paintLayer(dc, MASK_FILL, has_fill, *visible, flags);
                 }
                 if (has_stroke) {
-                    _nrstyle.applyStroke(dc, has_stroke);
-
-                    // If the draw mode is set to visible hairlines, don't let anything get smaller
-                    // than half a pixel.
-                    if (flags & RENDER_VISIBLE_HAIRLINES) {
-                        double dx = 1.0, dy = 0.0;
-                        dc.device_to_user_distance(dx, dy);
-                        auto half_pixel_size = std::hypot(dx, dy) * 0.5;
-                        if (_nrstyle.data.stroke_width < half_pixel_size) {
-                            dc.setLineWidth(half_pixel_size);
-                        }
-                    }
-
-                    dc.strokePreserve();
+                    _paintLayer(dc, MASK_STROKE, has_stroke, *visible, flags);
                 }
+            } else if (has_fill || has_stroke) {
+                _feedPath(dc, _cullArea(*visible, bool(has_stroke)));
+                _fillAndStroke(dc, has_fill, has_stroke, flags, false);
                 dc.newPath(); // clear path
             } // has fill or stroke pattern
         }
@@ -318,7 +600,7 @@ unsigned DrawingShape::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
     return RENDER_OK;
 }
 
-void DrawingShape::_clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &/*area*/) const
+void DrawingShape::_clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const
 {
     if (!_curve) return;
 
@@ -329,7 +611,7 @@ void DrawingShape::_clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRec
         dc.setFillRule(CAIRO_FILL_RULE_WINDING);
     }
     dc.transform(_ctm);
-    dc.path(_curve->get_pathvector());
+    _feedPath(dc, _cullArea(area, false));
     dc.fill();
 }
 
@@ -426,6 +708,58 @@ DrawingItem *DrawingShape::_pickItem(Geom::Point const &p, double delta, unsigne
     return nullptr;
 }
 
+/**
+ * Paint the fill and the stroke as _pickItem() sees them: the stroke is solid, has round caps
+ * and joins, and ignores dashes.
+ */
+void DrawingShape::_renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                                  DrawingItem const *target) const
+{
+    if (!_curve) return;
+
+    if (SP_SCALE24_TO_FLOAT(style_opacity) == 0 && !_drawing.selectZeroOpacity()) {
+        return;
+    }
+
+    for (auto it = _children.rbegin(); it != _children.rend(); ++it) {
+        it->renderPickIds(dc, area, buffer, target);
+    }
+
+    double width = 0;
+    if (_nrstyle.data.stroke.type != NRStyleData::PaintType::NONE && (_nrstyle.data.stroke.opacity > 1e-3 || _drawing.selectZeroOpacity())) {
+        auto stroke_width = _nrstyle.data.hairline ? 1 : _nrstyle.data.stroke_width;
+        width = std::max(0.125f, stroke_width * max_expansion(_ctm)) / 2;
+    }
+    bool const needfill = _nrstyle.data.fill.type != NRStyleData::PaintType::NONE && (_nrstyle.data.fill.opacity > 1e-3 || _drawing.selectZeroOpacity());
+    if (!needfill && width == 0) {
+        return;
+    }
+
+    // The path is built in device space, so that the stroke width is in pixels.
+    dc.save();
+    dc.transform(_ctm);
+    _feedPath(dc, Geom::Rect(area).expandedBy(width + DrawingPickBuffer::BORDER + 1));
+    dc.restore();
+
+    buffer.setSource(dc, target);
+    if (needfill) {
+        dc.setFillRule(style_fill_rule == SP_WIND_RULE_EVENODD ? CAIRO_FILL_RULE_EVEN_ODD : CAIRO_FILL_RULE_WINDING);
+        dc.fillPreserve();
+    }
+
+    // The pixels along the edges, which are all of them for strokes thinner than the border,
+    // are left to pick(). Only the middle of wider strokes is known.
+    dc.setLineCap(CAIRO_LINE_CAP_ROUND);
+    dc.setLineJoin(CAIRO_LINE_JOIN_ROUND);
+    buffer.strokeUnknown(dc, width);
+    if (width > DrawingPickBuffer::BORDER) {
+        buffer.setSource(dc, target);
+        dc.setLineWidth(2 * (width - DrawingPickBuffer::BORDER));
+        dc.strokePreserve();
+    }
+    dc.newPath();
+}
+
 } // namespace Inkscape
 
 /*
@@ -13,7 +13,13 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_SHAPE_H
 #define INKSCAPE_DISPLAY_DRAWING_SHAPE_H
 
+#include <array>
+#include <atomic>
+
+#include "display/coverage-mask.h"
 #include "display/drawing-item.h"
+#include "display/flattened-path.h"
+#include "display/initlock.h"
 #include "display/nr-style.h"
 
 class SPStyle;
@@ -29,21 +35,36 @@ public:
     int tag() const override { return tag_of<decltype(*this)>; }
 
     void setPath(std::shared_ptr<SPCurve const> curve);
+    void patchPath(std::shared_ptr<SPCurve const> curve, Geom::Rect const &changed);
     void setStyle(SPStyle const *style, SPStyle const *context_style = nullptr) override;
     void setChildrenStyle(SPStyle const *context_style) override;
 
 protected:
-    ~DrawingShape() override = default;
+    ~DrawingShape() override;
 
     unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) override;
     unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
     void _clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const override;
     DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
+    void _renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                        DrawingItem const *target) const override;
     bool _canClip() const override { return true; }
 
     void _renderFill(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const;
     void _renderStroke(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags) const;
     void _renderMarkers(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const;
+    double _strokeExpansion(Geom::Affine const &ctm) const;
+    Geom::OptRect _cullArea(Geom::IntRect const &area, bool stroke) const;
+    void _feedPath(DrawingContext &dc, Geom::OptRect const &area) const;
+    void _fillAndStroke(DrawingContext &dc, CairoPatternUniqPtr const &fill, CairoPatternUniqPtr const &stroke,
+                        unsigned flags, bool coverage) const;
+
+    enum MaskLayer { MASK_FILL, MASK_STROKE };
+    bool _useMasks(DrawingContext &dc, unsigned flags) const;
+    CoverageMask *_coverageMask(MaskLayer layer, int device_scale) const;
+    void _paintLayer(DrawingContext &dc, MaskLayer layer, CairoPatternUniqPtr const &paint, Geom::IntRect const &area,
+                     unsigned flags) const;
+    void _dropMasks();
 
     bool style_vector_effect_stroke : 1;
     bool style_stroke_extensions_hairline : 1;
@@ -54,8 +75,17 @@ protected:
     std::shared_ptr<SPCurve const> _curve;
     NRStyle _nrstyle;
 
+    InitLock _flattened_lock;
+    mutable std::unique_ptr<FlattenedPath const> _flattened; ///< The path in screen coordinates.
+
+    std::array<InitLock, 2> _mask_locks;
+    mutable std::array<std::unique_ptr<CoverageMask>, 2> _masks; ///< Of the fill and the stroke, by MaskLayer.
+    mutable std::atomic<bool> _masks_added = false; ///< Whether the drawing knows of the masks.
+
     DrawingItem *_last_pick;
     unsigned _repick_after;
+
+    friend class Drawing;
 };
 
 } // namespace Inkscape
@@ -19,6 +19,7 @@
 
 #include "cairo-utils.h"
 #include "drawing-context.h"
+#include "drawing-pick-buffer.h"
 #include "drawing-surface.h"
 #include "drawing-text.h"
 #include "drawing.h"
@@ -737,6 +738,34 @@ DrawingItem *DrawingText::_pickItem(Geom::Point const &p, double delta, unsigned
     return DrawingGroup::_pickItem(p, delta, flags) ? this : nullptr;
 }
 
+void DrawingText::_renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                                 DrawingItem const *target) const
+{
+    if (_nrstyle.data.fill.type == NRStyleData::PaintType::NONE &&
+        _nrstyle.data.stroke.type == NRStyleData::PaintType::NONE)
+    {
+        return;
+    }
+
+    // Glyphs are picked by their pick boxes, like in DrawingGlyphs::_pickItem().
+    buffer.setSource(dc, target);
+    for (auto &i : _children) {
+        auto glyphs = cast<DrawingGlyphs>(&i);
+        if (!glyphs || !glyphs->visible() || !glyphs->sensitive()) {
+            continue;
+        }
+        if (auto const box = Geom::intersect(area, glyphs->getPickBox())) {
+            dc.rectangle(*box);
+        }
+    }
+    dc.setFillRule(CAIRO_FILL_RULE_WINDING);
+    dc.fillPreserve();
+
+    // The pixels along the edges of the boxes are left to pick().
+    buffer.strokeUnknown(dc);
+    dc.newPath();
+}
+
 } // end namespace Inkscape
 
 /*
@@ -82,6 +82,8 @@ protected:
     unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
     void _clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const override;
     DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
+    void _renderPickIds(DrawingContext &dc, Geom::IntRect const &area, DrawingPickBuffer &buffer,
+                        DrawingItem const *target) const override;
     bool _canClip() const override { return true; }
 
     void decorateItem(DrawingContext &dc, double phase_length, bool under) const;
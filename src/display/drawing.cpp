@@ -19,9 +19,14 @@
 #include "cairo-utils.h"
 #include "control/canvas-item-drawing.h"
 #include "drawing-context.h"
+#include "drawing-pick-buffer.h"
+#include "drawing-profiler.h"
+#include "drawing-shape.h"
 #include "nr-filter-gaussian.h"
 #include "nr-filter-types.h"
+#include "pattern-cache.h"
 #include "threading.h"
+#include "debug/trace.h"
 
 namespace Inkscape {
 
@@ -81,6 +86,9 @@ void Drawing::setRenderMode(RenderMode mode)
         _rendermode = mode;
         _root->_markForUpdate(DrawingItem::STATE_ALL, true);
         _clearCache();
+        if (_pick_buffer) {
+            _pick_buffer->clear();
+        }
     });
 }
 
@@ -101,6 +109,9 @@ void Drawing::setOutlineOverlay(bool outlineoverlay)
         if (outlineoverlay == _outlineoverlay) return;
         _outlineoverlay = outlineoverlay;
         _root->_markForUpdate(DrawingItem::STATE_ALL, true);
+        if (_pick_buffer) {
+            _pick_buffer->clear();
+        }
     });
 }
 
@@ -197,6 +208,43 @@ void Drawing::setCacheBudget(size_t bytes)
     });
 }
 
+/**
+ * Set the memory the coverage masks of shapes may take, or turn them off with zero. Shapes
+ * with long paths then keep where their fill and stroke cover the pixels, and draw them again
+ * at the same zoom by compositing their paint through it.
+ */
+void Drawing::setFilterPlanning(bool planning)
+{
+    defer([=, this] {
+        if (planning == _filter_planning) return;
+        _filter_planning = planning;
+        _clearCache();
+    });
+}
+
+/**
+ * Set whether groups with many children index them by their boxes, or test every child. Indexing
+ * is on by default; turning it off is only meant for comparing against the linear scan in tests
+ * and benchmarks.
+ */
+void Drawing::setChildIndexing(bool indexing)
+{
+    defer([=, this] {
+        if (indexing == _child_indexing) return;
+        _child_indexing = indexing;
+        _root->_markForUpdate(DrawingItem::STATE_ALL, true);
+    });
+}
+
+void Drawing::setMaskBudget(size_t bytes)
+{
+    defer([=, this] {
+        if (bytes == _mask_budget) return;
+        _mask_budget = bytes;
+        _clearMasks();
+    });
+}
+
 void Drawing::setCacheLimit(Geom::OptIntRect const &rect)
 {
     defer([=, this] {
@@ -225,19 +273,64 @@ void Drawing::setAntialiasingOverride(std::optional<Antialiasing> antialiasing_o
     });
 }
 
+/**
+ * Have the items record their statistics to the profiler, or stop them if it is null. If the
+ * profiler shows an overlay, it is painted on top of the drawing.
+ */
+void Drawing::setProfiler(std::shared_ptr<DrawingProfiler> profiler)
+{
+    defer([=, this] {
+        bool const overlay = _profiler && _profiler->overlay();
+        _profiler = profiler;
+        if (_root && overlay != (_profiler && _profiler->overlay())) {
+            _root->_markForRendering();
+        }
+    });
+}
+
+/**
+ * Have the canvas render which item is picked where next to its tiles, so that picking only
+ * falls back to testing the geometry of the items where that isn't known.
+ */
+void Drawing::setPickBuffer(bool enabled)
+{
+    defer([=, this] {
+        if (enabled == bool(_pick_buffer)) return;
+        _pick_buffer = enabled ? std::make_unique<DrawingPickBuffer>() : nullptr;
+    });
+}
+
+void Drawing::setSelectZeroOpacity(bool select_zero_opacity)
+{
+    defer([=, this] {
+        if (select_zero_opacity == _select_zero_opacity) return;
+        _select_zero_opacity = select_zero_opacity;
+        if (_pick_buffer) {
+            _pick_buffer->clear();
+        }
+    });
+}
+
 void Drawing::update(Geom::IntRect const &area, Geom::Affine const &affine, unsigned flags, unsigned reset)
 {
+    auto span = Debug::Trace::Span("drawing", "update");
+    if (_pick_buffer && reset) {
+        // Every item may have moved.
+        _pick_buffer->clear();
+    }
     if (_root) {
         _root->update(area, { affine }, flags, reset);
     }
     if (flags & DrawingItem::STATE_CACHE) {
         // Process the updated cache scores.
         _pickItemsForCaching();
+        Debug::Trace::counter("drawing", "cached items", _cached_items.size());
     }
 }
 
 void Drawing::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags) const
 {
+    auto span = Debug::Trace::Span("drawing", "render");
     apply_antialias(dc, _antialiasing_override.value_or(Antialiasing(_root->_antialias)));
 
     auto rc = RenderContext{
@@ -256,13 +349,34 @@ void Drawing::render(DrawingContext &dc, Geom::IntRect const &area, unsigned fla
     if (_clip) {
         dc.restore();
     }
+
+    if (_profiler && _profiler->overlay()) {
+        _profiler->paintOverlay(dc, area);
+    }
 }
 
 DrawingItem *Drawing::pick(Geom::Point const &p, double delta, unsigned flags)
 {
+    if (_pick_buffer && !flags && (_root->_state & DrawingItem::STATE_PICK)) {
+        if (auto item = _pick_buffer->lookup(p, delta)) {
+            return item;
+        }
+    }
     return _root->pick(p, delta, flags);
 }
 
+/**
+ * Render the ids of the items picked in an area to the pick buffer, if there is one. Only
+ * the normal render modes are picked from the buffer.
+ */
+void Drawing::renderPickIds(Geom::IntRect const &area) const
+{
+    if (!_pick_buffer || !_root || _rendermode == RenderMode::OUTLINE || _outlineoverlay) {
+        return;
+    }
+    _pick_buffer->render(*_root, area);
+}
+
 void Drawing::snapshot()
 {
     assert(!_snapshotted);
@@ -312,6 +426,97 @@ void Drawing::_clearCache()
     for (auto item : to_uncache) {
         item->_setCached(false, true);
     }
+
+    // Pattern tiles and masks rendered with the old settings are no longer valid either.
+    _pattern_generation++;
+    PatternCache::dropStale(this, _pattern_generation);
+    _clearMasks();
+}
+
+/**
+ * The memory taken by the coverage masks of shapes.
+ */
+size_t Drawing::maskBytes() const
+{
+    auto lock = std::unique_lock(_mask_mutex);
+    return _mask_bytes;
+}
+
+/**
+ * Make room for a new chunk of a coverage mask taking the given memory, evicting the least
+ * recently used chunks of all the shapes while it doesn't fit in the budget. Returns whether
+ * it fits. Called while rendering, without holding the lock of any mask.
+ */
+bool Drawing::_reserveMaskBytes(size_t bytes)
+{
+    auto lock = std::unique_lock(_mask_mutex);
+    while (_mask_bytes + bytes > _mask_budget) {
+        if (_mask_chunks.empty()) {
+            return false;
+        }
+        auto const [mask, cell] = _mask_chunks.back();
+        auto mask_lock = mask->lock();
+        _mask_bytes -= mask->evictChunk(cell, _mask_chunks);
+    }
+    _mask_bytes += bytes;
+    return true;
+}
+
+/**
+ * Let a chunk made with reserved memory be evicted, as the most recently used. Called while
+ * rendering, without holding the lock of any mask.
+ */
+void Drawing::_addMaskChunk(CoverageMask *mask, CoverageMask::Cell const &cell, CoverageMask::Chunk &chunk)
+{
+    auto lock = std::unique_lock(_mask_mutex);
+    chunk.list(_mask_chunks, mask, cell);
+}
+
+/**
+ * Mark chunks of coverage masks as the most recently used. Called while rendering, without
+ * holding the lock of any mask.
+ */
+void Drawing::_useMaskChunks(std::vector<std::shared_ptr<CoverageMask::Chunk>> const &chunks)
+{
+    auto lock = std::unique_lock(_mask_mutex);
+    for (auto const &chunk : chunks) {
+        chunk->use(_mask_chunks);
+    }
+}
+
+/**
+ * Give back memory reserved for a chunk that wasn't made after all.
+ */
+void Drawing::_releaseMaskBytes(size_t bytes)
+{
+    auto lock = std::unique_lock(_mask_mutex);
+    _mask_bytes -= bytes;
+}
+
+/**
+ * Throw away the coverage masks of a shape.
+ */
+void Drawing::_removeMasks(DrawingShape *shape)
+{
+    auto lock = std::unique_lock(_mask_mutex);
+    for (auto &mask : shape->_masks) {
+        if (mask) {
+            auto mask_lock = mask->lock();
+            _mask_bytes -= mask->evictChunks(_mask_chunks);
+            mask_lock.unlock();
+            mask.reset();
+        }
+    }
+    _masked_items.erase(shape);
+}
+
+void Drawing::_clearMasks()
+{
+    // Note: _dropMasks() modifies _masked_items, so the temporary container is necessary.
+    std::vector<DrawingShape*> to_drop(_masked_items.begin(), _masked_items.end());
+    for (auto shape : to_drop) {
+        shape->_dropMasks();
+    }
 }
 
 void Drawing::_loadPrefs()
@@ -329,12 +534,20 @@ void Drawing::_loadPrefs()
     _cursor_tolerance    = prefs->getDouble    ("/options/cursortolerance/value",        1.0);
     _select_zero_opacity = prefs->getBool      ("/options/selection/zeroopacity",        false);
 
+    // Only the Canvas's drawing is picked from often enough for a pick buffer to pay off.
+    if (_canvas_item_drawing && prefs->getBool("/options/rendering/pickbuffer", false)) {
+        _pick_buffer = std::make_unique<DrawingPickBuffer>();
+    }
+
     // Enable caching only for the Canvas's drawing, since only it is persistent.
     if (_canvas_item_drawing) {
         // Preference is stored in MiB; convert to bytes, taking care not to overflow.
         _cache_budget = (size_t{1} << 20) * prefs->getIntLimited("/options/renderingcache/size", 64, 0, 4096);
+        PatternCache::setBudget((size_t{1} << 20) * prefs->getIntLimited("/options/renderingcache/patternsize", 64, 0, 4096));
+        _mask_budget = (size_t{1} << 20) * prefs->getIntLimited("/options/renderingcache/masksize", 0, 0, 4096);
     } else {
         _cache_budget = 0;
+        _mask_budget = 0;
     }
 
     // Set the global variable governing the number of threads, and track it too. (This is ugly, but hopefully
@@ -355,7 +568,10 @@ void Drawing::_loadPrefs()
         actions.emplace("/options/dithering/value",              [this] (auto &entry) { setDithering(entry.getBool(true)); });
         actions.emplace("/options/cursortolerance/value",        [this] (auto &entry) { setCursorTolerance(entry.getDouble(1.0)); });
         actions.emplace("/options/selection/zeroopacity",        [this] (auto &entry) { setSelectZeroOpacity(entry.getBool(false)); });
+        actions.emplace("/options/rendering/pickbuffer",         [this] (auto &entry) { setPickBuffer(entry.getBool(false)); });
         actions.emplace("/options/renderingcache/size",          [this] (auto &entry) { setCacheBudget((1 << 20) * entry.getIntLimited(64, 0, 4096)); });
+        actions.emplace("/options/renderingcache/patternsize",   [] (auto &entry) { PatternCache::setBudget((size_t{1} << 20) * entry.getIntLimited(64, 0, 4096)); });
+        actions.emplace("/options/renderingcache/masksize",      [this] (auto &entry) { setMaskBudget((size_t{1} << 20) * entry.getIntLimited(0, 0, 4096)); });
         actions.emplace("/options/threading/numthreads", [this](auto &entry) {
             set_num_dispatch_threads(entry.getIntLimited(default_numthreads(), 1, 256));
         });
@@ -13,6 +13,8 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_H
 #define INKSCAPE_DISPLAY_DRAWING_H
 
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <cstdint>
@@ -22,6 +24,7 @@
 #include <2geom/pathvector.h>
 #include <sigc++/sigc++.h>
 
+#include "display/coverage-mask.h"
 #include "display/drawing-item.h"
 #include "display/rendermode.h"
 #include "nr-filter-colormatrix.h"
@@ -33,6 +36,9 @@ namespace Inkscape {
 class DrawingItem;
 class CanvasItemDrawing;
 class DrawingContext;
+class DrawingPickBuffer;
+class DrawingProfiler;
+class DrawingShape;
 
 class Drawing
 {
@@ -56,13 +62,18 @@ public:
     void setImageOutlineMode(bool);
     void setFilterQuality(int);
     void setBlurQuality(int);
+    void setFilterPlanning(bool);
+    void setChildIndexing(bool);
     void setDithering(bool);
     void setCursorTolerance(double tol) { _cursor_tolerance = tol; }
-    void setSelectZeroOpacity(bool select_zero_opacity) { _select_zero_opacity = select_zero_opacity; }
+    void setSelectZeroOpacity(bool select_zero_opacity);
     void setCacheBudget(size_t bytes);
+    void setMaskBudget(size_t bytes);
     void setCacheLimit(Geom::OptIntRect const &rect);
     void setClip(std::optional<Geom::PathVector> &&clip);
     void setAntialiasingOverride(std::optional<Antialiasing> antialiasing_override);
+    void setProfiler(std::shared_ptr<DrawingProfiler> profiler);
+    void setPickBuffer(bool enabled);
 
     RenderMode renderMode() const { return _rendermode; }
     ColorMode colorMode() const { return _colormode; }
@@ -74,15 +85,22 @@ public:
     bool imageOutlineMode() const { return _image_outline_mode; }
     int filterQuality() const { return _filter_quality; }
     int blurQuality() const { return _blur_quality; }
+    bool filterPlanning() const { return _filter_planning; }
+    bool childIndexing() const { return _child_indexing; }
     bool useDithering() const { return _use_dithering; }
     double cursorTolerance() const { return _cursor_tolerance; }
     bool selectZeroOpacity() const { return _select_zero_opacity; }
     Geom::OptIntRect const &cacheLimit() const { return _cache_limit; }
+    size_t maskBytes() const;
+    unsigned patternGeneration() const { return _pattern_generation; }
+    DrawingProfiler *profiler() const { return _profiler.get(); }
+    DrawingPickBuffer *pickBuffer() const { return _pick_buffer.get(); }
 
     void update(Geom::IntRect const &area = Geom::IntRect::infinite(), Geom::Affine const &affine = Geom::identity(),
                 unsigned flags = DrawingItem::STATE_ALL, unsigned reset = 0);
     void render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags = 0) const;
     DrawingItem *pick(Geom::Point const &p, double delta, unsigned flags);
+    void renderPickIds(Geom::IntRect const &area) const;
 
     void snapshot();
     void unsnapshot();
@@ -97,6 +115,12 @@ public:
 private:
     void _pickItemsForCaching();
     void _clearCache();
+    bool _reserveMaskBytes(size_t bytes);
+    void _addMaskChunk(CoverageMask *mask, CoverageMask::Cell const &cell, CoverageMask::Chunk &chunk);
+    void _useMaskChunks(std::vector<std::shared_ptr<CoverageMask::Chunk>> const &chunks);
+    void _releaseMaskBytes(size_t bytes);
+    void _removeMasks(DrawingShape *shape);
+    void _clearMasks();
     void _loadPrefs();
 
     DrawingItem *_root = nullptr;
@@ -113,17 +137,28 @@ private:
     bool _image_outline_mode; ///< Always draw images as images, even in outline mode.
     int _filter_quality;
     int _blur_quality;
+    bool _filter_planning = true; ///< Plan filter primitives, rather than run them in order for comparison.
+    bool _child_indexing = true; ///< Index the children of large groups, rather than test each for comparison.
     bool _use_dithering;
     double _cursor_tolerance;
     size_t _cache_budget; ///< Maximum allowed size of cache.
+    unsigned _pattern_generation = 0; ///< Changed whenever cached pattern tiles become invalid.
     Geom::OptIntRect _cache_limit;
     std::optional<Geom::PathVector> _clip;
     bool _select_zero_opacity;
     std::optional<Antialiasing> _antialiasing_override;
+    std::shared_ptr<DrawingProfiler> _profiler; ///< Records per-item statistics if set.
+    std::unique_ptr<DrawingPickBuffer> _pick_buffer; ///< Answers picks without the geometry if set.
 
     std::set<DrawingItem*> _cached_items; // modified by DrawingItem::_setCached()
     CacheList _candidate_items;           // keep this list always sorted with std::greater
 
+    size_t _mask_budget; ///< Maximum size of the coverage masks of shapes.
+    mutable std::mutex _mask_mutex; ///< Guards the three below, as shapes make their masks while rendering.
+    size_t _mask_bytes = 0;
+    std::set<DrawingShape*> _masked_items; ///< Shapes that have made masks.
+    CoverageMask::ChunkList _mask_chunks; ///< The chunks of all the masks, to evict the least recently used.
+
     /*
      * Simple cacheline separator compatible with x86 (64 bytes) and M* (128 bytes).
      * Ideally alignas(std::hardware_destructive_interference_size) could be used instead,
@@ -138,6 +173,7 @@ private:
     void defer(F &&f) { _snapshotted ? _funclog.emplace(std::forward<F>(f)) : f(); }
 
     friend class DrawingItem;
+    friend class DrawingShape;
 };
 
 } // namespace Inkscape
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Paths flattened to polylines in screen coordinates.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "flattened-path.h"
+
+#include <algorithm>
+#include <cmath>
+#include <2geom/bezier-curve.h>
+#include <2geom/elliptical-arc.h>
+
+#include "display/drawing-context.h"
+#include "helper/geom.h"
+
+namespace Inkscape {
+namespace {
+
+/// Points in a run of the lowest level, and runs in a run of the next.
+constexpr std::size_t BRANCH = 16;
+
+/// Most points a path is flattened to. Longer paths, as at high zoom, are drawn from their curves.
+constexpr std::size_t MAX_POINTS = 1 << 20;
+
+} // namespace
+
+/**
+ * Flatten a path as drawn with the given transform to the screen. Returns null if the path is
+ * too long or has curves that can't be flattened, and must be drawn from its curves.
+ */
+std::unique_ptr<FlattenedPath const> FlattenedPath::create(Geom::PathVector const &pathv, Geom::Affine const &ctm)
+{
+    auto result = std::make_unique<FlattenedPath>();
+
+    for (auto const &path : pathv) {
+        if (path.empty()) {
+            continue;
+        }
+
+        auto subpath = Subpath{.first = result->_points.size(), .size = 0, .closed = path.closed()};
+        result->_points.push_back(path.initialPoint() * ctm);
+        for (auto it = path.begin(); it != path.end_open(); ++it) {
+            if (!result->_flatten(*it, ctm)) {
+                return {};
+            }
+        }
+        subpath.size = result->_points.size() - subpath.first;
+        result->_buildBoxes(subpath);
+        result->_subpaths.push_back(std::move(subpath));
+    }
+
+    return result;
+}
+
+/**
+ * Append the points of a curve after its initial point.
+ */
+bool FlattenedPath::_flatten(Geom::Curve const &curve, Geom::Affine const &ctm)
+{
+    double count = 1;
+
+    if (auto bezier = dynamic_cast<Geom::BezierCurve const *>(&curve)) {
+        // Lines between points a step h apart in time stray from a curve by at most h^2/8 times
+        // its second derivative, which is bounded by the second differences of the control points.
+        auto const order = bezier->order();
+        double second = 0;
+        for (unsigned i = 0; i + 2 <= order; i++) {
+            auto const d = bezier->controlPoint(i) * ctm - 2 * (bezier->controlPoint(i + 1) * ctm)
+                         + bezier->controlPoint(i + 2) * ctm;
+            second = std::max(second, Geom::L2(d));
+        }
+        count = std::ceil(std::sqrt(order * (order - 1) * second / (8 * TOLERANCE)));
+    } else if (auto arc = dynamic_cast<Geom::EllipticalArc const *>(&curve)) {
+        if (!arc->isChord()) {
+            // Lines spanning an angle a of a circle of radius r stray from it by r (1 - cos(a/2)).
+            auto const radius = std::max(arc->ray(Geom::X), arc->ray(Geom::Y)) * max_expansion(ctm);
+            if (radius > TOLERANCE) {
+                count = std::ceil(arc->sweepAngle() / (2 * std::acos(1 - TOLERANCE / radius)));
+            }
+        }
+    } else {
+        return false;
+    }
+
+    // Also catches non-finite counts.
+    if (!(_points.size() + count <= MAX_POINTS)) {
+        return false;
+    }
+
+    auto const n = std::max<std::size_t>(count, 1);
+    for (std::size_t i = 1; i < n; i++) {
+        _points.push_back(curve.pointAt(static_cast<double>(i) / n) * ctm);
+    }
+    _points.push_back(curve.finalPoint() * ctm);
+    return true;
+}
+
+/**
+ * Build the tree of boxes of a subpath. Consecutive runs share the point between them.
+ */
+void FlattenedPath::_buildBoxes(Subpath &subpath) const
+{
+    std::vector<Geom::Rect> level;
+    for (std::size_t begin = 0; begin + 1 < subpath.size; begin += BRANCH) {
+        auto const end = std::min(begin + BRANCH, subpath.size - 1);
+        auto box = Geom::Rect(_points[subpath.first + begin], _points[subpath.first + begin]);
+        for (auto i = begin + 1; i <= end; i++) {
+            box.expandTo(_points[subpath.first + i]);
+        }
+        level.push_back(box);
+    }
+
+    while (!level.empty()) {
+        auto const &below = subpath.boxes.emplace_back(std::move(level));
+        level = {};
+        if (below.size() == 1) {
+            break;
+        }
+        for (std::size_t begin = 0; begin < below.size(); begin += BRANCH) {
+            auto box = below[begin];
+            for (auto i = begin + 1; i < std::min(begin + BRANCH, below.size()); i++) {
+                box.unionWith(below[i]);
+            }
+            level.push_back(box);
+        }
+    }
+}
+
+/**
+ * Append the path to the context as lines. If an area is given, the parts of the path away
+ * from it are replaced by fewer lines, which draw the same within it.
+ */
+void FlattenedPath::feed(DrawingContext &dc, Geom::OptRect const &area) const
+{
+    for (auto const &subpath : _subpaths) {
+        dc.moveTo(_points[subpath.first]);
+        if (area && !subpath.boxes.empty()) {
+            _feedRun(dc, subpath, subpath.boxes.size() - 1, 0, *area);
+        } else {
+            for (auto i = subpath.first + 1; i < subpath.first + subpath.size; i++) {
+                dc.lineTo(_points[i]);
+            }
+        }
+        if (subpath.closed) {
+            dc.closePath();
+        }
+    }
+}
+
+/**
+ * Append the lines of a run after its first point, or a single line if the run misses the area.
+ */
+void FlattenedPath::_feedRun(DrawingContext &dc, Subpath const &subpath, std::size_t level, std::size_t index,
+                             Geom::Rect const &area) const
+{
+    auto span = BRANCH;
+    for (std::size_t i = 0; i < level; i++) {
+        span *= BRANCH;
+    }
+    auto const begin = index * span;
+    auto const end = std::min(begin + span, subpath.size - 1);
+
+    if (!subpath.boxes[level][index].intersects(area)) {
+        dc.lineTo(_points[subpath.first + end]);
+    } else if (level == 0) {
+        for (auto i = begin + 1; i <= end; i++) {
+            dc.lineTo(_points[subpath.first + i]);
+        }
+    } else {
+        auto const children = std::min((index + 1) * BRANCH, subpath.boxes[level - 1].size());
+        for (auto i = index * BRANCH; i < children; i++) {
+            _feedRun(dc, subpath, level - 1, i, area);
+        }
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
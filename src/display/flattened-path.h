@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Paths flattened to polylines in screen coordinates.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_FLATTENED_PATH_H
+#define INKSCAPE_DISPLAY_FLATTENED_PATH_H
+
+#include <memory>
+#include <vector>
+#include <2geom/affine.h>
+#include <2geom/pathvector.h>
+#include <2geom/rect.h>
+
+namespace Inkscape {
+
+class DrawingContext;
+
+/**
+ * @brief A path flattened to line segments at one scale, to be drawn many times
+ *
+ * Cairo flattens the curves of a path again on every fill and stroke, so a path spanning many
+ * tiles is flattened once per tile. A FlattenedPath does it once, within TOLERANCE of the
+ * curves in screen coordinates, and is fed to the context as lines.
+ *
+ * Its points are grouped into runs with boxes, in a tree, so that feeding it for one tile can
+ * leave out the parts away from the tile. A run whose box misses the area is replaced by a line
+ * between its ends, which lies in the same box. As the box is wholly to one side of the area,
+ * this changes neither the winding of the fill nor the stroke within the area, provided the
+ * area is enlarged by the reach of the stroke. Dashed strokes must not be culled, as it would
+ * shift their dashes.
+ */
+class FlattenedPath
+{
+public:
+    /// The largest distance between the lines and the curves, in screen units.
+    static constexpr double TOLERANCE = 0.05;
+
+    static std::unique_ptr<FlattenedPath const> create(Geom::PathVector const &pathv, Geom::Affine const &ctm);
+
+    void feed(DrawingContext &dc, Geom::OptRect const &area = {}) const;
+
+    std::size_t size() const { return _points.size(); }
+
+private:
+    struct Subpath
+    {
+        std::size_t first; ///< Index of its first point.
+        std::size_t size;  ///< Number of points.
+        bool closed;
+        /// Boxes of runs of BRANCH points, then of BRANCH runs, and so on up to a single box.
+        std::vector<std::vector<Geom::Rect>> boxes;
+    };
+
+    bool _flatten(Geom::Curve const &curve, Geom::Affine const &ctm);
+    void _buildBoxes(Subpath &subpath) const;
+    void _feedRun(DrawingContext &dc, Subpath const &subpath, std::size_t level, std::size_t index,
+                  Geom::Rect const &area) const;
+
+    std::vector<Geom::Point> _points;
+    std::vector<Subpath> _subpaths;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_FLATTENED_PATH_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -165,9 +165,9 @@ void FilterColorMatrix::render_cairo(FilterSlot &slot) const
     set_cairo_surface_ci(input, color_interpolation);
 
     if (type == COLORMATRIX_LUMINANCETOALPHA) {
-        out = ink_cairo_surface_create_same_size(input, CAIRO_CONTENT_ALPHA);
+        out = slot.create_surface(input, CAIRO_CONTENT_ALPHA);
     } else {
-        out = ink_cairo_surface_create_same_size(input, CAIRO_CONTENT_COLOR_ALPHA);
+        out = slot.create_surface(input, CAIRO_CONTENT_COLOR_ALPHA);
         // Set ci to that used for computation
         set_cairo_surface_ci(out, color_interpolation);
     }
@@ -194,6 +194,22 @@ void FilterColorMatrix::render_cairo(FilterSlot &slot) const
     cairo_surface_destroy(out);
 }
 
+std::function<guint32(guint32)> FilterColorMatrix::get_pixel_function() const
+{
+    switch (type) {
+    case COLORMATRIX_MATRIX:
+        return ColorMatrixMatrix(values);
+    case COLORMATRIX_SATURATE:
+        return ColorMatrixSaturate(value);
+    case COLORMATRIX_HUEROTATE:
+        return ColorMatrixHueRotate(value);
+    case COLORMATRIX_LUMINANCETOALPHA: // produces an alpha-only image
+    case COLORMATRIX_ENDTYPE:
+    default:
+        return {};
+    }
+}
+
 bool FilterColorMatrix::can_handle_affine(Geom::Affine const &) const
 {
     return true;
@@ -43,6 +43,7 @@ public:
     void render_cairo(FilterSlot &slot) const override;
     bool can_handle_affine(Geom::Affine const &) const override;
     double complexity(Geom::Affine const &ctm) const override;
+    std::function<guint32(guint32)> get_pixel_function() const override;
 
     virtual void set_type(FilterColorMatrixType type);
     virtual void set_value(double value);
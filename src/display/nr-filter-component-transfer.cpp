@@ -24,34 +24,6 @@ FilterComponentTransfer::FilterComponentTransfer() = default;
 
 FilterComponentTransfer::~FilterComponentTransfer() = default;
 
-struct UnmultiplyAlpha
-{
-    guint32 operator()(guint32 in)
-    {
-        EXTRACT_ARGB32(in, a, r, g, b);
-        if (a == 0 )
-            return in;
-        r = unpremul_alpha(r, a);
-        g = unpremul_alpha(g, a);
-        b = unpremul_alpha(b, a);
-        ASSEMBLE_ARGB32(out, a, r, g, b);
-        return out;
-    }
-};
-
-struct MultiplyAlpha
-{
-    guint32 operator()(guint32 in)
-    {
-        EXTRACT_ARGB32(in, a, r, g, b);
-        r = premul_alpha(r, a);
-        g = premul_alpha(g, a);
-        b = premul_alpha(b, a);
-        ASSEMBLE_ARGB32(out, a, r, g, b);
-        return out;
-    }
-};
-
 struct ComponentTransfer
 {
     ComponentTransfer(guint32 color)
@@ -166,10 +138,86 @@ private:
     double _offset;
 };
 
+/**
+ * All four transfer functions, tabulated. They work on unmultiplied values, so
+ * this also takes care of unmultiplying and premultiplying alpha around them.
+ */
+struct ComponentTransferLut
+{
+    ComponentTransferLut(FilterComponentTransfer const &ct)
+    {
+        // parameters: R = 0, G = 1, B = 2, A = 3
+        // Cairo:      R = 2, G = 1, B = 0, A = 3
+        // If tableValues is empty, use identity.
+        for (unsigned i = 0; i < 4; ++i) {
+            guint32 color = 2 - i;
+            if (i == 3) color = 3; // alpha
+
+            switch (ct.type[i]) {
+            case COMPONENTTRANSFER_TYPE_TABLE:
+                if (!ct.tableValues[i].empty()) {
+                    _fill(color, ComponentTransferTable(color, ct.tableValues[i]));
+                    continue;
+                }
+                break;
+            case COMPONENTTRANSFER_TYPE_DISCRETE:
+                if (!ct.tableValues[i].empty()) {
+                    _fill(color, ComponentTransferDiscrete(color, ct.tableValues[i]));
+                    continue;
+                }
+                break;
+            case COMPONENTTRANSFER_TYPE_LINEAR:
+                _fill(color, ComponentTransferLinear(color, ct.intercept[i], ct.slope[i]));
+                continue;
+            case COMPONENTTRANSFER_TYPE_GAMMA:
+                _fill(color, ComponentTransferGamma(color, ct.amplitude[i], ct.exponent[i], ct.offset[i]));
+                continue;
+            case COMPONENTTRANSFER_TYPE_ERROR:
+            case COMPONENTTRANSFER_TYPE_IDENTITY:
+            default:
+                break;
+            }
+            for (guint32 v = 0; v < 256; ++v) {
+                _lut[color][v] = v;
+            }
+        }
+    }
+
+    guint32 operator()(guint32 in) const
+    {
+        EXTRACT_ARGB32(in, a, r, g, b);
+        // We need to operate on unmultipled by alpha color values otherwise a change in alpha
+        // screws up the premultiplied by alpha r, g, b values.
+        if (a != 0) {
+            r = unpremul_alpha(r, a);
+            g = unpremul_alpha(g, a);
+            b = unpremul_alpha(b, a);
+        }
+        a = _lut[3][a];
+        r = premul_alpha(_lut[2][r], a);
+        g = premul_alpha(_lut[1][g], a);
+        b = premul_alpha(_lut[0][b], a);
+        ASSEMBLE_ARGB32(out, a, r, g, b);
+        return out;
+    }
+
+private:
+    template <typename Transfer>
+    void _fill(guint32 color, Transfer transfer)
+    {
+        guint32 const shift = color * 8;
+        for (guint32 v = 0; v < 256; ++v) {
+            _lut[color][v] = (transfer(v << shift) >> shift) & 0xff;
+        }
+    }
+
+    guint32 _lut[4][256];
+};
+
 void FilterComponentTransfer::render_cairo(FilterSlot &slot) const
 {
     cairo_surface_t *input = slot.getcairo(_input);
-    cairo_surface_t *out = ink_cairo_surface_create_same_size(input, CAIRO_CONTENT_COLOR_ALPHA);
+    cairo_surface_t *out = slot.create_surface(input, CAIRO_CONTENT_COLOR_ALPHA);
 
     // We may need to transform input surface to correct color interpolation space. The input surface
     // might be used as input to another primitive but it is likely that all the primitives in a given
@@ -177,49 +225,17 @@ void FilterComponentTransfer::render_cairo(FilterSlot &slot) const
     set_cairo_surface_ci(out, color_interpolation);
     set_cairo_surface_ci(input, color_interpolation);
 
-    ink_cairo_surface_blit(input, out);
-
-    // We need to operate on unmultipled by alpha color values otherwise a change in alpha screws
-    // up the premultiplied by alpha r, g, b values.
-    ink_cairo_surface_filter(out, out, UnmultiplyAlpha());
-
-    // parameters: R = 0, G = 1, B = 2, A = 3
-    // Cairo:      R = 2, G = 1, B = 0, A = 3
-    // If tableValues is empty, use identity.
-    for (unsigned i = 0; i < 4; ++i) {
-        guint32 color = 2 - i;
-        if (i == 3) color = 3; // alpha
-
-        switch (type[i]) {
-        case COMPONENTTRANSFER_TYPE_TABLE:
-            if (!tableValues[i].empty()) {
-              ink_cairo_surface_filter(out, out, ComponentTransferTable(color, tableValues[i]));
-            }
-            break;
-        case COMPONENTTRANSFER_TYPE_DISCRETE:
-            if (!tableValues[i].empty()) {
-                ink_cairo_surface_filter(out, out, ComponentTransferDiscrete(color, tableValues[i]));
-            }
-            break;
-        case COMPONENTTRANSFER_TYPE_LINEAR:
-            ink_cairo_surface_filter(out, out, ComponentTransferLinear(color, intercept[i], slope[i]));
-            break;
-        case COMPONENTTRANSFER_TYPE_GAMMA:
-            ink_cairo_surface_filter(out, out, ComponentTransferGamma(color, amplitude[i], exponent[i], offset[i]));
-            break;
-        case COMPONENTTRANSFER_TYPE_ERROR:
-        case COMPONENTTRANSFER_TYPE_IDENTITY:
-        default:
-            break;
-        }
-    }
-
-    ink_cairo_surface_filter(out, out, MultiplyAlpha());
+    ink_cairo_surface_filter(input, out, ComponentTransferLut(*this));
 
     slot.set(_output, out);
     cairo_surface_destroy(out);
 }
 
+std::function<guint32(guint32)> FilterComponentTransfer::get_pixel_function() const
+{
+    return ComponentTransferLut(*this);
+}
+
 bool FilterComponentTransfer::can_handle_affine(Geom::Affine const &) const
 {
     return true;
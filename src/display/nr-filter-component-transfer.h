@@ -40,6 +40,7 @@ public:
     void render_cairo(FilterSlot &slot) const override;
     bool can_handle_affine(Geom::Affine const &) const override;
     double complexity(Geom::Affine const &ctm) const override;
+    std::function<guint32(guint32)> get_pixel_function() const override;
 
     FilterComponentTransferType type[4];
     std::vector<double> tableValues[4];
@@ -11,6 +11,9 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <vector>
 #include "display/cairo-templates.h"
 #include "display/cairo-utils.h"
@@ -97,6 +100,251 @@ private:
     double _bias;
 };
 
+/**
+ * @brief feConvolveMatrix for ARGB32 images, a row at a time
+ *
+ * Computes the same as ConvolveMatrix in single precision. The image is split into planes
+ * of float channels a row at a time, and each kernel element is applied to all the pixels of
+ * a row in a loop the compiler can vectorise. Near the edges, where ConvolveMatrix shifts
+ * and cuts off the kernel, the pixels are computed one by one.
+ *
+ * Kernels which are the outer product of a column and a row, such as box and binomial blurs,
+ * are applied in a horizontal and a vertical pass, taking orderX + orderY instead of
+ * orderX * orderY multiplications per pixel.
+ */
+class ConvolveRows
+{
+public:
+    ConvolveRows(cairo_surface_t *s, int targetX, int targetY, int orderX, int orderY,
+                 double divisor, double bias, std::vector<double> const &kernel, bool preserve_alpha)
+        : _px(cairo_image_surface_get_data(s))
+        , _w(cairo_image_surface_get_width(s))
+        , _h(cairo_image_surface_get_height(s))
+        , _stride(cairo_image_surface_get_stride(s))
+        , _targetX(targetX)
+        , _targetY(targetY)
+        , _orderX(orderX)
+        , _orderY(orderY)
+        , _bias(bias)
+        , _preserve_alpha(preserve_alpha)
+        , _channels(preserve_alpha ? 3 : 4)
+    {
+        cairo_surface_flush(s);
+        // the matrix is given rotated 180 degrees
+        // which corresponds to reverse element order
+        _kernel.resize(kernel.size());
+        for (unsigned i = 0; i < kernel.size(); ++i) {
+            _kernel[kernel.size() - 1 - i] = kernel[i] / divisor;
+        }
+        _findFactors();
+    }
+
+    bool separable() const { return !_column.empty(); }
+
+    /// Run the horizontal pass of a separable kernel. Must be done before computing rows.
+    void prepare()
+    {
+        if (!separable()) {
+            return;
+        }
+        _pass.resize(std::size_t(_channels) * _w * _h);
+        auto const pool = get_global_dispatch_pool();
+        pool->dispatch_threshold(_h, _w * _h > POOL_THRESHOLD, [&](int y, int) {
+            _horizontalPass(y);
+        });
+    }
+
+    void operator()(int y, guint32 *out) const
+    {
+        std::vector<float> sums(4 * _w);
+        if (separable()) {
+            _verticalPass(y, sums.data());
+        } else {
+            _convolveRow(y, sums.data());
+        }
+        _assemble(y, sums.data(), out);
+    }
+
+private:
+    /// The start of the kernel window for pixel x, as in ConvolveMatrix.
+    int _startX(int x) const { return std::max(0, x - _targetX); }
+    int _startY(int y) const { return std::max(0, y - _targetY); }
+
+    /**
+     * Check whether the kernel is the product of a column and a row vector, within the
+     * precision of the single precision path, and set them up if it is.
+     */
+    void _findFactors()
+    {
+        if (_orderX * _orderY <= _orderX + _orderY) {
+            return;
+        }
+        auto const pivot = std::max_element(_kernel.begin(), _kernel.end(), [] (double a, double b) {
+            return std::abs(a) < std::abs(b);
+        }) - _kernel.begin();
+        double const max = std::abs(_kernel[pivot]);
+        if (max == 0.0) {
+            return;
+        }
+        int const pi = pivot / _orderX, pj = pivot % _orderX;
+        std::vector<float> column(_orderY), row(_orderX);
+        for (int j = 0; j < _orderX; ++j) {
+            row[j] = _kernel[pi * _orderX + j];
+        }
+        for (int i = 0; i < _orderY; ++i) {
+            column[i] = _kernel[i * _orderX + pj] / _kernel[pivot];
+        }
+        for (int i = 0; i < _orderY; ++i) {
+            for (int j = 0; j < _orderX; ++j) {
+                if (std::abs(double(column[i]) * row[j] - _kernel[i * _orderX + j]) > 1e-6 * max) {
+                    return;
+                }
+            }
+        }
+        _column = std::move(column);
+        _row = std::move(row);
+    }
+
+    /// Split row y of the image into float planes of its channels.
+    void _unpack(int y, float *planes) const
+    {
+        auto const px = reinterpret_cast<guint32 const *>(_px + y * _stride);
+        float *r = planes, *g = r + _w, *b = g + _w, *a = b + _w;
+        for (int x = 0; x < _w; ++x) {
+            r[x] = (px[x] >> 16) & 0xff;
+            g[x] = (px[x] >> 8) & 0xff;
+            b[x] = px[x] & 0xff;
+            a[x] = px[x] >> 24;
+        }
+    }
+
+    /**
+     * Add a row of kernel coefficients applied to an unpacked image row to the sums.
+     * Pixels whose window lies wholly within the image are done in one loop per coefficient.
+     */
+    void _applyRow(float const *coeffs, float const *planes, float *sums) const
+    {
+        int const begin = std::min(_targetX, _w);
+        int const end = std::max(begin, _w - _orderX + _targetX + 1);
+        for (int c = 0; c < _channels; ++c) {
+            float const *in = planes + c * _w;
+            float *sum = sums + c * _w;
+            // Three coefficients at a time, to read and write the sums less often.
+            int j = 0;
+            for (; j + 3 <= _orderX; j += 3) {
+                float const c0 = coeffs[j], c1 = coeffs[j + 1], c2 = coeffs[j + 2];
+                float const *src = in + j - _targetX;
+                for (int x = begin; x < end; ++x) {
+                    sum[x] += c0 * src[x] + c1 * src[x + 1] + c2 * src[x + 2];
+                }
+            }
+            for (; j < _orderX; ++j) {
+                float const coeff = coeffs[j];
+                float const *src = in + j - _targetX;
+                for (int x = begin; x < end; ++x) {
+                    sum[x] += coeff * src[x];
+                }
+            }
+            auto const edge = [&] (int x) {
+                int const start = _startX(x);
+                int const limit = std::min(_w, start + _orderX) - start;
+                for (int j = 0; j < limit; ++j) {
+                    sum[x] += coeffs[j] * in[start + j];
+                }
+            };
+            for (int x = 0; x < begin; ++x) {
+                edge(x);
+            }
+            for (int x = end; x < _w; ++x) {
+                edge(x);
+            }
+        }
+    }
+
+    void _convolveRow(int y, float *sums) const
+    {
+        std::vector<float> planes(4 * _w);
+        std::vector<float> coeffs(_orderX);
+        int const start = _startY(y);
+        int const limit = std::min(_h, start + _orderY) - start;
+        for (int i = 0; i < limit; ++i) {
+            _unpack(start + i, planes.data());
+            std::copy_n(_kernel.begin() + i * _orderX, _orderX, coeffs.begin());
+            _applyRow(coeffs.data(), planes.data(), sums);
+        }
+    }
+
+    /**
+     * Apply the row vector to row y, for every start of a window along it, as the windows
+     * of the vertical pass are cut off by the image edges the same way.
+     */
+    void _horizontalPass(int y)
+    {
+        std::vector<float> planes(4 * _w);
+        std::vector<float> sums(_channels * _w);
+        _unpack(y, planes.data());
+        // _applyRow() sums the window of pixel x, which starts at _startX(x).
+        _applyRow(_row.data(), planes.data(), sums.data());
+        for (int c = 0; c < _channels; ++c) {
+            float *dest = _pass.data() + (std::size_t(c) * _h + y) * _w;
+            for (int x = 0; x < _w; ++x) {
+                dest[x] = sums[c * _w + x];
+            }
+        }
+    }
+
+    void _verticalPass(int y, float *sums) const
+    {
+        int const start = _startY(y);
+        int const limit = std::min(_h, start + _orderY) - start;
+        for (int c = 0; c < _channels; ++c) {
+            float *sum = sums + c * _w;
+            for (int i = 0; i < limit; ++i) {
+                float const coeff = _column[i];
+                float const *src = _pass.data() + (std::size_t(c) * _h + start + i) * _w;
+                for (int x = 0; x < _w; ++x) {
+                    sum[x] += coeff * src[x];
+                }
+            }
+        }
+    }
+
+    void _assemble(int y, float *sums, guint32 *out) const
+    {
+        auto const in = reinterpret_cast<guint32 const *>(_px + y * _stride);
+        float *r = sums, *g = r + _w, *b = g + _w, *a = b + _w;
+        float const bias = _bias;
+        if (_preserve_alpha) {
+            for (int x = 0; x < _w; ++x) {
+                a[x] = in[x] >> 24;
+            }
+        } else {
+            for (int x = 0; x < _w; ++x) {
+                a[x] += bias * 255;
+            }
+        }
+        for (int x = 0; x < _w; ++x) {
+            // Conversions from int rather than unsigned, which SSE2 can't vectorise.
+            int const ao = std::clamp(a[x], 0.0f, 255.0f) + 0.5f;
+            float const fa = ao;
+            int const ro = std::clamp(r[x] + fa * bias, 0.0f, fa) + 0.5f;
+            int const go = std::clamp(g[x] + fa * bias, 0.0f, fa) + 0.5f;
+            int const bo = std::clamp(b[x] + fa * bias, 0.0f, fa) + 0.5f;
+            out[x] = guint32(ao) << 24 | guint32(ro) << 16 | guint32(go) << 8 | guint32(bo);
+        }
+    }
+
+    unsigned char *_px;
+    int _w, _h, _stride;
+    int _targetX, _targetY, _orderX, _orderY;
+    float _bias;
+    bool _preserve_alpha;
+    int _channels;
+    std::vector<float> _kernel;
+    std::vector<float> _column, _row; ///< The factors of a separable kernel.
+    std::vector<float> _pass;         ///< Planes of the horizontal pass.
+};
+
 void FilterConvolveMatrix::render_cairo(FilterSlot &slot) const
 {
     static bool bias_warning = false;
@@ -152,7 +400,11 @@ void FilterConvolveMatrix::render_cairo(FilterSlot &slot) const
         kernel[i] /= divisor; // The code that creates this object makes sure that divisor != 0
     }*/
 
-    if (preserveAlpha) {
+    if (cairo_image_surface_get_format(input) == CAIRO_FORMAT_ARGB32) {
+        ConvolveRows convolve(input, targetX, targetY, orderX, orderY, divisor, bias, kernelMatrix, preserveAlpha);
+        convolve.prepare();
+        ink_cairo_surface_synthesize_rows(out, std::cref(convolve));
+    } else if (preserveAlpha) {
         //convolve2D<true>(out_data, in_data, width, height, &kernel.front(), orderX, orderY,
         //    targetX, targetY, bias);
         ink_cairo_surface_synthesize(out, ConvolveMatrix<PRESERVE_ALPHA>(input,
@@ -16,6 +16,7 @@
 # include "config.h"  // only include where actually required!
 #endif
 
+#include <algorithm>
 #include <glib.h>
 
 #include "display/cairo-templates.h"
@@ -38,6 +39,10 @@ FilterDiffuseLighting::FilterDiffuseLighting()
 
 FilterDiffuseLighting::~FilterDiffuseLighting() = default;
 
+/**
+ * Lights a row at a time: the normals and light vectors of a row are computed into arrays
+ * in single precision first, so that the loops combining them can be vectorised.
+ */
 struct DiffuseLight : public SurfaceSynth
 {
     DiffuseLight(cairo_surface_t *bumpmap, double scale, double kd)
@@ -46,17 +51,28 @@ struct DiffuseLight : public SurfaceSynth
         , _kd(kd) {}
 
 protected:
-    guint32 diffuseLighting(int x, int y, NR::Fvector const &light, NR::Fvector const &light_components)
+    LightingRow prepareRow(int y) const
     {
-        NR::Fvector normal = surfaceNormalAt(x, y, _scale);
-        double k = _kd * NR::scalar_product(normal, light);
-
-        guint32 r = CLAMP_D_TO_U8(k * light_components[LIGHT_RED]);
-        guint32 g = CLAMP_D_TO_U8(k * light_components[LIGHT_GREEN]);
-        guint32 b = CLAMP_D_TO_U8(k * light_components[LIGHT_BLUE]);
+        LightingRow row(_w);
+        alphaRow(y, row.alpha.data());
+        surfaceNormalRow(y, _scale, row.nx.data(), row.ny.data(), row.nz.data());
+        return row;
+    }
 
-        ASSEMBLE_ARGB32(pxout, 255, r, g, b)
-        return pxout;
+    void diffuseLighting(LightingRow const &row, NR::Fvector const &light_components, guint32 *out) const
+    {
+        float const kd = _kd;
+        float const lr = light_components[LIGHT_RED];
+        float const lg = light_components[LIGHT_GREEN];
+        float const lb = light_components[LIGHT_BLUE];
+        for (int x = 0; x < row.width; ++x) {
+            float const k = kd * row.factor[x] * (row.nx[x] * row.lx[x] + row.ny[x] * row.ly[x] + row.nz[x] * row.lz[x]);
+            int const r = std::clamp(k * lr, 0.0f, 255.0f) + 0.5f;
+            int const g = std::clamp(k * lg, 0.0f, 255.0f) + 0.5f;
+            int const b = std::clamp(k * lb, 0.0f, 255.0f) + 0.5f;
+            ASSEMBLE_ARGB32(pxout, 255u, r, g, b)
+            out[x] = pxout;
+        }
     }
 
     double _scale, _kd;
@@ -67,19 +83,21 @@ struct DiffuseDistantLight : public DiffuseLight
     DiffuseDistantLight(cairo_surface_t *bumpmap, DistantLightData const &light, guint32 color,
                         double scale, double diffuse_constant)
         : DiffuseLight(bumpmap, scale, diffuse_constant)
+        , _light(light, color)
     {
-        DistantLight dl(light, color);
-        dl.light_vector(_lightv);
-        dl.light_components(_light_components);
+        _light.light_components(_light_components);
     }
 
-    guint32 operator()(int x, int y)
+    void operator()(int y, guint32 *out)
     {
-        return diffuseLighting(x, y, _lightv, _light_components);
+        auto row = prepareRow(y);
+        _light.light_vectors(row);
+        diffuseLighting(row, _light_components, out);
     }
 
 private:
-    NR::Fvector _lightv, _light_components;
+    DistantLight _light;
+    NR::Fvector _light_components;
 };
 
 struct DiffusePointLight : public DiffuseLight
@@ -95,11 +113,11 @@ struct DiffusePointLight : public DiffuseLight
         _light.light_components(_light_components);
     }
 
-    guint32 operator()(int x, int y)
+    void operator()(int y, guint32 *out)
     {
-        NR::Fvector light;
-        _light.light_vector(light, _x0 + x, _y0 + y, _scale * alphaAt(x, y) / 255.0);
-        return diffuseLighting(x, y, light, _light_components);
+        auto row = prepareRow(y);
+        _light.light_vectors(row, _x0, _y0 + y, _scale);
+        diffuseLighting(row, _light_components, out);
     }
 
 private:
@@ -115,19 +133,21 @@ struct DiffuseSpotLight : public DiffuseLight
                      double x0, double y0, int device_scale)
         : DiffuseLight(bumpmap, scale, diffuse_constant)
         , _light(light, color, trans, device_scale)
+        , _light_components(SP_RGBA32_R_U(color), SP_RGBA32_G_U(color), SP_RGBA32_B_U(color))
         , _x0(x0)
         , _y0(y0) {}
 
-    guint32 operator()(int x, int y)
+    void operator()(int y, guint32 *out)
     {
-        NR::Fvector light, light_components;
-        _light.light_vector(light, _x0 + x, _y0 + y, _scale * alphaAt(x, y)/255.0);
-        _light.light_components(light_components, light);
-        return diffuseLighting(x, y, light, light_components);
+        auto row = prepareRow(y);
+        _light.light_vectors(row, _x0, _y0 + y, _scale);
+        _light.light_factors(row);
+        diffuseLighting(row, _light_components, out);
     }
 
 private:
     SpotLight _light;
+    NR::Fvector _light_components;
     double _x0, _y0;
 };
 
@@ -167,13 +187,13 @@ void FilterDiffuseLighting::render_cairo(FilterSlot &slot) const
 
     switch (light_type) {
     case DISTANT_LIGHT:
-        ink_cairo_surface_synthesize(out, DiffuseDistantLight(input, light.distant, color, scale, diffuseConstant));
+        ink_cairo_surface_synthesize_rows(out, DiffuseDistantLight(input, light.distant, color, scale, diffuseConstant));
         break;
     case POINT_LIGHT:
-        ink_cairo_surface_synthesize(out, DiffusePointLight(input, light.point, color, trans, scale, diffuseConstant, x0, y0, device_scale));
+        ink_cairo_surface_synthesize_rows(out, DiffusePointLight(input, light.point, color, trans, scale, diffuseConstant, x0, y0, device_scale));
         break;
     case SPOT_LIGHT:
-        ink_cairo_surface_synthesize(out, DiffuseSpotLight(input, light.spot, color, trans, scale, diffuseConstant, x0, y0, device_scale));
+        ink_cairo_surface_synthesize_rows(out, DiffuseSpotLight(input, light.spot, color, trans, scale, diffuseConstant, x0, y0, device_scale));
         break;
     default: {
         cairo_t *ct = cairo_create(out);
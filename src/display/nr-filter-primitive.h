@@ -12,7 +12,9 @@
 #ifndef SEEN_NR_FILTER_PRIMITIVE_H
 #define SEEN_NR_FILTER_PRIMITIVE_H
 
+#include <functional>
 #include <memory>
+#include <vector>
 #include <2geom/forward.h>
 #include <2geom/rect.h>
 
@@ -72,6 +74,19 @@ public:
      */
     virtual void set_output(int slot);
 
+    /// Returns the slots read by this primitive.
+    virtual std::vector<int> get_inputs() const { return {_input}; }
+    int get_output() const { return _output; }
+    SPColorInterpolation get_color_interpolation() const { return color_interpolation; }
+
+    /**
+     * Primitives which compute every output pixel from the same pixel of their only input
+     * return the function doing so, working on premultiplied ARGB32 in the primitive's color
+     * interpolation space. Filter::render() runs chains of them in a single pass, without
+     * creating the intermediate images. The function may be called from several threads.
+     */
+    virtual std::function<guint32(guint32)> get_pixel_function() const { return {}; }
+
     // returns cache score factor, reflecting the cost of rendering this filter
     // this should return how many times slower this primitive is that normal rendering
     virtual double complexity(Geom::Affine const &/*ctm*/) const { return 1.0; }
@@ -62,10 +62,15 @@ FilterSlot::~FilterSlot()
     for (auto &_slot : _slots) {
         cairo_surface_destroy(_slot.second);
     }
+    for (auto s : _pool) {
+        cairo_surface_destroy(s);
+    }
 }
 
 cairo_surface_t *FilterSlot::getcairo(int slot_nr)
 {
+    std::scoped_lock lock(_mutex);
+
     if (slot_nr == NR_FILTER_SLOT_NOT_SET)
         slot_nr = _last_out;
 
@@ -188,6 +193,8 @@ cairo_surface_t *FilterSlot::_get_transformed_background() const
 
 cairo_surface_t *FilterSlot::get_result(int res)
 {
+    std::scoped_lock lock(_mutex);
+
     cairo_surface_t *result = getcairo(res);
 
     Geom::Affine trans = _units.get_matrix_pb2display();
@@ -231,6 +238,7 @@ void FilterSlot::_set_internal(int slot_nr, cairo_surface_t *surface)
 void FilterSlot::set(int slot_nr, cairo_surface_t *surface)
 {
     g_return_if_fail(surface != nullptr);
+    std::scoped_lock lock(_mutex);
 
     if (slot_nr == NR_FILTER_SLOT_NOT_SET)
         slot_nr = NR_FILTER_UNNAMED_SLOT;
@@ -239,8 +247,73 @@ void FilterSlot::set(int slot_nr, cairo_surface_t *surface)
     _last_out = slot_nr;
 }
 
+void FilterSlot::release(int slot_nr)
+{
+    std::scoped_lock lock(_mutex);
+
+    auto s = _slots.find(slot_nr);
+    if (s == _slots.end()) {
+        return;
+    }
+    cairo_surface_t *surface = s->second;
+    _slots.erase(s);
+
+    if (surface && cairo_surface_get_type(surface) == CAIRO_SURFACE_TYPE_IMAGE
+        && cairo_surface_get_reference_count(surface) == 1)
+    {
+        _pool.push_back(surface);
+    } else {
+        cairo_surface_destroy(surface);
+    }
+}
+
+cairo_surface_t *FilterSlot::create_surface(cairo_surface_t *like, cairo_content_t content)
+{
+    cairo_surface_t *reused = nullptr;
+
+    if (cairo_surface_get_type(like) == CAIRO_SURFACE_TYPE_IMAGE) {
+        cairo_format_t const format = content == CAIRO_CONTENT_ALPHA ? CAIRO_FORMAT_A8 : CAIRO_FORMAT_ARGB32;
+        double x_scale, y_scale, pool_x_scale, pool_y_scale;
+        cairo_surface_get_device_scale(like, &x_scale, &y_scale);
+
+        std::scoped_lock lock(_mutex);
+        for (auto it = _pool.begin(); it != _pool.end(); ++it) {
+            cairo_surface_get_device_scale(*it, &pool_x_scale, &pool_y_scale);
+            if (cairo_image_surface_get_format(*it) == format
+                && cairo_image_surface_get_width(*it) == cairo_image_surface_get_width(like)
+                && cairo_image_surface_get_height(*it) == cairo_image_surface_get_height(like)
+                && pool_x_scale == x_scale && pool_y_scale == y_scale)
+            {
+                reused = *it;
+                _pool.erase(it);
+                break;
+            }
+        }
+    }
+
+    if (!reused) {
+        return ink_cairo_surface_create_same_size(like, content);
+    }
+
+    cairo_surface_flush(reused);
+    std::memset(cairo_image_surface_get_data(reused), 0,
+                cairo_image_surface_get_stride(reused) * cairo_image_surface_get_height(reused));
+    cairo_surface_mark_dirty(reused);
+    // Transparent pixels look the same in every color space, so this only resets the tag.
+    set_cairo_surface_ci(reused, SP_CSS_COLOR_INTERPOLATION_AUTO);
+    return reused;
+}
+
+void FilterSlot::set_last_out(int slot_nr)
+{
+    std::scoped_lock lock(_mutex);
+    _last_out = slot_nr;
+}
+
 void FilterSlot::set_primitive_area(int slot_nr, Geom::Rect &area)
 {
+    std::scoped_lock lock(_mutex);
+
     if (slot_nr == NR_FILTER_SLOT_NOT_SET)
         slot_nr = NR_FILTER_UNNAMED_SLOT;
 
@@ -249,6 +322,8 @@ void FilterSlot::set_primitive_area(int slot_nr, Geom::Rect &area)
 
 Geom::Rect FilterSlot::get_primitive_area(int slot_nr) const
 {
+    std::scoped_lock lock(_mutex);
+
     if (slot_nr == NR_FILTER_SLOT_NOT_SET)
         slot_nr = _last_out;
 
@@ -16,14 +16,12 @@
  */
 
 #include <map>
+#include <mutex>
+#include <vector>
+#include <cairo.h>
 #include "nr-filter-types.h"
 #include "nr-filter-units.h"
 
-extern "C" {
-typedef struct _cairo cairo_t;
-typedef struct _cairo_surface cairo_surface_t;
-}
-
 namespace Inkscape {
 class DrawingContext;
 class DrawingItem;
@@ -57,11 +55,26 @@ public:
 
     cairo_surface_t *get_result(int slot_nr);
 
+    /** Sets the slot read through NR_FILTER_SLOT_NOT_SET, which is otherwise the
+     * slot last passed to set().
+     */
+    void set_last_out(int slot);
+
+    /** Empties a slot whose contents will not be read again. If nothing else
+     * uses its image, the image is kept for create_surface() to hand out again.
+     */
+    void release(int slot);
+
+    /** Like ink_cairo_surface_create_same_size(), but reuses a released image if
+     * there is one of the right size and content. The image is cleared.
+     */
+    cairo_surface_t *create_surface(cairo_surface_t *like, cairo_content_t content);
+
     void set_primitive_area(int slot, Geom::Rect &area);
     Geom::Rect get_primitive_area(int slot) const;
     
     /** Returns the number of slots in use. */
-    int get_slot_count() const { return _slots.size(); }
+    int get_slot_count() const { std::scoped_lock lock(_mutex); return _slots.size(); }
 
     /** Gets the gaussian filtering quality. Affects used interpolation methods */
     int get_blurquality() const { return _blurquality; }
@@ -75,8 +88,12 @@ public:
     RenderContext &get_rendercontext() const { return rc; }
 
 private:
+    // Primitives on independent branches of a filter may use the slots from several threads.
+    mutable std::recursive_mutex _mutex;
+
     using SlotMap = std::map<int, cairo_surface_t *>;
     SlotMap _slots;
+    std::vector<cairo_surface_t *> _pool; ///< Released images, see release()
 
     // We need to keep track of the primitive area as this is needed in feTile
     using PrimitiveAreaMap = std::map<int, Geom::Rect>;
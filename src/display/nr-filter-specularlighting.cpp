@@ -15,8 +15,10 @@
 # include "config.h"  // only include where actually required!
 #endif
 
-#include <glib.h>
+#include <algorithm>
 #include <cmath>
+#include <vector>
+#include <glib.h>
 
 #include "display/cairo-templates.h"
 #include "display/cairo-utils.h"
@@ -39,6 +41,10 @@ FilterSpecularLighting::FilterSpecularLighting()
 
 FilterSpecularLighting::~FilterSpecularLighting() = default;
 
+/**
+ * Lights a row at a time: the normals and light vectors of a row are computed into arrays
+ * in single precision first, so that the loops combining them can be vectorised.
+ */
 struct SpecularLight : public SurfaceSynth
 {
     SpecularLight(cairo_surface_t *bumpmap, double scale, double specular_constant, double specular_exponent)
@@ -48,23 +54,45 @@ struct SpecularLight : public SurfaceSynth
         , _exp(specular_exponent) {}
 
 protected:
-    guint32 specularLighting(int x, int y, NR::Fvector const &halfway, NR::Fvector const &light_components)
+    LightingRow prepareRow(int y) const
     {
-        NR::Fvector normal = surfaceNormalAt(x, y, _scale);
-        double sp = NR::scalar_product(normal, halfway);
-        double k = sp <= 0.0 ? 0.0 : _ks * std::pow(sp, _exp);
-
-        guint32 r = CLAMP_D_TO_U8(k * light_components[LIGHT_RED]);
-        guint32 g = CLAMP_D_TO_U8(k * light_components[LIGHT_GREEN]);
-        guint32 b = CLAMP_D_TO_U8(k * light_components[LIGHT_BLUE]);
-        guint32 a = std::max(std::max(r, g), b);
+        LightingRow row(_w);
+        alphaRow(y, row.alpha.data());
+        surfaceNormalRow(y, _scale, row.nx.data(), row.ny.data(), row.nz.data());
+        return row;
+    }
 
-        r = premul_alpha(r, a);
-        g = premul_alpha(g, a);
-        b = premul_alpha(b, a);
+    void specularLighting(LightingRow const &row, NR::Fvector const &light_components, guint32 *out) const
+    {
+        // The light vectors are replaced by the halfway vectors between them and the eye.
+        std::vector<float> k(row.width);
+        for (int x = 0; x < row.width; ++x) {
+            float const hz = row.lz[x] + 1.0f;
+            float const inv = 1.0f / std::sqrt(row.lx[x] * row.lx[x] + row.ly[x] * row.ly[x] + hz * hz);
+            k[x] = (row.nx[x] * row.lx[x] + row.ny[x] * row.ly[x] + row.nz[x] * hz) * inv;
+        }
+        float const ks = _ks;
+        float const exponent = _exp;
+        for (int x = 0; x < row.width; ++x) {
+            k[x] = k[x] <= 0.0f ? 0.0f : ks * row.factor[x] * std::pow(k[x], exponent);
+        }
 
-        ASSEMBLE_ARGB32(pxout, a,r,g,b)
-        return pxout;
+        float const lr = light_components[LIGHT_RED];
+        float const lg = light_components[LIGHT_GREEN];
+        float const lb = light_components[LIGHT_BLUE];
+        for (int x = 0; x < row.width; ++x) {
+            int r = std::clamp(k[x] * lr, 0.0f, 255.0f) + 0.5f;
+            int g = std::clamp(k[x] * lg, 0.0f, 255.0f) + 0.5f;
+            int b = std::clamp(k[x] * lb, 0.0f, 255.0f) + 0.5f;
+            int const a = std::max(std::max(r, g), b);
+
+            r = premul_alpha(r, a);
+            g = premul_alpha(g, a);
+            b = premul_alpha(b, a);
+
+            ASSEMBLE_ARGB32(pxout, a,r,g,b)
+            out[x] = pxout;
+        }
     }
 
     double _scale, _ks, _exp;
@@ -75,21 +103,21 @@ struct SpecularDistantLight : public SpecularLight
     SpecularDistantLight(cairo_surface_t *bumpmap, DistantLightData const &light, guint32 color,
                          double scale, double specular_constant, double specular_exponent)
         : SpecularLight(bumpmap, scale, specular_constant, specular_exponent)
+        , _light(light, color)
     {
-        DistantLight dl(light, color);
-        NR::Fvector lv;
-        dl.light_vector(lv);
-        dl.light_components(_light_components);
-        NR::normalized_sum(_halfway, lv, NR::EYE_VECTOR);
+        _light.light_components(_light_components);
     }
 
-    guint32 operator()(int x, int y)
+    void operator()(int y, guint32 *out)
     {
-        return specularLighting(x, y, _halfway, _light_components);
+        auto row = prepareRow(y);
+        _light.light_vectors(row);
+        specularLighting(row, _light_components, out);
     }
 
 private:
-    NR::Fvector _halfway, _light_components;
+    DistantLight _light;
+    NR::Fvector _light_components;
 };
 
 struct SpecularPointLight : public SpecularLight
@@ -105,12 +133,11 @@ struct SpecularPointLight : public SpecularLight
         _light.light_components(_light_components);
     }
 
-    guint32 operator()(int x, int y)
+    void operator()(int y, guint32 *out)
     {
-        NR::Fvector light, halfway;
-        _light.light_vector(light, _x0 + x, _y0 + y, _scale * alphaAt(x, y) / 255.0);
-        NR::normalized_sum(halfway, light, NR::EYE_VECTOR);
-        return specularLighting(x, y, halfway, _light_components);
+        auto row = prepareRow(y);
+        _light.light_vectors(row, _x0, _y0 + y, _scale);
+        specularLighting(row, _light_components, out);
     }
 
 private:
@@ -126,20 +153,21 @@ struct SpecularSpotLight : public SpecularLight
                       double specular_exponent, double x0, double y0, int device_scale)
         : SpecularLight(bumpmap, scale, specular_constant, specular_exponent)
         , _light(light, color, trans, device_scale)
+        , _light_components(SP_RGBA32_R_U(color), SP_RGBA32_G_U(color), SP_RGBA32_B_U(color))
         , _x0(x0)
         , _y0(y0) {}
 
-    guint32 operator()(int x, int y)
+    void operator()(int y, guint32 *out)
     {
-        NR::Fvector light, halfway, light_components;
-        _light.light_vector(light, _x0 + x, _y0 + y, _scale * alphaAt(x, y) / 255.0);
-        _light.light_components(light_components, light);
-        NR::normalized_sum(halfway, light, NR::EYE_VECTOR);
-        return specularLighting(x, y, halfway, light_components);
+        auto row = prepareRow(y);
+        _light.light_vectors(row, _x0, _y0 + y, _scale);
+        _light.light_factors(row);
+        specularLighting(row, _light_components, out);
     }
 
 private:
     SpotLight _light;
+    NR::Fvector _light_components;
     double _x0, _y0;
 };
 
@@ -180,15 +208,15 @@ void FilterSpecularLighting::render_cairo(FilterSlot &slot) const
 
     switch (light_type) {
     case DISTANT_LIGHT:
-        ink_cairo_surface_synthesize(out,
+        ink_cairo_surface_synthesize_rows(out,
             SpecularDistantLight(input, light.distant, color, scale, ks, se));
         break;
     case POINT_LIGHT:
-        ink_cairo_surface_synthesize(out,
+        ink_cairo_surface_synthesize_rows(out,
             SpecularPointLight(input, light.point, color, trans, scale, ks, se, x0, y0, device_scale));
         break;
     case SPOT_LIGHT:
-        ink_cairo_surface_synthesize(out,
+        ink_cairo_surface_synthesize_rows(out,
             SpecularSpotLight(input, light.spot, color, trans, scale, ks, se, x0, y0, device_scale));
         break;
     default: {
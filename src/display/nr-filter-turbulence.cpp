@@ -18,130 +18,300 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include "display/nr-filter-turbulence.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <2geom/int-rect.h>
+
 #include "display/cairo-templates.h"
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/nr-filter.h"
-#include "display/nr-filter-turbulence.h"
 #include "display/nr-filter-units.h"
 #include "display/nr-filter-utils.h"
-#include <cmath>
+#include "display/threading.h"
 
 namespace Inkscape {
 namespace Filters{
 
-class TurbulenceGenerator
+namespace {
+
+// random number generator constants
+long constexpr
+    RAND_m = 2147483647, // 2**31 - 1
+    RAND_a = 16807, // 7**5; primitive root of m
+    RAND_q = 127773, // m / a
+    RAND_r = 2836; // m % a
+
+double constexpr PerlinOffset = 4096.0;
+
+template <typename T>
+inline T scurve(T t)
 {
-public:
-    TurbulenceGenerator()
-        : _tile()
-        , _baseFreq()
-        , _latticeSelector()
-        , _gradient()
-        , _seed(0)
-        , _octaves(0)
-        , _stitchTiles(false)
-        , _wrapx(0)
-        , _wrapy(0)
-        , _wrapw(0)
-        , _wraph(0)
-        , _inited(false)
-        , _fractalnoise(false) {}
-
-    void init(long seed, Geom::Rect const &tile, Geom::Point const &freq, bool stitch, bool fractalnoise, int octaves)
-    {
-        // setup random number generator
-        _setupSeed(seed);
+    return t * t * (T{3} - T{2} * t);
+}
 
-        // set values
-        _tile = tile;
-        _baseFreq = freq;
-        _stitchTiles = stitch;
-        _fractalnoise = fractalnoise;
-        _octaves = octaves;
+template <typename T>
+inline T lerp(T t, T a, T b)
+{
+    return a + t * (b - a);
+}
 
-        int i;
-        for (int k = 0; k < 4; ++k) {
-            for (i = 0; i < BSize; ++i) {
-                _latticeSelector[i] = i;
-
-                do {
-                    _gradient[i][k][0] = static_cast<double>(_random() % (BSize * 2) - BSize) / BSize;
-                    _gradient[i][k][1] = static_cast<double>(_random() % (BSize * 2) - BSize) / BSize;
-                } while (_gradient[i][k][0] == 0 && _gradient[i][k][1] == 0);
-
-                // normalize gradient
-                double s = hypot(_gradient[i][k][0], _gradient[i][k][1]);
-                _gradient[i][k][0] /= s;
-                _gradient[i][k][1] /= s;
-            }
-        }
-        while (--i) {
-            // shuffle lattice selectors
-            int j = _random() % BSize;
-            std::swap(_latticeSelector[i], _latticeSelector[j]);
+int floor_div(int a, int b)
+{
+    return a / b - (a % b < 0);
+}
+
+} // namespace
+
+void TurbulenceGenerator::init(Params const &params)
+{
+    // setup random number generator
+    _setupSeed(params.seed);
+
+    // set values
+    _params = params;
+    _baseFreq = params.freq;
+
+    int i;
+    for (int k = 0; k < 4; ++k) {
+        for (i = 0; i < BSize; ++i) {
+            _latticeSelector[i] = i;
+
+            do {
+                _gradient[i][k][0] = static_cast<double>(_random() % (BSize * 2) - BSize) / BSize;
+                _gradient[i][k][1] = static_cast<double>(_random() % (BSize * 2) - BSize) / BSize;
+            } while (_gradient[i][k][0] == 0 && _gradient[i][k][1] == 0);
+
+            // normalize gradient
+            double s = hypot(_gradient[i][k][0], _gradient[i][k][1]);
+            _gradient[i][k][0] /= s;
+            _gradient[i][k][1] /= s;
         }
+    }
+    while (--i) {
+        // shuffle lattice selectors
+        int j = _random() % BSize;
+        std::swap(_latticeSelector[i], _latticeSelector[j]);
+    }
 
-        // fill out the remaining part of the gradient
-        for (i = 0; i < BSize + 2; ++i)
-        {
-            _latticeSelector[BSize + i] = _latticeSelector[i];
+    // fill out the remaining part of the gradient
+    for (i = 0; i < BSize + 2; ++i)
+    {
+        _latticeSelector[BSize + i] = _latticeSelector[i];
 
-            for (int k = 0; k < 4; ++k) {
-                _gradient[BSize + i][k][0] = _gradient[i][k][0];
-                _gradient[BSize + i][k][1] = _gradient[i][k][1];
-            }
+        for (int k = 0; k < 4; ++k) {
+            _gradient[BSize + i][k][0] = _gradient[i][k][0];
+            _gradient[BSize + i][k][1] = _gradient[i][k][1];
         }
+    }
 
-        // When stitching tiled turbulence, the frequencies must be adjusted
-        // so that the tile borders will be continuous.
-        if (_stitchTiles) {
-            if (_baseFreq[Geom::X] != 0.0) {
-                double freq = _baseFreq[Geom::X];
-                double lo = std::floor(_tile.width() * freq) / _tile.width();
-                double hi = std::ceil(_tile.width() * freq) / _tile.width();
-                _baseFreq[Geom::X] = freq / lo < hi / freq ? lo : hi;
-            }
-            if (_baseFreq[Geom::Y] != 0.0) {
-                double freq = _baseFreq[Geom::Y];
-                double lo = std::floor(_tile.height() * freq) / _tile.height();
-                double hi = std::ceil(_tile.height() * freq) / _tile.height();
-                _baseFreq[Geom::Y] = freq / lo < hi / freq ? lo : hi;
-            }
+    for (i = 0; i < 2 * BSize + 2; ++i) {
+        for (int k = 0; k < 4; ++k) {
+            _gradientf[i][0][k] = _gradient[i][k][0];
+            _gradientf[i][1][k] = _gradient[i][k][1];
+        }
+    }
 
-            _wrapw = _tile.width() * _baseFreq[Geom::X] + 0.5;
-            _wraph = _tile.height() * _baseFreq[Geom::Y] + 0.5;
-            _wrapx = _tile.left() * _baseFreq[Geom::X] + PerlinOffset + _wrapw;
-            _wrapy = _tile.top() * _baseFreq[Geom::Y] + PerlinOffset + _wraph;
+    // When stitching tiled turbulence, the frequencies must be adjusted
+    // so that the tile borders will be continuous.
+    if (_params.stitch) {
+        auto const &tile = _params.tile;
+        if (_baseFreq[Geom::X] != 0.0) {
+            double freq = _baseFreq[Geom::X];
+            double lo = std::floor(tile.width() * freq) / tile.width();
+            double hi = std::ceil(tile.width() * freq) / tile.width();
+            _baseFreq[Geom::X] = freq / lo < hi / freq ? lo : hi;
+        }
+        if (_baseFreq[Geom::Y] != 0.0) {
+            double freq = _baseFreq[Geom::Y];
+            double lo = std::floor(tile.height() * freq) / tile.height();
+            double hi = std::ceil(tile.height() * freq) / tile.height();
+            _baseFreq[Geom::Y] = freq / lo < hi / freq ? lo : hi;
         }
-        _inited = true;
+
+        _wrapw = tile.width() * _baseFreq[Geom::X] + 0.5;
+        _wraph = tile.height() * _baseFreq[Geom::Y] + 0.5;
+        _wrapx = tile.left() * _baseFreq[Geom::X] + PerlinOffset + _wrapw;
+        _wrapy = tile.top() * _baseFreq[Geom::Y] + PerlinOffset + _wraph;
     }
+    _inited = true;
+}
 
-    G_GNUC_PURE
-    guint32 turbulencePixel(Geom::Point const &p) const
+guint32 TurbulenceGenerator::turbulencePixel(Geom::Point const &p) const
+{
+    int wrapx = _wrapx, wrapy = _wrapy, wrapw = _wrapw, wraph = _wraph;
+
+    double pixel[4];
+    double x = p[Geom::X] * _baseFreq[Geom::X];
+    double y = p[Geom::Y] * _baseFreq[Geom::Y];
+    double ratio = 1.0;
+
+    for (double & k : pixel)
+        k = 0.0;
+
+    for (int octave = 0; octave < _params.octaves; ++octave)
     {
-        int wrapx = _wrapx, wrapy = _wrapy, wrapw = _wrapw, wraph = _wraph;
+        double tx = x + PerlinOffset;
+        double bx = floor(tx);
+        double rx0 = tx - bx, rx1 = rx0 - 1.0;
+        int bx0 = bx, bx1 = bx0 + 1;
+
+        double ty = y + PerlinOffset;
+        double by = floor(ty);
+        double ry0 = ty - by, ry1 = ry0 - 1.0;
+        int by0 = by, by1 = by0 + 1;
+
+        if (_params.stitch) {
+            if (bx0 >= wrapx) bx0 -= wrapw;
+            if (bx1 >= wrapx) bx1 -= wrapw;
+            if (by0 >= wrapy) by0 -= wraph;
+            if (by1 >= wrapy) by1 -= wraph;
+        }
+        bx0 &= BMask;
+        bx1 &= BMask;
+        by0 &= BMask;
+        by1 &= BMask;
+
+        int i = _latticeSelector[bx0];
+        int j = _latticeSelector[bx1];
+        int b00 = _latticeSelector[i + by0];
+        int b01 = _latticeSelector[i + by1];
+        int b10 = _latticeSelector[j + by0];
+        int b11 = _latticeSelector[j + by1];
+
+        double sx = scurve(rx0);
+        double sy = scurve(ry0);
+
+        double result[4];
+        // channel numbering: R=0, G=1, B=2, A=3
+        for (int k = 0; k < 4; ++k) {
+            double const *qxa = _gradient[b00][k];
+            double const *qxb = _gradient[b10][k];
+            double a = lerp(sx, rx0 * qxa[0] + ry0 * qxa[1],
+                                rx1 * qxb[0] + ry0 * qxb[1]);
+            double const *qya = _gradient[b01][k];
+            double const *qyb = _gradient[b11][k];
+            double b = lerp(sx, rx0 * qya[0] + ry1 * qya[1],
+                                rx1 * qyb[0] + ry1 * qyb[1]);
+            result[k] = lerp(sy, a, b);
+        }
 
-        double pixel[4];
-        double x = p[Geom::X] * _baseFreq[Geom::X];
-        double y = p[Geom::Y] * _baseFreq[Geom::Y];
-        double ratio = 1.0;
+        if (_params.fractalnoise) {
+            for (int k = 0; k < 4; ++k)
+                pixel[k] += result[k] / ratio;
+        } else {
+            for (int k = 0; k < 4; ++k)
+                pixel[k] += fabs(result[k]) / ratio;
+        }
 
-        for (double & k : pixel)
-            k = 0.0;
+        x *= 2;
+        y *= 2;
+        ratio *= 2;
 
-        for (int octave = 0; octave < _octaves; ++octave)
+        if (_params.stitch)
         {
-            double tx = x + PerlinOffset;
-            double bx = floor(tx);
-            double rx0 = tx - bx, rx1 = rx0 - 1.0;
-            int bx0 = bx, bx1 = bx0 + 1;
+            // Update stitch values. Subtracting PerlinOffset before the multiplication and
+            // adding it afterward simplifies to subtracting it once.
+            wrapw *= 2;
+            wraph *= 2;
+            wrapx = wrapx*2 - PerlinOffset;
+            wrapy = wrapy*2 - PerlinOffset;
+        }
+    }
 
-            double ty = y + PerlinOffset;
-            double by = floor(ty);
-            double ry0 = ty - by, ry1 = ry0 - 1.0;
-            int by0 = by, by1 = by0 + 1;
+    if (_params.fractalnoise) {
+        guint32 r = CLAMP_D_TO_U8((pixel[0]*255.0 + 255.0) / 2);
+        guint32 g = CLAMP_D_TO_U8((pixel[1]*255.0 + 255.0) / 2);
+        guint32 b = CLAMP_D_TO_U8((pixel[2]*255.0 + 255.0) / 2);
+        guint32 a = CLAMP_D_TO_U8((pixel[3]*255.0 + 255.0) / 2);
+        r = premul_alpha(r, a);
+        g = premul_alpha(g, a);
+        b = premul_alpha(b, a);
+        ASSEMBLE_ARGB32(pxout, a,r,g,b);
+        return pxout;
+    } else {
+        guint32 r = CLAMP_D_TO_U8(pixel[0]*255.0);
+        guint32 g = CLAMP_D_TO_U8(pixel[1]*255.0);
+        guint32 b = CLAMP_D_TO_U8(pixel[2]*255.0);
+        guint32 a = CLAMP_D_TO_U8(pixel[3]*255.0);
+        r = premul_alpha(r, a);
+        g = premul_alpha(g, a);
+        b = premul_alpha(b, a);
+        ASSEMBLE_ARGB32(pxout, a,r,g,b);
+        return pxout;
+    }
+}
 
-            if (_stitchTiles) {
+/**
+ * Compute the pixels at origin + i * step for begin <= i < end into out.
+ *
+ * The row is split into chunks at multiples of RowChunk counted from origin, so a pixel
+ * comes out the same no matter which run of the row it is computed as part of.
+ */
+void TurbulenceGenerator::turbulenceRow(Geom::Point const &origin, Geom::Point const &step,
+                                        int begin, int end, guint32 *out) const
+{
+    while (begin < end) {
+        int const chunk = floor_div(begin, RowChunk) * RowChunk;
+        int const last = std::min(end - chunk, RowChunk);
+        _turbulenceChunk(origin + chunk * step, step, begin - chunk, last, out);
+        out += chunk + last - begin;
+        begin = chunk + last;
+    }
+}
+
+/**
+ * Compute the pixels at base + i * step for first <= i < last <= RowChunk into out.
+ *
+ * Positions are split into the lattice cell and the offset within it in double precision
+ * once per chunk and octave, so single precision only has to hold the offsets, which stay
+ * small. The gradients of the four channels are stored next to each other, so the channels
+ * of a pixel are computed together in loops the compiler can vectorise.
+ */
+void TurbulenceGenerator::_turbulenceChunk(Geom::Point const &base, Geom::Point const &step,
+                                           int first, int last, guint32 *out) const
+{
+    float sum[RowChunk][4] = {};
+
+    int wrapx = _wrapx, wrapy = _wrapy, wrapw = _wrapw, wraph = _wraph;
+    double x = base[Geom::X] * _baseFreq[Geom::X];
+    double y = base[Geom::Y] * _baseFreq[Geom::Y];
+    double dx = step[Geom::X] * _baseFreq[Geom::X];
+    double dy = step[Geom::Y] * _baseFreq[Geom::Y];
+    float scale = 1.0f;
+
+    for (int octave = 0; octave < _params.octaves; ++octave) {
+        double const tx = std::floor(x + PerlinOffset);
+        double const ty = std::floor(y + PerlinOffset);
+        float const fx = x + PerlinOffset - tx;
+        float const fy = y + PerlinOffset - ty;
+        float const fdx = dx;
+        float const fdy = dy;
+        int const bxbase = tx;
+        int const bybase = ty;
+
+        for (int i = first; i < last; ++i) {
+            float const px = fx + i * fdx;
+            float const py = fy + i * fdy;
+            int cx = px, cy = py;
+            cx -= px < cx;
+            cy -= py < cy;
+            float const rx0 = px - cx, rx1 = rx0 - 1.0f;
+            float const ry0 = py - cy, ry1 = ry0 - 1.0f;
+
+            int bx0 = bxbase + cx, bx1 = bx0 + 1;
+            int by0 = bybase + cy, by1 = by0 + 1;
+            if (_params.stitch) {
                 if (bx0 >= wrapx) bx0 -= wrapw;
                 if (bx1 >= wrapx) bx1 -= wrapw;
                 if (by0 >= wrapy) by0 -= wraph;
@@ -152,163 +322,270 @@ public:
             by0 &= BMask;
             by1 &= BMask;
 
-            int i = _latticeSelector[bx0];
-            int j = _latticeSelector[bx1];
-            int b00 = _latticeSelector[i + by0];
-            int b01 = _latticeSelector[i + by1];
-            int b10 = _latticeSelector[j + by0];
-            int b11 = _latticeSelector[j + by1];
+            int const si = _latticeSelector[bx0];
+            int const sj = _latticeSelector[bx1];
+            auto const &g00 = _gradientf[_latticeSelector[si + by0]];
+            auto const &g01 = _gradientf[_latticeSelector[si + by1]];
+            auto const &g10 = _gradientf[_latticeSelector[sj + by0]];
+            auto const &g11 = _gradientf[_latticeSelector[sj + by1]];
 
-            double sx = _scurve(rx0);
-            double sy = _scurve(ry0);
+            float const sx = scurve(rx0);
+            float const sy = scurve(ry0);
 
-            double result[4];
             // channel numbering: R=0, G=1, B=2, A=3
+            float result[4];
             for (int k = 0; k < 4; ++k) {
-                double const *qxa = _gradient[b00][k];
-                double const *qxb = _gradient[b10][k];
-                double a = _lerp(sx, rx0 * qxa[0] + ry0 * qxa[1],
-                                     rx1 * qxb[0] + ry0 * qxb[1]);
-                double const *qya = _gradient[b01][k];
-                double const *qyb = _gradient[b11][k];
-                double b = _lerp(sx, rx0 * qya[0] + ry1 * qya[1],
-                                     rx1 * qyb[0] + ry1 * qyb[1]);
-                result[k] = _lerp(sy, a, b);
+                float const a = lerp(sx, rx0 * g00[0][k] + ry0 * g00[1][k],
+                                         rx1 * g10[0][k] + ry0 * g10[1][k]);
+                float const b = lerp(sx, rx0 * g01[0][k] + ry1 * g01[1][k],
+                                         rx1 * g11[0][k] + ry1 * g11[1][k]);
+                result[k] = lerp(sy, a, b);
             }
-
-            if (_fractalnoise) {
-                for (int k = 0; k < 4; ++k)
-                    pixel[k] += result[k] / ratio;
+            if (_params.fractalnoise) {
+                for (int k = 0; k < 4; ++k) {
+                    sum[i][k] += result[k] * scale;
+                }
             } else {
-                for (int k = 0; k < 4; ++k)
-                    pixel[k] += fabs(result[k]) / ratio;
+                for (int k = 0; k < 4; ++k) {
+                    sum[i][k] += std::abs(result[k]) * scale;
+                }
             }
+        }
 
-            x *= 2;
-            y *= 2;
-            ratio *= 2;
-
-            if(_stitchTiles)
-            {
-                // Update stitch values. Subtracting PerlinOffset before the multiplication and
-                // adding it afterward simplifies to subtracting it once.
-                wrapw *= 2;
-                wraph *= 2;
-                wrapx = wrapx*2 - PerlinOffset;
-                wrapy = wrapy*2 - PerlinOffset;
-            }
+        x *= 2;
+        y *= 2;
+        dx *= 2;
+        dy *= 2;
+        scale *= 0.5f;
+
+        if (_params.stitch) {
+            wrapw *= 2;
+            wraph *= 2;
+            wrapx = wrapx*2 - PerlinOffset;
+            wrapy = wrapy*2 - PerlinOffset;
         }
+    }
 
-        if (_fractalnoise) {
-            guint32 r = CLAMP_D_TO_U8((pixel[0]*255.0 + 255.0) / 2);
-            guint32 g = CLAMP_D_TO_U8((pixel[1]*255.0 + 255.0) / 2);
-            guint32 b = CLAMP_D_TO_U8((pixel[2]*255.0 + 255.0) / 2);
-            guint32 a = CLAMP_D_TO_U8((pixel[3]*255.0 + 255.0) / 2);
-            r = premul_alpha(r, a);
-            g = premul_alpha(g, a);
-            b = premul_alpha(b, a);
-            ASSEMBLE_ARGB32(pxout, a,r,g,b);
-            return pxout;
-        } else {
-            guint32 r = CLAMP_D_TO_U8(pixel[0]*255.0);
-            guint32 g = CLAMP_D_TO_U8(pixel[1]*255.0);
-            guint32 b = CLAMP_D_TO_U8(pixel[2]*255.0);
-            guint32 a = CLAMP_D_TO_U8(pixel[3]*255.0);
-            r = premul_alpha(r, a);
-            g = premul_alpha(g, a);
-            b = premul_alpha(b, a);
-            ASSEMBLE_ARGB32(pxout, a,r,g,b);
-            return pxout;
+    float const mul = _params.fractalnoise ? 127.5f : 255.0f;
+    float const add = _params.fractalnoise ? 127.5f : 0.0f;
+    for (int i = first; i < last; ++i) {
+        guint32 c[4];
+        for (int k = 0; k < 4; ++k) {
+            c[k] = std::clamp(sum[i][k] * mul + add, 0.0f, 255.0f) + 0.5f;
         }
+        guint32 const a = c[3];
+        guint32 const r = premul_alpha(c[0], a);
+        guint32 const g = premul_alpha(c[1], a);
+        guint32 const b = premul_alpha(c[2], a);
+        ASSEMBLE_ARGB32(pxout, a,r,g,b);
+        out[i - first] = pxout;
     }
+}
 
-    //G_GNUC_PURE
-    /*guint32 turbulencePixel(Geom::Point const &p) const {
-        if (!_fractalnoise) {
-            guint32 r = CLAMP_D_TO_U8(turbulence(0, p)*255.0);
-            guint32 g = CLAMP_D_TO_U8(turbulence(1, p)*255.0);
-            guint32 b = CLAMP_D_TO_U8(turbulence(2, p)*255.0);
-            guint32 a = CLAMP_D_TO_U8(turbulence(3, p)*255.0);
-            r = premul_alpha(r, a);
-            g = premul_alpha(g, a);
-            b = premul_alpha(b, a);
-            ASSEMBLE_ARGB32(pxout, a,r,g,b);
-            return pxout;
-        } else {
-            guint32 r = CLAMP_D_TO_U8((turbulence(0, p)*255.0 + 255.0) / 2);
-            guint32 g = CLAMP_D_TO_U8((turbulence(1, p)*255.0 + 255.0) / 2);
-            guint32 b = CLAMP_D_TO_U8((turbulence(2, p)*255.0 + 255.0) / 2);
-            guint32 a = CLAMP_D_TO_U8((turbulence(3, p)*255.0 + 255.0) / 2);
-            r = premul_alpha(r, a);
-            g = premul_alpha(g, a);
-            b = premul_alpha(b, a);
-            ASSEMBLE_ARGB32(pxout, a,r,g,b);
-            return pxout;
+void TurbulenceGenerator::_setupSeed(long seed)
+{
+    _seed = seed;
+    if (_seed <= 0) _seed = -(_seed % (RAND_m - 1)) + 1;
+    if (_seed > RAND_m - 1) _seed = RAND_m - 1;
+}
+
+long TurbulenceGenerator::_random()
+{
+    /* Produces results in the range [1, 2**31 - 2].
+     * Algorithm is: r = (a * r) mod m
+     * where a = 16807 and m = 2**31 - 1 = 2147483647
+     * See [Park & Miller], CACM vol. 31 no. 10 p. 1195, Oct. 1988
+     * To test: the algorithm should produce the result 1043618065
+     * as the 10,000th generated number if the original seed is 1. */
+    _seed = RAND_a * (_seed % RAND_q) - RAND_r * (_seed / RAND_q);
+    if (_seed <= 0) _seed += RAND_m;
+    return _seed;
+}
+
+namespace {
+
+/// The size of the noise tiles kept by TileCache, in pixels.
+int constexpr TileSize = 64;
+
+using Tile = std::array<guint32, TileSize * TileSize>;
+
+struct TileKey
+{
+    TurbulenceGenerator::Params params;
+    Geom::Affine trans;
+    Geom::IntPoint pos; ///< In units of TileSize.
+
+    bool operator==(TileKey const &) const = default;
+};
+
+struct TileKeyHash
+{
+    std::size_t operator()(TileKey const &key) const
+    {
+        std::size_t h = 0;
+        auto const mix = [&] (auto v) {
+            h ^= std::hash<decltype(v)>()(v) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        };
+        mix(key.params.seed);
+        mix(key.params.freq.x());
+        mix(key.params.freq.y());
+        mix(key.params.octaves);
+        mix(key.params.stitch);
+        mix(key.params.fractalnoise);
+        for (int i = 0; i < 6; ++i) {
+            mix(key.trans[i]);
         }
-    }*/
+        mix(key.pos.x());
+        mix(key.pos.y());
+        return h;
+    }
+};
 
-    bool ready() const { return _inited; }
-    void dirty() { _inited = false; }
+std::atomic<std::size_t> cache_budget = std::size_t{32} << 20;
 
-private:
-    void _setupSeed(long seed)
+/**
+ * @brief Noise tiles shared by all turbulence primitives
+ *
+ * Noise only depends on the generator parameters, the transform to primitive units and the
+ * position, so the tiles can be reused by every primitive with the same parameters, and when
+ * scrolling brings the same area into view again. The least recently used tiles are thrown
+ * away when they take up more than the budget.
+ */
+class TileCache
+{
+public:
+    std::shared_ptr<Tile const> find(TileKey const &key)
+    {
+        auto lock = std::lock_guard(_mutex);
+        auto it = _index.find(key);
+        if (it == _index.end()) {
+            return {};
+        }
+        _tiles.splice(_tiles.begin(), _tiles, it->second);
+        return it->second->second;
+    }
+
+    void insert(TileKey const &key, std::shared_ptr<Tile const> tile)
     {
-        _seed = seed;
-        if (_seed <= 0) _seed = -(_seed % (RAND_m - 1)) + 1;
-        if (_seed > RAND_m - 1) _seed = RAND_m - 1;
+        auto lock = std::lock_guard(_mutex);
+        if (_index.contains(key)) {
+            return;
+        }
+        _tiles.emplace_front(key, std::move(tile));
+        _index.emplace(key, _tiles.begin());
+        _trim();
     }
 
-    long _random()
+    void trim()
     {
-        /* Produces results in the range [1, 2**31 - 2].
-         * Algorithm is: r = (a * r) mod m
-         * where a = 16807 and m = 2**31 - 1 = 2147483647
-         * See [Park & Miller], CACM vol. 31 no. 10 p. 1195, Oct. 1988
-         * To test: the algorithm should produce the result 1043618065
-         * as the 10,000th generated number if the original seed is 1. */
-        _seed = RAND_a * (_seed % RAND_q) - RAND_r * (_seed / RAND_q);
-        if (_seed <= 0) _seed += RAND_m;
-        return _seed;
+        auto lock = std::lock_guard(_mutex);
+        _trim();
     }
 
-    static inline double _scurve(double t)
+    std::size_t bytes()
     {
-        return t * t * (3.0 - 2.0 * t);
+        auto lock = std::lock_guard(_mutex);
+        return _tiles.size() * sizeof(Tile);
     }
 
-    static inline double _lerp(double t, double a, double b)
+private:
+    void _trim()
     {
-        return a + t * (b - a);
+        while (!_tiles.empty() && _tiles.size() * sizeof(Tile) > cache_budget) {
+            _index.erase(_tiles.back().first);
+            _tiles.pop_back();
+        }
     }
 
-    // random number generator constants
-    static long constexpr
-        RAND_m = 2147483647, // 2**31 - 1
-        RAND_a = 16807, // 7**5; primitive root of m
-        RAND_q = 127773, // m / a
-        RAND_r = 2836; // m % a
-
-    // other constants
-    static int constexpr BSize = 0x100;
-    static int constexpr BMask = 0xff;
-
-    static double constexpr PerlinOffset = 4096.0;
-
-    Geom::Rect _tile;
-    Geom::Point _baseFreq;
-    int _latticeSelector[2 * BSize + 2];
-    double _gradient[2 * BSize + 2][4][2];
-    long _seed;
-    int _octaves;
-    bool _stitchTiles;
-    int _wrapx;
-    int _wrapy;
-    int _wrapw;
-    int _wraph;
-    bool _inited;
-    bool _fractalnoise;
+    std::mutex _mutex;
+    std::list<std::pair<TileKey, std::shared_ptr<Tile const>>> _tiles; ///< Most recently used first.
+    std::unordered_map<TileKey, decltype(_tiles)::iterator, TileKeyHash> _index;
 };
 
+TileCache &get_tile_cache()
+{
+    static TileCache cache;
+    return cache;
+}
+
+/**
+ * Fill an image with the noise for the pixels starting at origin, where pixel (x, y) is at
+ * (x, y) * trans in primitive units.
+ *
+ * The tiles which lie wholly within the image are taken from the cache, or computed and
+ * added to it. The rest is computed directly, so small images never cost more than they
+ * would without the cache.
+ */
+void render_noise(TurbulenceGenerator const &gen, Geom::Affine const &trans, Geom::IntPoint const &origin,
+                  cairo_surface_t *surface)
+{
+    cairo_surface_flush(surface);
+    int const width = cairo_image_surface_get_width(surface);
+    int const height = cairo_image_surface_get_height(surface);
+    int const stride = cairo_image_surface_get_stride(surface);
+    auto const data = cairo_image_surface_get_data(surface);
+    auto const area = Geom::IntRect::from_xywh(origin, {width, height});
+    auto const step = Geom::Point(trans[0], trans[1]);
+    auto const row_origin = [&] (int y) { return Geom::Point(0, y) * trans; };
+
+    auto const tx0 = -floor_div(-area.left(), TileSize);
+    auto const ty0 = -floor_div(-area.top(), TileSize);
+    auto const tx1 = floor_div(area.right(), TileSize);
+    auto const ty1 = floor_div(area.bottom(), TileSize);
+    auto const columns = std::max(tx1 - tx0, 0);
+    auto const rows = std::max(ty1 - ty0, 0);
+
+    auto &cache = get_tile_cache();
+    std::vector<std::shared_ptr<Tile const>> tiles(columns * rows);
+    std::vector<std::pair<TileKey, std::shared_ptr<Tile>>> missing;
+    for (int ty = ty0; ty < ty1; ++ty) {
+        for (int tx = tx0; tx < tx1; ++tx) {
+            auto key = TileKey{.params = gen.params(), .trans = trans, .pos = {tx, ty}};
+            auto &tile = tiles[(ty - ty0) * columns + tx - tx0];
+            tile = cache.find(key);
+            if (!tile) {
+                tile = missing.emplace_back(std::move(key), std::make_shared<Tile>()).second;
+            }
+        }
+    }
+
+    auto const pool = get_global_dispatch_pool();
+    int const count = missing.size() * TileSize;
+    pool->dispatch_threshold(count, count * TileSize > POOL_THRESHOLD, [&] (int i, int) {
+        auto const &[key, tile] = missing[i / TileSize];
+        int const y = key.pos.y() * TileSize + i % TileSize;
+        int const x = key.pos.x() * TileSize;
+        gen.turbulenceRow(row_origin(y), step, x, x + TileSize, tile->data() + i % TileSize * TileSize);
+    });
+    for (auto &[key, tile] : missing) {
+        cache.insert(key, std::move(tile));
+    }
+
+    pool->dispatch_threshold(height, width * height > POOL_THRESHOLD, [&] (int i, int) {
+        int const y = area.top() + i;
+        auto const out = reinterpret_cast<guint32 *>(data + i * stride);
+        int const ty = floor_div(y, TileSize);
+        if (ty < ty0 || ty >= ty1 || !columns) {
+            gen.turbulenceRow(row_origin(y), step, area.left(), area.right(), out);
+            return;
+        }
+
+        int const left = tx0 * TileSize;
+        int const right = tx1 * TileSize;
+        gen.turbulenceRow(row_origin(y), step, area.left(), left, out);
+        for (int tx = tx0; tx < tx1; ++tx) {
+            auto const &tile = tiles[(ty - ty0) * columns + tx - tx0];
+            std::memcpy(out + tx * TileSize - area.left(), tile->data() + (y - ty * TileSize) * TileSize,
+                        TileSize * sizeof(guint32));
+        }
+        gen.turbulenceRow(row_origin(y), step, right, area.right(), out + right - area.left());
+    });
+
+    cairo_surface_mark_dirty(surface);
+}
+
+} // namespace
+
 FilterTurbulence::FilterTurbulence()
     : gen(std::make_unique<TurbulenceGenerator>())
     , XbaseFrequency(0)
@@ -360,26 +637,6 @@ void FilterTurbulence::set_updated(bool /*u*/)
 {
 }
 
-struct Turbulence
-{
-    Turbulence(TurbulenceGenerator const &gen, Geom::Affine const &trans, int x0, int y0)
-        : _gen(gen)
-        , _trans(trans)
-        , _x0(x0), _y0(y0) {}
-
-    guint32 operator()(int x, int y)
-    {
-        Geom::Point point(x + _x0, y + _y0);
-        point *= _trans;
-        return _gen.turbulencePixel(point);
-    }
-
-private:
-    TurbulenceGenerator const &_gen;
-    Geom::Affine _trans;
-    int _x0, _y0;
-};
-
 void FilterTurbulence::render_cairo(FilterSlot &slot) const
 {
     cairo_surface_t *input = slot.getcairo(_input);
@@ -401,19 +658,23 @@ void FilterTurbulence::render_cairo(FilterSlot &slot) const
     // color_interpolation_filter is determined by CSS value (see spec. Turbulence).
     set_cairo_surface_ci(out, color_interpolation);
 
-    if (!gen->ready()) {
-        Geom::Point ta(fTileX, fTileY);
-        Geom::Point tb(fTileX + fTileWidth, fTileY + fTileHeight);
-        gen->init(seed, Geom::Rect(ta, tb),
-                  Geom::Point(XbaseFrequency, YbaseFrequency), stitchTiles,
-                  type == TURBULENCE_FRACTALNOISE, numOctaves);
+    {
+        // Filters may be rendered by several threads at once.
+        auto lock = std::lock_guard(gen_mutex);
+        if (!gen->ready()) {
+            Geom::Point ta(fTileX, fTileY);
+            Geom::Point tb(fTileX + fTileWidth, fTileY + fTileHeight);
+            gen->init({.seed = static_cast<long>(seed), .tile = Geom::Rect(ta, tb),
+                       .freq = Geom::Point(XbaseFrequency, YbaseFrequency), .stitch = stitchTiles,
+                       .fractalnoise = type == TURBULENCE_FRACTALNOISE, .octaves = numOctaves});
+        }
     }
 
     Geom::Affine unit_trans = slot.get_units().get_matrix_primitiveunits2pb().inverse();
     Geom::Rect slot_area = slot.get_slot_area();
-    double x0 = slot_area.min()[Geom::X];
-    double y0 = slot_area.min()[Geom::Y];
-    ink_cairo_surface_synthesize(temp, Turbulence(*gen, unit_trans, x0, y0));
+    int x0 = slot_area.min()[Geom::X];
+    int y0 = slot_area.min()[Geom::Y];
+    render_noise(*gen, unit_trans, Geom::IntPoint(x0, y0), temp);
 
     // cairo_surface_write_to_png( temp, "turbulence0.png" );
 
@@ -430,6 +691,20 @@ void FilterTurbulence::render_cairo(FilterSlot &slot) const
     cairo_surface_destroy(out);
 }
 
+/**
+ * Set how much memory the noise tiles kept for reuse by all turbulence primitives may take up.
+ */
+void FilterTurbulence::setCacheBudget(std::size_t bytes)
+{
+    cache_budget = bytes;
+    get_tile_cache().trim();
+}
+
+std::size_t FilterTurbulence::cacheBytes()
+{
+    return get_tile_cache().bytes();
+}
+
 double FilterTurbulence::complexity(Geom::Affine const &) const
 {
     return 5.0;
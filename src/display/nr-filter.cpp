@@ -11,8 +11,12 @@
  */
 
 #include <glib.h>
+#include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <exception>
+#include <map>
+#include <mutex>
 #include <string>
 #include <cairo.h>
 
@@ -39,11 +43,14 @@
 #include "display/nr-filter-tile.h"
 #include "display/nr-filter-turbulence.h"
 
+#include "display/cairo-templates.h"
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/drawing.h"
 #include "display/drawing-item.h"
 #include "display/drawing-context.h"
 #include "display/drawing-surface.h"
+#include "display/threading.h"
 #include <2geom/affine.h>
 #include <2geom/rect.h>
 #include "svg/svg-length.h"
@@ -55,6 +62,41 @@ namespace Filters {
 using Geom::X;
 using Geom::Y;
 
+namespace {
+
+/// Whether the thread is rendering a step of a filter for Filter::_render_stage().
+thread_local bool in_branch = false;
+
+/**
+ * Render a chain of per-pixel primitives, each reading the result of the one before,
+ * in one pass over the image. They all use the same color interpolation.
+ */
+void render_pixel_chain(std::vector<FilterPrimitive const *> const &chain, FilterSlot &slot)
+{
+    std::vector<std::function<guint32(guint32)>> functions;
+    for (auto p : chain) {
+        functions.push_back(p->get_pixel_function());
+    }
+    auto const ci = chain.front()->get_color_interpolation();
+
+    cairo_surface_t *input = slot.getcairo(chain.front()->get_inputs().front());
+    cairo_surface_t *out = slot.create_surface(input, CAIRO_CONTENT_COLOR_ALPHA);
+    set_cairo_surface_ci(input, ci);
+    set_cairo_surface_ci(out, ci);
+
+    ink_cairo_surface_filter(input, out, [&] (guint32 px) {
+        for (auto const &f : functions) {
+            px = f(px);
+        }
+        return px;
+    });
+
+    slot.set(chain.back()->get_output(), out);
+    cairo_surface_destroy(out);
+}
+
+} // namespace
+
 Filter::Filter()
 {
     _common_init();
@@ -151,8 +193,20 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
 
     auto slot = FilterSlot(bgdc, graphic, units, rc, blurquality);
 
-    for (auto &i : primitives) {
-        i->render_cairo(slot);
+    // The primitives are planned, see _compile(), unless the drawing asks for them to be run in
+    // document order, to compare against.
+    if (item->drawing().filterPlanning()) {
+        for (auto const &stage : _compile()) {
+            _render_stage(stage, slot);
+            for (int s : stage.release) {
+                slot.release(s);
+            }
+            slot.set_last_out(stage.last_out);
+        }
+    } else {
+        for (auto const &primitive : primitives) {
+            primitive->render_cairo(slot);
+        }
     }
 
     Geom::Point origin = graphic.targetLogicalBounds().min();
@@ -170,6 +224,248 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
     return 0;
 }
 
+/**
+ * Plan the rendering of the primitives. Primitives whose results are never used are left out,
+ * chains of per-pixel primitives are merged into single steps, and slots are released after
+ * their last use so that their images can be reused for later results. The steps are grouped
+ * into stages of steps independent of each other, such as the branches of a drop shadow which
+ * all start from SourceAlpha.
+ */
+std::vector<Filter::Stage> Filter::_compile() const
+{
+    int const n = primitives.size();
+
+    // Find the slot each primitive reads from and writes to, and which primitive wrote
+    // each of its inputs; -1 stands for the predefined images.
+    std::vector<int> out_slot(n);
+    std::vector<std::vector<int>> in_slots(n);
+    std::vector<std::vector<int>> sources(n);
+    std::map<int, int> writer;
+    for (int i = 0; i < n; i++) {
+        for (int in : primitives[i]->get_inputs()) {
+            if (in == NR_FILTER_SLOT_NOT_SET) {
+                in = i > 0 ? out_slot[i - 1] : NR_FILTER_SOURCEGRAPHIC;
+            }
+            auto w = writer.find(in);
+            in_slots[i].push_back(in);
+            sources[i].push_back(w != writer.end() ? w->second : -1);
+        }
+        int const out = primitives[i]->get_output();
+        out_slot[i] = out == NR_FILTER_SLOT_NOT_SET ? NR_FILTER_UNNAMED_SLOT : out;
+        writer[out_slot[i]] = i;
+    }
+
+    int const result_slot = _output_slot == NR_FILTER_SLOT_NOT_SET ? out_slot[n - 1] : _output_slot;
+    auto const w = writer.find(result_slot);
+    int const result = w != writer.end() ? w->second : -1;
+
+    // Walk backwards from the result to find the primitives contributing to it.
+    std::vector<bool> live(n, false);
+    std::vector<int> readers(n, 0);
+    if (result >= 0) {
+        live[result] = true;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        if (!live[i]) {
+            // Some primitives also record their subregion in their slot, for feTile, so
+            // only leave out a primitive if its slot is not read again at all.
+            bool read_later = false;
+            for (int j = i + 1; j < n && !read_later; j++) {
+                read_later = std::find(in_slots[j].begin(), in_slots[j].end(), out_slot[i]) != in_slots[j].end();
+            }
+            if (!read_later) {
+                continue;
+            }
+            live[i] = true;
+        }
+        for (int s : sources[i]) {
+            if (s >= 0) {
+                live[s] = true;
+                readers[s]++;
+            }
+        }
+    }
+
+    struct Node
+    {
+        Step step;
+        int first;
+        int out;
+        bool uses_last_out;
+        int stage = 0;
+    };
+    std::vector<Node> nodes;
+
+    for (int i = 0; i < n; i++) {
+        if (!live[i]) {
+            continue;
+        }
+        auto &node = nodes.emplace_back();
+        node.first = i;
+        node.step.chain.push_back(primitives[i].get());
+        node.step.inputs = in_slots[i];
+        auto const inputs = primitives[i]->get_inputs();
+        node.uses_last_out = std::find(inputs.begin(), inputs.end(), NR_FILTER_SLOT_NOT_SET) != inputs.end();
+
+        // Extend the step while the next primitive only reads this one, and nothing else does.
+        if (primitives[i]->get_pixel_function()) {
+            while (i + 1 < n && i != result && readers[i] == 1 && sources[i + 1] == std::vector<int>{i}) {
+                auto const next = primitives[i + 1].get();
+                if (!next->get_pixel_function() ||
+                    next->get_color_interpolation() != primitives[i]->get_color_interpolation())
+                {
+                    break;
+                }
+                node.step.chain.push_back(next);
+                i++;
+            }
+        }
+        node.out = out_slot[i];
+    }
+
+    // A step has to come after the earlier steps whose results it reads, and after those reading
+    // or writing the slot it writes. It also has to come after those reading the same image,
+    // since primitives convert their inputs to their color interpolation in place; the alpha
+    // images don't have colors to convert though. Steps reading the previous result through
+    // an unset input run on their own, after everything before them.
+    auto const conflict = [] (Node const &a, Node const &b) {
+        auto const reads = [] (Node const &node, int slot) {
+            return std::find(node.step.inputs.begin(), node.step.inputs.end(), slot) != node.step.inputs.end();
+        };
+        if (a.out == b.out || reads(b, a.out) || reads(a, b.out)) {
+            return true;
+        }
+        for (int in : b.step.inputs) {
+            if (in != NR_FILTER_SOURCEALPHA && in != NR_FILTER_BACKGROUNDALPHA && reads(a, in)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    int barrier = 0;
+    int stage_count = 0;
+    for (std::size_t k = 0; k < nodes.size(); k++) {
+        auto &node = nodes[k];
+        if (node.uses_last_out) {
+            node.stage = stage_count;
+            barrier = stage_count + 1;
+        } else {
+            node.stage = barrier;
+            for (std::size_t j = 0; j < k; j++) {
+                if (conflict(nodes[j], node)) {
+                    node.stage = std::max(node.stage, nodes[j].stage + 1);
+                }
+            }
+        }
+        stage_count = std::max(stage_count, node.stage + 1);
+    }
+
+    std::vector<Stage> stages(stage_count);
+    for (auto &node : nodes) {
+        stages[node.stage].steps.push_back(node.step);
+    }
+
+    // Before a step reading the previous result, all earlier steps and no later ones have run.
+    int last = -1;
+    for (int s = 0; s < stage_count; s++) {
+        for (std::size_t k = 0; k < nodes.size(); k++) {
+            if (nodes[k].stage <= s) {
+                last = std::max(last, (int)k);
+            }
+        }
+        stages[s].last_out = nodes[last].out;
+    }
+
+    // Release the slot of each result after the stage of its last reader, unless one of the
+    // readers writes its own result there.
+    for (std::size_t k = 0; k < nodes.size(); k++) {
+        int const d = nodes[k].first + nodes[k].step.chain.size() - 1;
+        if (d == result) {
+            continue;
+        }
+        int release_stage = -1;
+        bool overwritten = false;
+        for (auto const &reader : nodes) {
+            if (std::find(sources[reader.first].begin(), sources[reader.first].end(), d) != sources[reader.first].end()) {
+                release_stage = std::max(release_stage, reader.stage);
+                overwritten = overwritten || reader.out == nodes[k].out;
+            }
+        }
+        auto &release = stages[std::max(release_stage, 0)].release;
+        if (release_stage >= 0 && !overwritten && std::find(release.begin(), release.end(), nodes[k].out) == release.end()) {
+            release.push_back(nodes[k].out);
+        }
+    }
+
+    return stages;
+}
+
+/**
+ * Render the steps of a stage, on several threads if they are independent branches.
+ */
+void Filter::_render_stage(Stage const &stage, FilterSlot &slot)
+{
+    auto const render_step = [&] (Step const &step) {
+        if (step.chain.size() == 1) {
+            step.chain.front()->render_cairo(slot);
+        } else {
+            render_pixel_chain(step.chain, slot);
+        }
+    };
+
+    // Filters may be rendered from inside a branch, e.g. by feImage, which can't dispatch again.
+    bool parallel = stage.steps.size() > 1 && !in_branch;
+
+    // Primitives convert their inputs to their color interpolation in place, so steps can only
+    // run concurrently if they don't share any images with colors, which slots may also alias.
+    std::vector<cairo_surface_t *> shared;
+    for (auto const &step : stage.steps) {
+        if (!parallel) {
+            break;
+        }
+        std::vector<cairo_surface_t *> own;
+        for (int in : step.inputs) {
+            auto const s = slot.getcairo(in);
+            if (cairo_surface_get_content(s) != CAIRO_CONTENT_ALPHA && std::find(own.begin(), own.end(), s) == own.end()) {
+                own.push_back(s);
+            }
+        }
+        for (auto s : own) {
+            if (std::find(shared.begin(), shared.end(), s) != shared.end()) {
+                parallel = false;
+            }
+            shared.push_back(s);
+        }
+    }
+
+    if (parallel) {
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto const pool = get_global_branch_pool();
+        bool const dispatched = pool->size() > 1 && pool->try_dispatch(stage.steps.size(), [&] (int i, int) {
+            in_branch = true;
+            try {
+                render_step(stage.steps[i]);
+            } catch (...) {
+                std::scoped_lock lock(error_mutex);
+                error = std::current_exception();
+            }
+            in_branch = false;
+        });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (dispatched) {
+            return;
+        }
+    }
+
+    for (auto const &step : stage.steps) {
+        render_step(step);
+    }
+}
+
 void Filter::add_primitive(std::unique_ptr<FilterPrimitive> primitive)
 {
     primitives.emplace_back(std::move(primitive));
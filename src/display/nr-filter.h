@@ -14,6 +14,7 @@
  */
 
 #include <memory>
+#include <vector>
 #include <cairo.h>
 #include "display/nr-filter-primitive.h"
 #include "display/nr-filter-types.h"
@@ -27,6 +28,8 @@ class RenderContext;
 
 namespace Filters {
 
+class FilterSlot;
+
 class Filter final
 {
 public:
@@ -185,6 +188,22 @@ private:
     SPFilterUnits _filter_units;
     SPFilterUnits _primitive_units;
 
+    /** A single primitive, or a chain of per-pixel primitives to be run in one pass. */
+    struct Step
+    {
+        std::vector<FilterPrimitive const *> chain;
+        std::vector<int> inputs; ///< The slots read, with NR_FILTER_SLOT_NOT_SET resolved.
+    };
+    /** Steps which don't depend on each other, so they can run in any order or concurrently. */
+    struct Stage
+    {
+        std::vector<Step> steps;
+        std::vector<int> release; ///< Slots which are not read again afterwards.
+        int last_out;             ///< The slot NR_FILTER_SLOT_NOT_SET refers to afterwards.
+    };
+    std::vector<Stage> _compile() const;
+    static void _render_stage(Stage const &stage, FilterSlot &slot);
+
     void _common_init();
     static int _resolution_limit(FilterQuality quality);
     std::pair<double, double> _filter_resolution(Geom::Rect const &area,
@@ -10,6 +10,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <cmath>
 
 #include "display/nr-light.h"
@@ -21,7 +22,29 @@
 
 namespace Inkscape {
 namespace Filters {
-   
+
+LightingRow::LightingRow(int width)
+    : width(width)
+    , alpha(width)
+    , nx(width), ny(width), nz(width)
+    , lx(width), ly(width), lz(width)
+    , factor(width, 1.0f)
+{}
+
+namespace {
+
+void normalize_light_vectors(LightingRow &row)
+{
+    for (int i = 0; i < row.width; ++i) {
+        float const inv = 1.0f / std::sqrt(row.lx[i] * row.lx[i] + row.ly[i] * row.ly[i] + row.lz[i] * row.lz[i]);
+        row.lx[i] *= inv;
+        row.ly[i] *= inv;
+        row.lz[i] *= inv;
+    }
+}
+
+} // namespace
+
 DistantLight::DistantLight(DistantLightData const &light, guint32 lighting_color)
 {
     color = lighting_color;
@@ -43,6 +66,14 @@ void DistantLight::light_components(NR::Fvector &lc) {
     lc[LIGHT_BLUE] = SP_RGBA32_B_U(color);
 }
 
+void DistantLight::light_vectors(LightingRow &row) {
+    NR::Fvector v;
+    light_vector(v);
+    std::fill(row.lx.begin(), row.lx.end(), v[X_3D]);
+    std::fill(row.ly.begin(), row.ly.end(), v[Y_3D]);
+    std::fill(row.lz.begin(), row.lz.end(), v[Z_3D]);
+}
+
 PointLight::PointLight(PointLightData const &light, guint32 lighting_color, const Geom::Affine &trans, int device_scale) {
     color = lighting_color;
     l_x = light.x * device_scale;
@@ -66,6 +97,19 @@ void PointLight::light_components(NR::Fvector &lc) {
     lc[LIGHT_BLUE] = SP_RGBA32_B_U(color);
 }
 
+void PointLight::light_vectors(LightingRow &row, double x, double y, double scale) {
+    float const dx = l_x - x;
+    float const dy = l_y - y;
+    float const lz = l_z;
+    float const s = scale / 255.0;
+    for (int i = 0; i < row.width; ++i) {
+        row.lx[i] = dx - i;
+        row.ly[i] = dy;
+        row.lz[i] = lz - s * row.alpha[i];
+    }
+    normalize_light_vectors(row);
+}
+
 SpotLight::SpotLight(SpotLightData const &light, guint32 lighting_color, const Geom::Affine &trans, int device_scale)
 {
     double p_x, p_y, p_z;
@@ -106,6 +150,29 @@ void SpotLight::light_components(NR::Fvector &lc, const NR::Fvector &L) {
     lc[LIGHT_BLUE] = spmod * SP_RGBA32_B_U(color);
 }
 
+void SpotLight::light_vectors(LightingRow &row, double x, double y, double scale) {
+    float const dx = l_x - x;
+    float const dy = l_y - y;
+    float const lz = l_z;
+    float const s = scale / 255.0;
+    for (int i = 0; i < row.width; ++i) {
+        row.lx[i] = dx - i;
+        row.ly[i] = dy;
+        row.lz[i] = lz - s * row.alpha[i];
+    }
+    normalize_light_vectors(row);
+}
+
+void SpotLight::light_factors(LightingRow &row) {
+    float const sx = S[X_3D], sy = S[Y_3D], sz = S[Z_3D];
+    float const exponent = speExp;
+    float const limit = cos_lca;
+    for (int i = 0; i < row.width; ++i) {
+        float const spmod = -(row.lx[i] * sx + row.ly[i] * sy + row.lz[i] * sz);
+        row.factor[i] = spmod <= limit ? 0.0f : std::pow(spmod, exponent);
+    }
+}
+
 } /* namespace Filters */
 } /* namespace Inkscape */
 
@@ -18,6 +18,7 @@
  * light color components (at a given point).
  */
 
+#include <vector>
 #include <2geom/forward.h>
 
 #include "display/nr-3dutils.h"
@@ -37,6 +38,21 @@ enum LightComponent {
     LIGHT_BLUE
 };
 
+/**
+ * The vectors needed to light a row of pixels, one array per component, so that they can
+ * be combined in loops the compiler vectorises.
+ */
+struct LightingRow
+{
+    explicit LightingRow(int width);
+
+    int width;
+    std::vector<float> alpha;      ///< Alpha of the bump map.
+    std::vector<float> nx, ny, nz; ///< Unit surface normals.
+    std::vector<float> lx, ly, lz; ///< Unit vectors towards the light.
+    std::vector<float> factor;     ///< Intensity of a spot light, 1 for other lights.
+};
+
 class DistantLight {
     public:
         /**
@@ -62,6 +78,11 @@ class DistantLight {
          */
         void light_components(NR::Fvector &lc);
 
+        /**
+         * Fills in the light vectors of a row
+         */
+        void light_vectors(LightingRow &row);
+
     private:
         guint32 color;
         double azimuth; //azimuth in rad
@@ -101,6 +122,12 @@ class PointLight {
          */
         void light_components(NR::Fvector &lc);
 
+        /**
+         * Fills in the light vectors of a row of pixels at (x + i, y, scale * alpha / 255),
+         * in the same coordinates as light_vector()
+         */
+        void light_vectors(LightingRow &row, double x, double y, double scale);
+
     private:
         guint32 color;
         //light position coordinates in render setting
@@ -145,6 +172,18 @@ class SpotLight {
          */
         void light_components(NR::Fvector &lc, const NR::Fvector &L);
 
+        /**
+         * Fills in the light vectors of a row of pixels at (x + i, y, scale * alpha / 255),
+         * in the same coordinates as light_vector()
+         */
+        void light_vectors(LightingRow &row, double x, double y, double scale);
+
+        /**
+         * Fills in the intensity factors of a row from its light vectors. The light
+         * components of a pixel are its factor times those of the lighting color.
+         */
+        void light_factors(LightingRow &row);
+
     private:
         guint32 color;
         //light position coordinates in render setting
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Rendered pattern tiles shared between the views of a pattern.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "pattern-cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
+#include <cairo.h>
+
+namespace Inkscape {
+namespace {
+
+std::atomic<std::size_t> budget = std::size_t{64} << 20;
+std::atomic<std::size_t> total_bytes = 0;
+
+// All the caches, so that the tiles of an old generation can be freed as soon as it ends.
+// Only ever taken before the lock of a cache, never while holding one.
+std::mutex registry_mutex;
+std::unordered_set<PatternCache *> registry;
+
+} // namespace
+
+PatternCache::Surface::Surface(Geom::IntRect const &rect, int device_scale)
+    : rect(rect)
+    , surface(Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, rect.width() * device_scale, rect.height() * device_scale))
+{
+    cairo_surface_set_device_scale(surface->cobj(), device_scale, device_scale);
+}
+
+PatternCache::PatternCache()
+{
+    auto guard = std::lock_guard(registry_mutex);
+    registry.insert(this);
+}
+
+PatternCache::~PatternCache()
+{
+    {
+        auto guard = std::lock_guard(registry_mutex);
+        registry.erase(this);
+    }
+    total_bytes -= _bytes;
+}
+
+/**
+ * Return the entry for the given key, creating an empty one if there is none.
+ * The lock must be held.
+ */
+PatternCache::Entry &PatternCache::get(Key const &key)
+{
+    auto it = std::find_if(_entries.begin(), _entries.end(), [&] (auto const &e) { return e.key == key; });
+    if (it == _entries.end()) {
+        _entries.emplace_front().key = key;
+    } else if (it != _entries.begin()) {
+        _entries.splice(_entries.begin(), _entries, it);
+    }
+    return _entries.front();
+}
+
+/**
+ * Record the size of an entry after drawing into it, then evict other entries
+ * if the budget is exceeded. The lock must be held.
+ */
+void PatternCache::commit(Entry &entry)
+{
+    std::size_t bytes = 0;
+    for (auto const &s : entry.surfaces) {
+        bytes += s.surface->get_stride() * s.surface->get_height();
+    }
+
+    _bytes = _bytes - entry.bytes + bytes;
+    total_bytes += bytes;
+    total_bytes -= entry.bytes;
+    entry.bytes = bytes;
+
+    _trim(&entry);
+}
+
+/**
+ * Throw away the tiles drawn for a drawing, because the pattern content has changed.
+ */
+void PatternCache::drop(Drawing const *drawing)
+{
+    auto guard = lock();
+    for (auto it = _entries.begin(); it != _entries.end(); ) {
+        auto next = std::next(it);
+        if (it->key.drawing == drawing) {
+            _erase(it);
+        }
+        it = next;
+    }
+}
+
+/**
+ * Throw away the tiles drawn for a drawing before its pattern generation changed, in all
+ * the caches. Called by the drawing when it bumps the generation, as nothing will ever ask
+ * for those tiles again.
+ */
+void PatternCache::dropStale(Drawing const *drawing, unsigned generation)
+{
+    auto guard = std::lock_guard(registry_mutex);
+    for (auto cache : registry) {
+        auto lock = cache->lock();
+        for (auto it = cache->_entries.begin(); it != cache->_entries.end(); ) {
+            auto next = std::next(it);
+            if (it->key.drawing == drawing && it->key.generation != generation) {
+                cache->_erase(it);
+            }
+            it = next;
+        }
+    }
+}
+
+void PatternCache::setBudget(std::size_t bytes)
+{
+    budget = bytes;
+}
+
+std::size_t PatternCache::totalBytes()
+{
+    return total_bytes;
+}
+
+void PatternCache::_erase(std::list<Entry>::iterator it)
+{
+    _bytes -= it->bytes;
+    total_bytes -= it->bytes;
+    _entries.erase(it);
+}
+
+/**
+ * Evict the least recently used entries, apart from keep, until all the pattern caches
+ * together fit in the budget. Only this cache is touched, since the others may be in use
+ * by other threads; they trim themselves the next time they are drawn into.
+ */
+void PatternCache::_trim(Entry const *keep)
+{
+    auto it = _entries.end();
+    while (total_bytes > budget && it != _entries.begin()) {
+        --it;
+        if (&*it == keep) {
+            continue;
+        }
+        auto const victim = it;
+        ++it;
+        _erase(victim);
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
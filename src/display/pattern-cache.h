@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Rendered pattern tiles shared between the views of a pattern.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_PATTERN_CACHE_H
+#define INKSCAPE_DISPLAY_PATTERN_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <vector>
+#include <cairomm/surface.h>
+#include <2geom/affine.h>
+#include <2geom/int-rect.h>
+#include <2geom/rect.h>
+
+namespace Inkscape {
+
+class Drawing;
+
+/**
+ * @brief Cache of rendered pattern tiles.
+ *
+ * One cache is shared by all the DrawingPatterns showing the same pattern. Tiles are kept
+ * for every resolution they were drawn at, so zooming back to an earlier level or filling
+ * another object with the same pattern reuses them instead of drawing the content again.
+ *
+ * Tiles are thrown away when the content of the pattern changes, when the drawing they were
+ * drawn for invalidates its pattern tiles, or when the memory used by all pattern caches
+ * together exceeds the budget, in which case the least recently used resolutions go first.
+ */
+class PatternCache
+{
+public:
+    /**
+     * Everything apart from the pattern content that affects the rendered tiles.
+     */
+    struct Key
+    {
+        Drawing const *drawing = nullptr;
+        unsigned generation = 0;
+        Geom::IntPoint resolution;
+        Geom::Rect tile_rect;
+        Geom::Affine child_transform;
+        Geom::Affine overflow_initial_transform;
+        Geom::Affine overflow_step_transform;
+        int overflow_steps = 1;
+        float opacity = 1.0;
+        int device_scale = 1;
+        int antialiasing = -1; ///< The antialiasing override, or -1 if there is none.
+        bool dithering = false;
+
+        bool operator==(Key const &) const = default;
+    };
+
+    /**
+     * A rendered part of the pattern tile, in tile rasterisation space.
+     */
+    struct Surface
+    {
+        Surface(Geom::IntRect const &rect, int device_scale);
+        Geom::IntRect rect;
+        Cairo::RefPtr<Cairo::ImageSurface> surface;
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::vector<Surface> surfaces;
+        std::size_t bytes = 0;
+    };
+
+    PatternCache();
+    PatternCache(PatternCache const &) = delete;
+    PatternCache &operator=(PatternCache const &) = delete;
+    ~PatternCache();
+
+    /// Must be held while using an entry, as the cache may be shared between threads and drawings.
+    std::unique_lock<std::mutex> lock() { return std::unique_lock(_mutex); }
+
+    Entry &get(Key const &key);
+    void commit(Entry &entry);
+    void drop(Drawing const *drawing);
+    static void dropStale(Drawing const *drawing, unsigned generation);
+
+    std::size_t bytes() const { return _bytes; }
+
+    static void setBudget(std::size_t bytes);
+    static std::size_t totalBytes();
+
+private:
+    void _erase(std::list<Entry>::iterator it);
+    void _trim(Entry const *keep);
+
+    std::mutex _mutex;
+    std::list<Entry> _entries; ///< Most recently used first.
+    std::size_t _bytes = 0;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_PATTERN_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
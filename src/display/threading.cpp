@@ -7,6 +7,7 @@
 
 #include "threading.h"
 
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 
@@ -19,6 +20,7 @@ namespace {
 std::mutex g_dispatch_lock;
 
 std::shared_ptr<dispatch_pool> g_dispatch_pool;
+std::shared_ptr<dispatch_pool> g_branch_pool;
 std::atomic<int> g_num_dispatch_threads = 4;
 
 } // namespace
@@ -42,6 +44,20 @@ std::shared_ptr<dispatch_pool> get_global_dispatch_pool()
     return g_dispatch_pool;
 }
 
+std::shared_ptr<dispatch_pool> get_global_branch_pool()
+{
+    int const num_threads = std::max(1, g_num_dispatch_threads.load(std::memory_order_relaxed) / 2);
+
+    std::scoped_lock lk(g_dispatch_lock);
+
+    if (g_branch_pool && num_threads == g_branch_pool->size()) {
+        return g_branch_pool;
+    }
+
+    g_branch_pool = std::make_shared<dispatch_pool>(num_threads);
+    return g_branch_pool;
+}
+
 } // namespace Inkscape
 
 /*
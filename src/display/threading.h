@@ -19,6 +19,10 @@ void set_num_dispatch_threads(int num_dispatch_threads);
 
 std::shared_ptr<dispatch_pool> get_global_dispatch_pool();
 
+// A second pool, for coarse jobs which themselves dispatch work to the global pool. It has half as
+// many threads, so that both together keep about as many threads busy as there are cores.
+std::shared_ptr<dispatch_pool> get_global_branch_pool();
+
 } // namespace Inkscape
 
 #endif // INKSCAPE_DISPLAY_THREADING_H
@@ -38,6 +38,7 @@
 #include <vector>
 #include <string>
 #include <cstring>
+#include <utility>
 
 #include <boost/range/adaptor/reversed.hpp>
 #include <glibmm/main.h>
@@ -45,6 +46,7 @@
 
 #include <2geom/transforms.h>
 
+#include "conn-router.h"
 #include "desktop.h"
 #include "document-undo.h"
 #include "event-log.h"
@@ -58,7 +60,6 @@
 #include "rdf.h"
 #include "selection.h"
 
-#include "3rdparty/adaptagrams/libavoid/router.h"
 #include "3rdparty/libcroco/src/cr-sel-eng.h"
 #include "3rdparty/libcroco/src/cr-selector.h"
 #include "actions/actions-effect.h"
@@ -67,6 +68,7 @@
 #include "actions/actions-svg-processing.h"
 #include "actions/actions-undo-document.h"
 #include "display/control/canvas-item-drawing.h"
+#include "debug/trace.h"
 #include "display/drawing.h"
 #include "io/dir-util.h"
 #include "live_effects/lpeobject.h"
@@ -83,6 +85,7 @@
 #include "ui/widget/desktop-widget.h"
 #include "util/units.h"
 #include "xml/croco-node-iface.h"
+#include "xml/mutation-batch.h"
 #include "xml/rebase-hrefs.h"
 #include "xml/simple-document.h"
 
@@ -115,7 +118,7 @@ SPDocument::SPDocument() :
     document_name(nullptr),
     actionkey(),
     object_id_counter(1),
-    _router(std::make_unique<Avoid::Router>(Avoid::PolyLineRouting|Avoid::OrthogonalRouting)),
+    _router(std::make_unique<Inkscape::ConnectorRouter>()),
     current_persp3d(nullptr),
     current_persp3d_impl(nullptr),
     _activexmltree(nullptr)
@@ -129,10 +132,6 @@ SPDocument::SPDocument() :
                 sigc::hide(sigc::bind(
                 sigc::ptr_fun(&DocumentUndo::resetKey), this)));
 
-    // Penalise libavoid for choosing paths with needless extra segments.
-    // This results in much better looking orthogonal connector paths.
-    _router->setRoutingPenalty(Avoid::segmentPenalty);
-
     _serial = next_serial++;
 
     sensitive = false;
@@ -345,6 +344,7 @@ std::unique_ptr<SPDocument> SPDocument::createDoc(
     bool keepalive,
     SPDocument *parent)
 {
+    auto span = Inkscape::Debug::Trace::Span("document", "build", filename);
     auto document = std::make_unique<SPDocument>();
 
     Inkscape::XML::Node *rroot = rdoc->root();
@@ -571,30 +571,34 @@ void SPDocument::rebase(Inkscape::XML::Document * new_xmldoc, bool keep_namedvie
     }
     emitReconstructionStart();
     Inkscape::XML::Document * origin_xmldoc = getReprDoc();
-    Inkscape::XML::Node *namedview = nullptr;
-    for ( Inkscape::XML::Node *child = origin_xmldoc->root()->lastChild() ; child != nullptr ;)
     {
-        Inkscape::XML::Node *prevchild = child->prev();
-        if (!g_strcmp0(child->name(),"sodipodi:namedview") && keep_namedview) {
-            namedview = child;
-        } else {
-            origin_xmldoc->root()->removeChild(child);
+        // The whole tree is replaced, observers only need to see the result.
+        Inkscape::XML::MutationBatch batch(origin_xmldoc);
+        Inkscape::XML::Node *namedview = nullptr;
+        for ( Inkscape::XML::Node *child = origin_xmldoc->root()->lastChild() ; child != nullptr ;)
+        {
+            Inkscape::XML::Node *prevchild = child->prev();
+            if (!g_strcmp0(child->name(),"sodipodi:namedview") && keep_namedview) {
+                namedview = child;
+            } else {
+                origin_xmldoc->root()->removeChild(child);
+            }
+            child = prevchild;
         }
-        child = prevchild;
-    }
-    for ( Inkscape::XML::Node *child = new_xmldoc->root()->firstChild() ; child != nullptr ; child = child->next() )
-    {
-        if (!g_strcmp0(child->name(),"sodipodi:namedview") && keep_namedview) {
-            namedview->mergeFrom(child, "id", true, true);
-        } else {
-            Inkscape::XML::Node *new_child = child->duplicate(origin_xmldoc);
-            origin_xmldoc->root()->appendChild(new_child);
-            Inkscape::GC::release(new_child);
+        for ( Inkscape::XML::Node *child = new_xmldoc->root()->firstChild() ; child != nullptr ; child = child->next() )
+        {
+            if (!g_strcmp0(child->name(),"sodipodi:namedview") && keep_namedview) {
+                namedview->mergeFrom(child, "id", true, true);
+            } else {
+                Inkscape::XML::Node *new_child = child->duplicate(origin_xmldoc);
+                origin_xmldoc->root()->appendChild(new_child);
+                Inkscape::GC::release(new_child);
+            }
+        }
+        // Copy svg root attributes
+        for (const auto & iter : new_xmldoc->root()->attributeList()) {
+            origin_xmldoc->root()->setAttribute(g_quark_to_string(iter.key), iter.value);
         }
-    }
-    // Copy svg root attributes
-    for (const auto & iter : new_xmldoc->root()->attributeList()) {
-        origin_xmldoc->root()->setAttribute(g_quark_to_string(iter.key), iter.value);
     }
     emitReconstructionFinish();
     new_xmldoc->release();
@@ -674,7 +678,10 @@ std::unique_ptr<SPDocument> SPDocument::createNewDoc(char const *filename, bool
     if (filename) {
         Inkscape::XML::Node *rroot;
         /* Try to fetch repr from file */
-        rdoc = sp_repr_read_file(filename, SP_SVG_NS_URI);
+        {
+            auto span = Inkscape::Debug::Trace::Span("document", "parse", filename);
+            rdoc = sp_repr_read_file(filename, SP_SVG_NS_URI);
+        }
         /* If file cannot be loaded, return NULL without warning */
         if (rdoc == nullptr) return nullptr;
         rroot = rdoc->root();
@@ -717,7 +724,10 @@ std::unique_ptr<SPDocument> SPDocument::createNewDoc(char const *filename, bool
 
 std::unique_ptr<SPDocument> SPDocument::createNewDocFromMem(std::span<char const> buffer, bool keepalive, std::string const &filename)
 {
-    auto rdoc = sp_repr_read_mem(buffer.data(), buffer.size(), SP_SVG_NS_URI);
+    auto rdoc = [&] {
+        auto span = Inkscape::Debug::Trace::Span("document", "parse");
+        return sp_repr_read_mem(buffer.data(), buffer.size(), SP_SVG_NS_URI);
+    }();
     if (!rdoc) {
         return {};
     }
@@ -1469,6 +1479,7 @@ bool SPDocument::_updateDocument(int update_flags, unsigned int object_modified_
 
     /* Process updates */
     if (root->uflags || root->mflags) {
+        auto span = Inkscape::Debug::Trace::Span("document", "update");
         if (root->uflags) {
             SPItemCtx ctx;
             setupViewport(&ctx);
@@ -1476,6 +1487,8 @@ bool SPDocument::_updateDocument(int update_flags, unsigned int object_modified_
             DocumentUndo::ScopedInsensitive _no_undo(this);
 
             root->updateDisplay(&ctx, update_flags);
+
+            _last_path_effect_stats = std::exchange(path_effect_stats, {});
         }
         _emitModified(object_modified_tag);
     }
@@ -1517,7 +1530,7 @@ gint SPDocument::ensureUpToDate(unsigned int object_modified_tag)
         // changed objects and provide new routings.  This may cause some objects
             // to be modified, hence the second update pass.
         if (pass == 1) {
-            _router->processTransaction();
+            _router->finish();
         }
     }
 
@@ -1548,10 +1561,10 @@ SPDocument::idle_handler()
 bool
 SPDocument::rerouting_handler()
 {
-    // Process any queued movement actions and determine new routings for
-    // object-avoiding connectors.  Callbacks will be used to update and
-    // redraw affected connectors.
-    _router->processTransaction();
+    // Hand any queued movement actions to the routing thread, which determines
+    // new routings for object-avoiding connectors.  Callbacks will be used to
+    // update and redraw affected connectors once their routes are ready.
+    _router->reroute();
 
     // We don't need to handle rerouting again until there are further
     // diagram updates.
@@ -44,6 +44,7 @@
 #include "3rdparty/libcroco/src/cr-cascade.h"  // for CRCascade
 
 #include "composite-undo-stack-observer.h"
+#include "css/rule-index.h"                     // for RuleIndex
 // XXX only for testing!
 #include "console-output-undo-observer.h"
 
@@ -63,10 +64,6 @@ extern bool sp_no_convert_text_baseline_spacing;
 extern bool sp_do_not_fix_pre_92;
 
 
-namespace Avoid {
-class Router;
-}
-
 class Persp3D;
 class Persp3DImpl;
 class SPDefs;
@@ -78,6 +75,7 @@ class SPObject;
 class SPRoot;
 
 namespace Inkscape {
+    class ConnectorRouter;
     class DocumentUndo;
     class Event;
     class EventLog;
@@ -105,6 +103,16 @@ public:
     /// For sanity check in SPObject::requestDisplayUpdate
     unsigned update_in_progress = 0;
 
+    /// Counts of live path effect runs, see SPLPEItem::performOnePathEffect
+    struct PathEffectStats
+    {
+        unsigned recomputed = 0; ///< Effects which were run.
+        unsigned reused = 0;     ///< Effects whose previous result was still valid.
+    };
+    /// Runs since the last document update, which become lastPathEffectStats() when it is done.
+    PathEffectStats path_effect_stats;
+    PathEffectStats const &lastPathEffectStats() const { return _last_path_effect_stats; }
+
     SPDocument();
     ~SPDocument();
     SPDocument(SPDocument const &) = delete;
@@ -196,7 +204,7 @@ public:
     /******** Getters and Setters **********/
 
     // Document structure -----------------
-    Avoid::Router* getRouter() const { return _router.get(); }
+    Inkscape::ConnectorRouter *getRouter() const { return _router.get(); }
     
     /** Returns our SPRoot */
     SPRoot *getRoot() { return root; }
@@ -223,6 +231,7 @@ public:
 
     // Styling
     CRCascade    *getStyleCascade() { return style_cascade; }
+    Inkscape::CSS::RuleIndex &getStyleRuleIndex() { return style_rule_index; }
 
     // File information --------------------
 
@@ -376,7 +385,7 @@ public:
 private:
 
     // Document ------------------------------
-    std::unique_ptr<Avoid::Router> _router; // Instance of the connector router
+    std::unique_ptr<Inkscape::ConnectorRouter> _router; // Instance of the connector router
     std::unique_ptr<Inkscape::Selection> _selection;
 
     // Document status -----------------------
@@ -387,6 +396,7 @@ private:
     bool modified_since_autosave = false;
     sigc::connection modified_connection;
     sigc::connection rerouting_connection;
+    PathEffectStats _last_path_effect_stats;
 
     // Document structure --------------------
     Inkscape::XML::Document *rdoc; ///< Our Inkscape::XML::Document
@@ -405,6 +415,7 @@ private:
 
     // Styling
     CRCascade *style_cascade;
+    Inkscape::CSS::RuleIndex style_rule_index; ///< Rules of style_cascade by the elements they can match.
 
     // Desktop geometry
     mutable Geom::Affine _doc2dt;
@@ -25,6 +25,7 @@
 #include "timer.h"
 
 #include "actions/actions-effect.h"
+#include "debug/trace.h"
 #include "extension/internal/filter/filter.h"  // for Filter
 #include "implementation/implementation.h"
 #include "io/sys.h"
@@ -245,6 +246,7 @@ void Effect::effect(SPDesktop *desktop, SPDocument *document)
         run_processing_actions(evdoc);
     }
 
+    auto span = Debug::Trace::Span("extension", "effect", get_id());
     timer->lock();
     try {
         executionEnv.run();
@@ -13,6 +13,7 @@
 #include "timer.h"
 
 #include "db.h"
+#include "debug/trace.h"
 #include "implementation/implementation.h"
 
 #include "xml/attribute-record.h"
@@ -154,6 +155,7 @@ std::unique_ptr<SPDocument> Input::open(char const *uri, bool is_importing)
     }
     timer->touch();
 
+    auto span = Debug::Trace::Span("extension", "open", get_id());
     return imp->open(this, uri, is_importing);
 }
 
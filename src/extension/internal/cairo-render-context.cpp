@@ -121,6 +121,14 @@ void CairoRenderContext::_freeResources()
         font_data_free(font.second);
     }
     _font_table.clear();
+    for (auto const font : _fonts_seen) {
+        g_object_unref(font);
+    }
+    _fonts_seen.clear();
+    for (auto const &image : _image_ids) {
+        cairo_surface_destroy(image.first);
+    }
+    _image_ids.clear();
 
     if (_cr) {
         cairo_destroy(_cr);
@@ -192,6 +200,15 @@ CairoRenderContext &CairoRenderContext::operator=(CairoRenderContext &&other)
     _state_stack = std::move(other._state_stack);
     _metadata = std::move(other._metadata);
 
+    _font_table = std::move(other._font_table);
+    other._font_table.clear();
+    _fonts_seen = std::move(other._fonts_seen);
+    other._fonts_seen.clear();
+    _image_ids = std::move(other._image_ids);
+    other._image_ids.clear();
+    _image_hashes = std::move(other._image_hashes);
+    _stats = other._stats;
+
     // Point to the same renderer and unparent the moved-from context
     _renderer = other._renderer;
     other._renderer = nullptr;
@@ -928,8 +945,20 @@ bool CairoRenderContext::finish(bool finish_surface)
     cairo_destroy(_cr);
     _cr = nullptr;
 
-    if (finish_surface)
+    if (finish_surface) {
+        // Vector backends encode images and font subsets when the surface is finished.
+        auto const start = std::chrono::steady_clock::now();
         cairo_surface_finish(_surface);
+        _stats.encode_time += std::chrono::steady_clock::now() - start;
+
+        if (_vector_based_target) {
+            g_info("Cairo export: %zu distinct images, %u image and %u font references reused, "
+                   "%zu bytes of image data not re-encoded, %.1f ms hashing, %.1f ms encoding.",
+                   _image_hashes.size(), _stats.images_reused, _stats.fonts_reused, _stats.bytes_saved,
+                   std::chrono::duration<double, std::milli>(_stats.hash_time).count(),
+                   std::chrono::duration<double, std::milli>(_stats.encode_time).count());
+        }
+    }
     status = cairo_surface_status(_surface);
     cairo_surface_destroy(_surface);
     _surface = nullptr;
@@ -1619,6 +1648,10 @@ bool CairoRenderContext::renderImage(Inkscape::Pixbuf const *pb,
     // scaling by width & height is not needed because it will be done by Cairo
     transform(image_transform);
 
+    if (_vector_based_target) {
+        _setImageUniqueId(pb);
+    }
+
     // cairo_set_source_surface only modifies refcount of 'image_surface', which is an implementation detail
     cairo_set_source_surface(_cr, const_cast<cairo_surface_t*>(image_surface), 0.0, 0.0);
 
@@ -1664,6 +1697,64 @@ bool CairoRenderContext::renderImage(Inkscape::Pixbuf const *pb,
     return true;
 }
 
+/**
+ * Tag the image surface with a hash of its content, so that the PDF and PS backends
+ * embed identical images (e.g. the targets of many clones) only once.
+ */
+void CairoRenderContext::_setImageUniqueId(Inkscape::Pixbuf const *pb)
+{
+    auto surface = const_cast<cairo_surface_t *>(pb->getSurfaceRaw());
+    std::size_t size = 0;
+
+    auto it = _image_ids.find(surface);
+    if (it == _image_ids.end()) {
+        auto const start = std::chrono::steady_clock::now();
+        auto checksum = g_checksum_new(G_CHECKSUM_SHA256);
+
+        gsize len = 0;
+        std::string mimetype;
+        if (auto data = pb->getMimeData(len, mimetype)) {
+            // Original compressed data is embedded as-is, so it is all that matters.
+            g_checksum_update(checksum, (guchar const *)mimetype.c_str(), mimetype.size());
+            g_checksum_update(checksum, data, len);
+            size = len;
+        } else {
+            cairo_surface_flush(surface);
+            int const width = cairo_image_surface_get_width(surface);
+            int const height = cairo_image_surface_get_height(surface);
+            int const stride = cairo_image_surface_get_stride(surface);
+            int const format = cairo_image_surface_get_format(surface);
+            unsigned char const *pixels = cairo_image_surface_get_data(surface);
+
+            for (int v : {width, height, format}) {
+                g_checksum_update(checksum, (guchar const *)&v, sizeof(v));
+            }
+            for (int y = 0; pixels && y < height; y++) {
+                // Skip the row padding, it is not guaranteed to be initialised.
+                g_checksum_update(checksum, pixels + y * stride, width * 4);
+            }
+            size = (std::size_t)stride * height;
+        }
+
+        std::string hash = g_checksum_get_string(checksum);
+        g_checksum_free(checksum);
+        _stats.hash_time += std::chrono::steady_clock::now() - start;
+
+        if (!_image_hashes.insert(hash).second) {
+            _stats.images_reused++;
+            _stats.bytes_saved += size;
+        }
+        it = _image_ids.emplace(cairo_surface_reference(surface), std::move(hash)).first;
+
+        // The unique id must outlive this context, cairo keeps it with the surface.
+        auto id = g_strdup(it->second.c_str());
+        cairo_surface_set_mime_data(surface, CAIRO_MIME_TYPE_UNIQUE_ID, (unsigned char const *)id,
+                                    it->second.size(), g_free, id);
+    } else {
+        _stats.images_reused++;
+    }
+}
+
 #define GLYPH_ARRAY_SIZE 64
 
 // TODO investigate why the font is being ignored:
@@ -1720,18 +1811,35 @@ CairoRenderContext::renderGlyphtext(PangoFont *font, Geom::Affine const &font_ma
     if (_is_omittext)
         return false;
 
-    gpointer fonthash = (gpointer)font;
-    cairo_font_face_t *font_face = nullptr;
-    if (auto const it = _font_table.find(fonthash); it != _font_table.end()) {
-        font_face = it->second;
-    }
-
     FcPattern *fc_pattern = nullptr;
+    cairo_font_face_t *font_face = nullptr;
 
 # ifdef CAIRO_HAS_FT_FONT
     PangoFcFont *fc_font = PANGO_FC_FONT(font);
     fc_pattern = fc_font->font_pattern;
-    if (font_face == nullptr) {
+
+    // Pango hands out a separate font for every size, but the embedded font program only
+    // depends on the face itself, so share one cairo face (and its subset) between them.
+    std::string fonthash;
+    static auto const key_format = (FcChar8 const *)"%{file}|%{index}|%{embolden}|%{matrix}|%{fontvariations}";
+    if (auto key = FcPatternFormat(fc_pattern, key_format)) {
+        fonthash = (char const *)key;
+        FcStrFree(key);
+    } else {
+        fonthash = std::to_string((std::uintptr_t)font);
+    }
+
+    bool const new_font = _fonts_seen.insert(font).second;
+    if (new_font) {
+        g_object_ref(font);
+    }
+    if (auto const it = _font_table.find(fonthash); it != _font_table.end()) {
+        font_face = it->second;
+        // Only another size or variant of a face counts, not later runs of the same font.
+        if (new_font) {
+            _stats.fonts_reused++;
+        }
+    } else {
         font_face = cairo_ft_font_face_create_for_pattern(fc_pattern);
         _font_table[fonthash] = font_face;
     }
@@ -15,8 +15,11 @@
  */
 
 #include "extension/extension.h"
+#include <chrono>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <2geom/forward.h>
 #include <2geom/affine.h>
@@ -260,9 +263,27 @@ private:
     template <cairo_surface_type_t type>
     bool _setVectorTarget(gchar const *utf8_fn);
 
-    std::map<gpointer, cairo_font_face_t *> _font_table;
+    void _setImageUniqueId(Inkscape::Pixbuf const *pb);
+
+    std::map<std::string, cairo_font_face_t *> _font_table;
+    std::unordered_set<PangoFont *> _fonts_seen; ///< Referenced, to tell new sizes of a face from repeated runs.
     static void font_data_free(gpointer data);
 
+    // Content hashes of the image surfaces painted so far; vector backends write each
+    // distinct hash only once, so clones and copies of an image share one XObject.
+    // The surfaces are referenced, so that a freed one's address can't alias a new image.
+    std::unordered_map<cairo_surface_t *, std::string> _image_ids;
+    std::unordered_set<std::string> _image_hashes;
+
+    // Embedding statistics, reported when a vector target is finished.
+    struct EmbedStats {
+        unsigned images_reused = 0;
+        unsigned fonts_reused = 0;
+        std::size_t bytes_saved = 0;
+        std::chrono::steady_clock::duration hash_time{};
+        std::chrono::steady_clock::duration encode_time{};
+    } _stats;
+
     CairoRenderState *_addState() { return &_state_stack.emplace_back(); }
 };
 
@@ -20,6 +20,7 @@
 
 #include <poppler/Catalog.h>
 #include <poppler/ErrorCodes.h>
+#include <poppler/GfxState.h>
 #include <poppler/FontInfo.h>
 #include <poppler/GfxFont.h>
 #include <poppler/GlobalParams.h>
@@ -50,16 +51,21 @@
 #include <gtkmm/liststore.h>
 #include <gtkmm/notebook.h>
 #include <gtkmm/scale.h>
+#include <optional>
 #include <utility>
 
 #include "async/async.h"
+#include "display/dispatch-pool.h"
+#include "display/threading.h"
 #include "document-undo.h"
 #include "document.h"
 #include "extension/input.h"
 #include "extension/system.h"
+#include "inkgc/gc-core.h"
 #include "inkscape.h"
 #include "object/sp-root.h"
 #include "pdf-parser.h"
+#include "pdf-utils.h"
 #include "preferences.h"
 #include "ui/builder-utils.h"
 #include "ui/dialog-events.h"
@@ -686,10 +692,8 @@ std::unique_ptr<SPDocument> PdfInput::open(Inkscape::Extension::Input *, char co
         if (dlg)
             dlg->getImportSettings(prefs);
 
-        for (auto p : pages) {
-            // And then add each of the pages
-            add_builder_page(pdf_doc, builder, doc.get(), p);
-        }
+        // And then add each of the pages
+        add_builder_pages(pdf_doc, builder, doc.get(), uri, pages);
 
         delete builder;
         g_free(docname);
@@ -769,9 +773,133 @@ std::unique_ptr<SPDocument> PdfInput::open(Inkscape::Extension::Input *, char co
 }
 
 /**
- * Parses the selected page object of the given PDF document using PdfParser.
+ * The width SvgBuilder ends up giving a page: its trim box, scaled as PdfParser scales its
+ * crop box to the page size.
+ */
+static std::optional<double> get_page_width(Catalog *catalog, int page_num)
+{
+    auto page = catalog->getPage(page_num);
+    if (!page) {
+        return {};
+    }
+    GfxState state(96.0, 96.0, page->getCropBox(), page->getRotate(), true);
+    return getRect(page->getTrimBox()).width() * state.getPageWidth() / getRect(page->getCropBox()).width();
+}
+
+/**
+ * Read the preferences used to write out SVG numbers and paths, so that builders on other
+ * threads find them all in the preferences cache and never write to it.
+ */
+static void cache_output_preferences()
+{
+    auto prefs = Inkscape::Preferences::get();
+    for (auto path : {"/options/svgoutput/numericprecision", "/options/svgoutput/minimumexponent",
+                      "/options/svgoutput/pathstring_format"}) {
+        prefs->getInt(path);
+    }
+    for (auto path : {"/options/svgoutput/disable_optimizations", "/options/svgoutput/forcerepeatcommands",
+                      "/options/svgoutput/check_on_editing"}) {
+        prefs->getBool(path);
+    }
+}
+
+/**
+ * Parses the selected pages of the given PDF document, in parallel when there are enough of them.
+ *
+ * The document, its XML and poppler documents can only be used by one thread. So the pages are
+ * split into runs, each of which is parsed into an XML document of its own, by a builder and a
+ * poppler document of its own. The runs are then added to the document in page order.
  */
 void
+PdfInput::add_builder_pages(std::shared_ptr<PDFDoc> pdf_doc, SvgBuilder *builder, SPDocument *doc,
+                            char const *uri, std::set<unsigned> const &pages)
+{
+    static constexpr std::size_t min_pages_per_run = 2;
+
+    auto const thread_count = get_global_dispatch_pool()->size();
+    auto const run_count = std::min<std::size_t>(thread_count, pages.size() / min_pages_per_run);
+    if (run_count < 2) {
+        for (auto p : pages) {
+            add_builder_page(pdf_doc, builder, doc, p);
+        }
+        return;
+    }
+
+    struct PageRun
+    {
+        std::vector<int> pages;
+        std::vector<double> skipped_widths; // Of the pages before them
+        std::shared_ptr<PDFDoc> pdf_doc;
+        std::unique_ptr<SvgBuilder> builder; // Null if the run failed
+    };
+    auto runs = std::vector<PageRun>(run_count);
+
+    // Each run has to know where its first page goes, so lay all the pages out up front.
+    auto catalog = pdf_doc->getCatalog();
+    std::vector<double> widths;
+    std::size_t index = 0;
+    for (auto p : pages) {
+        auto &run = runs[index++ * run_count / pages.size()];
+        if (run.pages.empty()) {
+            run.skipped_widths = widths;
+        }
+        run.pages.push_back(p);
+        if (auto width = get_page_width(catalog, p)) {
+            widths.push_back(*width);
+        }
+    }
+
+    cache_output_preferences();
+    Inkscape::GC::allow_threads();
+
+    // Threads of its own, rather than the global pool, which the canvas needs in the meantime and
+    // which the runs use to encode their images.
+    auto pool = dispatch_pool(run_count);
+    pool.dispatch(run_count, [&](int i, int) {
+        auto const gc_scope = Inkscape::GC::ThreadScope();
+        auto &run = runs[i];
+        try {
+            // The first run can have the document which is already open, nothing else uses it now.
+            run.pdf_doc = i == 0 ? pdf_doc : _POPPLER_MAKE_SHARED_PDFDOC(uri);
+            if (!run.pdf_doc->isOk()) {
+                return;
+            }
+            run.builder = std::make_unique<SvgBuilder>(*builder, run.pdf_doc->getXRef(),
+                                                       "page" + std::to_string(run.pages.front()) + "-");
+            for (auto width : run.skipped_widths) {
+                run.builder->skipPage(width);
+            }
+            for (auto p : run.pages) {
+                if (!add_builder_page(run.pdf_doc, run.builder.get(), nullptr, p)) {
+                    // Leave the page to this thread, so that it fails as it does without threads.
+                    run.builder.reset();
+                    return;
+                }
+            }
+        } catch (...) {
+            // Try again on this thread, where errors are reported to the caller.
+            run.builder.reset();
+        }
+    });
+
+    for (auto &run : runs) {
+        if (run.builder) {
+            builder->appendPages(*run.builder);
+            run.builder.reset();
+        } else {
+            for (auto p : run.pages) {
+                add_builder_page(pdf_doc, builder, doc, p);
+            }
+        }
+    }
+}
+
+/**
+ * Parses the selected page object of the given PDF document using PdfParser.
+ *
+ * @return false if the page or its content couldn't be read.
+ */
+bool
 PdfInput::add_builder_page(std::shared_ptr<PDFDoc>pdf_doc, SvgBuilder *builder, SPDocument *doc, int page_num)
 {
     Inkscape::XML::Node *prefs = builder->getPreferences();
@@ -782,7 +910,7 @@ PdfInput::add_builder_page(std::shared_ptr<PDFDoc>pdf_doc, SvgBuilder *builder,
     Page *page = catalog->getPage(page_num);
     if (!page) {
         std::cerr << "PDFInput::open: error opening page " << page_num << std::endl;
-        return;
+        return false;
     }
 
     // Apply crop settings
@@ -824,9 +952,7 @@ PdfInput::add_builder_page(std::shared_ptr<PDFDoc>pdf_doc, SvgBuilder *builder,
 
     // Parse the document structure
     Object obj = page->getContents();
-    if (!obj.isNull()) {
-        pdf_parser.parse(&obj);
-    }
+    bool parsed = obj.isNull() || pdf_parser.parse(&obj);
 
     // Parse the annotations
     if (auto annots = page->getAnnotsObject(); annots.isArray()) {
@@ -835,6 +961,10 @@ PdfInput::add_builder_page(std::shared_ptr<PDFDoc>pdf_doc, SvgBuilder *builder,
             pdf_parser.build_annots(annots.arrayGet(i), page_num);
         }
     }
+
+    // Compress this page's images while their decoded pixels are still at hand.
+    builder->flushImages();
+    return parsed;
 }
 
 #include "../clear-n_.h"
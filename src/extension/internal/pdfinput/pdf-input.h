@@ -17,6 +17,7 @@
 
 #include <glibmm/refptr.h>
 #include <gtkmm/dialog.h>
+#include <set>
 #include <unordered_map>
 
 #include "extension/implementation/implementation.h"
@@ -139,10 +140,14 @@ public:
     static void init();
 
 private:
-    void add_builder_page(
+    bool add_builder_page(
         std::shared_ptr<PDFDoc> pdf_doc,
         SvgBuilder *builder, SPDocument *doc,
         int page_num);
+    void add_builder_pages(
+        std::shared_ptr<PDFDoc> pdf_doc,
+        SvgBuilder *builder, SPDocument *doc,
+        char const *uri, std::set<unsigned> const &pages);
 };
 
 } // namespace Inkscape::Extension::Internal
@@ -24,7 +24,6 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <mutex> // std::call_once()
 #include <utility>
 #include <vector>
 #include <2geom/transforms.h>
@@ -373,7 +372,7 @@ PdfParser::~PdfParser() {
   }
 }
 
-void PdfParser::parse(Object *obj, GBool topLevel) {
+bool PdfParser::parse(Object *obj, GBool topLevel) {
   Object obj2;
 
   if (obj->isArray()) {
@@ -382,18 +381,19 @@ void PdfParser::parse(Object *obj, GBool topLevel) {
       if (!obj2.isStream()) {
 	error(errInternal, -1, "Weird page contents");
 	_POPPLER_FREE(obj2);
-	return;
+	return false;
       }
       _POPPLER_FREE(obj2);
     }
   } else if (!obj->isStream()) {
 	error(errInternal, -1, "Weird page contents");
-    	return;
+    	return false;
   }
   parser = new _POPPLER_NEW_PARSER(xref, obj);
   go(topLevel);
   delete parser;
   parser = nullptr;
+  return true;
 }
 
 void PdfParser::go(GBool /*topLevel*/)
@@ -2155,13 +2155,19 @@ std::shared_ptr<CairoFontEngine> PdfParser::getFontEngine()
 {
     // poppler/CairoOutputDev.cc claims the FT Library needs to be kept around
     // for a while. It's unclear if this is sure for our case.
-    static FT_Library ft_lib;
-    static std::once_flag ft_lib_once_flag;
-    std::call_once(ft_lib_once_flag, FT_Init_FreeType, &ft_lib);
+    // A library can't be used by several threads, and pages may be built in parallel.
+    static thread_local FT_Library ft_lib = nullptr;
+    if (!ft_lib) {
+        FT_Init_FreeType(&ft_lib);
+    }
     if (!_font_engine) {
-        // This will make a new font engine per form1, in the future we could
-        // share this between PdfParser instances for the same PDF file.
-        _font_engine = std::make_shared<CairoFontEngine>(ft_lib);
+        // All the pages and patterns of one import share a font engine, so fonts used
+        // across pages are only loaded once.
+        _font_engine = builder->getFontEngine();
+        if (!_font_engine) {
+            _font_engine = std::make_shared<CairoFontEngine>(ft_lib);
+            builder->setFontEngine(_font_engine);
+        }
     }
     return _font_engine;
 }
@@ -119,8 +119,8 @@ public:
 
     virtual ~PdfParser();
 
-    // Interpret a stream or array of streams.
-    void parse(Object *obj, GBool topLevel = gTrue);
+    // Interpret a stream or array of streams, false if it isn't one.
+    bool parse(Object *obj, GBool topLevel = gTrue);
 
     // Save graphics state.
     void saveState();
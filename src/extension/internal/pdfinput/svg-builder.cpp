@@ -20,7 +20,11 @@
 # include "config.h"  // only include where actually required!
 #endif
 
+#include <atomic>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <locale>
 #include <codecvt>
 
@@ -40,7 +44,9 @@
 #include "colors/cms/profile.h"
 #include "colors/document-cms.h"
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/nr-filter-utils.h"
+#include "display/threading.h"
 #include "object/sp-defs.h"
 #include "object/sp-namedview.h"
 #include "object/sp-text.h"
@@ -82,6 +88,8 @@ SvgBuilder::SvgBuilder(SPDocument *document, gchar *docname, XRef *xref)
     // Set default preference settings
     _preferences = _xml_doc->createElement("svgbuilder:prefs");
     _preferences->setAttribute("embedImages", "1");
+    _cache = std::make_shared<SvgBuilderCache>();
+    _cache->images = std::make_shared<SvgImageStore>();
 }
 
 SvgBuilder::SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root) {
@@ -91,12 +99,52 @@ SvgBuilder::SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root) {
     _xref = parent->_xref;
     _xml_doc = parent->_xml_doc;
     _preferences = parent->_preferences;
+    _cache = parent->_cache;
     _container = this->_root = root;
     _init();
 }
 
+/**
+ * Create a builder for some of the pages of the same import as the main builder, which writes
+ * into an XML document of its own instead of the SPDocument. The object tree isn't involved,
+ * so it can build its pages on another thread, while reading the PDF through its own xref.
+ * Its pages are then added to the main builder by appendPages().
+ *
+ * @param id_prefix - Put in front of the ids it generates, to tell them apart from the ones of
+ *                    the main document and other such builders.
+ */
+SvgBuilder::SvgBuilder(SvgBuilder const &main, XRef *xref, std::string id_prefix)
+{
+    _is_top_level = true;
+    _doc = nullptr;
+    _docname = main._docname;
+    _xref = xref;
+    _xml_doc = sp_repr_document_new("svg:svg");
+    _container = _root = _xml_doc->root();
+    _init();
+
+    _preferences = main._preferences;
+    _font_strategies = main._font_strategies;
+    _as_pages = main._as_pages;
+    _cache = std::make_shared<SvgBuilderCache>();
+    _cache->images = main._cache->images;
+    _cache->id_prefix = std::move(id_prefix);
+}
+
 SvgBuilder::~SvgBuilder()
 {
+    if (_is_top_level) {
+        flushImages();
+        if (_doc) {
+            _shareImages();
+        }
+        for (auto const &[id, node] : _cache->ids) {
+            Inkscape::GC::release(node);
+        }
+        if (!_doc) {
+            Inkscape::GC::release(_xml_doc);
+        }
+    }
     if (_clip_history) {
         delete _clip_history;
         _clip_history = nullptr;
@@ -140,7 +188,17 @@ void SvgBuilder::pushPage(const std::string &label, GfxState *state)
         if (!label.empty()) {
             _page->setAttribute("inkscape:label", validateString(label));
         }
-        auto _nv = _doc->getNamedView()->getRepr();
+        Inkscape::XML::Node *_nv = nullptr;
+        if (_doc) {
+            _nv = _doc->getNamedView()->getRepr();
+        } else {
+            if (!_cache->named_view) {
+                _cache->named_view = _xml_doc->createElement("sodipodi:namedview");
+                _xml_doc->root()->appendChild(_cache->named_view);
+                Inkscape::GC::release(_cache->named_view);
+            }
+            _nv = _cache->named_view;
+        }
         _nv->appendChild(_page);
     }
 
@@ -172,6 +230,98 @@ void SvgBuilder::pushPage(const std::string &label, GfxState *state)
     }
 }
 
+/**
+ * Lay out the pages which come after a page of this width, as if it had been built, without
+ * building it. Another builder does that, see appendPages().
+ */
+void SvgBuilder::skipPage(double width)
+{
+    if (_page_offset && this->_width) {
+        int gap = 20;
+        _page_left += this->_width + gap;
+    }
+    _page_num += 1;
+    _page_offset = true;
+    this->_width = width;
+}
+
+/**
+ * Move the pages built by a builder of this import with a document of its own, and everything
+ * they use, into the document. The pages must be the ones which come next, and its layout must
+ * have been started by skipping all the pages before them, so that they are in the right place.
+ * The clips it left to the document are decided once the pages are in it.
+ */
+void SvgBuilder::appendPages(SvgBuilder &pages)
+{
+    auto const source_root = pages._xml_doc->root();
+    std::vector<Inkscape::XML::Node *> grafted;
+
+    // Definitions first, so that the references to them are found when the content is added.
+    if (auto defs = pages._cache->defs) {
+        for (auto child = defs->firstChild(); child; child = child->next()) {
+            if (!std::strcmp(child->name(), "svg:color-profile")) {
+                auto name = child->attribute("name");
+                if (name && _doc->getDocumentCMS().getSpace(name)) {
+                    continue;
+                }
+            }
+            auto copy = child->duplicate(_xml_doc);
+            _getDefs()->appendChild(copy);
+            grafted.push_back(copy);
+            Inkscape::GC::release(copy);
+        }
+    }
+    if (auto named_view = pages._cache->named_view) {
+        auto nv = _doc->getNamedView()->getRepr();
+        for (auto child = named_view->firstChild(); child; child = child->next()) {
+            auto copy = child->duplicate(_xml_doc);
+            nv->appendChild(copy);
+            Inkscape::GC::release(copy);
+        }
+    }
+
+    for (auto child = source_root->firstChild(); child; child = child->next()) {
+        if (child == pages._cache->defs || child == pages._cache->named_view) {
+            continue;
+        }
+        // Layers of optional content are shared by all the pages which use them.
+        auto id = child->attribute("id");
+        auto existing = id ? _getNodeById(id) : nullptr;
+        if (existing && existing->parent() == _root) {
+            for (auto grandchild = child->firstChild(); grandchild; grandchild = grandchild->next()) {
+                auto copy = grandchild->duplicate(_xml_doc);
+                existing->appendChild(copy);
+                grafted.push_back(copy);
+                Inkscape::GC::release(copy);
+            }
+        } else {
+            auto copy = child->duplicate(_xml_doc);
+            _root->appendChild(copy);
+            grafted.push_back(copy);
+            Inkscape::GC::release(copy);
+        }
+    }
+    if (!pages._cache->deferred_clips.empty()) {
+        for (auto copy : grafted) {
+            _applyDeferredClips(pages, copy);
+        }
+    }
+    for (auto attr : {"width", "height"}) {
+        if (auto value = source_root->attribute(attr)) {
+            _root->setAttribute(attr, value);
+        }
+    }
+    for (auto const &[name, content] : pages._cache->metadata) {
+        setMetadata(name.c_str(), content);
+    }
+
+    _page_num = pages._page_num;
+    _page_left = pages._page_left;
+    _page_offset = pages._page_offset;
+    _width = pages._width;
+    _height = pages._height;
+}
+
 void SvgBuilder::setDocumentSize(double width, double height) {
     this->_width = width;
     this->_height = height;
@@ -250,6 +400,11 @@ void SvgBuilder::setMargins(const Geom::Rect &page, const Geom::Rect &margins, c
 void SvgBuilder::setMetadata(char const *name, const std::string &content)
 {
     if (name && !content.empty()) {
+        if (!_doc) {
+            // Set when the pages are added to the document.
+            _cache->metadata.emplace_back(name, content);
+            return;
+        }
         rdf_set_work_entity(_doc, rdf_find_entity(name), validateString(content).c_str());
     }
 }
@@ -382,7 +537,7 @@ Inkscape::XML::Node *SvgBuilder::_popGroup()
 
 static gchar *svgConvertRGBToText(double r, double g, double b) {
     using Inkscape::Filters::clamp;
-    static gchar tmp[1023] = {0};
+    static thread_local gchar tmp[1023] = {0};
     snprintf(tmp, 1023,
              "#%02x%02x%02x",
              clamp(SP_COLOR_F_TO_U(r)),
@@ -795,7 +950,7 @@ void SvgBuilder::setClip(GfxState *state, GfxClipType clip, bool is_bbox)
 /**
  * Return the active clip as a new xml node.
  */
-Inkscape::XML::Node *SvgBuilder::_getClip(const Inkscape::XML::Node *node)
+Inkscape::XML::Node *SvgBuilder::_getClip(Inkscape::XML::Node *node)
 {
     // In SVG the path-clip transforms are compounded, so we have to do extra work to
     // pull transforms back out of the clipping object and set them. Otherwise this
@@ -822,15 +977,54 @@ Inkscape::XML::Node *SvgBuilder::_getClip(const Inkscape::XML::Node *node)
         _clip_text = nullptr;
         return clip_node;
     }
-    if (_shouldClip(node)) {
-        std::string clip_d = svgInterpretPath(_clip_history->getClipPath());
-        Geom::Affine tr = _clip_history->getAffine() * _page_affine * node_tr.inverse();
-        return _createClip(clip_d, tr, _clip_history->evenOdd());
+    auto const should_clip = _shouldClip(node);
+    if (should_clip == false) {
+        return nullptr;
     }
-    return nullptr;
+    std::string clip_d = svgInterpretPath(_clip_history->getClipPath());
+    Geom::Affine tr = _clip_history->getAffine() * _page_affine * node_tr.inverse();
+    if (!should_clip) {
+        // Left to appendPages(), once the node is in the document.
+        auto &deferred = _cache->deferred_clips;
+        node->setAttributeInt("svgbuilder:clip", deferred.size());
+        deferred.push_back({std::move(clip_d), tr, _clip_history->evenOdd(), _getClipArea()});
+        return nullptr;
+    }
+    return _createClip(clip_d, tr, _clip_history->evenOdd());
 }
 
-bool SvgBuilder::_shouldClip(const Inkscape::XML::Node *node) const
+/**
+ * The active clip path, to test nodes against with clip_cuts().
+ *
+ * Its transform is compounded with the page, node inverse and node transforms. Skip the node
+ * inverse * node part as it's just identity, and the page transform as it should be applied
+ * equally to both.
+ */
+Geom::PathVector SvgBuilder::_getClipArea() const
+{
+    return sp_svg_read_pathv(svgInterpretPath(_clip_history->getClipPath())) * _clip_history->getAffine();
+}
+
+/**
+ * Whether a node with the given outline, before its transform, would be cut by a clip area.
+ */
+static bool clip_cuts(Geom::PathVector const &clip_area, Geom::PathVector node_vec, Inkscape::XML::Node const *node)
+{
+    Geom::Affine node_tr = Geom::identity();
+    if (auto attr = node->attribute("transform")) {
+        sp_svg_transform_read(attr, &node_tr);
+    }
+    node_vec *= node_tr;
+    return !pathv_fully_contains(clip_area, node_vec);
+}
+
+/**
+ * Whether the node has to be clipped by the active clip, which it doesn't if it lies within.
+ *
+ * Nothing is known for a node which only the document can measure, such as text, when the
+ * builder has a document of its own; appendPages() then decides in the same way.
+ */
+std::optional<bool> SvgBuilder::_shouldClip(const Inkscape::XML::Node *node) const
 {
     if (!_clip_history->hasClipPath()) {
         return false;
@@ -842,11 +1036,28 @@ bool SvgBuilder::_shouldClip(const Inkscape::XML::Node *node) const
     if (node_vec.empty()) {
         // Non-path node (text, image, etc)
         // Create a PathVector of the bounding box instead
-        _doc->ensureUpToDate();
-        auto item = cast<SPItem>(_doc->getObjectByRepr(const_cast<Inkscape::XML::Node *>(node)));
         // transform will be applied later, so default identity is good
         Geom::OptRect bounds;
-        bounds = item ? item->visualBounds() : bounds;
+        if (!std::strcmp(node->name(), "svg:image")) {
+            // Images are placed by their transform, their box is all there is to them.
+            bounds = Geom::Rect::from_xywh(node->getAttributeDouble("x", 0.0), node->getAttributeDouble("y", 0.0),
+                                           node->getAttributeDouble("width", 0.0),
+                                           node->getAttributeDouble("height", 0.0));
+        } else if (_doc) {
+            _doc->ensureUpToDate();
+            auto item = cast<SPItem>(_doc->getObjectByRepr(const_cast<Inkscape::XML::Node *>(node)));
+            bounds = item ? item->visualBounds() : bounds;
+        } else {
+            // The document measures the node once it is in it. Nodes outside of the builder's
+            // own document, such as the content of patterns, aren't found there either.
+            auto top = node;
+            while (top->parent()) {
+                top = top->parent();
+            }
+            if (top == _xml_doc->root()) {
+                return {};
+            }
+        }
 
         if (!bounds.empty()) {
             node_vec.push_back(Geom::Path(*bounds));
@@ -856,21 +1067,33 @@ bool SvgBuilder::_shouldClip(const Inkscape::XML::Node *node) const
         }
     }
 
-    Geom::PathVector clip_vec = sp_svg_read_pathv(svgInterpretPath(_clip_history->getClipPath()));
+    return clip_cuts(_getClipArea(), std::move(node_vec), node);
+}
 
-    // Clip transform is compounded with page, node inverse, and node transforms
-    // Skip the node inverse * node part as it's just identity.
-    // Also skip the page transform as it should be applied equally to both.
-    Geom::Affine clip_tr = _clip_history->getAffine();
-    Geom::Affine node_tr = Geom::identity();
-    if (auto attr = node->attribute("transform")) {
-        sp_svg_transform_read(attr, &node_tr);
+/**
+ * Clip the nodes of grafted pages which their builder left to the document, as _shouldClip()
+ * decides for the pages this builder builds. Children go before their parents, as they do when
+ * the pages are built here.
+ */
+void SvgBuilder::_applyDeferredClips(SvgBuilder const &pages, Inkscape::XML::Node *node)
+{
+    for (auto child = node->firstChild(); child; child = child->next()) {
+        _applyDeferredClips(pages, child);
     }
+    auto const index = node->getAttributeInt("svgbuilder:clip", -1);
+    if (index < 0) {
+        return;
+    }
+    node->removeAttribute("svgbuilder:clip");
 
-    node_vec *= node_tr;
-    clip_vec *= clip_tr;
-
-    return !pathv_fully_contains(clip_vec, node_vec);
+    auto const &clip = pages._cache->deferred_clips.at(index);
+    _doc->ensureUpToDate();
+    auto item = cast<SPItem>(_doc->getObjectByRepr(node));
+    auto bounds = item ? item->visualBounds() : Geom::OptRect();
+    if (!bounds || clip_cuts(clip.area, Geom::PathVector(Geom::Path(*bounds)), node)) {
+        auto clip_path = _createClip(clip.d, clip.transform, clip.even_odd);
+        node->setAttribute("clip-path", std::string("url(#") + clip_path->attribute("id") + ")");
+    }
 }
 
 Inkscape::XML::Node *SvgBuilder::_createClip(const std::string &d, const Geom::Affine tr, bool even_odd)
@@ -905,7 +1128,7 @@ Inkscape::XML::Node *SvgBuilder::_createClip(const std::string &d, const Geom::A
     Inkscape::GC::release(path);
 
     // Append clipPath to defs and get id
-    _doc->getDefs()->getRepr()->appendChild(clip_path);
+    _addToDefs(clip_path);
     Inkscape::GC::release(clip_path);
 
     // update the previous clip path
@@ -918,9 +1141,9 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
 {
     if (name && group && std::string(name) == "OC") {
         auto layer_id = std::string("layer-") + sanitizeId(group);
-        if (auto existing = _doc->getObjectById(layer_id)) {
-            if (existing->getRepr()->parent() == _container) {
-                _container = existing->getRepr();
+        if (auto existing = _getNodeById(layer_id)) {
+            if (existing->parent() == _container) {
+                _container = existing;
                 _node_stack.push_back(_container);
             } else {
                 g_warning("Unexpected marked content group in PDF!");
@@ -928,7 +1151,7 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
             }
         } else {
             auto node = _pushGroup();
-            node->setAttribute("id", layer_id);
+            _setNodeId(node, layer_id);
             if (_ocgs.find(group) != _ocgs.end()) {
                 auto pair = _ocgs[group];
                 setAsLayer(pair.first.c_str(), pair.second);
@@ -937,7 +1160,7 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
     } else {
         auto node = _pushGroup();
         if (group) {
-            node->setAttribute("id", std::string("group-") + sanitizeId(group));
+            _setNodeId(node, std::string("group-") + sanitizeId(group));
         }
     }
 }
@@ -951,15 +1174,15 @@ Inkscape::XML::Node *SvgBuilder::beginLayer(const std::string &label, bool visib
 {
     auto id = sanitizeId(label);
     Inkscape::XML::Node *save_current_location = _container;
-    if (auto existing = _doc->getObjectById(id)) {
-        _container = existing->getRepr();
+    if (auto existing = _getNodeById(id)) {
+        _container = existing;
         _node_stack.push_back(_container);
     } else {
         while (_container != _root) {
             _popGroup();
         }
         auto node = _pushGroup();
-        node->setAttribute("id", id);
+        _setNodeId(node, id);
         setAsLayer(label.c_str(), visible);
     }
     return save_current_location;
@@ -1002,8 +1225,18 @@ std::string SvgBuilder::_getColorProfile(cmsHPROFILE hp)
     std::string name = validateString(profile->getName());
 
     // Find the named profile in the document (if already added)
-    if (_doc->getDocumentCMS().getSpace(name))
-        return name;
+    if (_doc) {
+        if (_doc->getDocumentCMS().getSpace(name))
+            return name;
+    } else {
+        for (auto child = _getDefs()->firstChild(); child; child = child->next()) {
+            auto child_name = child->attribute("name");
+            if (!std::strcmp(child->name(), "svg:color-profile") && child_name && name == child_name) {
+                _icc_profiles[hp] = name;
+                return name;
+            }
+        }
+    }
 
     // Add the profile, we've never seen it before.
     Inkscape::XML::Node *icc_node = _xml_doc->createElement("svg:color-profile");
@@ -1012,7 +1245,7 @@ std::string SvgBuilder::_getColorProfile(cmsHPROFILE hp)
 
     auto icc_data = std::string("data:application/vnd.iccprofile;base64,") + profile->dumpBase64();
     icc_node->setAttributeOrRemoveIfEmpty("xlink:href", icc_data);
-    _doc->getDefs()->getRepr()->appendChild(icc_node);
+    _addToDefs(icc_node);
     Inkscape::GC::release(icc_node);
 
     _icc_profiles[hp] = name;
@@ -1124,7 +1357,7 @@ gchar *SvgBuilder::_createTilingPattern(GfxTilingPattern *tiling_pattern,
     delete pattern_builder;
 
     // Append the pattern to defs
-    _doc->getDefs()->getRepr()->appendChild(pattern_node);
+    _addToDefs(pattern_node);
     gchar *id = g_strdup(pattern_node->attribute("id"));
     Inkscape::GC::release(pattern_node);
 
@@ -1191,7 +1424,7 @@ gchar *SvgBuilder::_createGradient(GfxShading *shading, const Geom::Affine pat_m
         return nullptr;
     }
 
-    _doc->getDefs()->getRepr()->appendChild(gradient);
+    _addToDefs(gradient);
     gchar *id = g_strdup(gradient->attribute("id"));
     Inkscape::GC::release(gradient);
 
@@ -1354,6 +1587,9 @@ void SvgBuilder::updateFont(GfxState *state, std::shared_ptr<CairoFont> cairo_fo
         return;
     }
 
+    // The font factory isn't thread-safe, and pages may be built in parallel.
+    static std::mutex font_factory_mutex;
+    auto const font_factory_lock = std::scoped_lock(font_factory_mutex);
     auto font_data = FontData(font);
     auto new_font_specification = font_data.getSpecification();
     TRACE(("FontSpecification: %s\n", new_font_specification.c_str()));
@@ -1715,10 +1951,9 @@ void SvgBuilder::_flushText(GfxState *state)
 
     // Set up a clipPath group (if required).
     if (state->getRender() & 4 && !_clip_text_group) {
-        auto defs = _doc->getDefs()->getRepr();
         _clip_text_group = _pushContainer("svg:clipPath");
         _clip_text_group->setAttribute("clipPathUnits", "userSpaceOnUse");
-        defs->appendChild(_clip_text_group);
+        _addToDefs(_clip_text_group);
         Inkscape::GC::release(_clip_text_group);
     }
 
@@ -1894,7 +2129,7 @@ void SvgBuilder::addChar(GfxState *state,
     _aria_space = false;
 
     std::string utf8_code;
-    static std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv1;
+    static thread_local std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv1;
     // Note std::wstring_convert and std::codecvt_utf are deprecated and will be removed in C++26.
     if (u) {
         // 'u' maybe null if there is not a "ToUnicode" table in the PDF!
@@ -2000,66 +2235,50 @@ void SvgBuilder::endTextObject(GfxState *state)
 void png_write_vector(png_structp png_ptr, png_bytep data, png_size_t length)
 {
     auto *v_ptr = reinterpret_cast<std::vector<guchar> *>(png_get_io_ptr(png_ptr)); // Get pointer to stream
-    for ( unsigned i = 0 ; i < length ; i++ ) {
-        v_ptr->push_back(data[i]);
-    }
+    v_ptr->insert(v_ptr->end(), data, data + length);
 }
 
 /**
- * \brief Creates an <image> element containing the given ImageStream as a PNG
+ * Compress decoded image pixels into a PNG, either into the buffer or the open file.
+ * This doesn't touch poppler or the document, so it's safe to call from worker threads.
  *
+ * @returns true if the PNG was written successfully.
  */
-Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height,
-                                              GfxImageColorMap *color_map, bool interpolate,
-                                              int *mask_colors, bool alpha_only,
-                                              bool invert_alpha) {
-
+static bool write_png(SvgPendingImage const &image, std::vector<guchar> *buffer, FILE *fp)
+{
     // Create PNG write struct
     png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     if ( png_ptr == nullptr ) {
-        return nullptr;
+        return false;
     }
     // Create PNG info struct
     png_infop info_ptr = png_create_info_struct(png_ptr);
     if ( info_ptr == nullptr ) {
         png_destroy_write_struct(&png_ptr, nullptr);
-        return nullptr;
+        return false;
     }
     // Set error handler
     if (setjmp(png_jmpbuf(png_ptr))) {
         png_destroy_write_struct(&png_ptr, &info_ptr);
-        return nullptr;
+        return false;
     }
-    // Decide whether we should embed this image
-    bool embed_image = _preferences->getAttributeBoolean("embedImages", true);
 
     // Set read/write functions
-    std::vector<guchar> png_buffer;
-    FILE *fp = nullptr;
-    gchar *file_name = nullptr;
-    if (embed_image) {
-        png_set_write_fn(png_ptr, &png_buffer, png_write_vector, nullptr);
+    if (buffer) {
+        png_set_write_fn(png_ptr, buffer, png_write_vector, nullptr);
     } else {
-        static int counter = 0;
-        file_name = g_strdup_printf("%s_img%d.png", _docname, counter++);
-        fp = fopen(file_name, "wb");
-        if ( fp == nullptr ) {
-            png_destroy_write_struct(&png_ptr, &info_ptr);
-            g_free(file_name);
-            return nullptr;
-        }
         png_init_io(png_ptr, fp);
     }
 
     // Set header data
-    if ( !invert_alpha && !alpha_only ) {
+    if (image.invert_alpha) {
         png_set_invert_alpha(png_ptr);
     }
     png_color_8 sig_bit;
-    if (alpha_only) {
+    if (image.alpha_only) {
         png_set_IHDR(png_ptr, info_ptr,
-                     width,
-                     height,
+                     image.width,
+                     image.height,
                      8, /* bit_depth */
                      PNG_COLOR_TYPE_GRAY,
                      PNG_INTERLACE_NONE,
@@ -2072,8 +2291,8 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
         sig_bit.alpha = 0;
     } else {
         png_set_IHDR(png_ptr, info_ptr,
-                     width,
-                     height,
+                     image.width,
+                     image.height,
                      8, /* bit_depth */
                      PNG_COLOR_TYPE_RGB_ALPHA,
                      PNG_INTERLACE_NONE,
@@ -2089,26 +2308,62 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
     // Write the file header
     png_write_info(png_ptr, info_ptr);
 
+    std::size_t const row_size = image.alpha_only ? image.width : image.width * 4;
+    for (int y = 0; y < image.height; y++) {
+        png_write_row(png_ptr, (png_bytep)image.pixels.data() + y * row_size);
+    }
+
+    // Close PNG
+    png_write_end(png_ptr, info_ptr);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    return true;
+}
+
+/**
+ * \brief Creates an <image> element containing the given ImageStream as a PNG
+ *
+ * Only the pixel decoding happens here, embedded images are compressed later
+ * and in parallel by flushImages().
+ */
+Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height,
+                                              GfxImageColorMap *color_map, bool interpolate,
+                                              int *mask_colors, bool alpha_only,
+                                              bool invert_alpha) {
+
+    // A colormap must be provided for color images, so quit
+    if (width <= 0 || height <= 0 || (!alpha_only && !color_map)) {
+        return nullptr;
+    }
+
+    auto image = SvgPendingImage{
+        .node = nullptr,
+        .width = width,
+        .height = height,
+        .alpha_only = alpha_only,
+        .invert_alpha = !invert_alpha && !alpha_only,
+    };
+    std::size_t const row_size = alpha_only ? width : width * 4;
+    image.pixels.resize(row_size * height);
+
     // Convert pixels
-    ImageStream *image_stream;
+    std::unique_ptr<ImageStream> image_stream;
     if (alpha_only) {
         if (color_map) {
-            image_stream = new ImageStream(str, width, color_map->getNumPixelComps(),
-                                           color_map->getBits());
+            image_stream = std::make_unique<ImageStream>(str, width, color_map->getNumPixelComps(),
+                                                         color_map->getBits());
         } else {
-            image_stream = new ImageStream(str, width, 1, 1);
+            image_stream = std::make_unique<ImageStream>(str, width, 1, 1);
         }
         image_stream->reset();
 
         // Convert grayscale values
-        unsigned char *buffer = new unsigned char[width];
         int invert_bit = invert_alpha ? 1 : 0;
         for ( int y = 0 ; y < height ; y++ ) {
             unsigned char *row = image_stream->getLine();
+            unsigned char *buf_ptr = image.pixels.data() + y * row_size;
             if (color_map) {
-                color_map->getGrayLine(row, buffer, width);
+                color_map->getGrayLine(row, buf_ptr, width);
             } else {
-                unsigned char *buf_ptr = buffer;
                 for ( int x = 0 ; x < width ; x++ ) {
                     if ( row[x] ^ invert_bit ) {
                         *buf_ptr++ = 0;
@@ -2117,20 +2372,18 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
                     }
                 }
             }
-            png_write_row(png_ptr, (png_bytep)buffer);
         }
-        delete [] buffer;
-    } else if (color_map) {
-        image_stream = new ImageStream(str, width,
-                                       color_map->getNumPixelComps(),
-                                       color_map->getBits());
+    } else {
+        image_stream = std::make_unique<ImageStream>(str, width,
+                                                     color_map->getNumPixelComps(),
+                                                     color_map->getBits());
         image_stream->reset();
 
         // Convert RGB values
-        unsigned int *buffer = new unsigned int[width];
-        if (mask_colors) {
-            for ( int y = 0 ; y < height ; y++ ) {
-                unsigned char *row = image_stream->getLine();
+        for ( int y = 0 ; y < height ; y++ ) {
+            unsigned char *row = image_stream->getLine();
+            auto buffer = reinterpret_cast<unsigned int *>(image.pixels.data() + y * row_size);
+            if (mask_colors) {
                 color_map->getRGBLine(row, buffer, width);
 
                 unsigned int *dest = buffer;
@@ -2147,32 +2400,14 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
                     row += color_map->getNumPixelComps();
                     dest++;
                 }
-                // Write it to the PNG
-                png_write_row(png_ptr, (png_bytep)buffer);
-            }
-        } else {
-            for ( int i = 0 ; i < height ; i++ ) {
-                unsigned char *row = image_stream->getLine();
+            } else {
                 memset((void*)buffer, 0xff, sizeof(int) * width);
                 color_map->getRGBLine(row, buffer, width);
-                png_write_row(png_ptr, (png_bytep)buffer);
             }
         }
-        delete [] buffer;
-
-    } else {    // A colormap must be provided, so quit
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        if (!embed_image) {
-            fclose(fp);
-            g_free(file_name);
-        }
-        return nullptr;
     }
-    delete image_stream;
+    image_stream.reset();
     str->close();
-    // Close PNG
-    png_write_end(png_ptr, info_ptr);
-    png_destroy_write_struct(&png_ptr, &info_ptr);
 
     // Create repr
     Inkscape::XML::Node *image_node = _xml_doc->createElement("svg:image");
@@ -2190,21 +2425,185 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
     image_node->setAttribute("preserveAspectRatio", "none");
 
     // Create href
-    if (embed_image) {
-        // Append format specification to the URI
-        auto *base64String = g_base64_encode(png_buffer.data(), png_buffer.size());
-        auto png_data = std::string("data:image/png;base64,") + base64String;
-        g_free(base64String);
-        image_node->setAttributeOrRemoveIfEmpty("xlink:href", png_data);
+    if (_preferences->getAttributeBoolean("embedImages", true)) {
+        image.node = image_node;
+        _queueImage(std::move(image));
     } else {
-        fclose(fp);
-        image_node->setAttribute("xlink:href", file_name);
+        static std::atomic<int> counter = 0;
+        gchar *file_name = g_strdup_printf("%s_img%d.png", _docname, counter++);
+        FILE *fp = fopen(file_name, "wb");
+        bool written = fp && write_png(image, nullptr, fp);
+        if (fp) {
+            fclose(fp);
+        }
+        if (written) {
+            image_node->setAttribute("xlink:href", file_name);
+        }
         g_free(file_name);
+        if (!written) {
+            Inkscape::GC::release(image_node);
+            image_node = nullptr;
+        }
     }
 
     return image_node;
 }
 
+/**
+ * Keep the decoded image until the next flushImages(), which is done at the end of every page
+ * or when too much pixel data is waiting.
+ */
+void SvgBuilder::_queueImage(SvgPendingImage &&image)
+{
+    static constexpr std::size_t max_pending_bytes = 256 * 1024 * 1024;
+
+    Inkscape::GC::anchor(image.node);
+    _cache->pending_bytes += image.pixels.size();
+    _cache->pending_images.push_back(std::move(image));
+
+    if (_cache->pending_bytes > max_pending_bytes) {
+        flushImages();
+    }
+}
+
+/**
+ * Compress all the queued images into PNG data in parallel and write them into the document.
+ *
+ * Images with identical pixels, for example a logo repeated on every page, are only encoded
+ * once per import, even by builders working on other pages at the same time. They are stored
+ * once in the document when the top-level builder is done, see _shareImages().
+ */
+void SvgBuilder::flushImages()
+{
+    auto &pending = _cache->pending_images;
+    if (pending.empty()) {
+        return;
+    }
+
+    // The builders of pages built in parallel take turns with the pool, as does the canvas.
+    auto pool = get_global_dispatch_pool();
+    auto dispatch = [&](int count, dispatch_pool::dispatch_func const &func) {
+        if (!pool->try_dispatch(count, func)) {
+            for (int i = 0; i < count; i++) {
+                func(i, 0);
+            }
+        }
+    };
+
+    dispatch(pending.size(), [&](int i, int) {
+        auto &image = pending[i];
+        auto checksum = g_checksum_new(G_CHECKSUM_SHA256);
+        for (int v : {image.width, image.height, (int)image.alpha_only, (int)image.invert_alpha}) {
+            g_checksum_update(checksum, (guchar const *)&v, sizeof(v));
+        }
+        g_checksum_update(checksum, image.pixels.data(), image.pixels.size());
+        image.hash = g_checksum_get_string(checksum);
+        g_checksum_free(checksum);
+    });
+
+    // Only encode the data nobody has seen before, once.
+    std::vector<std::pair<SvgPendingImage const *, std::promise<std::string>>> to_encode;
+    std::vector<std::shared_future<std::string>> hrefs;
+    hrefs.reserve(pending.size());
+    {
+        auto &store = *_cache->images;
+        auto lock = std::scoped_lock(store.mutex);
+        for (auto const &image : pending) {
+            auto [it, inserted] = store.hrefs.try_emplace(image.hash);
+            if (inserted) {
+                it->second = to_encode.emplace_back(&image, std::promise<std::string>()).second.get_future().share();
+            }
+            hrefs.push_back(it->second);
+        }
+    }
+
+    dispatch(to_encode.size(), [&](int i, int) {
+        auto &[image, href] = to_encode[i];
+        std::string data;
+        std::vector<guchar> png_buffer;
+        if (write_png(*image, &png_buffer, nullptr)) {
+            // Append format specification to the URI
+            auto *base64String = g_base64_encode(png_buffer.data(), png_buffer.size());
+            data = std::string("data:image/png;base64,") + base64String;
+            g_free(base64String);
+        }
+        href.set_value(std::move(data));
+    });
+
+    for (std::size_t i = 0; i < pending.size(); i++) {
+        // Waits for other builders encoding the same data. If it failed, leave the image empty.
+        if (auto const &href = hrefs[i].get(); !href.empty()) {
+            pending[i].node->setAttribute("xlink:href", href);
+        }
+        Inkscape::GC::release(pending[i].node);
+    }
+    pending.clear();
+    _cache->pending_bytes = 0;
+}
+
+static void collect_images(Inkscape::XML::Node *node,
+                           std::unordered_map<std::string_view, std::vector<Inkscape::XML::Node *>> &images)
+{
+    if (!std::strcmp(node->name(), "svg:image")) {
+        // Only the images made by _createImage() can be replaced by a clone of a 1x1 image.
+        auto href = node->attribute("xlink:href");
+        if (href && g_str_has_prefix(href, "data:") && node->getAttributeDouble("width") == 1.0 &&
+            node->getAttributeDouble("height") == 1.0) {
+            images[href].push_back(node);
+        }
+    }
+    for (auto child = node->firstChild(); child; child = child->next()) {
+        collect_images(child, images);
+    }
+}
+
+/**
+ * When the same image data is used more than once, move a single <image> with it into the defs
+ * and turn every use of it into a clone, so that it is only stored once in the document.
+ */
+void SvgBuilder::_shareImages()
+{
+    std::unordered_map<std::string_view, std::vector<Inkscape::XML::Node *>> images;
+    collect_images(_root, images);
+
+    for (auto const &[data, uses] : images) {
+        if (uses.size() < 2) {
+            continue;
+        }
+        auto image = _xml_doc->createElement("svg:image");
+        image->setAttributeSvgDouble("width", 1);
+        image->setAttributeSvgDouble("height", 1);
+        image->setAttribute("preserveAspectRatio", "none");
+        image->setAttribute("xlink:href", data.data());
+        _addToDefs(image);
+        auto const href = std::string("#") + image->attribute("id");
+        Inkscape::GC::release(image);
+
+        for (auto node : uses) {
+            // Transform, style, mask and clip all carry over to the clone.
+            auto use = _xml_doc->createElement("svg:use");
+            for (auto const &attr : node->attributeList()) {
+                auto name = g_quark_to_string(attr.key);
+                if (strcmp(name, "xlink:href") && strcmp(name, "width") && strcmp(name, "height") &&
+                    strcmp(name, "preserveAspectRatio")) {
+                    use->setAttribute(name, attr.value);
+                }
+            }
+            use->setAttribute("xlink:href", href);
+            auto parent = node->parent();
+            auto ref = node->prev();
+            // Keeps the data the key points to alive while the other uses are replaced.
+            Inkscape::GC::anchor(node);
+            parent->removeChild(node);
+            parent->addChild(use, ref);
+            Inkscape::GC::release(use);
+        }
+        for (auto node : uses) {
+            Inkscape::GC::release(node);
+        }
+    }
+}
+
 /**
  * \brief Creates a <mask> with the specified width and height and adds to <defs>
  *  If we're not the top-level SvgBuilder, creates a <defs> too and adds the mask to it.
@@ -2219,15 +2618,15 @@ Inkscape::XML::Node *SvgBuilder::_createMask(double width, double height) {
     mask_node->setAttributeSvgDouble("height", height);
     // Append mask to defs
     if (_is_top_level) {
-        _doc->getDefs()->getRepr()->appendChild(mask_node);
+        _addToDefs(mask_node);
         Inkscape::GC::release(mask_node);
-        return _doc->getDefs()->getRepr()->lastChild();
+        return mask_node;
     } else {    // Work around for renderer bug when mask isn't defined in pattern
-        static int mask_count = 0;
+        static std::atomic<int> mask_count = 0;
         gchar *mask_id = g_strdup_printf("_mask%d", mask_count++);
         mask_node->setAttribute("id", mask_id);
         g_free(mask_id);
-        _doc->getDefs()->getRepr()->appendChild(mask_node);
+        _addToDefs(mask_node);
         Inkscape::GC::release(mask_node);
         return mask_node;
     }
@@ -2350,13 +2749,77 @@ Inkscape::XML::Node *SvgBuilder::_getGradientNode(Inkscape::XML::Node *node, boo
 {
     auto css = sp_repr_css_attr(node, "style");
     if (auto id = try_extract_uri_id(css->attribute(is_fill ? "fill" : "stroke"))) {
-        if (auto obj = _doc->getObjectById(*id)) {
-            return obj->getRepr();
-        }
+        return _getNodeById(*id);
     }
     return nullptr;
 }
 
+/**
+ * The defs of the document being built into.
+ */
+Inkscape::XML::Node *SvgBuilder::_getDefs()
+{
+    if (_doc) {
+        return _doc->getDefs()->getRepr();
+    }
+    if (!_cache->defs) {
+        _cache->defs = _xml_doc->createElement("svg:defs");
+        _xml_doc->root()->addChild(_cache->defs, nullptr);
+        Inkscape::GC::release(_cache->defs);
+    }
+    return _cache->defs;
+}
+
+/**
+ * Append a node to the defs, making sure that it has an id to be referenced by.
+ */
+void SvgBuilder::_addToDefs(Inkscape::XML::Node *node)
+{
+    _getDefs()->appendChild(node);
+    if (_doc) {
+        // The object tree has given it an id.
+        return;
+    }
+    if (auto id = node->attribute("id")) {
+        _setNodeId(node, id);
+    } else {
+        auto name = std::string_view(node->name());
+        if (name.starts_with("svg:")) {
+            name.remove_prefix(4);
+        }
+        _setNodeId(node, _cache->id_prefix + std::string(name) + std::to_string(++_cache->id_count));
+    }
+}
+
+/**
+ * Find a node of the document being built into by its id.
+ */
+Inkscape::XML::Node *SvgBuilder::_getNodeById(std::string const &id)
+{
+    if (_doc) {
+        auto obj = _doc->getObjectById(id);
+        return obj ? obj->getRepr() : nullptr;
+    }
+    auto it = _cache->ids.find(id);
+    // Nodes which have been removed since don't count.
+    return it != _cache->ids.end() && it->second->parent() ? it->second : nullptr;
+}
+
+void SvgBuilder::_setNodeId(Inkscape::XML::Node *node, std::string const &id)
+{
+    node->setAttribute("id", id);
+    if (!_doc) {
+        auto &entry = _cache->ids[id];
+        if (entry != node) {
+            Inkscape::GC::anchor(node);
+            if (entry) {
+                Inkscape::GC::release(entry);
+            }
+            entry = node;
+        }
+    }
+}
+
 bool SvgBuilder::_attrEqual(Inkscape::XML::Node *a, Inkscape::XML::Node *b, char const *attr)
 {
     return (!a->attribute(attr) && !b->attribute(attr)) || std::string(a->attribute(attr)) == b->attribute(attr);
@@ -2465,8 +2928,8 @@ void SvgBuilder::popGroup(GfxState *state)
             child->setAttributeSvgDouble("opacity", orig * grp);
 
             if (auto mask_id = try_extract_uri_id(parent->attribute("mask"))) {
-                if (auto obj = _doc->getObjectById(*mask_id)) {
-                    applyOptionalMask(obj->getRepr(), child);
+                if (auto mask = _getNodeById(*mask_id)) {
+                    applyOptionalMask(mask, child);
                 }
             }
             if (auto clip = parent->attribute("clip-path")) {
@@ -31,6 +31,7 @@ namespace Inkscape {
 #undef Operator
 
 #include <2geom/affine.h>
+#include <2geom/pathvector.h>
 #include <2geom/point.h>
 #include <cairo-ft.h>
 #include <glibmm/ustring.h>
@@ -55,12 +56,18 @@ class Stream;
 class XRef;
 
 class CairoFont;
+class CairoFontEngine;
 class SPCSSAttr;
 class ClipHistoryEntry;
 
+#include <future>
 #include <glib.h>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace Inkscape {
@@ -95,6 +102,59 @@ struct SvgGlyph {
     std::shared_ptr<CairoFont> cairo_font; // A pointer to the selected cairo font
 };
 
+/**
+ * Decoded image pixels waiting to be compressed into a PNG, see SvgBuilder::flushImages()
+ */
+struct SvgPendingImage {
+    Inkscape::XML::Node *node; // The <image> element which will receive the data
+    int width;
+    int height;
+    bool alpha_only;           // One grey channel instead of BGRA
+    bool invert_alpha;         // Ask libpng to invert the alpha channel
+    std::vector<unsigned char> pixels;
+    std::string hash;
+};
+
+/**
+ * PNG data uris of the images of one import by content hash, shared by the builders of pages
+ * built in parallel. A future is stored as soon as a builder starts encoding an image, so the
+ * others wait for it instead of encoding it again.
+ */
+struct SvgImageStore {
+    std::mutex mutex;
+    std::map<std::string, std::shared_future<std::string>> hrefs;
+};
+
+/**
+ * A clip which a builder with a document of its own couldn't decide on, because only the
+ * document can measure the node, see SvgBuilder::appendPages().
+ */
+struct SvgDeferredClip {
+    std::string d;          // The clip path, as SvgBuilder::_createClip() takes it
+    Geom::Affine transform;
+    bool even_odd;
+    Geom::PathVector area;  // The clip path to test the node against, see SvgBuilder::_shouldClip()
+};
+
+/**
+ * State shared by a builder and the builders of its patterns, across pages.
+ */
+struct SvgBuilderCache {
+    std::shared_ptr<CairoFontEngine> font_engine;
+    std::vector<SvgPendingImage> pending_images;
+    std::size_t pending_bytes = 0;
+    std::shared_ptr<SvgImageStore> images;
+
+    // Only used when building into a document of its own, see SvgBuilder::appendPages()
+    std::string id_prefix;                          // Keeps generated ids apart from other runs
+    unsigned id_count = 0;
+    std::map<std::string, Inkscape::XML::Node *> ids; // Anchored, in place of SPDocument::getObjectById()
+    Inkscape::XML::Node *defs = nullptr;
+    Inkscape::XML::Node *named_view = nullptr;    // Holds the pages
+    std::vector<std::pair<std::string, std::string>> metadata;
+    std::vector<SvgDeferredClip> deferred_clips;    // By the index in their node's svgbuilder:clip
+};
+
 /**
  * Builds the inner SVG representation using libpoppler from the calls of PdfParser.
  */
@@ -102,6 +162,7 @@ class SvgBuilder {
 public:
     SvgBuilder(SPDocument *document, gchar *docname, XRef *xref);
     SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root);
+    SvgBuilder(SvgBuilder const &main, XRef *xref, std::string id_prefix);
     virtual ~SvgBuilder();
 
     // Property setting
@@ -115,8 +176,14 @@ public:
         return _preferences;
     }
     void pushPage(const std::string &label, GfxState *state);
+    void skipPage(double width);
+    void appendPages(SvgBuilder &pages);
     void setPageMode(bool as_pages) { _as_pages = as_pages; }
 
+    std::shared_ptr<CairoFontEngine> getFontEngine() const { return _cache->font_engine; }
+    void setFontEngine(std::shared_ptr<CairoFontEngine> engine) { _cache->font_engine = std::move(engine); }
+    void flushImages();
+
     // Path adding
     bool shouldMergePath(bool is_fill, const std::string &path);
     bool mergePath(GfxState *state, bool is_fill, const std::string &path, bool even_odd = false);
@@ -200,6 +267,8 @@ private:
                                       GfxImageColorMap *color_map, bool interpolate,
                                       int *mask_colors, bool alpha_only=false,
                                       bool invert_alpha=false);
+    void _queueImage(SvgPendingImage &&image);
+    void _shareImages();
     Inkscape::XML::Node *_createMask(double width, double height);
     Inkscape::XML::Node *_createClip(const std::string &d, const Geom::Affine tr, bool even_odd);
 
@@ -228,8 +297,10 @@ private:
     std::vector<GfxState *> _mask_groups;
     int _clip_groups = 0;
 
-    Inkscape::XML::Node *_getClip(const Inkscape::XML::Node *node);
-    bool _shouldClip(const Inkscape::XML::Node *node) const;
+    Inkscape::XML::Node *_getClip(Inkscape::XML::Node *node);
+    std::optional<bool> _shouldClip(const Inkscape::XML::Node *node) const;
+    Geom::PathVector _getClipArea() const;
+    void _applyDeferredClips(SvgBuilder const &pages, Inkscape::XML::Node *node);
     Inkscape::XML::Node *_addToContainer(const char *name);
     Inkscape::XML::Node *_renderText(std::shared_ptr<CairoFont> cairo_font, double font_size,
                                      const Geom::Affine &transform,
@@ -238,6 +309,10 @@ private:
     void _setClipPath(Inkscape::XML::Node *node);
     void _addToContainer(Inkscape::XML::Node *node, bool release = true);
 
+    Inkscape::XML::Node *_getDefs();
+    void _addToDefs(Inkscape::XML::Node *node);
+    Inkscape::XML::Node *_getNodeById(std::string const &id);
+    void _setNodeId(Inkscape::XML::Node *node, std::string const &id);
     Inkscape::XML::Node *_getGradientNode(Inkscape::XML::Node *node, bool is_fill);
     static bool _attrEqual(Inkscape::XML::Node *a, Inkscape::XML::Node *b, char const *attr);
 
@@ -264,13 +339,14 @@ private:
     bool _for_softmask = false;
 
     bool _is_top_level;  // Whether this SvgBuilder is the top-level one
-    SPDocument *_doc;
+    SPDocument *_doc;    // Null when building into a document of its own on another thread
     gchar *_docname;    // Basename of the URI from which this document is created
     XRef *_xref;    // Cross-reference table from the PDF doc we're converting from
     Inkscape::XML::Document *_xml_doc;
     Inkscape::XML::Node *_root;  // Root node from the point of view of this SvgBuilder
     Inkscape::XML::Node *_container; // Current container (group/pattern/mask)
     Inkscape::XML::Node *_preferences;  // Preferences container node
+    std::shared_ptr<SvgBuilderCache> _cache; // Shared with the parent builder
     double _width;       // Document size in px
     double _height;       // Document size in px
 
@@ -222,20 +222,60 @@ std::optional<CapyPDF_TransparencyGroupId> Document::style_to_transparency_mask(
     return {};
 }
 
+/**
+ * Write the finished PDF and report how much the image and font caches saved.
+ */
+void Document::write()
+{
+    _gen.write();
+
+    g_info("PDF export: %u images embedded, %u image and %u font references reused, %zu bytes of "
+           "image data not re-encoded, %.1f ms spent encoding images.",
+           _stats.images_embedded, _stats.images_reused, _stats.fonts_reused, _stats.bytes_saved,
+           std::chrono::duration<double, std::milli>(_stats.encode_time).count());
+}
+
 /**
  * Add an image into the PDF stream, returns the image id if successful.
+ *
+ * Images are deduplicated by content, so the same raster data referenced many times
+ * (by clones or by copies of an embedded image) is only encoded into the PDF once.
  */
-std::optional<CapyPDF_ImageId> Document::load_image(Inkscape::URI const &uri, capypdf::ImagePdfProperties const &props)
+std::optional<CapyPDF_ImageId> Document::load_image(Inkscape::URI const &uri, CapyPDF_Image_Interpolation interpolation)
 {
     try {
+        std::string key;
+        std::string contents;
         if (uri.hasScheme("data")) {
-            auto contents = uri.getContents();
-            auto image = _gen.load_image_from_memory(contents.c_str(), contents.size());
-            return _gen.add_image(image, props);
+            contents = uri.getContents();
+            auto checksum = g_compute_checksum_for_data(G_CHECKSUM_SHA256, (guchar const *)contents.data(),
+                                                        contents.size());
+            key = checksum;
+            g_free(checksum);
         } else {
-            auto image = _gen.load_image(uri.toNativeFilename().c_str());
-            return _gen.add_image(image, props);
+            key = uri.toNativeFilename();
+        }
+        key += ":" + std::to_string(interpolation);
+
+        if (auto it = _image_cache.find(key); it != _image_cache.end()) {
+            _stats.images_reused++;
+            _stats.bytes_saved += contents.size();
+            return it->second;
         }
+
+        auto props = capypdf::ImagePdfProperties();
+        props.set_interpolate(interpolation);
+        // TODO: props.set_conversion_intent(...)
+
+        auto const start = std::chrono::steady_clock::now();
+        auto image = contents.empty() ? _gen.load_image(uri.toNativeFilename().c_str())
+                                      : _gen.load_image_from_memory(contents.c_str(), contents.size());
+        auto image_id = _gen.add_image(image, props);
+        _stats.encode_time += std::chrono::steady_clock::now() - start;
+        _stats.images_embedded++;
+
+        _image_cache[key] = image_id;
+        return image_id;
     } catch (Inkscape::BadURIException &e) {
         g_warning("Couldn't read image: %s", e.what());
     } catch (std::exception &e) {
@@ -14,6 +14,7 @@
 #define EXTENSION_INTERNAL_PDFOUTPUT_BUILDER_H
 
 #include <2geom/2geom.h>
+#include <chrono>
 #include <memory>
 #include <optional>
 
@@ -99,7 +100,7 @@ public:
 
     void add_page(PageContext &page);
     void set_label(uint32_t page, std::string const &label);
-    void write() { _gen.write(); }
+    void write();
 
     void set_filter_resolution(unsigned res = 0) { _filter_resolution = res; }
     unsigned get_filter_resolution() const { return _filter_resolution; }
@@ -138,7 +139,7 @@ private:
                                                           int to);
 
 public:
-    std::optional<CapyPDF_ImageId> load_image(Inkscape::URI const &uri, capypdf::ImagePdfProperties const &props);
+    std::optional<CapyPDF_ImageId> load_image(Inkscape::URI const &uri, CapyPDF_Image_Interpolation interpolation);
 
     CapyPDF_Device_Colorspace get_default_colorspace() const;
     CapyPDF_Device_Colorspace get_colorspace(std::shared_ptr<Colors::Space::AnySpace> const &space) const;
@@ -168,6 +169,17 @@ private:
     std::map<std::string, CapyPDF_TransparencyGroupId> _mask_cache;
     std::map<std::string, CapyPDF_PatternId> _pattern_cache;
     std::map<std::string, CapyPDF_FontId> _font_cache;
+    std::map<std::string, CapyPDF_ImageId> _image_cache;
+
+    // Embedding statistics, reported when the document is written.
+    struct EmbedStats
+    {
+        unsigned images_embedded = 0;
+        unsigned images_reused = 0;
+        unsigned fonts_reused = 0;
+        std::size_t bytes_saved = 0;
+        std::chrono::steady_clock::duration encode_time{};
+    } _stats;
 
     // Anchors are post-processed into pages
     std::set<SPAnchor const *> _anchors;
@@ -54,10 +54,6 @@ void DrawContext::paint_raster(SPImage const *image)
         return;
     }
 
-    auto props = capypdf::ImagePdfProperties();
-    props.set_interpolate(get_interpolation(image->style->image_rendering.computed));
-    // TODO: props.set_conversion_intent(...)
-
     // If pixbuf is requested AFTER getURI it will sometimes return zero. This is a bug.
     auto img_width = image->pixbuf->width();
     auto img_height = image->pixbuf->height();
@@ -94,7 +90,7 @@ void DrawContext::paint_raster(SPImage const *image)
         } else {
             g_warning("Unable to paint embedded SVG image into PDF.");
         }
-    } else if (auto image_id = _doc.load_image(uri, props)) {
+    } else if (auto image_id = _doc.load_image(uri, get_interpolation(image->style->image_rendering.computed))) {
         // Format the width and height into a transformation matrix, the image is a unit square painted
         // from the bottom upwards so must be scaled out and flipped. No cropping is needed.
         auto paint_box = image->get_paintbox(img_width, img_height, image_box);
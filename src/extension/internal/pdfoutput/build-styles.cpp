@@ -296,6 +296,8 @@ std::optional<CapyPDF_FontId> Document::get_font(std::string const &filename)
             std::cerr << "Can't load font: '" << filename.c_str() << "'\n";
             return {};
         }
+    } else {
+        _stats.fonts_reused++;
     }
     return _font_cache[filename];
 }
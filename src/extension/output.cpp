@@ -14,6 +14,7 @@
 #include "document.h"
 
 #include "io/sys.h"
+#include "debug/trace.h"
 #include "implementation/implementation.h"
 
 #include "xml/attribute-record.h"
@@ -218,6 +219,7 @@ Output::save(SPDocument *doc, gchar const *filename, bool detachbase)
         set_state(Extension::STATE_LOADED);
 
     if (loaded()) {
+        auto span = Debug::Trace::Span("extension", "save", get_id());
         imp->setDetachBase(detachbase);
         auto new_doc = doc->copy();
         new_doc->ensureUpToDate();
@@ -240,6 +242,7 @@ Output::export_raster(const SPDocument *doc, std::string png_filename, gchar con
         set_state(Extension::STATE_LOADED);
 
     if (loaded()) {
+        auto span = Debug::Trace::Span("extension", "export raster", get_id());
         imp->setDetachBase(detachbase);
         imp->export_raster(this, doc, png_filename, filename);
     }
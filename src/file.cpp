@@ -31,6 +31,7 @@
 # include "config.h"  // only include where actually required!
 #endif
 
+#include <unordered_set>
 #include <gtkmm.h>
 
 #include "desktop.h"
@@ -71,6 +72,7 @@
 #include "ui/interface.h"
 #include "ui/tools/tool-base.h"
 #include "util/recently-used-fonts.h"
+#include "xml/mutation-batch.h"
 #include "xml/rebase-hrefs.h"
 #include "xml/sp-css-attr.h"
 
@@ -602,6 +604,74 @@ sp_file_save_template(Gtk::Window &parentWindow, Glib::ustring name,
 ## I M P O R T
 ######################*/
 
+std::vector<Inkscape::XML::Node *> sp_import_copy_objects(SPDocument *clipdoc, SPDocument *target_document,
+                                                          Inkscape::XML::Node *target_parent,
+                                                          Inkscape::XML::Node *node_after,
+                                                          Inkscape::XML::Node *&clipboard)
+{
+    std::vector<Inkscape::XML::Node*> copies;
+    for (Inkscape::XML::Node *obj = clipdoc->getReprRoot()->firstChild() ; obj ; obj = obj->next()) {
+        // Don't copy metadata, defs, named views and internal clipboard contents to the document
+        if (!strcmp(obj->name(), "svg:defs")) {
+            continue;
+        }
+        if (!strcmp(obj->name(), "svg:metadata")) {
+            continue;
+        }
+        if (!strcmp(obj->name(), "sodipodi:namedview")) {
+            continue;
+        }
+        if (!strcmp(obj->name(), "inkscape:clipboard")) {
+            clipboard = obj;
+            continue;
+        }
+
+        Inkscape::XML::Node *obj_copy = obj->duplicate(target_document->getReprDoc());
+        target_parent->addChild(obj_copy, node_after);
+        node_after = obj_copy;
+        Inkscape::GC::release(obj_copy);
+        copies.push_back(obj_copy);
+    }
+    return copies;
+}
+
+std::vector<Inkscape::XML::Node *> sp_import_adjust_clones(SPDocument *target_document,
+                                                           std::vector<Inkscape::XML::Node *> const &copies)
+{
+    // Objects pasted after a clone were not there yet when it was pasted one at a time.
+    std::unordered_set<Inkscape::XML::Node *> later(copies.begin(), copies.end());
+    auto const pasted_later = [&] (Inkscape::XML::Node *node) {
+        for (; node; node = node->parent()) {
+            if (later.contains(node)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<Inkscape::XML::Node*> pasted_objects;
+    for (auto obj_copy : copies) {
+        later.erase(obj_copy);
+
+        // if we are pasting a clone to an already existing object, its
+        // transform is relative to the document, not to its original (see ui/clipboard.cpp)
+        auto spobject = target_document->getObjectByRepr(obj_copy);
+        auto use = cast<SPUse>(spobject);
+        if (use) {
+            SPItem *original = use->get_original();
+            if (original && !pasted_later(original->getRepr())) {
+                Geom::Affine relative_use_transform = original->transform.inverse() * use->transform;
+                obj_copy->setAttributeOrRemoveIfEmpty("transform", sp_svg_transform_write(relative_use_transform));
+            }
+        }
+
+        if (is<SPItem>(spobject)) {
+            pasted_objects.push_back(obj_copy);
+        }
+    }
+    return pasted_objects;
+}
+
 /**
  * Paste the contents of a document into the active desktop.
  * @param clipdoc The document to paste
@@ -645,44 +715,13 @@ void sp_import_document(SPDesktop *desktop, SPDocument *clipdoc, bool in_place,
 
     Inkscape::XML::Node* clipboard = nullptr;
     // copy objects
-    std::vector<Inkscape::XML::Node*> pasted_objects;
-    for (Inkscape::XML::Node *obj = root->firstChild() ; obj ; obj = obj->next()) {
-        // Don't copy metadata, defs, named views and internal clipboard contents to the document
-        if (!strcmp(obj->name(), "svg:defs")) {
-            continue;
-        }
-        if (!strcmp(obj->name(), "svg:metadata")) {
-            continue;
-        }
-        if (!strcmp(obj->name(), "sodipodi:namedview")) {
-            continue;
-        }
-        if (!strcmp(obj->name(), "inkscape:clipboard")) {
-            clipboard = obj;
-            continue;
-        }
-
-        Inkscape::XML::Node *obj_copy = obj->duplicate(target_document->getReprDoc());
-        target_parent->addChild(obj_copy, node_after);
-        node_after = obj_copy;
-        Inkscape::GC::release(obj_copy);
-
-        // if we are pasting a clone to an already existing object, its
-        // transform is relative to the document, not to its original (see ui/clipboard.cpp)
-        auto spobject = target_document->getObjectByRepr(obj_copy);
-        auto use = cast<SPUse>(spobject);
-        if (use) {
-            SPItem *original = use->get_original();
-            if (original) {
-                Geom::Affine relative_use_transform = original->transform.inverse() * use->transform;
-                obj_copy->setAttributeOrRemoveIfEmpty("transform", sp_svg_transform_write(relative_use_transform));
-            }
-        }
-
-        if (is<SPItem>(spobject)) {
-            pasted_objects.push_back(obj_copy);
-        }
+    std::vector<Inkscape::XML::Node*> copies;
+    {
+        // Observers such as the object tree only need to see the pasted objects once they are all in.
+        Inkscape::XML::MutationBatch batch(target_document->getReprDoc());
+        copies = sp_import_copy_objects(clipdoc, target_document, target_parent, node_after, clipboard);
     }
+    auto const pasted_objects = sp_import_adjust_clones(target_document, copies);
 
     std::vector<Inkscape::XML::Node*> pasted_objects_not;
     Geom::Affine doc2parent = layer->i2doc_affine().inverse();
@@ -865,30 +904,36 @@ file_import(SPDocument *in_doc, const std::string &path, Inkscape::Extension::Ex
         // Construct a new object representing the imported image,
         // and insert it into the current document.
         SPObject *new_obj = nullptr;
-        for (auto& child: doc->getRoot()->children) {
-            if (is<SPItem>(&child)) {
-                Inkscape::XML::Node *newitem = did_ungroup ? o->getRepr()->duplicate(xml_in_doc) : child.getRepr()->duplicate(xml_in_doc);
-
-                // convert layers to groups, and make sure they are unlocked
-                // FIXME: add "preserve layers" mode where each layer from
-                //        import is copied to the same-named layer in host
-                newitem->removeAttribute("inkscape:groupmode");
-                newitem->removeAttribute("sodipodi:insensitive");
-
-                if (newgroup) newgroup->appendChild(newitem);
-                else new_obj = place_to_insert->appendChildRepr(newitem);
-            }
+        Inkscape::XML::Node *new_repr = newgroup;
+        {
+            // Observers only need to see the result, not every copied object.
+            Inkscape::XML::MutationBatch batch(xml_in_doc);
+            for (auto& child: doc->getRoot()->children) {
+                if (is<SPItem>(&child)) {
+                    Inkscape::XML::Node *newitem = did_ungroup ? o->getRepr()->duplicate(xml_in_doc) : child.getRepr()->duplicate(xml_in_doc);
+
+                    // convert layers to groups, and make sure they are unlocked
+                    // FIXME: add "preserve layers" mode where each layer from
+                    //        import is copied to the same-named layer in host
+                    newitem->removeAttribute("inkscape:groupmode");
+                    newitem->removeAttribute("sodipodi:insensitive");
+
+                    if (newgroup) newgroup->appendChild(newitem);
+                    else place_to_insert->getRepr()->appendChild(new_repr = newitem);
+                }
 
-            // don't lose top-level defs or style elements
-            else if (child.getRepr()->type() == Inkscape::XML::NodeType::ELEMENT_NODE) {
-                const gchar *tag = child.getRepr()->name();
-                if (!strcmp(tag, "svg:style")) {
-                    in_doc->getRoot()->appendChildRepr(child.getRepr()->duplicate(xml_in_doc));
+                // don't lose top-level defs or style elements
+                else if (child.getRepr()->type() == Inkscape::XML::NodeType::ELEMENT_NODE) {
+                    const gchar *tag = child.getRepr()->name();
+                    if (!strcmp(tag, "svg:style")) {
+                        in_doc->getRoot()->getRepr()->appendChild(child.getRepr()->duplicate(xml_in_doc));
+                    }
                 }
             }
+            if (newgroup) place_to_insert->getRepr()->appendChild(newgroup);
         }
+        if (new_repr) new_obj = in_doc->getObjectByRepr(new_repr);
         in_doc->emitReconstructionFinish();
-        if (newgroup) new_obj = place_to_insert->appendChildRepr(newgroup);
 
         // release some stuff
         if (newgroup) Inkscape::GC::release(newgroup);
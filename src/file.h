@@ -18,6 +18,7 @@
 
 #include <glibmm/ustring.h>
 #include <string>
+#include <vector>
 #include "extension/system.h"
 
 class SPDesktop;
@@ -28,6 +29,9 @@ namespace Inkscape {
     namespace Extension {
         class Extension;
     }
+    namespace XML {
+        class Node;
+    }
 }
 
 namespace Gtk {
@@ -113,6 +117,23 @@ bool sp_file_save_dialog (Gtk::Window &parentWindow, SPDocument *doc, Inkscape::
 
 void sp_import_document(SPDesktop *desktop, SPDocument *clipdoc, bool in_place, bool on_page = false);
 
+/**
+ * Copies the objects of a clipboard document into a parent in the target document, after the
+ * given node. Sets clipboard to its inkscape:clipboard element, if it has one.
+ * Returns the copies.
+ */
+std::vector<Inkscape::XML::Node *> sp_import_copy_objects(SPDocument *clipdoc, SPDocument *target_document,
+                                                          Inkscape::XML::Node *target_parent,
+                                                          Inkscape::XML::Node *node_after,
+                                                          Inkscape::XML::Node *&clipboard);
+
+/**
+ * Makes the transforms of pasted clones of existing objects relative to them, once the copies
+ * are in the object tree. Returns the copies which are items.
+ */
+std::vector<Inkscape::XML::Node *> sp_import_adjust_clones(SPDocument *target_document,
+                                                           std::vector<Inkscape::XML::Node *> const &copies);
+
 // See src/actions/actions-file-window.h
 
 /**
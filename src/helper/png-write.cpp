@@ -15,6 +15,12 @@
  */
 
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <string>
+#include <vector>
 #include <2geom/rect.h>
 #include <2geom/transforms.h>
 
@@ -24,18 +30,27 @@
 #include "png-write.h"
 #include "rdf.h"
 
+#include "debug/trace.h"
+
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/drawing-context.h"
+#include "display/drawing-item.h"
 #include "display/drawing.h"
+#include "display/drawing-profiler.h"
+#include "display/threading.h"
 
 #include "io/sys.h"
 
 #include "object/sp-defs.h"
 #include "object/sp-item.h"
+#include "object/sp-item-group.h"
 #include "object/sp-root.h"
+#include "object/sp-use.h"
 
 #include "ui/interface.h"
 #include <glibmm/convert.h>
+#include <glibmm/miscutils.h>
 
 /* This is an example of how to use libpng to read and write PNG files.
  * The file libpng.txt is much more verbose then this.  If you have not
@@ -49,13 +64,22 @@
  * working PNG reader/writer, see pngtest.c, included in this distribution.
  */
 
+/// A strip of rows, rendered before libpng asks for it.
+struct SPEBPStrip {
+    int row = 0;
+    int num_rows = 0;
+    guchar const *px = nullptr; // in the format written, freed by the writer once taken
+    std::vector<guchar const *> rows;
+};
+
 struct SPEBP {
     unsigned long int width, height, sheight;
     guint32 background;
     Inkscape::Drawing *drawing; // it is assumed that all unneeded items are hidden
-    guchar *px;
     unsigned (*status)(float, void *);
     void *data;
+    std::vector<SPEBPStrip> strips; // rendered together, in order
+    std::size_t next_strip = 0;
 };
 
 /* write a png file */
@@ -124,6 +148,7 @@ void PngTextList::add(gchar const* key, gchar const* text)
 /**
  * Write to PNG.
  * 
+ * @arg doc The document whose metadata is written, or null to write none.
  * @arg filename Filename and path. Value is in UTF8 encoding.
  */
 static bool
@@ -216,7 +241,7 @@ sp_png_write_rgba_striped(SPDocument *doc,
     PngTextList textList;
 
     textList.add("Software", "www.inkscape.org"); // Made by Inkscape comment
-    {
+    if (doc) {
         const gchar* pngToDc[] = {"Title", "title",
                                "Author", "creator",
                                "Description", "description",
@@ -323,34 +348,31 @@ sp_png_write_rgba_striped(SPDocument *doc,
 
 
 /**
- *
+ * Free the strips libpng hasn't taken.
  */
-static int
-sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, void *data, int color_type, int bit_depth)
+static void
+sp_export_free_strips(SPEBP *ebp)
 {
-    struct SPEBP *ebp = (struct SPEBP *) data;
-
-    if (ebp->status) {
-        if (!ebp->status((float) row / ebp->height, ebp->data)) return 0;
+    for (auto &strip : ebp->strips) {
+        free(const_cast<guchar *>(strip.px));
     }
+    ebp->strips.clear();
+    ebp->next_strip = 0;
+}
 
-    num_rows = MIN(num_rows, static_cast<int>(ebp->sheight));
-    num_rows = MIN(num_rows, static_cast<int>(ebp->height - row));
-
-    /* Set area of interest */
-    // bbox is now set to the entire image to prevent discontinuities
-    // in the image when blur is used (the borders may still be a bit
-    // off, but that's less noticeable).
-    Geom::IntRect bbox = Geom::IntRect::from_xywh(0, row, ebp->width, num_rows);
-
-    /* Update to renderable state */
-    ebp->drawing->update(bbox);
-
-    int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, ebp->width);
-    unsigned char *px = g_new(guchar, num_rows * stride);
+/**
+ * Render an area of the drawing, as wide as the image, into a strip in the format written.
+ * Only the part of the area inside the clip, if any, is drawn on the background.
+ */
+static void
+sp_export_render_strip(SPEBP const *ebp, SPEBPStrip &strip, Geom::IntRect const &bbox, int color_type, int bit_depth,
+                       Geom::OptIntRect const &clip = {})
+{
+    int const stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, ebp->width);
+    unsigned char *px = g_new(guchar, strip.num_rows * stride);
 
     cairo_surface_t *s = cairo_image_surface_create_for_data(
-        px, CAIRO_FORMAT_ARGB32, ebp->width, num_rows, stride);
+        px, CAIRO_FORMAT_ARGB32, ebp->width, strip.num_rows, stride);
     Inkscape::DrawingContext dc(s, bbox.min());
     dc.setSource(ebp->background);
     dc.setOperator(CAIRO_OPERATOR_SOURCE);
@@ -358,18 +380,98 @@ sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, v
     dc.setOperator(CAIRO_OPERATOR_OVER);
 
     /* Render */
-    ebp->drawing->render(dc, bbox, 0);
+    if (clip) {
+        dc.rectangle(*clip);
+        dc.clip();
+    }
+    ebp->drawing->render(dc, clip ? *clip : bbox, 0);
     cairo_surface_destroy(s);
 
     // PNG stores data as unpremultiplied big-endian RGBA, which means
     // it's identical to the GdkPixbuf format.
-    convert_pixels_argb32_to_pixbuf(px, ebp->width, num_rows, stride,
+    convert_pixels_argb32_to_pixbuf(px, ebp->width, strip.num_rows, stride,
                                     /* RGBA to ARGB with A=0 */ ebp->background >> 8);
-    
+
     // If a custom bit depth or color type is asked, then convert rgb to grayscale, etc.
-    const guchar* new_data = pixbuf_to_png(rows, px, num_rows, ebp->width, stride, color_type, bit_depth);
-    *to_free = (void*) new_data;
-    free(px);
+    strip.px = pixbuf_to_png(strip.rows.data(), px, strip.num_rows, ebp->width, stride, color_type, bit_depth);
+    g_free(px);
+}
+
+/**
+ * Render the strips starting at the given row, as many at a time as there are threads, or
+ * all that remain.
+ */
+static void
+sp_export_render_strips(SPEBP *ebp, int row, int color_type, int bit_depth, bool all = false)
+{
+    sp_export_free_strips(ebp);
+
+    auto const pool = Inkscape::get_global_branch_pool();
+    int const stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, ebp->width);
+
+    // Keep the strips rendered ahead to 64 MiB, unless a single one takes more.
+    int const remaining = (ebp->height - row + ebp->sheight - 1) / ebp->sheight;
+    int const affordable = (64 << 20) / (static_cast<std::size_t>(stride) * ebp->sheight);
+    int const count = all ? remaining : std::clamp(std::min(pool->size(), affordable), 1, remaining);
+
+    ebp->strips.resize(count);
+    for (int i = 0; i < count; i++) {
+        auto &strip = ebp->strips[i];
+        strip.row = row + i * ebp->sheight;
+        strip.num_rows = std::min<int>(ebp->sheight, ebp->height - strip.row);
+        strip.rows.resize(strip.num_rows);
+    }
+
+    /* Set area of interest */
+    // bbox is now set to the entire image to prevent discontinuities
+    // in the image when blur is used (the borders may still be a bit
+    // off, but that's less noticeable).
+    auto const &last = ebp->strips.back();
+    Geom::IntRect const area = Geom::IntRect::from_xywh(0, row, ebp->width, last.row + last.num_rows - row);
+
+    auto const profiler = ebp->drawing->profiler();
+    if (profiler) {
+        profiler->beginFrame();
+    }
+
+    /* Update to renderable state */
+    ebp->drawing->update(area);
+
+    // The drawing can render areas concurrently once it's updated. Filters inside dispatch
+    // their rows to the global pool, which is why the strips go to the branch pool.
+    pool->dispatch_threshold(count, count > 1, [&] (int i, int) {
+        auto span = Inkscape::Debug::Trace::Span("export", "strip");
+        auto &strip = ebp->strips[i];
+        sp_export_render_strip(ebp, strip, Geom::IntRect::from_xywh(0, strip.row, ebp->width, strip.num_rows),
+                               color_type, bit_depth);
+    });
+
+    if (profiler) {
+        profiler->endFrame();
+    }
+}
+
+/**
+ *
+ */
+static int
+sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, void *data, int color_type, int bit_depth)
+{
+    struct SPEBP *ebp = (struct SPEBP *) data;
+
+    if (ebp->status) {
+        if (!ebp->status((float) row / ebp->height, ebp->data)) return 0;
+    }
+
+    if (ebp->next_strip >= ebp->strips.size() || ebp->strips[ebp->next_strip].row != row) {
+        sp_export_render_strips(ebp, row, color_type, bit_depth);
+    }
+
+    auto &strip = ebp->strips[ebp->next_strip++];
+    num_rows = MIN(num_rows, strip.num_rows);
+    std::copy_n(strip.rows.begin(), num_rows, rows);
+    *to_free = const_cast<guchar *>(strip.px);
+    strip.px = nullptr;
 
     return num_rows;
 }
@@ -380,10 +482,12 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                                 unsigned long bgcolor,
                                 unsigned int (*status) (float, void *),
                                 void *data, bool force_overwrite,
-                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing,
+                                std::shared_ptr<Inkscape::DrawingProfiler> const &profiler)
 {
     return sp_export_png_file(doc, filename, Geom::Rect(Geom::Point(x0,y0),Geom::Point(x1,y1)),
-                              width, height, xdpi, ydpi, bgcolor, status, data, force_overwrite, items_only, interlace, color_type, bit_depth, zlib, antialiasing);
+                              width, height, xdpi, ydpi, bgcolor, status, data, force_overwrite, items_only, interlace, color_type, bit_depth, zlib, antialiasing,
+                              profiler);
 }
 
 /**
@@ -398,9 +502,45 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                                 unsigned long bgcolor,
                                 unsigned (*status)(float, void *),
                                 void *data, bool force_overwrite,
-                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing,
+                                std::shared_ptr<Inkscape::DrawingProfiler> const &profiler)
 {
     g_return_val_if_fail(doc != nullptr, EXPORT_ERROR);
+
+    return PngExportDrawing(doc).exportFile(filename, area, width, height, xdpi, ydpi, bgcolor, status, data,
+                                            force_overwrite, items_only, interlace, color_type, bit_depth, zlib,
+                                            antialiasing, profiler);
+}
+
+PngExportDrawing::PngExportDrawing(SPDocument *doc)
+    : _doc(doc)
+    , _drawing(std::make_unique<Inkscape::Drawing>())
+    , _dkey(SPItem::display_key_new(1))
+{
+    auto span = Inkscape::Debug::Trace::Span("export", "show document");
+    _doc->ensureUpToDate();
+    _drawing->setRoot(_doc->getRoot()->invoke_show(*_drawing, _dkey, SP_ITEM_SHOW_DISPLAY));
+    _drawing->setExact(); // export with maximum blur rendering quality
+}
+
+PngExportDrawing::~PngExportDrawing()
+{
+    // Hide items, this releases arenaitem
+    _doc->getRoot()->invoke_hide(_dkey);
+}
+
+/**
+ * Export an area to a PNG file, like sp_export_png_file().
+ */
+ExportResult PngExportDrawing::exportFile(gchar const *filename,
+                                          Geom::Rect const &area,
+                                          unsigned long width, unsigned long height, double xdpi, double ydpi,
+                                          unsigned long bgcolor,
+                                          unsigned (*status)(float, void *),
+                                          void *data, bool force_overwrite,
+                                          std::vector<SPItem const *> const &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing,
+                                          std::shared_ptr<Inkscape::DrawingProfiler> const &profiler)
+{
     g_return_val_if_fail(filename != nullptr, EXPORT_ERROR);
     g_return_val_if_fail(width >= 1, EXPORT_ERROR);
     g_return_val_if_fail(height >= 1, EXPORT_ERROR);
@@ -411,7 +551,8 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 	return EXPORT_ABORTED;
     }
 
-    doc->ensureUpToDate();
+    auto span = Inkscape::Debug::Trace::Span("export", "png", filename);
+    _doc->ensureUpToDate();
 
     /* Calculate translation by transforming to document coordinates (flipping Y)*/
     Geom::Point translation = -area.min();
@@ -441,39 +582,370 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
     ebp.height = height;
     ebp.background = bgcolor;
 
-    /* Create new drawing */
-    Inkscape::Drawing drawing;
-    unsigned const dkey = SPItem::display_key_new(1);
-    drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
-    drawing.root()->setTransform(affine);
-    drawing.setExact(); // export with maximum blur rendering quality
-    drawing.setAntialiasingOverride(static_cast<Inkscape::Antialiasing>(antialiasing));
+    /* Reuse the drawing, only its transform and hidden items change between exports */
+    _drawing->root()->setTransform(affine);
+    _drawing->setAntialiasingOverride(static_cast<Inkscape::Antialiasing>(antialiasing));
+    _drawing->setProfiler(profiler);
 
-    ebp.drawing = &drawing;
+    ebp.drawing = _drawing.get();
 
     // We show all and then hide all items we don't want, instead of showing only requested items,
     // because that would not work if the shown item references something in defs
     if (!items_only.empty()) {
-        doc->getRoot()->invoke_hide_except(dkey, items_only);
+        _hideExcept(_doc->getRoot(), items_only);
     }
 
     ebp.status = status;
     ebp.data   = data;
+    ebp.sheight = 64;
 
-    bool write_status = false;;
+    bool const write_status = sp_png_write_rgba_striped(_doc, filename, width, height, xdpi, ydpi, sp_export_get_rows, &ebp, interlace, color_type, bit_depth, zlib);
+    sp_export_free_strips(&ebp);
 
-    ebp.sheight = 64;
-    ebp.px = g_try_new(guchar, 4 * ebp.sheight * width);
+    _showHidden();
+    _drawing->setProfiler({});
+
+    return write_status ? EXPORT_OK : EXPORT_ERROR;
+}
+
+/**
+ * Export an area to a PNG file for each of the targets, like exportFile() does one by one.
+ *
+ * The document is updated once for all of them. Each image not larger than 64 MiB is rendered
+ * whole, and encoded and written by another thread while the next one renders; larger ones
+ * are exported one strip at a time. Existing files are overwritten.
+ *
+ * @return EXPORT_OK if all files were written, EXPORT_ERROR otherwise.
+ */
+ExportResult PngExportDrawing::exportFiles(std::vector<PngExportTarget> const &targets,
+                                           Geom::Rect const &area, unsigned long bgcolor,
+                                           std::vector<SPItem const *> const &items_only,
+                                           int color_type, int bit_depth, int zlib, int antialiasing)
+{
+    g_return_val_if_fail(!area.hasZeroArea(), EXPORT_ERROR);
+
+    auto span = Inkscape::Debug::Trace::Span("export", "png sizes");
+    _doc->ensureUpToDate();
 
-    if (ebp.px) {
-        write_status = sp_png_write_rgba_striped(doc, filename, width, height, xdpi, ydpi, sp_export_get_rows, &ebp, interlace, color_type, bit_depth, zlib);
-        g_free(ebp.px);
+    _drawing->setAntialiasingOverride(static_cast<Inkscape::Antialiasing>(antialiasing));
+    if (!items_only.empty()) {
+        _hideExcept(_doc->getRoot(), items_only);
     }
 
-    // Hide items, this releases arenaitem
-    doc->getRoot()->invoke_hide(dkey);
+    bool ok = true;
+    std::unique_ptr<SPEBP> writing_ebp;
+    std::future<bool> writing;
+    auto const finish_writing = [&] {
+        if (writing.valid()) {
+            ok = writing.get() && ok;
+            sp_export_free_strips(writing_ebp.get());
+            writing_ebp.reset();
+        }
+    };
 
-    return write_status ? EXPORT_OK : EXPORT_ERROR;
+    for (auto const &target : targets) {
+        if (target.width < 1 || target.height < 1) {
+            g_warning("Cannot export %s at %lux%lu pixels", target.filename.c_str(), target.width, target.height);
+            ok = false;
+            continue;
+        }
+
+        auto ebp = std::make_unique<SPEBP>();
+        ebp->width = target.width;
+        ebp->height = target.height;
+        ebp->sheight = 64;
+        ebp->background = bgcolor;
+        ebp->drawing = _drawing.get();
+        ebp->status = nullptr;
+        ebp->data = nullptr;
+
+        _drawing->root()->setTransform(Geom::Translate(-area.min())
+                                       * Geom::Scale(target.width / area.width(), target.height / area.height()));
+
+        auto const stride = static_cast<std::size_t>(cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, target.width));
+        if (stride * target.height > (64 << 20)) {
+            finish_writing();
+            auto const file_span = Inkscape::Debug::Trace::Span("export", "png", target.filename.c_str());
+            ok = sp_png_write_rgba_striped(_doc, target.filename.c_str(), target.width, target.height,
+                                           target.dpi, target.dpi, sp_export_get_rows, ebp.get(), false,
+                                           color_type, bit_depth, zlib) && ok;
+            sp_export_free_strips(ebp.get());
+            continue;
+        }
+
+        // Only one file is written at a time, since reading the metadata isn't thread safe.
+        sp_export_render_strips(ebp.get(), 0, color_type, bit_depth, true);
+        finish_writing();
+        writing_ebp = std::move(ebp);
+        writing = std::async(std::launch::async, [this, &target, ebp = writing_ebp.get(), color_type, bit_depth, zlib] {
+            auto const file_span = Inkscape::Debug::Trace::Span("export", "png", target.filename.c_str());
+            return sp_png_write_rgba_striped(_doc, target.filename.c_str(), target.width, target.height,
+                                             target.dpi, target.dpi, sp_export_get_rows, ebp, false,
+                                             color_type, bit_depth, zlib);
+        });
+    }
+    finish_writing();
+
+    _showHidden();
+
+    return ok ? EXPORT_OK : EXPORT_ERROR;
+}
+
+/**
+ * Write the descriptor of a Deep Zoom image.
+ */
+static bool
+sp_export_write_dzi(std::string const &filename, unsigned long width, unsigned long height, int tile_size)
+{
+    FILE *fp = Inkscape::IO::fopen_utf8name(filename.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" Format=\"png\" Overlap=\"0\" TileSize=\"%d\">\n"
+                "  <Size Width=\"%lu\" Height=\"%lu\"/>\n"
+                "</Image>\n", tile_size, width, height);
+    return fclose(fp) == 0;
+}
+
+/**
+ * Render a tile of the drawing and write it to a PNG file without metadata.
+ *
+ * @param bbox Area of the tile in pixels of the updated drawing.
+ * @param clip Area of the tile the image covers, if not all of it.
+ */
+static bool
+sp_export_write_tile(Inkscape::Drawing *drawing, std::string const &filename, Geom::IntRect const &bbox,
+                     Geom::OptIntRect const &clip, double dpi, guint32 bgcolor, int zlib)
+{
+    auto span = Inkscape::Debug::Trace::Span("export", "tile", filename.c_str());
+
+    SPEBP ebp;
+    ebp.width = bbox.width();
+    ebp.height = bbox.height();
+    ebp.sheight = bbox.height();
+    ebp.background = bgcolor;
+    ebp.drawing = drawing;
+    ebp.status = nullptr;
+    ebp.data = nullptr;
+
+    auto &strip = ebp.strips.emplace_back();
+    strip.num_rows = bbox.height();
+    strip.rows.resize(strip.num_rows);
+    sp_export_render_strip(&ebp, strip, bbox, 6, 8, clip);
+
+    bool const ok = sp_png_write_rgba_striped(nullptr, filename.c_str(), ebp.width, ebp.height, dpi, dpi,
+                                              sp_export_get_rows, &ebp, false, 6, 8, zlib);
+    sp_export_free_strips(&ebp);
+    return ok;
+}
+
+/**
+ * Export an area as a pyramid of PNG tiles for map and deep zoom viewers. Each level is half
+ * the size of the next, down to a single tile for XYZ and a single pixel for Deep Zoom.
+ *
+ * The tiles are rendered straight from the drawing, as many at a time as there are threads, so
+ * memory doesn't grow with the size of the image. With a transparent background, the tiles
+ * that no visible item is drawn in aren't written. Existing files are overwritten.
+ *
+ * @param path The directory to write the XYZ tiles to, or the name of the Deep Zoom image
+ *             without the .dzi extension. Value is UTF8 encoded.
+ * @param width Width of the last, full resolution level.
+ * @param height Height of the last, full resolution level.
+ * @param dpi Resolution of the last level.
+ */
+ExportResult PngExportDrawing::exportTiles(std::string const &path, TileLayout layout,
+                                           Geom::Rect const &area,
+                                           unsigned long width, unsigned long height, double dpi,
+                                           int tile_size, unsigned long bgcolor,
+                                           std::vector<SPItem const *> const &items_only, int zlib, int antialiasing)
+{
+    g_return_val_if_fail(!path.empty(), EXPORT_ERROR);
+    g_return_val_if_fail(width >= 1, EXPORT_ERROR);
+    g_return_val_if_fail(height >= 1, EXPORT_ERROR);
+    g_return_val_if_fail(tile_size >= 1, EXPORT_ERROR);
+    g_return_val_if_fail(!area.hasZeroArea(), EXPORT_ERROR);
+
+    auto span = Inkscape::Debug::Trace::Span("export", "tiles", path.c_str());
+    _doc->ensureUpToDate();
+
+    unsigned long const smallest = layout == TileLayout::XYZ ? tile_size : 1;
+    int max_level = 0;
+    while ((smallest << max_level) < std::max(width, height)) {
+        max_level++;
+    }
+
+    auto tile_dir = path;
+    if (layout == TileLayout::DEEP_ZOOM) {
+        tile_dir += "_files";
+        if (!sp_export_write_dzi(path + ".dzi", width, height, tile_size)) {
+            return EXPORT_ERROR;
+        }
+    }
+
+    Geom::Affine const affine(Geom::Translate(-area.min())
+                            * Geom::Scale(width / area.width(), height / area.height()));
+    _drawing->setAntialiasingOverride(static_cast<Inkscape::Antialiasing>(antialiasing));
+    if (!items_only.empty()) {
+        _hideExcept(_doc->getRoot(), items_only);
+    }
+
+    // Empty tiles would only hold the background.
+    bool const skip_empty = (bgcolor & 0xff) == 0;
+    auto const pool = Inkscape::get_global_branch_pool();
+    std::atomic<bool> failed = false;
+
+    for (int level = 0; level <= max_level && !failed; level++) {
+        auto level_span = Inkscape::Debug::Trace::Span("export", "tile level", std::to_string(level).c_str());
+        double const scale = std::ldexp(1.0, level - max_level);
+        Geom::IntRect const level_area(0, 0, static_cast<int>(std::ceil(width * scale)),
+                                       static_cast<int>(std::ceil(height * scale)));
+        int const cols = (level_area.width() + tile_size - 1) / tile_size;
+        int const rows = (level_area.height() + tile_size - 1) / tile_size;
+        auto const level_dir = Glib::build_filename(tile_dir, std::to_string(level));
+
+        _drawing->root()->setTransform(affine * Geom::Scale(scale));
+        _drawing->update(level_area);
+
+        std::vector<bool> drawn(cols * rows, !skip_empty);
+        if (skip_empty) {
+            _markTiles(_doc->getRoot(), tile_size, cols, rows, drawn);
+        }
+
+        struct Tile
+        {
+            std::string filename;
+            Geom::IntRect bbox;
+            Geom::OptIntRect clip;
+        };
+        std::vector<Tile> batch;
+        std::vector<bool> dirs(layout == TileLayout::XYZ ? cols : 1, false);
+
+        // Only as many tiles as there are threads are in memory at once.
+        auto const flush = [&] {
+            int const count = batch.size();
+            pool->dispatch_threshold(count, count > 1, [&] (int i, int) {
+                auto const &tile = batch[i];
+                if (!sp_export_write_tile(_drawing.get(), tile.filename, tile.bbox, tile.clip, dpi * scale,
+                                          bgcolor, zlib)) {
+                    failed = true;
+                }
+            });
+            batch.clear();
+        };
+
+        for (int y = 0; y < rows && !failed; y++) {
+            for (int x = 0; x < cols && !failed; x++) {
+                if (!drawn[y * cols + x]) {
+                    continue;
+                }
+
+                auto const bbox = Geom::IntRect::from_xywh(x * tile_size, y * tile_size, tile_size, tile_size);
+                auto &tile = batch.emplace_back();
+                std::string dir;
+                if (layout == TileLayout::XYZ) {
+                    // Square tiles, with only the background past the end of the image.
+                    dir = Glib::build_filename(level_dir, std::to_string(x));
+                    tile.filename = Glib::build_filename(dir, std::to_string(y) + ".png");
+                    tile.bbox = bbox;
+                    tile.clip = Geom::intersect(bbox, level_area);
+                } else {
+                    dir = level_dir;
+                    tile.filename = Glib::build_filename(dir, std::to_string(x) + "_" + std::to_string(y) + ".png");
+                    tile.bbox = *Geom::intersect(bbox, level_area);
+                }
+
+                int const dir_index = layout == TileLayout::XYZ ? x : 0;
+                if (!dirs[dir_index]) {
+                    if (g_mkdir_with_parents(Glib::filename_from_utf8(dir).c_str(), 0755) != 0) {
+                        g_warning("Could not create directory %s", dir.c_str());
+                        failed = true;
+                        break;
+                    }
+                    dirs[dir_index] = true;
+                }
+
+                if (batch.size() >= static_cast<std::size_t>(pool->size())) {
+                    flush();
+                }
+            }
+        }
+        if (!failed) {
+            flush();
+        }
+    }
+
+    _showHidden();
+
+    return failed ? EXPORT_ERROR : EXPORT_OK;
+}
+
+/**
+ * Mark the tiles of the current level that a visible item under the given one is drawn in.
+ * Unfiltered groups are looked into, since their own drawing box can be much larger than
+ * the areas their children cover.
+ */
+void PngExportDrawing::_markTiles(SPItem *item, int tile_size, int cols, int rows, std::vector<bool> &tiles) const
+{
+    auto const drawing_item = item->get_arenaitem(_dkey);
+    if (!drawing_item || !drawing_item->visible()) {
+        return;
+    }
+
+    if (is<SPGroup>(item) && !item->isFiltered()) {
+        for (auto &child : item->children) {
+            if (auto child_item = cast<SPItem>(&child)) {
+                _markTiles(child_item, tile_size, cols, rows, tiles);
+            }
+        }
+        return;
+    }
+
+    auto const box = Geom::intersect(Geom::IntRect(0, 0, cols * tile_size, rows * tile_size), drawing_item->drawbox());
+    if (!box || box->hasZeroArea()) {
+        return;
+    }
+    for (int y = box->top() / tile_size; y <= (box->bottom() - 1) / tile_size; y++) {
+        for (int x = box->left() / tile_size; x <= (box->right() - 1) / tile_size; x++) {
+            tiles[y * cols + x] = true;
+        }
+    }
+}
+
+/**
+ * Show the items hidden for the current export again.
+ */
+void PngExportDrawing::_showHidden()
+{
+    for (auto item : _hidden) {
+        item->setVisible(true);
+    }
+    _hidden.clear();
+}
+
+/**
+ * Hide the items SPItem::invoke_hide_except() would, but only until the end of the export.
+ */
+void PngExportDrawing::_hideExcept(SPItem *item, std::vector<SPItem const *> const &items_only)
+{
+    if (std::find(items_only.begin(), items_only.end(), item) != items_only.end()) {
+        return;
+    }
+
+    // Only hide the item if it's not a group, root or use. Hiding it hides its descendants.
+    if (!is<SPRoot>(item) && !is<SPGroup>(item) && !is<SPUse>(item)) {
+        if (auto const drawing_item = item->get_arenaitem(_dkey); drawing_item && drawing_item->visible()) {
+            drawing_item->setVisible(false);
+            _hidden.push_back(drawing_item);
+        }
+        return;
+    }
+
+    for (auto &child : item->children) {
+        if (auto child_item = cast<SPItem>(&child)) {
+            _hideExcept(child_item, items_only);
+        }
+    }
 }
 
 
@@ -16,6 +16,8 @@
  */
 
 #include <glib.h> // Only for gchar.
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <2geom/forward.h>
@@ -23,14 +25,105 @@
 class SPDocument;
 class SPItem;
 
+namespace Inkscape {
+class Drawing;
+class DrawingItem;
+class DrawingProfiler;
+} // namespace Inkscape
+
 enum ExportResult {
     EXPORT_ERROR = 0,
     EXPORT_OK,
     EXPORT_ABORTED
 };
 
+/// One of the files of a multi-size export.
+struct PngExportTarget {
+    std::string filename; ///< Filename and path, UTF8 encoded.
+    unsigned long int width;
+    unsigned long int height;
+    double dpi;
+};
+
+/// How the tiles of a tile pyramid are laid out on disk.
+enum class TileLayout {
+    XYZ,      ///< <dir>/<zoom>/<x>/<y>.png, square tiles, as slippy map viewers expect.
+    DEEP_ZOOM ///< <name>.dzi and <name>_files/<level>/<col>_<row>.png, as OpenSeadragon expects.
+};
+
+/**
+ * A drawing of a document that any number of PNG exports are rendered from.
+ *
+ * Showing a document builds the rendering tree of all of it, which is usually more work than
+ * rendering a small item of it. Exports of many items or sizes, like batch exports, share one
+ * drawing this way: between exports, only its transform and the items hidden change.
+ *
+ * The document must outlive the drawing, and should not change while an export runs.
+ */
+class PngExportDrawing
+{
+public:
+    explicit PngExportDrawing(SPDocument *doc);
+    ~PngExportDrawing();
+    PngExportDrawing(PngExportDrawing const &) = delete;
+    PngExportDrawing &operator=(PngExportDrawing const &) = delete;
+
+    SPDocument *document() const { return _doc; }
+
+    ExportResult exportFile(gchar const *filename,
+                            Geom::Rect const &area,
+                            unsigned long int width,
+                            unsigned long int height,
+                            double xdpi,
+                            double ydpi,
+                            unsigned long bgcolor,
+                            unsigned int (*status) (float, void *),
+                            void *data,
+                            bool force_overwrite = false,
+                            std::vector<SPItem const *> const &items_only = {},
+                            bool interlace = false,
+                            int color_type = 6,
+                            int bit_depth = 8,
+                            int zlib = 6,
+                            int antialiasing = 2,
+                            std::shared_ptr<Inkscape::DrawingProfiler> const &profiler = {});
+
+    ExportResult exportFiles(std::vector<PngExportTarget> const &targets,
+                             Geom::Rect const &area,
+                             unsigned long bgcolor,
+                             std::vector<SPItem const *> const &items_only = {},
+                             int color_type = 6,
+                             int bit_depth = 8,
+                             int zlib = 6,
+                             int antialiasing = 2);
+
+    ExportResult exportTiles(std::string const &path,
+                             TileLayout layout,
+                             Geom::Rect const &area,
+                             unsigned long int width,
+                             unsigned long int height,
+                             double dpi,
+                             int tile_size,
+                             unsigned long bgcolor,
+                             std::vector<SPItem const *> const &items_only = {},
+                             int zlib = 6,
+                             int antialiasing = 2);
+
+private:
+    void _hideExcept(SPItem *item, std::vector<SPItem const *> const &items_only);
+    void _showHidden();
+    void _markTiles(SPItem *item, int tile_size, int cols, int rows, std::vector<bool> &tiles) const;
+
+    SPDocument *_doc;
+    std::unique_ptr<Inkscape::Drawing> _drawing;
+    unsigned _dkey;
+    std::vector<Inkscape::DrawingItem *> _hidden; ///< Hidden until the end of the current export.
+};
+
 /**
  * Export the given document as a Portable Network Graphics (PNG) file.
+ * If a profiler is given, each batch of strips of rows rendered together is recorded to it
+ * as a frame. To export more than one area or item of a document, use a PngExportDrawing.
  *
  * @return EXPORT_OK if succeeded, EXPORT_ABORTED if no action was taken, EXPORT_ERROR (false) if an error occurred.
  */
@@ -50,7 +143,8 @@ ExportResult sp_export_png_file(SPDocument *doc,
                                 int color_type = 6,
                                 int bit_depth = 8,
                                 int zlib = 6,
-                                int antialiasing = 2);
+                                int antialiasing = 2,
+                                std::shared_ptr<Inkscape::DrawingProfiler> const &profiler = {});
 
 ExportResult sp_export_png_file(SPDocument *doc,
                                 gchar const *filename,
@@ -68,6 +162,7 @@ ExportResult sp_export_png_file(SPDocument *doc,
                                 int color_type = 6,
                                 int bit_depth = 8,
                                 int zlib = 6,
-                                int antialiasing = 2);
+                                int antialiasing = 2,
+                                std::shared_ptr<Inkscape::DrawingProfiler> const &profiler = {});
 
 #endif // SEEN_SP_PNG_WRITE_H
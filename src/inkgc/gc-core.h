@@ -122,6 +122,25 @@ inline void init() {
 
 void request_early_collection();
 
+void allow_threads();
+
+/**
+ * Registers the calling thread with the collector while it exists, so that the thread can
+ * allocate collectable memory and the pointers on its stack are seen by collections.
+ * allow_threads() must have been called from the main thread first.
+ */
+class ThreadScope
+{
+public:
+    ThreadScope();
+    ~ThreadScope();
+    ThreadScope(ThreadScope const &) = delete;
+    ThreadScope &operator=(ThreadScope const &) = delete;
+
+private:
+    bool _registered = false;
+};
+
 }
 }
 
@@ -11,6 +11,7 @@
  */
 
 #include "inkgc/gc-core.h"
+#include <mutex>
 #include <stdexcept>
 #include <cstring>
 #include <string>
@@ -24,6 +25,8 @@ namespace GC {
 
 namespace {
 
+bool collector_running = false;
+
 void display_warning(char *msg, GC_word arg) {
     g_warning(msg, arg);
 }
@@ -36,6 +39,7 @@ void do_init() {
     GC_INIT();
 
     GC_set_warn_proc(&display_warning);
+    collector_running = true;
 }
 
 void *debug_malloc(std::size_t size) {
@@ -298,6 +302,35 @@ void request_early_collection() {
     }
 }
 
+/**
+ * Let other threads use collectable memory while they hold a ThreadScope. Until this is
+ * called the collector doesn't lock around allocations, so it must be called from the main
+ * thread before starting such threads.
+ */
+void allow_threads() {
+    static std::once_flag once;
+    if (collector_running) {
+        std::call_once(once, &GC_allow_register_threads);
+    }
+}
+
+ThreadScope::ThreadScope() {
+    if (!collector_running) {
+        return;
+    }
+    GC_stack_base stack_base;
+    if (GC_get_stack_base(&stack_base) == GC_SUCCESS) {
+        // Already registered threads, such as the main one, report GC_DUPLICATE.
+        _registered = GC_register_my_thread(&stack_base) == GC_SUCCESS;
+    }
+}
+
+ThreadScope::~ThreadScope() {
+    if (_registered) {
+        GC_unregister_my_thread();
+    }
+}
+
 }
 }
 
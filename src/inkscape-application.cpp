@@ -84,6 +84,7 @@
 #include "actions/actions-tutorial.h"
 #include "actions/actions-window.h"
 #include "debug/logger.h"           // INKSCAPE_DEBUG_LOG support
+#include "debug/trace.h"            // INKSCAPE_TRACE support
 #include "extension/db.h"
 #include "extension/effect.h"
 #include "extension/init.h"
@@ -599,6 +600,8 @@ InkscapeApplication::InkscapeApplication()
     // Use environment variable INKSCAPE_DEBUG_LOG=log.txt for event logging
     Inkscape::Debug::Logger::init();
 #endif
+    // Use environment variable INKSCAPE_TRACE=trace.json for performance traces
+    Inkscape::Debug::Trace::init();
 
     // Don't set application name for now. We don't use it anywhere but
     // it overrides the name used for adding recently opened files and breaks the Gtk::RecentFilter
@@ -697,6 +700,10 @@ InkscapeApplication::InkscapeApplication()
     // FIXME: Antialias should really be an INT, but an upstream bug means 0 is detected as NULL
     gapp->add_main_option_entry(T::OptionType::STRING,   "export-png-antialias",   '\0', N_("Antialias level for PNG export (0 to 3); default is 2"),   N_("LEVEL"));
     gapp->add_main_option_entry(T::OptionType::BOOL,     "export-make-paths",      '\0', N_("Attempt to make the export directory if it doesn't exist."), ""); // Bxx
+    gapp->add_main_option_entry(T::OptionType::FILENAME, "export-profile",         '\0', N_("Write the render time of each object in bitmap exports to a JSON file"), N_("FILENAME")); // Bxx
+    gapp->add_main_option_entry(T::OptionType::STRING,   "export-png-sizes",       '\0', N_("Export PNG at each of a comma separated list of widths in pixels or resolutions like 96dpi, to files named after them"), N_("SIZES")); // Bxx
+    gapp->add_main_option_entry(T::OptionType::STRING,   "export-tiles",           '\0', N_("Export PNG as a pyramid of tiles for map viewers, into the directory named like the output file"), "xyz|deepzoom"); // Bxx
+    gapp->add_main_option_entry(T::OptionType::INT,      "export-tile-size",       '\0', N_("Size of the tiles in pixels; default is 256"), N_("SIZE")); // Bxx
 
     // Query - Geometry
     _start_main_option_section(_("Query object/document geometry"));
@@ -1488,6 +1495,10 @@ InkscapeApplication::on_handle_local_options(const Glib::RefPtr<Glib::VariantDic
         options->contains("export-png-compression") ||
         options->contains("export-png-antialias") ||
         options->contains("export-make-paths")     ||
+        options->contains("export-profile")        ||
+        options->contains("export-png-sizes")      ||
+        options->contains("export-tiles")          ||
+        options->contains("export-tile-size")      ||
 
         options->contains("query-id")              ||
         options->contains("query-x")               ||
@@ -1714,6 +1725,22 @@ InkscapeApplication::on_handle_local_options(const Glib::RefPtr<Glib::VariantDic
     if (options->contains("export-use-hints"))    _file_export.export_use_hints   = true;
     if (options->contains("export-make-paths"))   _file_export.make_paths = true;
 
+    if (options->contains("export-profile")) {
+        options->lookup_value("export-profile", _file_export.export_profile);
+    }
+
+    if (options->contains("export-png-sizes")) {
+        options->lookup_value("export-png-sizes", _file_export.export_png_sizes);
+    }
+
+    if (options->contains("export-tiles")) {
+        options->lookup_value("export-tiles", _file_export.export_tiles);
+    }
+
+    if (options->contains("export-tile-size")) {
+        options->lookup_value("export-tile-size", _file_export.export_tile_size);
+    }
+
     if (options->contains("export-background")) {
         options->lookup_value("export-background",_file_export.export_background);
     }
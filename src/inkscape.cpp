@@ -45,6 +45,7 @@
 
 #include "debug/simple-event.h"
 #include "debug/event-tracker.h"
+#include "debug/trace.h"
 #include "io/resource.h"
 #include "io/sys.h"
 #include "libnrtype/font-factory.h"
@@ -558,6 +559,7 @@ Application::crash_handler (int /*signum*/)
 
     tracker.clear();
     Logger::shutdown();
+    Inkscape::Debug::Trace::shutdown();
 
     fflush(stderr); // make sure buffers are empty before crashing (otherwise output might be suppressed)
 
@@ -26,6 +26,7 @@
 
 #include "colors/color.h"
 #include "colors/manager.h"
+#include "display/drawing-profiler.h"
 #include "document.h"
 #include "extension/db.h"
 #include "extension/extension.h"
@@ -75,6 +76,7 @@ InkFileExportCmd::InkFileExportCmd()
     , export_png_compression(6)
     , export_png_antialias(2)
     , make_paths(false)
+    , export_tile_size(256)
 {
 }
 
@@ -503,6 +505,9 @@ InkFileExportCmd::do_export_png(SPDocument *doc, std::string const &export_filen
     bool old_dither = prefs->getBool("/options/dithering/value", true);
     prefs->setBool("/options/dithering/value", export_png_use_dithering);
 
+    // All the exports render from one drawing of the document, which is only shown once.
+    PngExportDrawing drawing(doc);
+
     // Export each object in list (or root if empty).  Use ';' so in future it could be possible to selected multiple objects to export together.
     std::vector<Glib::ustring> objects = Glib::Regex::split_simple("\\s*;\\s*", export_id);
 
@@ -545,7 +550,7 @@ InkFileExportCmd::do_export_png(SPDocument *doc, std::string const &export_filen
             // And if only one page is selected then we assume the user knows the filename they intended.
             std::string filename_out = base + (pages.size() > 1 ? "_p" + std::to_string(page_num) : "") + ".png";
             if (auto page = pm.getPage(page_num - 1)) {
-                do_export_png_now(doc, filename_out, page->getDesktopRect(), dpi, items);
+                do_export_png_now(drawing, filename_out, page->getDesktopRect(), dpi, items);
             }
         }
         return 0;
@@ -678,7 +683,7 @@ InkFileExportCmd::do_export_png(SPDocument *doc, std::string const &export_filen
             area = area.roundOutwards();
         }
         // End finding area.
-        do_export_png_now(doc, filename_out, area, dpi, items);
+        do_export_png_now(drawing, filename_out, area, dpi, items);
 
     } // End loop over objects.
     prefs->setBool("/options/dithering/value", old_dither);
@@ -689,8 +694,10 @@ InkFileExportCmd::do_export_png(SPDocument *doc, std::string const &export_filen
  * @param filename_out Filename and path. Value is UTF8 encoded.
  */
 void
-InkFileExportCmd::do_export_png_now(SPDocument *doc, std::string const &filename_out, Geom::Rect area, double dpi_in, const std::vector<SPItem const *> &items)
+InkFileExportCmd::do_export_png_now(PngExportDrawing &drawing, std::string const &filename_out, Geom::Rect area, double dpi_in, const std::vector<SPItem const *> &items)
 {
+    auto const doc = drawing.document();
+
     // -------------------------- DPI -------------------------------
 
     double dpi = dpi_in;
@@ -812,12 +819,119 @@ InkFileExportCmd::do_export_png_now(SPDocument *doc, std::string const &filename
             return;
         }
 
-        if( sp_export_png_file(doc, filename_out.c_str(), area, width, height, xdpi, ydpi,
+        // ------------------------------ Sizes ----------------------------------
+
+        if (!export_png_sizes.empty()) {
+            // Each size is a width in pixels or a resolution, written to a file named after it.
+            auto base = filename_out;
+            if (base.size() > 4 && base.compare(base.size() - 4, 4, ".png") == 0) {
+                base.erase(base.size() - 4);
+            }
+
+            std::vector<PngExportTarget> targets;
+            std::vector<std::string> sizes;
+            boost::split(sizes, export_png_sizes.raw(), boost::is_any_of(","));
+            for (auto size : sizes) {
+                boost::trim(size);
+                bool const is_dpi = boost::ends_with(size, "dpi");
+                auto const number = size.substr(0, size.size() - (is_dpi ? 3 : 0));
+                char *end;
+                double const value = strtod(number.c_str(), &end);
+                if (number.empty() || *end != '\0' || value <= 0) {
+                    std::cerr << "InkFileExport::do_export_png: "
+                              << "Size " << size << " is invalid. It must be a width in pixels or a resolution like 96dpi."
+                              << std::endl;
+                    return;
+                }
+
+                PngExportTarget target;
+                target.filename = base + "-" + size + ".png";
+                if (is_dpi) {
+                    target.dpi = value;
+                    target.width = Inkscape::Util::Quantity::convert(area.width(), "px", "in") * value + 0.5;
+                    target.height = Inkscape::Util::Quantity::convert(area.height(), "px", "in") * value + 0.5;
+                } else {
+                    target.width = value;
+                    target.height = std::max(1.0, value * area.height() / area.width() + 0.5);
+                    target.dpi = Inkscape::Util::Quantity::convert(target.width, "in", "px") / area.width();
+                }
+                if (target.width < 1 || target.height < 1 || target.width > PNG_UINT_31_MAX || target.height > PNG_UINT_31_MAX) {
+                    std::cerr << "InkFileExport::do_export_png: Dimensions " << target.width << "x" << target.height
+                              << " for size " << size << " are out of range (1 to " << PNG_UINT_31_MAX << ")." << std::endl;
+                    return;
+                }
+                targets.push_back(std::move(target));
+            }
+
+            if (drawing.exportFiles(targets, area, bgcolor, export_id_only ? items : std::vector<SPItem const *>(),
+                                    color_type, bit_depth, export_png_compression, export_png_antialias) != EXPORT_OK) {
+                std::cerr << "InkFileExport::do_export_png: Failed to export sizes to " << base << "-*.png" << std::endl;
+            }
+            return;
+        }
+
+        // ------------------------------ Tiles ----------------------------------
+
+        if (!export_tiles.empty()) {
+            TileLayout layout;
+            if (export_tiles == "xyz") {
+                layout = TileLayout::XYZ;
+            } else if (export_tiles == "deepzoom") {
+                layout = TileLayout::DEEP_ZOOM;
+            } else {
+                std::cerr << "InkFileExport::do_export_png: "
+                          << "Tile layout " << export_tiles.raw() << " is invalid. It must be one of xyz/deepzoom."
+                          << std::endl;
+                return;
+            }
+            if (export_tile_size < 1 || export_tile_size > 4096) {
+                std::cerr << "InkFileExport::do_export_png: "
+                          << "Tile size " << export_tile_size << " out of range [1 - 4096]. Skipping." << std::endl;
+                return;
+            }
+
+            // The tiles go into a directory named like the file, without the extension.
+            auto path = filename_out;
+            if (path.size() > 4 && path.compare(path.size() - 4, 4, ".png") == 0) {
+                path.erase(path.size() - 4);
+            }
+            if (drawing.exportTiles(path, layout, area, width, height, dpi, export_tile_size, bgcolor,
+                                    export_id_only ? items : std::vector<SPItem const *>(),
+                                    export_png_compression, export_png_antialias) != EXPORT_OK) {
+                std::cerr << "InkFileExport::do_export_png: Failed to export tiles to " << path << std::endl;
+            }
+            return;
+        }
+
+        if (!export_profile.empty() && !_profiler) {
+            _profiler = std::make_shared<Inkscape::DrawingProfiler>();
+        }
+
+        if( drawing.exportFile(filename_out.c_str(), area, width, height, xdpi, ydpi,
                                bgcolor, nullptr, nullptr, true, export_id_only ? items : std::vector<SPItem const *>(),
-                               false, color_type, bit_depth, export_png_compression, export_png_antialias) == 1 ) {
+                               false, color_type, bit_depth, export_png_compression, export_png_antialias,
+                               _profiler) == 1 ) {
         } else {
             std::cerr << "InkFileExport::do_export_png: Failed to export to " << filename_out << std::endl;
         }
+
+        if (_profiler) {
+            write_profile();
+        }
+}
+
+/**
+ * Write the render statistics of all bitmap exports so far to the file given by --export-profile.
+ */
+void
+InkFileExportCmd::write_profile()
+{
+    std::ofstream out(export_profile);
+    if (!out) {
+        std::cerr << "InkFileExport::write_profile: Could not open " << export_profile << std::endl;
+        return;
+    }
+    _profiler->writeReport(out);
 }
 
 
@@ -15,12 +15,17 @@
 #ifndef INK_FILE_EXPORT_CMD_H
 #define INK_FILE_EXPORT_CMD_H
 
+#include <memory>
 #include <string>
 #include <2geom/rect.h>
 #include <glibmm/ustring.h>
 
+class PngExportDrawing;
 class SPDocument;
 class SPItem;
+namespace Inkscape {
+class DrawingProfiler;
+} // namespace Inkscape
 namespace Inkscape::Extension {
 class Output;
 } // namespace Inkscape::Extension
@@ -52,7 +57,9 @@ private:
                          Inkscape::Extension::Output &extension);
     int do_export_extension(SPDocument *doc, std::string const &filename_in, Inkscape::Extension::Output *extension);
     Glib::ustring export_type_current;
-    void do_export_png_now(SPDocument *doc, std::string const &filename_out, Geom::Rect area, double dpi_in, const std::vector<SPItem const *> &items);
+    void do_export_png_now(PngExportDrawing &drawing, std::string const &filename_out, Geom::Rect area, double dpi_in, const std::vector<SPItem const *> &items);
+    void write_profile();
+    std::shared_ptr<Inkscape::DrawingProfiler> _profiler; ///< Shared by all bitmap exports.
 
 public:
     // Should be private, but this is just temporary code (I hope!).
@@ -88,6 +95,10 @@ public:
     int           export_png_compression;
     int           export_png_antialias;
     bool          make_paths = false;
+    std::string   export_profile; ///< JSON file for the render statistics of bitmap exports.
+    Glib::ustring export_png_sizes; ///< Widths and resolutions to export PNGs at in one go, if any.
+    Glib::ustring export_tiles;   ///< Layout of a tile pyramid to export PNGs as, if any.
+    int           export_tile_size;
 
     void set_export_area(const Glib::ustring &area);
     void set_export_area_type(ExportAreaType type);
@@ -17,6 +17,7 @@
 #include "font-instance.h"
 #include "font-factory.h"
 #include "svg/svg-length.h"
+#include "debug/trace.h"
 #include "object/sp-object.h"
 #include "object/sp-flowdiv.h"
 #include "Layout-TNG-Scanline-Maker.h"
@@ -2380,6 +2381,7 @@ void Layout::_calculateCursorShapeForEmpty()
 bool Layout::calculateFlow()
 {
     TRACE(("begin calculateFlow()\n"));
+    auto span = Debug::Trace::Span("text", "layout");
     Layout::Calculator calc = Calculator(this);
     bool result = calc.calculate();
 
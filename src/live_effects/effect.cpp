@@ -1783,6 +1783,69 @@ Effect::update_helperpath() {
     }
 }
 
+/**
+ * Describe everything apart from the input path that the result of the effect on lpeitem depends on:
+ * the parameter values, the revisions of objects linked by parameters, the transform of the item and
+ * whatever the effect adds in appendCacheKey().
+ *
+ * Returns nothing if the result must not be reused, because the effect doesn't support it or needs
+ * to run for its own bookkeeping (loading, applying, adjusting to a new path). Effects shared by
+ * several items are never reused either, since their knots and helper paths belong to the last item.
+ */
+std::optional<std::string> Effect::getCacheKey(SPLPEItem const *lpeitem) const
+{
+    if (!_cacheable || is_load || is_applied || on_remove_all || _adjust_path || !lpeobj ||
+        lpeobj->hrefList.size() != 1 || !lpeitem)
+    {
+        return {};
+    }
+
+    std::string key;
+    for (auto const param : param_vector) {
+        key += param->param_key.raw();
+        key += '=';
+        key += param->param_getSVGValue().raw();
+        if (param->key_on_linked_revision) {
+            key += '@';
+            key += std::to_string(param->linked_revision);
+        }
+        key += ';';
+    }
+    // The exact transform, as some effects work in document coordinates.
+    char buf[G_ASCII_DTOSTR_BUF_SIZE];
+    for (int i = 0; i < 6; i++) {
+        key += g_ascii_dtostr(buf, sizeof(buf), lpeitem->transform[i]);
+        key += ';';
+    }
+    if (!appendCacheKey(key, lpeitem)) {
+        return {};
+    }
+    return key;
+}
+
+/**
+ * Put the result of the previous run into curve, if it was computed from the same key and
+ * the same input path. Returns whether it did.
+ */
+bool Effect::reuseCachedResult(std::string const &key, SPCurve *curve)
+{
+    if (!_cached_result || _cached_result->key != key || _cached_result->input != curve->get_pathvector()) {
+        return false;
+    }
+    curve->set_pathvector(_cached_result->output);
+    pathvector_after_effect = _cached_result->output;
+    return true;
+}
+
+/**
+ * Remember the result of a run, which turned pathvector_before_effect into curve.
+ * The key must be taken after the run, as the effect may have updated its own parameters.
+ */
+void Effect::cacheResult(std::string key, SPCurve const *curve)
+{
+    _cached_result = CachedResult{std::move(key), pathvector_before_effect, curve->get_pathvector()};
+}
+
 /**
  * This *creates* a managed widget. Deletion should be done by the eventual parent, or otherwise the caller.
  */
@@ -16,6 +16,8 @@
 #include <2geom/forward.h>
 #include <glibmm/ustring.h>
 #include <iostream>
+#include <optional>
+#include <string>
 
 #define  LPE_CONVERSION_TOLERANCE 0.01    // FIXME: find good solution for this.
 
@@ -140,6 +142,11 @@ public:
     void update_helperpath();
     bool has_exception;
 
+    // Reuse of results when nothing the effect depends on has changed, see SPLPEItem::performOnePathEffect().
+    std::optional<std::string> getCacheKey(SPLPEItem const *lpeitem) const;
+    bool reuseCachedResult(std::string const &key, SPCurve *curve);
+    void cacheResult(std::string key, SPCurve const *curve);
+
     inline bool providesOwnFlashPaths() const {
         return provides_own_flash_paths || show_orig_path;
     }
@@ -187,6 +194,9 @@ protected:
     friend class LPEMeasureSegments;
     // adjust path study make public if grow
     bool _adjust_path = false;
+    // set this to true in derived effects whose result only depends on the input path, the
+    // parameters and whatever appendCacheKey() adds, so it can be reused while they are unchanged
+    bool _cacheable = false;
     // provide a set of doEffect functions so the developer has a choice
     // of what kind of input/output parameters he desires.
     // the order in which they appear is the order in which they are
@@ -203,6 +213,8 @@ protected:
     virtual void addKnotHolderEntities(KnotHolder * /*knotholder*/, SPItem * /*item*/) {};
 
     virtual void addCanvasIndicators(SPLPEItem const* lpeitem, std::vector<Geom::PathVector> &hp_vec);
+    // add anything else the result depends on, for cacheable effects; return false to prevent reuse
+    virtual bool appendCacheKey(std::string & /*key*/, SPLPEItem const * /*lpeitem*/) const { return true; };
 
     bool _provides_knotholder_entities;
     bool _provides_path_adjustment = false;
@@ -233,6 +245,14 @@ private:
     LPEItemShapesNumbers _lpenumbers;
     bool is_ready;
     bool defaultsopen;
+
+    struct CachedResult
+    {
+        std::string key;
+        Geom::PathVector input;
+        Geom::PathVector output;
+    };
+    std::optional<CachedResult> _cached_result;
 };
 
 } //namespace LivePathEffect
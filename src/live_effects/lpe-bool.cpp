@@ -98,6 +98,7 @@ LPEBool::LPEBool(LivePathEffectObject *lpeobject)
     registerParameter(&filter);
     registerParameter(&fill_type_operand);
     show_orig_path = true;
+    _cacheable = true;
     satellitestoclipboard = true;
     prev_affine = Geom::identity();
     operand = cast<SPItem>(operand_item.getObject());
@@ -721,6 +722,19 @@ void LPEBool::addCanvasIndicators(SPLPEItem const * /*lpeitem*/, std::vector<Geo
     hp_vec.push_back(_hp);
 }
 
+bool LPEBool::appendCacheKey(std::string &key, SPLPEItem const *lpeitem) const
+{
+    // While removing, the operand is looked up by id rather than through the parameter.
+    if (onremove) {
+        return false;
+    }
+    // The fill rules can come from the styles of the item itself and of the operand.
+    auto operand = cast<SPItem>(operand_item.getObject());
+    key += std::to_string(GetFillTyp(const_cast<SPLPEItem *>(lpeitem)));
+    key += std::to_string(operand ? GetFillTyp(operand) : fill_justDont);
+    return true;
+}
+
 Inkscape::XML::Node *
 LPEBool::dupleNode(SPObject * origin, Glib::ustring element_type)
 {
@@ -28,6 +28,7 @@ public:
 
     void doEffect(SPCurve *curve) override;
     void addCanvasIndicators(SPLPEItem const *lpeitem, std::vector<Geom::PathVector> &hp_vec) override;
+    bool appendCacheKey(std::string &key, SPLPEItem const *lpeitem) const override;
     void doBeforeEffect(SPLPEItem const *lpeitem) override;
     void transform_multiply(Geom::Affine const &postmul, bool set) override;
     void doAfterEffect(SPLPEItem const* lpeitem, SPCurve *curve) override;
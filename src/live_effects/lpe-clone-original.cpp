@@ -79,6 +79,10 @@ LPECloneOriginal::LPECloneOriginal(LivePathEffectObject *lpeobject)
     registerParameter(&css_properties);
     attributes.param_hide_canvas_text();
     css_properties.param_hide_canvas_text();
+    // The source is compared in appendCacheKey() instead, as it is modified far more often than
+    // its result changes.
+    linkeditem.key_on_linked_revision = false;
+    _cacheable = true;
 }
 
 LPECloneOriginal::~LPECloneOriginal() = default;
@@ -332,6 +336,10 @@ LPECloneOriginal::doBeforeEffect (SPLPEItem const* lpeitem){
             dest->setAttribute("transform", nullptr);
         }
         original_bbox(lpeitem, false, true);
+        // Nothing to clone again if neither the source nor the clone changed since last time.
+        if (!init && cloned_key && cloned_input == pathvector_before_effect && cloned_key == getCacheKey(lpeitem)) {
+            return;
+        }
         auto attributes_str = attributes.param_getSVGValue();
         attr += attributes_str + ",";
         if (attr.size()  && attributes_str.empty()) {
@@ -348,9 +356,49 @@ LPECloneOriginal::doBeforeEffect (SPLPEItem const* lpeitem){
         old_attributes = attributes.param_getSVGValue();
         sync = false;
         linked = id;
+        cloned_key = getCacheKey(lpeitem);
+        cloned_input = pathvector_before_effect;
     } else {
         linked = "";
+        cloned_key.reset();
+    }
+}
+
+bool LPECloneOriginal::appendCacheKey(std::string &key, SPLPEItem const *lpeitem) const
+{
+    // Groups are cloned child by child, which is not described here.
+    auto orig = cast<SPItem>(linkeditem.getObject());
+    if (sync || !orig || is<SPGroup>(orig) || is<SPGroup>(lpeitem) ||
+        g_strcmp0(linked.c_str(), getLPEObj()->getAttribute("linkeditem")))
+    {
+        return false;
     }
+    // The result of the source, as cloneAttributes() copies it.
+    if (auto text = cast<SPText>(orig)) {
+        key += sp_svg_write_path(text->getNormalizedBpath().get_pathvector());
+    } else if (auto shape = cast<SPShape>(orig)) {
+        auto const curve = method == CLM_D ? shape->curve() : shape->curveForEdit();
+        if (curve) {
+            key += sp_svg_write_path(curve->get_pathvector());
+        }
+    }
+    key += ';';
+    for (auto const name : {"transform", "style"}) {
+        if (auto const value = orig->getAttribute(name)) {
+            key += value;
+        }
+        key += ';';
+    }
+    gchar **attarray = g_strsplit(attributes.param_getSVGValue().c_str(), ",", 0);
+    for (auto iter = attarray; *iter; iter++) {
+        auto const attribute = g_strstrip(*iter);
+        if (auto const value = strlen(attribute) ? orig->getAttribute(attribute) : nullptr) {
+            key += value;
+        }
+        key += ';';
+    }
+    g_strfreev(attarray);
+    return true;
 }
 
 bool LPECloneOriginal::getHolderRemove() {
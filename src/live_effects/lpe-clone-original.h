@@ -29,6 +29,7 @@ public:
     bool doOnOpen(SPLPEItem const *lpeitem) override;
     void doOnRemove(SPLPEItem const * /*lpeitem*/) override;
     bool getHolderRemove() override;
+    bool appendCacheKey(std::string &key, SPLPEItem const *lpeitem) const override;
     Gtk::Widget *newWidget() override;
     OriginalSatelliteParam linkeditem;
 
@@ -44,6 +45,9 @@ private:
     void cloneAttributes(SPObject *origin, SPObject *dest, const gchar *attributes, const gchar *css_properties,
                          bool init);
     bool sync;
+    // the cache key and input path when the source was last cloned, to skip cloning it again
+    std::optional<std::string> cloned_key;
+    Geom::PathVector cloned_input;
     bool holderRemove = false; // move to effect if use more
     LPECloneOriginal(const LPECloneOriginal&) = delete;
     LPECloneOriginal& operator=(const LPECloneOriginal&) = delete;
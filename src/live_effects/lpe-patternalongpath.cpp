@@ -110,6 +110,7 @@ LPEPatternAlongPath::LPEPatternAlongPath(LivePathEffectObject *lpeobject) :
     prop_scale.param_set_increments(0.01, 0.10);
     _knotholder = nullptr;
     _provides_knotholder_entities = true;
+    _cacheable = true;
 }
 
 LPEPatternAlongPath::~LPEPatternAlongPath() {
@@ -193,7 +193,7 @@ LPEPowerStroke::LPEPowerStroke(LivePathEffectObject *lpeobject) :
     recusion_limit = 0;
     has_recursion = false;
     _provides_path_adjustment = true;
-    
+    _cacheable = true;
 }
 
 LPEPowerStroke::~LPEPowerStroke() = default;
@@ -105,6 +105,10 @@ public:
     bool widget_is_visible;
     bool widget_is_enabled;
     void connect_selection_changed();
+    // bumped whenever an object linked by the parameter changes, so cached effect results are not reused
+    unsigned linked_revision = 0;
+    // false if the effect describes what it uses of the linked object in its cache key itself
+    bool key_on_linked_revision = true;
 
 protected:
     bool _updating = false;
@@ -431,6 +431,7 @@ PathParam::quit_listening()
 void
 PathParam::ref_changed(SPObject */*old_ref*/, SPObject *new_ref)
 {
+    linked_revision++;
     quit_listening();
     if ( new_ref ) {
         start_listening(new_ref);
@@ -450,6 +451,7 @@ void PathParam::unlink()
 void
 PathParam::linked_deleted(SPObject *deleted)
 {
+    linked_revision++;
     Geom::PathVector pv = _pathvector;
     quit_listening();
     set_new_value (pv, true);
@@ -472,6 +474,7 @@ void PathParam::linked_transformed(Geom::Affine const *rel_transf, SPItem *moved
 void
 PathParam::linked_modified_callback(SPObject *linked_obj, guint flags)
 {
+    linked_revision++;
     if (!_updating && flags & (SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG |
                  SP_OBJECT_CHILD_MODIFIED_FLAG | SP_OBJECT_VIEWPORT_MODIFIED_FLAG)) 
     {
@@ -200,6 +200,7 @@ void SatelliteParam::quit_listening()
 
 void SatelliteParam::linked_changed(SPObject *old_obj, SPObject *new_obj)
 {
+    linked_revision++;
     quit_listening();
     if (new_obj) {
         start_listening(new_obj);
@@ -208,6 +209,7 @@ void SatelliteParam::linked_changed(SPObject *old_obj, SPObject *new_obj)
 
 void SatelliteParam::linked_released(SPObject *released)
 {
+    linked_revision++;
     if (param_effect->getLPEObj()) {
         unlink();
         param_effect->processObjects(LPE_UPDATE);
@@ -217,6 +219,7 @@ void SatelliteParam::linked_released(SPObject *released)
 
 void SatelliteParam::linked_modified(SPObject *linked_obj, guint flags)
 {
+    linked_revision++;
     if (!_updating && flags & (SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG |
                  SP_OBJECT_CHILD_MODIFIED_FLAG | SP_OBJECT_VIEWPORT_MODIFIED_FLAG)) {
         if (!param_effect->is_load || ownerlocator || (!SP_ACTIVE_DESKTOP && param_effect->isReady())) {
@@ -231,6 +234,7 @@ void SatelliteParam::linked_modified(SPObject *linked_obj, guint flags)
 
 void SatelliteParam::linked_transformed(Geom::Affine const *rel_transf, SPItem *moved_item)
 {
+    linked_revision++;
     if (!_updating) {
         update_satellites();
     }
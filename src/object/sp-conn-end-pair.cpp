@@ -19,6 +19,7 @@
 #include <glibmm/stringutils.h>
 
 #include "attributes.h"
+#include "conn-router.h"
 #include "document.h"
 #include "sp-conn-end.h"
 #include "sp-item-group.h"
@@ -26,13 +27,14 @@
 #include "sp-use.h"
 #include "uri.h"
 
-#include "3rdparty/adaptagrams/libavoid/router.h"
 #include "display/curve.h"
 #include "xml/node.h"
 
+static void redrawConnectorCallback(void *ptr);
+
 SPConnEndPair::SPConnEndPair(SPPath *const owner)
     : _path(owner)
-    , _connRef(nullptr)
+    , _connId(0)
     , _connType(SP_CONNECTOR_NOAVOID)
     , _connCurvature(0.0)
     , _transformed_connection()
@@ -66,13 +68,13 @@ void SPConnEndPair::release()
     }
 
     // If the document is being destroyed then the router instance
-    // and the ConnRefs will have been destroyed with it.
-    const bool routerInstanceExists = (_path->document->getRouter() != nullptr);
+    // and the connectors will have been destroyed with it.
+    auto const router = _path->document->getRouter();
 
-    if (_connRef && routerInstanceExists) {
-        _connRef->router()->deleteConnector(_connRef);
+    if (_connId && router) {
+        router->removeConnector(_connId);
     }
-    _connRef = nullptr;
+    _connId = 0;
 
     _transformed_connection.disconnect();
 }
@@ -103,26 +105,25 @@ void SPConnEndPair::setAttr(const SPAttr key, gchar const *const value)
     case SPAttr::CONNECTOR_TYPE:
         if (value && (strcmp(value, "polyline") == 0 || strcmp(value, "orthogonal") == 0)) {
             int new_conn_type = strcmp(value, "polyline") ? SP_CONNECTOR_ORTHOGONAL : SP_CONNECTOR_POLYLINE;
+            auto const avoid_type = new_conn_type == SP_CONNECTOR_POLYLINE ?
+                Avoid::ConnType_PolyLine : Avoid::ConnType_Orthogonal;
+            auto const router = _path->document->getRouter();
 
-            if (!_connRef) {
+            if (!_connId) {
                 _connType = new_conn_type;
-                Avoid::Router *router = _path->document->getRouter();
-                _connRef = new Avoid::ConnRef(router);
-                _connRef->setRoutingType(new_conn_type == SP_CONNECTOR_POLYLINE ?
-                    Avoid::ConnType_PolyLine : Avoid::ConnType_Orthogonal);
+                _connId = router->addConnector(avoid_type, &redrawConnectorCallback, _path);
                 _transformed_connection = _path->connectTransformed(sigc::ptr_fun(&avoid_conn_transformed));
             } else if (new_conn_type != _connType) {
                 _connType = new_conn_type;
-                _connRef->setRoutingType(new_conn_type == SP_CONNECTOR_POLYLINE ?
-                    Avoid::ConnType_PolyLine : Avoid::ConnType_Orthogonal);
+                router->setConnectorType(_connId, avoid_type);
                 sp_conn_reroute_path(_path);
             }
         } else {
             _connType = SP_CONNECTOR_NOAVOID;
 
-            if (_connRef) {
-                _connRef->router()->deleteConnector(_connRef);
-                _connRef = nullptr;
+            if (_connId) {
+                _path->document->getRouter()->removeConnector(_connId);
+                _connId = 0;
                 _transformed_connection.disconnect();
             }
         }
@@ -130,7 +131,7 @@ void SPConnEndPair::setAttr(const SPAttr key, gchar const *const value)
     case SPAttr::CONNECTOR_CURVATURE:
         if (value) {
             _connCurvature = g_strtod(value, nullptr);
-            if (_connRef && _connRef->isInitialised()) {
+            if (_connId && _path->document->getRouter()->isInitialised(_connId)) {
                 // Redraw the connector, but only if it has been initialised.
                 sp_conn_reroute_path(_path);
             }
@@ -273,10 +274,9 @@ void SPConnEndPair::rerouteFromManipulation()
 void SPConnEndPair::update()
 {
     if (_connType != SP_CONNECTOR_NOAVOID) {
-        g_assert(_connRef != nullptr);
-        if (!_connRef->isInitialised()) {
+        g_assert(_connId != 0);
+        if (!_path->document->getRouter()->isInitialised(_connId)) {
             _updateEndPoints();
-            _connRef->setCallback(&redrawConnectorCallback, _path);
         }
     }
 }
@@ -289,7 +289,7 @@ void SPConnEndPair::_updateEndPoints()
     Avoid::Point src(endPt[0][Geom::X], endPt[0][Geom::Y]);
     Avoid::Point dst(endPt[1][Geom::X], endPt[1][Geom::Y]);
 
-    _connRef->setEndpoints(src, dst);
+    _path->document->getRouter()->setEndpoints(_connId, src, dst);
 }
 
 
@@ -298,26 +298,30 @@ bool SPConnEndPair::isAutoRoutingConn() const
     return _connType != SP_CONNECTOR_NOAVOID;
 }
 
+bool SPConnEndPair::isRoutePreview() const
+{
+    return _connId && _path->document->getRouter()->isPreview(_connId);
+}
+
 void SPConnEndPair::makePathInvalid()
 {
-    g_assert(_connRef != nullptr);
+    g_assert(_connId != 0);
 
-    _connRef->makePathInvalid();
+    _path->document->getRouter()->invalidate(_connId);
 }
 
 // Redraws the curve along the recalculated route
 // Straight or curved
-SPCurve SPConnEndPair::createCurve(Avoid::ConnRef *connRef, const gdouble curvature)
+SPCurve SPConnEndPair::createCurve(Avoid::PolyLine route, const gdouble curvature)
 {
-    g_assert(connRef != nullptr);
-
     bool straight = curvature<1e-3;
 
-    Avoid::PolyLine route = connRef->displayRoute();
     if (!straight) route = route.curvedPolyline(curvature);
-    connRef->calcRouteDist();
 
     SPCurve curve;
+    if (route.empty()) {
+        return curve;
+    }
 
     curve.moveto(Geom::Point(route.ps[0].x, route.ps[0].y));
     int pn = route.size();
@@ -348,7 +352,7 @@ SPCurve SPConnEndPair::createCurve(Avoid::ConnRef *connRef, const gdouble curvat
 
 void SPConnEndPair::tellLibavoidNewEndpoints(bool const processTransaction)
 {
-    if (_connRef == nullptr || !isAutoRoutingConn()) {
+    if (!_connId || !isAutoRoutingConn()) {
         // Do nothing
         return;
     }
@@ -356,19 +360,19 @@ void SPConnEndPair::tellLibavoidNewEndpoints(bool const processTransaction)
 
     _updateEndPoints();
     if (processTransaction) {
-        _connRef->router()->processTransaction();
+        _path->document->getRouter()->reroute();
     }
     return;
 }
 
 bool SPConnEndPair::reroutePathFromLibavoid()
 {
-    if (!_connRef || !isAutoRoutingConn()) {
+    if (!_connId || !isAutoRoutingConn()) {
         // Do nothing
         return false;
     }
 
-    auto curve = createCurve(_connRef, _connCurvature);
+    auto curve = createCurve(_path->document->getRouter()->route(_connId), _connCurvature);
 
     auto doc2item = _path->i2doc_affine().inverse();
     curve.transform(doc2item);
@@ -16,7 +16,7 @@
 #include <cstddef>
 #include <sigc++/sigc++.h>
 
-#include "3rdparty/adaptagrams/libavoid/connector.h"
+#include "3rdparty/adaptagrams/libavoid/geomtypes.h"
 #include "attributes.h"
 
 
@@ -45,9 +45,10 @@ public:
     double getCurvature() const;
     SPConnEnd **getConnEnds();
     bool isOrthogonal() const;
-    static SPCurve createCurve(Avoid::ConnRef *connRef, double curvature);
+    static SPCurve createCurve(Avoid::PolyLine route, double curvature);
     void tellLibavoidNewEndpoints(bool const processTransaction = false);
     bool reroutePathFromLibavoid();
+    bool isRoutePreview() const;
     void makePathInvalid();
     void update();
     bool isAutoRoutingConn() const;
@@ -60,8 +61,8 @@ private:
 
     SPPath *_path;
 
-    // libavoid's internal representation of the item.
-    Avoid::ConnRef *_connRef;
+    // The id of the connector in the document's ConnectorRouter, or 0.
+    unsigned _connId;
 
     int _connType;
     double _connCurvature;
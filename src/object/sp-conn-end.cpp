@@ -186,7 +186,9 @@ void sp_conn_reroute_path_immediate(SPPath *const path)
 
 void sp_conn_redraw_path(SPPath *const path)
 {
-    sp_conn_get_route_and_redraw(path);
+    // A straight line shown while the route is being worked out is not
+    // worth writing to the repr.
+    sp_conn_get_route_and_redraw(path, !path->connEndPair.isRoutePreview());
 }
 
 
@@ -272,6 +272,16 @@ bool SPLPEItem::performOnePathEffect(SPCurve *curve, SPShape *current, Inkscape:
                 lpe->doBeforeEffect_impl(this);
             }
 
+            // Skip the effect if neither its input nor anything else it depends on has changed.
+            auto const cache_key = !group && !is_clip_or_mask ? lpe->getCacheKey(this) : std::nullopt;
+            if (cache_key && lpe->reuseCachedResult(*cache_key, curve)) {
+                document->path_effect_stats.reused++;
+                current->setCurveInsync(curve);
+                lpe->doAfterEffect_impl(this, curve);
+                return true;
+            }
+            document->path_effect_stats.recomputed++;
+
             try {
                 lpe->doEffect(curve);
                 lpe->has_exception = false;
@@ -294,6 +304,12 @@ bool SPLPEItem::performOnePathEffect(SPCurve *curve, SPShape *current, Inkscape:
                     lpe->pathvector_after_effect = curve->get_pathvector();
                 }
                 lpe->doAfterEffect_impl(this, curve);
+                // Taken again, as running the effect may have updated its parameters.
+                if (cache_key && curve) {
+                    if (auto key = lpe->getCacheKey(this)) {
+                        lpe->cacheResult(std::move(*key), curve);
+                    }
+                }
             }
         }
     }
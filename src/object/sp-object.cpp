@@ -47,6 +47,7 @@
 #include "debug/event-tracker.h"
 #include "debug/simple-event.h"
 #include "debug/demangle.h"
+#include "debug/trace.h"
 #include "svg/css-ostringstream.h"
 #include "util/format.h"
 #include "util/longest-common-suffix.h"
@@ -1100,10 +1101,12 @@ void SPObject::set(SPAttr key, gchar const* value) {
             }
             break;
 
-        case SPAttr::STYLE:
+        case SPAttr::STYLE: {
+            auto span = Inkscape::Debug::Trace::Span("style", "read");
             object->style->readFromObject( object );
             object->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
             break;
+        }
 
         default:
             break;
@@ -1476,8 +1479,10 @@ void SPObject::updateDisplay(SPCtx *ctx, unsigned int flags)
     if (style) {
         style->block_filter_bbox_updates = true;
         if ((flags & SP_OBJECT_STYLESHEET_MODIFIED_FLAG)) {
+            auto span = Inkscape::Debug::Trace::Span("style", "read");
             style->readFromObject(this);
         } else if (parent && (flags & SP_OBJECT_STYLE_MODIFIED_FLAG) && (flags & SP_OBJECT_PARENT_MODIFIED_FLAG)) {
+            auto span = Inkscape::Debug::Trace::Span("style", "cascade");
             style->cascade( this->parent->style );
         }
         style->block_filter_bbox_updates = false;
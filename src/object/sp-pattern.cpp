@@ -36,6 +36,7 @@
 #include "display/drawing.h"
 #include "display/drawing-group.h"
 #include "display/drawing-pattern.h"
+#include "display/pattern-cache.h"
 
 #include "svg/svg.h"
 #include "xml/href-attribute-helper.h"
@@ -67,6 +68,7 @@ SPPattern::SPPattern()
     , _pattern_content_units_set(false)
     , _pattern_transform_set(false)
     , shown(nullptr)
+    , tile_cache(std::make_shared<Inkscape::PatternCache>())
 {
     ref.changedSignal().connect(sigc::mem_fun(*this, &SPPattern::_onRefChanged));
 }
@@ -688,6 +690,7 @@ Inkscape::DrawingPattern *SPPattern::show(Inkscape::Drawing &drawing, unsigned k
     }
 
     root->setStyle(style);
+    root->setTileCache(tile_cache);
 
     update_view(v);
 
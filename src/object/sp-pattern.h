@@ -30,6 +30,7 @@ class SPPattern;
 class SPItem;
 
 namespace Inkscape {
+class PatternCache;
 namespace XML {
 class Node;
 } // namespace XML
@@ -169,6 +170,12 @@ private:
     using View = ObjectView<Inkscape::DrawingPattern>;
     std::vector<View> views;
     void update_view(View &v);
+
+    /**
+     * Rendered tiles shared by all our views, so objects filled with the same pattern
+     * don't each render their own copy.
+     */
+    std::shared_ptr<Inkscape::PatternCache> tile_cache;
 };
 
 #endif // SEEN_SP_PATTERN_H
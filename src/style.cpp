@@ -23,7 +23,10 @@
 #include "style.h"
 
 #include <cstring>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -216,16 +219,10 @@ public:
     }
 
     /**
-     * Get a vector of property pointers
-     * \todo provide iterator instead
+     * Get the property members, in cascade order
      */
-    std::vector<SPIBase *> get_vector(SPStyle *style) {
-        std::vector<SPIBase *> v;
-        v.reserve(m_vector.size());
-        for (auto ptr : m_vector) {
-            v.push_back(_get(style, ptr));
-        }
-        return v;
+    std::vector<SPIBasePtr> const &members() const {
+        return m_vector;
     }
 
 private:
@@ -245,6 +242,138 @@ private:
 
 auto &_prop_helper = SPStylePropHelper::instance();
 
+std::vector<SPIBasePtr> const &SPStyle::_members()
+{
+    return SPStylePropHelper::instance().members();
+}
+
+/**
+ * The declarations of a style="..." string, parsed once and then merged into any number of
+ * styles. Documents tend to repeat the same few style attributes on many objects, so those
+ * read from the document are interned, see intern_declarations().
+ */
+struct SPStyleDeclarations
+{
+    struct Declaration
+    {
+        SPAttr id;         ///< SPAttr::INVALID for extended properties.
+        bool important;
+        std::string name;  ///< Name of an extended property.
+        std::string value; ///< With " !important" appended for known properties.
+    };
+
+    /// In the order they are merged: reversed, as earlier declarations only apply to
+    /// properties that aren't set by later ones yet.
+    std::vector<Declaration> declarations;
+};
+
+namespace {
+
+void collect_declarations(CRDeclaration const *decl, std::vector<SPStyleDeclarations::Declaration> &result)
+{
+    // In reverse order, like SPStyle::_mergeDeclList().
+    if (decl->next) {
+        collect_declarations(decl->next, result);
+    }
+
+    gchar const *key = decl->property->stryng->str;
+    auto const value = reinterpret_cast<gchar *>(cr_term_to_string(decl->value));
+    auto const id = sp_attribute_lookup(key);
+
+    if (id != SPAttr::INVALID) {
+        // Add "!important" rule if necessary as this is not handled by cr_term_to_string().
+        Inkscape::CSSOStringStream os;
+        os << value << (decl->important ? " !important" : "");
+        result.push_back({id, static_cast<bool>(decl->important), {}, os.str()});
+    } else if (g_str_has_prefix(key, "--")) {
+        g_warning("Ignoring CSS variable: %s", key);
+    } else if (g_str_has_prefix(key, "-")) {
+        result.push_back({id, static_cast<bool>(decl->important), key, value});
+    } else {
+        g_warning("Ignoring unrecognized CSS property: %s", key);
+    }
+
+    g_free(value);
+}
+
+std::shared_ptr<SPStyleDeclarations const> parse_declarations(char const *str)
+{
+    auto result = std::make_shared<SPStyleDeclarations>();
+    CRDeclaration *const decl_list
+        = cr_declaration_parse_list_from_buf(reinterpret_cast<guchar const *>(str), CR_UTF_8);
+    if (decl_list) {
+        collect_declarations(decl_list, result->declarations);
+        cr_declaration_destroy(decl_list);
+    }
+    return result;
+}
+
+struct StringHash
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+};
+
+struct DeclarationCache
+{
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<SPStyleDeclarations const>, StringHash, std::equal_to<>> entries;
+    bool enabled = true; ///< See SPStyle::set_interning().
+};
+
+DeclarationCache &declaration_cache()
+{
+    static DeclarationCache instance;
+    return instance;
+}
+
+/**
+ * Return the parsed declarations of a style attribute, shared with all other styles that
+ * were read from the same string.
+ */
+std::shared_ptr<SPStyleDeclarations const> intern_declarations(char const *str)
+{
+    // Enough for the distinct style attributes of large documents, while bounding the memory
+    // used by ones that are edited a lot.
+    constexpr std::size_t max_entries = 8192;
+
+    auto &cache = declaration_cache();
+    auto const key = std::string_view(str);
+    {
+        auto lock = std::lock_guard(cache.mutex);
+        if (auto it = cache.entries.find(key); it != cache.entries.end()) {
+            return it->second;
+        }
+    }
+
+    auto result = parse_declarations(str);
+
+    auto lock = std::lock_guard(cache.mutex);
+    if (!cache.enabled) {
+        return result;
+    }
+    if (cache.entries.size() >= max_entries) {
+        cache.entries.clear();
+    }
+    cache.entries.emplace(key, result);
+    return result;
+}
+
+} // namespace
+
+/**
+ * Whether the style attributes read from documents are interned, see intern_declarations().
+ * On by default; turning it off, which also empties the cache, is only meant for measuring
+ * what interning saves.
+ */
+void SPStyle::set_interning(bool enabled)
+{
+    auto &cache = declaration_cache();
+    auto lock = std::lock_guard(cache.mutex);
+    cache.enabled = enabled;
+    cache.entries.clear();
+}
+
 // C++11 allows one constructor to call another... might be useful. The original C code
 // had separate calls to create SPStyle, one with only SPDocument and the other with only
 // SPObject as parameters.
@@ -458,10 +587,6 @@ SPStyle::SPStyle(SPDocument *document_in, SPObject *object_in) :
     marker_ptrs[SP_MARKER_LOC_START] = &marker_start;
     marker_ptrs[SP_MARKER_LOC_MID]   = &marker_mid;
     marker_ptrs[SP_MARKER_LOC_END]   = &marker_end;
-
-
-    // This might be too resource hungary... but for now it possible to loop over properties
-    _properties = _prop_helper.get_vector(this);
 }
 
 SPStyle::~SPStyle() {
@@ -503,7 +628,7 @@ SPStyle::clear(SPAttr id) {
 
 void
 SPStyle::clear() {
-    for (auto * p : _properties) {
+    for (auto p : properties()) {
         p->clear();
     }
 
@@ -565,7 +690,7 @@ SPStyle::read( SPObject *object, Inkscape::XML::Node *repr ) {
     // std::cout << " MERGING STYLE ATTRIBUTE" << std::endl;
     gchar const *val = repr->attribute("style");
     if( val != nullptr && *val ) {
-        _mergeString( val );
+        _mergeDeclarations(*intern_declarations(val), SPStyleSrc::STYLE_PROP);
     }
 
     /* 2 Style sheet */
@@ -574,7 +699,7 @@ SPStyle::read( SPObject *object, Inkscape::XML::Node *repr ) {
     }
 
     /* 3 Presentation attributes */
-    for (auto * p : _properties) {
+    for (auto p : properties()) {
         // Shorthands are not allowed as presentation properties. Note: text-decoration and
         // font-variant are converted to shorthands in CSS 3 but can still be read as a
         // non-shorthand for compatibility with older renders, so they should not be in this list.
@@ -756,11 +881,11 @@ SPStyle::write( guint const flags, SPStyleSrc const style_src_req, SPStyle const
     }
 
     Glib::ustring style_string;
-    for(std::vector<SPIBase*>::size_type i = 0; i != _properties.size(); ++i) {
+    for (auto member : _members()) {
         if( base != nullptr ) {
-            style_string += _properties[i]->write( flags, style_src_req, base->_properties[i] );
+            style_string += (this->*member).write( flags, style_src_req, &(base->*member) );
         } else {
-            style_string += _properties[i]->write( flags, style_src_req, nullptr );
+            style_string += (this->*member).write( flags, style_src_req, nullptr );
         }
     }
 
@@ -816,8 +941,8 @@ Glib::ustring SPStyle::writeIfDiff(SPStyle const *base) const
 void
 SPStyle::cascade( SPStyle const *const parent ) {
     // std::cout << "SPStyle::cascade: " << (object->getId()?object->getId():"null") << std::endl;
-    for(std::vector<SPIBase*>::size_type i = 0; i != _properties.size(); ++i) {
-        _properties[i]->cascade( parent->_properties[i] );
+    for (auto member : _members()) {
+        (this->*member).cascade( &(parent->*member) );
     }
 }
 
@@ -842,8 +967,8 @@ SPStyle::cascade( SPStyle const *const parent ) {
 void
 SPStyle::merge( SPStyle const *const parent ) {
     // std::cout << "SPStyle::merge" << std::endl;
-    for(std::vector<SPIBase*>::size_type i = 0; i != _properties.size(); ++i) {
-        _properties[i]->merge( parent->_properties[i] );
+    for (auto member : _members()) {
+        (this->*member).merge( &(parent->*member) );
     }
 }
 
@@ -883,16 +1008,16 @@ bool
 SPStyle::operator==(const SPStyle& rhs) const {
 
     // Uncomment for testing
-    // for(std::vector<SPIBase*>::size_type i = 0; i != _properties.size(); ++i) {
-    //     if( *_properties[i] != *rhs._properties[i])
-    //     std::cout << _properties[i]->name << ": "
-    //               << _properties[i]->write(SP_STYLE_FLAG_ALWAYS,NULL) << " " 
-    //               << rhs._properties[i]->write(SP_STYLE_FLAG_ALWAYS,NULL)
-    //               << (*_properties[i]  == *rhs._properties[i]) << std::endl;
+    // for (auto member : _members()) {
+    //     if( this->*member != rhs.*member)
+    //     std::cout << (this->*member).name() << ": "
+    //               << (this->*member).write(SP_STYLE_FLAG_ALWAYS) << " "
+    //               << (rhs.*member).write(SP_STYLE_FLAG_ALWAYS)
+    //               << (this->*member == rhs.*member) << std::endl;
     // }
 
-    for(std::vector<SPIBase*>::size_type i = 0; i != _properties.size(); ++i) {
-        if( *_properties[i] != *rhs._properties[i]) return false;
+    for (auto member : _members()) {
+        if( this->*member != rhs.*member) return false;
     }
     return true;
 }
@@ -901,11 +1026,18 @@ void
 SPStyle::_mergeString( gchar const *const p ) {
 
     // std::cout << "SPStyle::_mergeString: " << (p?p:"null") << std::endl;
-    CRDeclaration *const decl_list
-        = cr_declaration_parse_list_from_buf(reinterpret_cast<guchar const *>(p), CR_UTF_8);
-    if (decl_list) {
-        _mergeDeclList( decl_list, SPStyleSrc::STYLE_PROP );
-        cr_declaration_destroy(decl_list);
+    _mergeDeclarations(*parse_declarations(p), SPStyleSrc::STYLE_PROP);
+}
+
+void
+SPStyle::_mergeDeclarations(SPStyleDeclarations const &declarations, SPStyleSrc const &source) {
+
+    for (auto const &decl : declarations.declarations) {
+        if (decl.id == SPAttr::INVALID) {
+            extended_properties[decl.name] = decl.value;
+        } else if (!isSet(decl.id) || decl.important) {
+            readIfUnset(decl.id, decl.value.c_str(), source);
+        }
     }
 }
 
@@ -996,6 +1128,16 @@ SPStyle::_mergeObjectStylesheet( SPObject const *const object, SPDocument *const
         _mergeObjectStylesheet(object, parent);
     }
 
+    // Most documents are matched through the index, which only tests the rules that can match.
+    if (auto const decls = document->getStyleRuleIndex().match(document->getStyleCascade(), sel_eng,
+                                                               object->getRepr())) {
+        // In reverse order, as in _mergeProps().
+        for (auto it = decls->rbegin(); it != decls->rend(); ++it) {
+            _mergeDecl(*it, SPStyleSrc::STYLE_SHEET);
+        }
+        return;
+    }
+
     CRPropList *props = nullptr;
 
     //XML Tree being directly used here while it shouldn't be.
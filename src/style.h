@@ -22,8 +22,11 @@
 #include "style-internal.h"
 
 #include <sigc++/connection.h>
+#include <cstddef>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "3rdparty/libcroco/src/cr-declaration.h"
@@ -40,13 +43,61 @@ class Node;
 }
 }
 
+struct SPStyleDeclarations;
+
+/**
+ * The properties of a style, in the order they are cascaded. All styles share the table of
+ * their members, rather than each holding pointers to its own.
+ */
+template <class Style, class Base>
+class SPStylePropertyRange
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Base *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Base *;
+
+        iterator() = default;
+        iterator(Style *style, SPIBasePtr const *member) : _style(style), _member(member) {}
+
+        Base *operator*() const { return &(_style->*(*_member)); }
+        iterator &operator++() { ++_member; return *this; }
+        iterator operator++(int) { auto old = *this; ++_member; return old; }
+        bool operator==(iterator const &other) const { return _member == other._member; }
+        bool operator!=(iterator const &other) const { return _member != other._member; }
+
+    private:
+        Style *_style = nullptr;
+        SPIBasePtr const *_member = nullptr;
+    };
+
+    SPStylePropertyRange(Style *style, std::vector<SPIBasePtr> const &members)
+        : _style(style)
+        , _members(&members)
+    {}
+
+    iterator begin() const { return {_style, _members->data()}; }
+    iterator end() const { return {_style, _members->data() + _members->size()}; }
+    std::size_t size() const { return _members->size(); }
+
+private:
+    Style *_style;
+    std::vector<SPIBasePtr> const *_members;
+};
+
 /// An SVG style object.
 class SPStyle
 {
 public:
     SPStyle(SPDocument *document = nullptr, SPObject *object = nullptr); // document is ignored if valid object given
     ~SPStyle();
-    std::vector<SPIBase *> const &properties() const { return _properties; }
+    SPStylePropertyRange<SPStyle, SPIBase> properties() { return {this, _members()}; }
+    SPStylePropertyRange<SPStyle const, SPIBase const> properties() const { return {this, _members()}; }
     void clear();
     void clear(SPAttr id);
     void read(SPObject *object, Inkscape::XML::Node *repr);
@@ -70,8 +121,11 @@ public:
     void mergeStatement(CRStatement *statement);
     bool operator==(SPStyle const &rhs) const;
 
+    static void set_interning(bool enabled);
+
 private:
     void _mergeString(char const *p);
+    void _mergeDeclarations(SPStyleDeclarations const &declarations, SPStyleSrc const &source);
     void _mergeDeclList(CRDeclaration const *decl_list, SPStyleSrc const &source);
     void _mergeDecl(    CRDeclaration const *decl,      SPStyleSrc const &source);
     void _mergeProps(CRPropList *props);
@@ -86,8 +140,8 @@ public:
     SPDocument *document;
 
 private:
-    /// Pointers to all the properties (for looping through them)
-    std::vector<SPIBase *> _properties;
+    /// Pointers to the property members of all styles (for looping through them)
+    static std::vector<SPIBasePtr> const &_members();
 
     // Shorthand for better readability
     template <SPAttr Id, class Base>
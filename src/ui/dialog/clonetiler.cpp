@@ -38,6 +38,7 @@
 #include "message-stack.h"
 #include "selection.h"
 #include "display/cairo-utils.h"
+#include "display/color-sampler.h"
 #include "display/drawing-context.h"
 #include "display/drawing.h"
 #include "object/algorithms/unclump.h"
@@ -89,6 +90,7 @@ static constexpr int VB_MARGIN = 4;
 static Glib::ustring const prefs_path = "/dialogs/clonetiler/";
 
 static std::unique_ptr<Inkscape::Drawing> trace_drawing;
+static std::unique_ptr<Inkscape::ColorSampler> trace_sampler;
 static unsigned trace_visionkey;
 static gdouble trace_zoom;
 static SPDocument *trace_doc = nullptr;
@@ -1924,33 +1926,29 @@ void CloneTiler::trace_setup(SPDocument *doc, gdouble zoom, SPItem *original)
     trace_doc->ensureUpToDate();
 
     trace_zoom = zoom;
+    trace_drawing->root()->setTransform(Geom::Scale(trace_zoom));
+    trace_drawing->update();
+
+    // The background stays the same while tiling, so render each part of it only once.
+    trace_sampler = std::make_unique<Inkscape::ColorSampler>(*trace_drawing);
 }
 
 guint32 CloneTiler::trace_pick(Geom::Rect box)
 {
-    if (!trace_drawing) {
+    if (!trace_sampler) {
         return 0;
     }
 
-    trace_drawing->root()->setTransform(Geom::Scale(trace_zoom));
-    trace_drawing->update();
-
     /* Item integer bbox in points */
     Geom::IntRect ibox = (box * Geom::Scale(trace_zoom)).roundOutwards();
 
-    /* Find visible area */
-    cairo_surface_t *s = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, ibox.width(), ibox.height());
-    Inkscape::DrawingContext dc(s, ibox.min());
-    /* Render */
-    trace_drawing->render(dc, ibox);
-    auto color = ink_cairo_surface_average_color(s);
-    cairo_surface_destroy(s);
-    return color.toRGBA();
+    return trace_sampler->average(ibox).toRGBA();
 }
 
 void CloneTiler::trace_finish()
 {
     if (trace_doc) {
+        trace_sampler.reset();
         trace_doc->getRoot()->invoke_hide(trace_visionkey);
         trace_doc = nullptr;
         trace_drawing.reset();
@@ -2442,6 +2440,13 @@ void CloneTiler::apply()
             // add the new clone to the top of the original's parent
             parent->getRepr()->appendChild(clone);
 
+            if (dotrace) {
+                // keep tracing the background only, whichever tiles of it are rendered later
+                if (auto clone_item = cast<SPItem>(desktop->getDocument()->getObjectByRepr(clone))) {
+                    clone_item->invoke_hide(trace_visionkey);
+                }
+            }
+
             if (blur > 0.0) {
                 SPObject *clone_object = desktop->getDocument()->getObjectByRepr(clone);
                 auto item = cast<SPItem>(clone_object);
@@ -26,6 +26,7 @@
 #include <gtkmm/messagedialog.h>
 #include <gtkmm/progressbar.h>
 #include <gtkmm/widget.h>
+#include <memory>
 #include <png.h>
 #include <regex>
 #include <sigc++/scoped_connection.h>
@@ -36,6 +37,7 @@
 #include "document.h"
 #include "export-batch.h"
 #include "extension/output.h"
+#include "helper/png-write.h"
 #include "inkscape-window.h"
 #include "io/fix-broken-links.h"
 #include "io/sandbox.h"
@@ -766,6 +768,9 @@ void BatchExport::onExport()
     auto sels = _desktop->getSelection()->items();
     std::vector<SPItem const *> selected_items(sels.begin(), sels.end());
 
+    // Shown once for all bitmap exports, rather than once per item and size.
+    std::unique_ptr<PngExportDrawing> png_drawing;
+
     // Start Exporting Each Item
     for (int j = 0; j < num_rows && !interrupted; j++) {
 
@@ -875,8 +880,12 @@ void BatchExport::onExport()
                 unsigned long int width = (int)(area.width() * dpi / DPI_BASE + 0.5);
                 unsigned long int height = (int)(area.height() * dpi / DPI_BASE + 0.5);
 
+                if (!png_drawing) {
+                    png_drawing = std::make_unique<PngExportDrawing>(_document);
+                }
                 Export::exportRaster(area, width, height, dpi, _background_color.get_current_color().toRGBA(),
-                                     item_filename_utf8, true, onProgressCallback, this, ext, &show_only);
+                                     item_filename_utf8, true, onProgressCallback, this, ext, &show_only,
+                                     png_drawing.get());
             } else if (page || !show_only.empty()) {
                 auto copy_doc = _document->copy();
                 Export::exportVector(ext, copy_doc.get(), item_filename_utf8, true, show_only, page);
@@ -17,6 +17,7 @@
 
 #include "export.h"
 
+#include <optional>
 #include <set>
 
 #include <glibmm/convert.h>
@@ -222,7 +223,8 @@ bool Export::exportRaster(
         Geom::Rect const &area, unsigned long int const &width, unsigned long int const &height,
         float const &dpi, guint32 bg_color, Glib::ustring const &filename, bool overwrite,
         unsigned (*callback)(float, void *), void *data,
-        Inkscape::Extension::Output *extension, std::vector<SPItem const *> *items)
+        Inkscape::Extension::Output *extension, std::vector<SPItem const *> *items,
+        PngExportDrawing *drawing)
 {
     SPDesktop *desktop = SP_ACTIVE_DESKTOP;
     if (!desktop)
@@ -280,8 +282,14 @@ bool Export::exportRaster(
         selected = *items;
     }
 
-    ExportResult result = sp_export_png_file(
-        desktop->getDocument(), Glib::filename_to_utf8(png_filename).c_str(), area, width, height, pHYs,
+    // Batch exports pass the drawing they share between exports.
+    std::optional<PngExportDrawing> own_drawing;
+    if (!drawing || drawing->document() != doc) {
+        drawing = &own_drawing.emplace(doc);
+    }
+
+    ExportResult result = drawing->exportFile(
+        Glib::filename_to_utf8(png_filename).c_str(), area, width, height, pHYs,
         pHYs, // previously xdpi, ydpi.
         bg_color, callback, data, true, selected, use_interlacing, color_type, bit_depth, zlib, antialiasing);
 
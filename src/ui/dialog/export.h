@@ -29,6 +29,7 @@ class Builder;
 class Notebook;
 } // namespace Gtk
 
+class PngExportDrawing;
 class SPObject;
 class SPPage;
 
@@ -98,7 +99,8 @@ public:
         Geom::Rect const &area, unsigned long int const &width, unsigned long int const &height,
         float const &dpi, guint32 bg_color, Glib::ustring const &filename, bool overwrite,
         unsigned (*callback)(float, void *), void *data,
-        Inkscape::Extension::Output *extension, std::vector<SPItem const *> *items = nullptr);
+        Inkscape::Extension::Output *extension, std::vector<SPItem const *> *items = nullptr,
+        PngExportDrawing *drawing = nullptr);
   
     static bool exportVector(
         Inkscape::Extension::Output *extension, SPDocument *doc, Glib::ustring const &filename,
@@ -2497,6 +2497,12 @@ void InkscapePreferences::initPageIO()
     _page_cms.add_line( true, _("Display rendering intent:"), _cms_intent, "",
                         _("The rendering intent to use to calibrate display output"), false);
 
+    Glib::ustring const lutLabels[] = {_("Off"), _("33 × 33 × 33"), _("65 × 65 × 65")};
+    int const lutValues[] = {0, 33, 65};
+    _cms_lut.init("/options/displayprofile/lut_size", lutLabels, lutValues, 0);
+    _page_cms.add_line( true, _("Display lookup table:"), _cms_lut, "",
+                        _("Approximate the display correction with a precomputed table, which is faster but may differ by a level or two"), false);
+
     _page_cms.add_group_header( _("Proofing"));
 
     _cms_softproof.init( _("Simulate output on screen"), "/options/softproof/enable", false);
@@ -2956,6 +2962,18 @@ void InkscapePreferences::initPageRendering()
     _rendering_cache_size.init("/options/renderingcache/size", 0.0, 4096.0, 1.0, 32.0, 64.0, true, false);
     _page_rendering.add_line( false, _("Rendering _cache size:"), _rendering_cache_size, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of memory per document which can be used to store rendered parts of the drawing for later reuse; set to zero to disable caching"), false);
 
+    // pattern tile cache
+    _rendering_pattern_cache_size.init("/options/renderingcache/patternsize", 0.0, 4096.0, 1.0, 32.0, 64.0, true, false);
+    _page_rendering.add_line( false, _("_Pattern cache size:"), _rendering_pattern_cache_size, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of memory which can be used to keep rendered pattern tiles for reuse at other zoom levels and by other objects with the same pattern"), false);
+
+    // shape coverage masks
+    _rendering_mask_cache_size.init("/options/renderingcache/masksize", 0.0, 4096.0, 1.0, 32.0, 0.0, true, false);
+    _page_rendering.add_line( false, _("Shape _mask cache size:"), _rendering_mask_cache_size, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of memory which can be used to keep where complex shapes cover the pixels, so that redrawing them at the same zoom only paints them; set to zero to disable"), false);
+
+    // pick buffer
+    _rendering_pick_buffer.init(_("Pick objects from a buffer"), "/options/rendering/pickbuffer", false);
+    _page_rendering.add_line(false, "", _rendering_pick_buffer, "", _("Render which object is under each pixel along with the drawing, so that finding the object under the mouse doesn't test the shapes of the objects; uses 4 bytes per pixel of the visible area"), false);
+
     // rendering x-ray radius
     _rendering_xray_radius.init("/options/rendering/xray-radius", 1.0, 1500.0, 1.0, 100.0, 100.0, true, false);
     _page_rendering.add_line( false, _("X-ray radius:"), _rendering_xray_radius, "", _("Radius of the circular area around the mouse cursor in X-ray mode"), false);
@@ -3127,6 +3145,8 @@ void InkscapePreferences::initPageRendering()
     add_devmode_line(_("Sticky decoupled mode"), _canvas_debug_sticky_decoupled, "", _("Stay in decoupled mode even after rendering is complete"));
     _canvas_debug_animate.init("", "/options/rendering/debug_animate", false);
     add_devmode_line(_("Animate"), _canvas_debug_animate, "", _("Continuously adjust viewing parameters in an animation loop."));
+    _canvas_debug_show_profile.init("", "/options/rendering/debug_show_profile", false);
+    add_devmode_line(_("Show render time heat map"), _canvas_debug_show_profile, "", _("Paint the objects that take longest to render in red, and the cheaper ones in yellow, as of when each tile was drawn"));
 
     AddPage(_page_rendering, _("Rendering"), PREFS_PAGE_RENDERING);
 }
@@ -349,6 +349,9 @@ protected:
 
     UI::Widget::PrefSpinButton  _filter_multi_threaded;
     UI::Widget::PrefSpinButton  _rendering_cache_size;
+    UI::Widget::PrefSpinButton  _rendering_pattern_cache_size;
+    UI::Widget::PrefSpinButton  _rendering_mask_cache_size;
+    UI::Widget::PrefCheckButton _rendering_pick_buffer;
     UI::Widget::PrefSpinButton  _rendering_xray_radius;
     UI::Widget::PrefSpinButton  _rendering_outline_overlay_opacity;
     UI::Widget::PrefCombo       _canvas_update_strategy;
@@ -388,6 +391,7 @@ protected:
     UI::Widget::PrefCheckButton _canvas_debug_disable_redraw;
     UI::Widget::PrefCheckButton _canvas_debug_sticky_decoupled;
     UI::Widget::PrefCheckButton _canvas_debug_animate;
+    UI::Widget::PrefCheckButton _canvas_debug_show_profile;
 
     UI::Widget::PrefCheckButton _trans_scale_stroke;
     UI::Widget::PrefCheckButton _trans_scale_corner;
@@ -517,6 +521,7 @@ protected:
     Gtk::ComboBoxText   _cms_display_profile;
     UI::Widget::PrefCheckButton     _cms_from_user;
     UI::Widget::PrefCombo           _cms_intent;
+    UI::Widget::PrefCombo           _cms_lut;
 
     UI::Widget::PrefCheckButton     _cms_softproof;
     UI::Widget::PrefCheckButton     _cms_gamutwarn;
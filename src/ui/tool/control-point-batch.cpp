@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Control points drawn together by one canvas item.
+ */
+/* Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "ui/tool/control-point-batch.h"
+
+#include <algorithm>
+
+#include "desktop.h"
+#include "ui/tool/control-point.h"
+#include "ui/widget/events/canvas-event.h"
+
+namespace Inkscape::UI {
+
+ControlPointBatch::ControlPointBatch(SPDesktop *desktop, Inkscape::CanvasItemGroup *group)
+    : _desktop(desktop)
+    , _group(group)
+    , _set(make_canvasitem<Inkscape::CanvasItemCtrlSet>(group))
+{
+    _set->set_name("CanvasItemCtrlSet:ControlPointBatch");
+    _event_connection = _set->connect_event([this] (CanvasEvent const &event) {
+        return _eventHandler(event);
+    });
+}
+
+ControlPointBatch::~ControlPointBatch() = default;
+
+unsigned ControlPointBatch::_add(ControlPoint *point)
+{
+    auto const id = _set->add(point->_handle.type, point->position());
+    if (id >= _points.size()) {
+        _points.resize(id + 1);
+    }
+    _points[id] = point;
+    return id;
+}
+
+void ControlPointBatch::_remove(ControlPoint *point)
+{
+    _set->remove(point->_batch_id);
+    _points[point->_batch_id] = nullptr;
+    _promoted.erase(std::remove(_promoted.begin(), _promoted.end(), point), _promoted.end());
+}
+
+/**
+ * Give a point a canvas item of its own, in place of its ctrl in the set.
+ */
+void ControlPointBatch::_promote(ControlPoint *point)
+{
+    if (point->_canvas_item_ctrl) {
+        return;
+    }
+    point->_createCanvasItem();
+    _set->set_visible(point->_batch_id, false);
+    _promoted.push_back(point);
+}
+
+/**
+ * Draw the points nothing interacts with from the set again. Only called from the set's own
+ * handler, as the canvas items of the points may be the ones handling the current event.
+ */
+void ControlPointBatch::_demoteIdle()
+{
+    auto const idle = std::partition(_promoted.begin(), _promoted.end(), [] (ControlPoint *point) {
+        return point->mouseovered() || point->state() != ControlPoint::STATE_NORMAL;
+    });
+    for (auto it = idle; it != _promoted.end(); ++it) {
+        auto const point = *it;
+        point->_destroyCanvasItem();
+        _set->set_visible(point->_batch_id, point->_visible);
+    }
+    _promoted.erase(idle, _promoted.end());
+}
+
+/**
+ * The set only gets the events of the points without canvas items. Those under the pointer get
+ * one, and the event is passed on to them as if they had had it all along.
+ */
+bool ControlPointBatch::_eventHandler(CanvasEvent const &event)
+{
+    auto const tool = _desktop->getTool();
+    if (!tool) {
+        return false;
+    }
+
+    auto point_at = [this] (Geom::Point const &pos) -> ControlPoint * {
+        auto const id = _set->find(pos);
+        return id ? _points[*id] : nullptr;
+    };
+
+    bool ret = false;
+
+    // The canvas item of a point only gets its enter event on the next motion, so send one now.
+    auto enter = [&] (Geom::Point const &pos, unsigned modifiers) {
+        _demoteIdle();
+        if (auto const point = point_at(pos)) {
+            _promote(point);
+            auto enter = EnterEvent();
+            enter.pos = pos;
+            enter.modifiers = modifiers;
+            ret = point->_eventHandler(tool, enter);
+        }
+    };
+
+    inspect_event(event,
+    [&] (EnterEvent const &event) {
+        enter(event.pos, event.modifiers);
+    },
+    [&] (MotionEvent const &event) {
+        enter(event.pos, event.modifiers);
+    },
+    [&] (LeaveEvent const &event) {
+        // The pointer may have left a point it entered through the set without its canvas item
+        // ever getting the pointer, and so a leave event.
+        if (std::find(_promoted.begin(), _promoted.end(), ControlPoint::mouseovered_point) != _promoted.end()) {
+            ControlPoint::_clearMouseover();
+        }
+    },
+    [&] (ButtonPressEvent const &event) {
+        _demoteIdle();
+        if (auto const point = point_at(event.pos)) {
+            _promote(point);
+            ret = point->_eventHandler(tool, event);
+        }
+    },
+    [&] (CanvasEvent const &event) {}
+    );
+
+    return ret;
+}
+
+} // namespace Inkscape::UI
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
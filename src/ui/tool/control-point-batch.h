@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Control points drawn together by one canvas item.
+ */
+/* Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_UI_TOOL_CONTROL_POINT_BATCH_H
+#define INKSCAPE_UI_TOOL_CONTROL_POINT_BATCH_H
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <sigc++/scoped_connection.h>
+
+#include "display/control/canvas-item-ctrl-set.h"
+#include "display/control/canvas-item-ptr.h"
+
+class SPDesktop;
+
+namespace Inkscape {
+class CanvasItemGroup;
+struct CanvasEvent;
+} // namespace Inkscape
+
+namespace Inkscape::UI {
+
+class ControlPoint;
+
+/**
+ * Draws many control points, like the nodes of long paths, with one CanvasItemCtrlSet.
+ *
+ * A point in a batch has no canvas item of its own until the pointer comes over it. It is then
+ * given one on top of the set, so that hovering, clicking and dragging it work as for any other
+ * point, and goes back to the set when the pointer is over the set again and the point is
+ * neither mouseovered nor clicked.
+ */
+class ControlPointBatch : boost::noncopyable
+{
+public:
+    ControlPointBatch(SPDesktop *desktop, Inkscape::CanvasItemGroup *group);
+    ~ControlPointBatch();
+
+    Inkscape::CanvasItemGroup *group() const { return _group; }
+    Inkscape::CanvasItemCtrlSet &set() { return *_set; }
+
+private:
+    friend class ControlPoint;
+
+    unsigned _add(ControlPoint *point);
+    void _remove(ControlPoint *point);
+    void _promote(ControlPoint *point);
+    void _demoteIdle();
+    bool _eventHandler(CanvasEvent const &event);
+
+    SPDesktop *_desktop;
+    Inkscape::CanvasItemGroup *_group;
+    CanvasItemPtr<Inkscape::CanvasItemCtrlSet> _set;
+    sigc::scoped_connection _event_connection;
+
+    std::vector<ControlPoint *> _points;   ///< By their ids in the set.
+    std::vector<ControlPoint *> _promoted; ///< Points with canvas items of their own.
+};
+
+} // namespace Inkscape::UI
+
+#endif // INKSCAPE_UI_TOOL_CONTROL_POINT_BATCH_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -18,6 +18,7 @@
 #include "object/sp-namedview.h"
 #include "ui/tools/tool-base.h"
 #include "ui/tool/control-point.h"
+#include "ui/tool/control-point-batch.h"
 #include "ui/tool/transform-handle-set.h"
 #include "ui/widget/canvas.h" // autoscroll
 #include "ui/widget/events/canvas-event.h"
@@ -45,15 +46,20 @@ bool ControlPoint::_event_grab = false;
 
 ControlPoint::ControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAnchorType anchor,
                            Inkscape::CanvasItemCtrlType type,
-                           Inkscape::CanvasItemGroup *group)
+                           Inkscape::CanvasItemGroup *group,
+                           ControlPointBatch *batch)
     : _desktop(d)
     , _position(initial_pos)
+    , _group(batch ? batch->group() : group ? group : _desktop->getCanvasControls())
+    , _batch(batch)
+    , _anchor(anchor)
+    , _handle{.type = type}
 {
-    _canvas_item_ctrl = make_canvasitem<Inkscape::CanvasItemCtrl>(group ? group : _desktop->getCanvasControls(), type);
-    _canvas_item_ctrl->set_name("CanvasItemCtrl:ControlPoint");
-    _canvas_item_ctrl->set_anchor(anchor);
-
-    _commonInit();
+    if (_batch) {
+        _batch_id = _batch->_add(this);
+    } else {
+        _createCanvasItem();
+    }
 }
 
 ControlPoint::~ControlPoint()
@@ -63,12 +69,29 @@ ControlPoint::~ControlPoint()
         _clearMouseover();
     }
 
-    _canvas_item_ctrl->set_visible(false);
+    if (_batch) {
+        _batch->_remove(this);
+    }
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_visible(false);
+    }
 }
 
-void ControlPoint::_commonInit()
+/**
+ * Create the canvas item showing the point, as it currently looks.
+ */
+void ControlPoint::_createCanvasItem()
 {
+    _canvas_item_ctrl = make_canvasitem<Inkscape::CanvasItemCtrl>(_group, _handle.type);
+    _canvas_item_ctrl->set_name(std::string(_name));
+    _canvas_item_ctrl->set_anchor(_anchor);
     _canvas_item_ctrl->set_position(_position);
+    _canvas_item_ctrl->set_size(_rel_size);
+    _canvas_item_ctrl->set_normal(_handle.selected);
+    _canvas_item_ctrl->set_hover(_handle.hover);
+    _canvas_item_ctrl->set_click(_handle.click);
+    _canvas_item_ctrl->set_visible(_visible);
+
     _event_handler_connection = _canvas_item_ctrl->connect_event([this] (CanvasEvent const &event) {
         // re-routes events into the virtual function   TODO: Refactor this nonsense.
         if (!_desktop) {
@@ -78,10 +101,24 @@ void ControlPoint::_commonInit()
     });
 }
 
+/**
+ * Go back to being drawn by the batch. Must not be called from the canvas item's own handler.
+ */
+void ControlPoint::_destroyCanvasItem()
+{
+    _event_handler_connection.disconnect();
+    _canvas_item_ctrl.reset();
+}
+
 void ControlPoint::setPosition(Geom::Point const &pos)
 {
     _position = pos;
-    _canvas_item_ctrl->set_position(_position);
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_position(_position);
+    }
+    if (_batch) {
+        _batch->set().set_position(_batch_id, _position);
+    }
 }
 
 void ControlPoint::move(Geom::Point const &pos)
@@ -95,15 +132,17 @@ void ControlPoint::transform(Geom::Affine const &m) {
 
 bool ControlPoint::visible() const
 {
-    return _canvas_item_ctrl->is_visible();
+    return _visible;
 }
 
 void ControlPoint::setVisible(bool v)
 {
-    if (v) {
-        _canvas_item_ctrl->set_visible(true);
-    } else {
-        _canvas_item_ctrl->set_visible(false);
+    _visible = v;
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_visible(v);
+    }
+    if (_batch) {
+        _batch->set().set_visible(_batch_id, v && !_canvas_item_ctrl);
     }
 }
 
@@ -121,14 +160,78 @@ Glib::ustring ControlPoint::format_tip(char const *format, ...)
 
 // ===== Setters =====
 
+// Batched points only take sizes relative to the preferred one.
 void ControlPoint::_setSize(unsigned int size)
 {
-    _canvas_item_ctrl->_set_size(size);
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->_set_size(size);
+    }
+}
+
+void ControlPoint::_setRelativeSize(HandleSize rel_size)
+{
+    _rel_size = rel_size;
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_size(rel_size);
+    }
+    if (_batch) {
+        _batch->set().set_size(_batch_id, rel_size);
+    }
 }
 
 void ControlPoint::_setControlType(Inkscape::CanvasItemCtrlType type)
 {
-    _canvas_item_ctrl->set_type(type);
+    _handle.type = type;
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_type(type);
+    }
+    if (_batch) {
+        _batch->set().set_state(_batch_id, _handle);
+    }
+}
+
+/**
+ * Show the point as selected or not, in a given state.
+ */
+void ControlPoint::_setAppearance(bool selected, State state)
+{
+    _handle.selected = selected;
+    _handle.hover = state == STATE_MOUSEOVER;
+    _handle.click = state == STATE_CLICKED;
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_normal(selected);
+        switch (state) {
+            case STATE_NORMAL:
+                break;
+            case STATE_MOUSEOVER:
+                _canvas_item_ctrl->set_hover();
+                break;
+            case STATE_CLICKED:
+                _canvas_item_ctrl->set_click();
+                break;
+        }
+    }
+    if (_batch) {
+        _batch->set().set_state(_batch_id, _handle);
+    }
+}
+
+void ControlPoint::_setName(std::string name)
+{
+    _name = std::move(name);
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_name(std::string(_name));
+    }
+}
+
+void ControlPoint::_lowerToBottom()
+{
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->lower_to_bottom();
+    }
+    if (_batch) {
+        _batch->set().lower_to_bottom(_batch_id);
+    }
 }
 
 // main event callback, which emits all other callbacks.
@@ -400,6 +503,9 @@ void ControlPoint::transferGrab(ControlPoint *prev_point, MotionEvent const &eve
 {
     if (!_event_grab) return;
 
+    if (_batch) {
+        _batch->_promote(this);
+    }
     grabbed(event);
     prev_point->_canvas_item_ctrl->ungrab();
     _canvas_item_ctrl->grab(grab_event_mask); // cursor is null
@@ -412,18 +518,7 @@ void ControlPoint::transferGrab(ControlPoint *prev_point, MotionEvent const &eve
 
 void ControlPoint::_setState(State state)
 {
-    _canvas_item_ctrl->set_normal(_selected_appearance);
-
-    switch(state) {
-        case STATE_NORMAL:
-            break;
-        case STATE_MOUSEOVER:
-            _canvas_item_ctrl->set_hover();
-            break;
-        case STATE_CLICKED:
-            _canvas_item_ctrl->set_click();
-            break;
-    };
+    _setAppearance(_selected_appearance, state);
     _state = state;
 }
 
@@ -431,13 +526,21 @@ void ControlPoint::set_selected_appearance(bool selected) {
     if (_selected_appearance == selected) return;
 
     _selected_appearance = selected;
-    _canvas_item_ctrl->set_selected(selected);
+    _handle.selected = selected;
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_selected(selected);
+    }
+    if (_batch) {
+        _batch->set().set_state(_batch_id, _handle);
+    }
 }
 
 // TODO: RENAME
 void ControlPoint::_handleControlStyling()
 {
-    _canvas_item_ctrl->set_size_default();
+    if (_canvas_item_ctrl) {
+        _canvas_item_ctrl->set_size_default();
+    }
 }
 
 bool ControlPoint::_is_drag_cancelled(MotionEvent const &event)
@@ -12,6 +12,7 @@
 #define INKSCAPE_UI_TOOL_CONTROL_POINT_H
 
 #include <cstddef>
+#include <string>
 #include <boost/noncopyable.hpp>
 #include <gdkmm/pixbuf.h>
 #include <sigc++/signal.h>
@@ -32,6 +33,7 @@ namespace Inkscape { struct MotionEvent; struct ButtonReleaseEvent; }
 namespace Inkscape::UI {
 
 namespace Tools { class ToolBase; }
+class ControlPointBatch;
 
 /**
  * Draggable point, the workhorse of on-canvas editing.
@@ -168,6 +170,9 @@ public:
     State state() const { return _state; }
 
     bool mouseovered() const { return this == mouseovered_point; }
+
+    /** Whether some control point is being dragged. */
+    static bool dragging() { return _drag_initiated; }
     /// @}
 
     /** Holds the currently mouseovered control point. */
@@ -200,10 +205,13 @@ protected:
      * @param anchor Where is the control point rendered relative to its desktop coordinates
      * @param type Logical type of the control point.
      * @param group The canvas group the point's canvas item should be created in
+     * @param batch If given, the point is drawn by the batch, and only has a canvas item of its
+     *   own while it is being interacted with. The group is then the batch's.
      */
     ControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAnchorType anchor,
                  Inkscape::CanvasItemCtrlType type,
-                 Inkscape::CanvasItemGroup *group = nullptr);
+                 Inkscape::CanvasItemGroup *group = nullptr,
+                 ControlPointBatch *batch = nullptr);
 
     /// @name Handle control point events in subclasses
     /// @{
@@ -264,14 +272,20 @@ protected:
     void _handleControlStyling();
 
     void _setSize(unsigned int size);
+    void _setRelativeSize(HandleSize rel_size);
     void _setControlType(Inkscape::CanvasItemCtrlType type);
     void _setAnchor(SPAnchorType anchor);
+    void _setAppearance(bool selected, State state);
+    void _setName(std::string name);
+    void _lowerToBottom();
 
     virtual Glib::ustring _getTip(unsigned /*state*/) const { return ""; }
     virtual Glib::ustring _getDragTip(MotionEvent const &event) const { return ""; }
     virtual bool _hasDragTips() const { return false; }
 
-    CanvasItemPtr<Inkscape::CanvasItemCtrl> _canvas_item_ctrl; ///< Visual representation of the control point.
+    /// Visual representation of the control point. Null for a batched point while nothing
+    /// interacts with it.
+    CanvasItemPtr<Inkscape::CanvasItemCtrl> _canvas_item_ctrl;
 
     State _state = STATE_NORMAL;
 
@@ -283,6 +297,8 @@ protected:
     static bool _drag_initiated;
 
 private:
+    friend class ControlPointBatch;
+
     static void _setMouseover(ControlPoint *, unsigned state);
     static void _clearMouseover();
 
@@ -291,12 +307,25 @@ private:
 
     void _setDefaultColors();
 
-    void _commonInit();
+    void _createCanvasItem();
+    void _destroyCanvasItem();
 
     Geom::Point _position; ///< Current position in desktop coordinates
 
     sigc::scoped_connection _event_handler_connection;
 
+    /// @name Appearance, kept for creating the canvas item of a batched point
+    /// @{
+    Inkscape::CanvasItemGroup *_group;
+    ControlPointBatch *const _batch;
+    unsigned _batch_id = 0; ///< Id of the point in the batch's CanvasItemCtrlSet.
+    std::string _name = "CanvasItemCtrl:ControlPoint";
+    SPAnchorType _anchor;
+    Handles::TypeState _handle;
+    HandleSize _rel_size = HandleSize::NORMAL;
+    bool _visible = true;
+    /// @}
+
     /** Stores the window point over which the cursor was during the last mouse button press. */
     static Geom::Point _drag_event_origin;
     /** Stores the desktop point from which the last drag was initiated. */
@@ -750,13 +750,13 @@ Glib::ustring Handle::_getDragTip(MotionEvent const & /*event*/) const
 
 Node::Node(NodeSharedData const &data, Geom::Point const &initial_pos)
     : SelectableControlPoint(data.desktop, initial_pos, SP_ANCHOR_CENTER, Inkscape::CANVAS_ITEM_CTRL_TYPE_NODE_CUSP,
-                             *data.selection, data.node_group)
+                             *data.selection, data.node_group, data.node_batch)
     , _front(data, initial_pos, this)
     , _back(data, initial_pos, this)
     , _type(NODE_CUSP)
     , _handles_shown(false)
 {
-    _canvas_item_ctrl->set_name("CanvasItemCtrl:Node");
+    _setName("CanvasItemCtrl:Node");
     // NOTE we do not set type here, because the handles are still degenerate
 }
 
@@ -1149,7 +1149,7 @@ bool Node::isEndNode() const
 
 void Node::sink()
 {
-    _canvas_item_ctrl->lower_to_bottom();
+    _lowerToBottom();
 }
 
 NodeType Node::parse_nodetype(char x)
@@ -1341,7 +1341,7 @@ void Node::_linearGrow(int dir)
 void Node::_setState(State state)
 {
     // change node size to match type and selection state
-    _canvas_item_ctrl->set_size(selected() ? HandleSize::LARGE : HandleSize::NORMAL);
+    _setRelativeSize(selected() ? HandleSize::LARGE : HandleSize::NORMAL);
     switch (state) {
         // These were used to set "active" and "prelight" flags but the flags weren't being used.
         case STATE_NORMAL:
@@ -56,6 +56,7 @@ struct NodeSharedData
     Inkscape::CanvasItemGroup *node_group;
     Inkscape::CanvasItemGroup *handle_group;
     Inkscape::CanvasItemGroup *handle_line_group;
+    ControlPointBatch *node_batch; ///< Draws the nodes, if set.
 };
 
 class Handle : public ControlPoint
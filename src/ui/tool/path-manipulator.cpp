@@ -11,14 +11,17 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <2geom/bezier-curve.h>
 #include <2geom/bezier-utils.h>
 #include <2geom/path-sink.h>
 #include <2geom/point.h>
 
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "display/curve.h"
+#include "display/drawing-shape.h"
 #include "display/control/canvas-item-bpath.h"
 
 #include <2geom/forward.h>
@@ -29,6 +32,7 @@
 #include "live_effects/lpe-bspline.h"
 #include "live_effects/parameter/path.h"
 
+#include "object/sp-gradient.h"
 #include "object/sp-path.h"
 #include "style.h"
 
@@ -53,6 +57,25 @@ enum PathChange {
     PATH_CHANGE_TRANSFORM
 };
 
+/// Whether a paint looks the same whatever the bounding box of what it paints.
+bool paint_ignores_bbox(SPIPaint const &paint, SPPaintServer *server)
+{
+    if (paint.isNone() || paint.isColor()) {
+        return true;
+    }
+    auto const gradient = cast<SPGradient>(server);
+    return paint.isPaintserver() && gradient && gradient->fetchUnits() == SP_GRADIENT_UNITS_USERSPACEONUSE;
+}
+
+/// Whether a change to a part of a path only changes its rendering around that part. Dashes run
+/// along the whole path, and paint fitted to its bounding box changes everywhere.
+bool renders_locally(SPStyle &style)
+{
+    return style.stroke_dasharray.values.empty() &&
+           paint_ignores_bbox(style.fill, style.getFillPaintServer()) &&
+           paint_ignores_bbox(style.stroke, style.getStrokePaintServer());
+}
+
 } // anonymous namespace
 static constexpr double BSPLINE_TOL = 0.001;
 static constexpr double NO_POWER = 0.0;
@@ -181,7 +204,10 @@ bool PathManipulator::empty() {
 void PathManipulator::update(bool alert_LPE)
 {
     _observer->block();
-    _createGeometryFromControlPoints(alert_LPE);
+    // While dragging, only the segments next to the dragged nodes and handles change.
+    if (alert_LPE || !ControlPoint::dragging() || !_updateGeometryFromMovedNodes()) {
+        _createGeometryFromControlPoints(alert_LPE);
+    }
     _observer->unblock();
 }
 
@@ -1058,11 +1084,13 @@ void PathManipulator::showPathDirection(bool show)
 void PathManipulator::setLiveOutline(bool set)
 {
     _live_outline = set;
+    _built_subpaths.clear();
 }
 
 void PathManipulator::setLiveObjects(bool set)
 {
     _live_objects = set;
+    _built_subpaths.clear();
 }
 
 void PathManipulator::updateHandles()
@@ -1287,6 +1315,7 @@ void PathManipulator::_createControlPointsFromGeometry()
         return;
     }
     _spcurve = SPCurve(pathv);
+    _built_subpaths.clear();
 
     pathv *= _getTransform();
 
@@ -1522,24 +1551,184 @@ void PathManipulator::_createGeometryFromControlPoints(bool alert_LPE)
     if (_live_objects) {
         _setGeometry();
     }
+    _storeBuiltGeometry();
+}
+
+NodeGeometry NodeGeometry::of(Node &node)
+{
+    return {node.position(), node.front()->position(), node.back()->position(),
+            node.front()->isDegenerate(), node.back()->isDegenerate()};
+}
+
+/** Remember what the geometry was built from, for _updateGeometryFromMovedNodes(). */
+void PathManipulator::_storeBuiltGeometry()
+{
+    _built_nodes.clear();
+    _built_subpaths.clear();
+    _built_transform = _getTransform();
+    unsigned path_count = 0;
+    for (auto const &subpath : _subpaths) {
+        for (auto &node : *subpath) {
+            _built_nodes.push_back(NodeGeometry::of(node));
+        }
+        // A single node only builds a curve if it closes on itself with handles.
+        auto const &first = *subpath->begin();
+        bool const builds_path = subpath->size() > 1 ||
+            (subpath->closed() && (!first.front()->isDegenerate() || !first.back()->isDegenerate()));
+        _built_subpaths.push_back({static_cast<unsigned>(subpath->size()), subpath->closed(),
+                                   builds_path ? std::optional(path_count++) : std::nullopt});
+    }
+}
+
+/** Update the geometry while nodes are dragged, rebuilding only the segments next to the nodes
+ * that moved since it was last built. The outline and the display are only redrawn where those
+ * segments were and are; the path itself is set by writeXML() when the drag ends.
+ * \return false if the subpaths changed, and the geometry must be built again from scratch
+ */
+bool PathManipulator::_updateGeometryFromMovedNodes()
+{
+    auto const transform = _getTransform();
+    if (_built_subpaths.size() != _subpaths.size() || transform != _built_transform) {
+        return false;
+    }
+    auto built = _built_subpaths.begin();
+    for (auto const &subpath : _subpaths) {
+        if (subpath->size() != built->size || subpath->closed() != built->closed) {
+            return false;
+        }
+        ++built;
+    }
+
+    auto pathv = _spcurve.get_pathvector();
+    auto const to_item = transform.inverse();
+    Geom::OptRect changed;
+    auto built_node = _built_nodes.begin();
+    built = _built_subpaths.begin();
+    std::vector<bool> moved;
+    for (auto const &subpath : _subpaths) {
+        auto const nodes = std::span<NodeGeometry const>(built_node, built->size);
+        moved.assign(built->size, false);
+        bool any_moved = false;
+        unsigned i = 0;
+        for (auto &node : *subpath) {
+            auto const state = NodeGeometry::of(node);
+            if (state != *built_node) {
+                *built_node = state;
+                moved[i] = any_moved = true;
+            }
+            ++built_node;
+            ++i;
+        }
+        if (any_moved) {
+            if (built->size < 2) {
+                _built_subpaths.clear();
+                return false;
+            }
+            changed.unionWith(rebuild_segments(pathv[*built->path], nodes, built->closed, moved, to_item));
+        }
+        ++built;
+    }
+
+    if (!changed) {
+        return true;
+    }
+    _spcurve = SPCurve(std::move(pathv));
+
+    if (_live_outline) {
+        _updateOutline(changed);
+    }
+    if (_live_objects) {
+        auto path = cast<SPPath>(_path);
+        if (path && !path->curveBeforeLPE() && !path->hasMarkers() && !path->hrefcount &&
+            renders_locally(*path->style))
+        {
+            // Nothing depends on the path but its display, so leave updating it to writeXML().
+            path->setCurveInsync(&_spcurve);
+            auto curve = std::make_shared<SPCurve const>(_spcurve);
+            for (auto &v : path->views) {
+                static_cast<Inkscape::DrawingShape *>(v.drawingitem.get())->patchPath(curve, *changed);
+            }
+        } else {
+            _setGeometry();
+        }
+    }
+    return true;
 }
 
 /** Build one segment of the geometric representation.
  * @relates PathManipulator */
 void build_segment(Geom::PathBuilder &builder, Node *prev_node, Node *cur_node)
 {
-    if (cur_node->back()->isDegenerate() && prev_node->front()->isDegenerate())
+    build_segment(builder, NodeGeometry::of(*prev_node), NodeGeometry::of(*cur_node));
+}
+
+void build_segment(Geom::PathBuilder &builder, NodeGeometry const &prev, NodeGeometry const &cur)
+{
+    if (cur.back_degenerate && prev.front_degenerate)
     {
         // NOTE: It seems like the renderer cannot correctly handle vline / hline segments,
         // and trying to display a path using them results in funny artifacts.
-        builder.lineTo(cur_node->position());
+        builder.lineTo(cur.position);
     } else {
         // this is a bezier segment
-        builder.curveTo(
-            prev_node->front()->position(),
-            cur_node->back()->position(),
-            cur_node->position());
+        builder.curveTo(prev.front, cur.back, cur.position);
+    }
+}
+
+/** Rebuild the segments of a path that start or end at moved nodes of its subpath, the way
+ * build_segment() does, and copy the others.
+ * \param nodes the nodes of the subpath, as they are now
+ * \param moved which nodes of the subpath moved
+ * \param to_item transform from the nodes to the path
+ * \return the area the old and new rebuilt segments cover, in the coordinates of the path
+ * @relates PathManipulator */
+Geom::OptRect rebuild_segments(Geom::Path &path, std::span<NodeGeometry const> nodes, bool closed,
+                               std::vector<bool> const &moved, Geom::Affine const &to_item)
+{
+    auto const n = nodes.size();
+    auto const segment_count = closed ? n : n - 1;
+    Geom::Path const old = path;
+    Geom::OptRect area;
+
+    Geom::Path rebuilt(moved[0] ? nodes[0].position * to_item : old.initialPoint());
+    for (std::size_t i = 0; i < segment_count; i++) {
+        auto const next = (i + 1) % n;
+        bool const linear = nodes[i].front_degenerate && nodes[next].back_degenerate;
+        bool const closing = next == 0;
+        if (!moved[i] && !moved[next]) {
+            // A linear last segment of a closed path is its closing segment, made by close().
+            if (!(closing && linear)) {
+                rebuilt.append(old[i]);
+            }
+            continue;
+        }
+
+        area.unionWith(old[i].boundsFast());
+        if (closing && linear) {
+            area.unionWith(Geom::Rect(rebuilt.finalPoint(), rebuilt.initialPoint()));
+            continue;
+        }
+
+        // Meet the segments kept on either side exactly, so that the path stays continuous.
+        auto const end = closing ? rebuilt.initialPoint()
+                       : moved[next] ? nodes[next].position * to_item
+                       : old[i].finalPoint();
+        std::unique_ptr<Geom::Curve> segment;
+        if (linear) {
+            segment = std::make_unique<Geom::LineSegment>(rebuilt.finalPoint(), end);
+        } else {
+            segment = std::make_unique<Geom::CubicBezier>(rebuilt.finalPoint(),
+                nodes[i].front * to_item, nodes[next].back * to_item, end);
+        }
+        area.unionWith(segment->boundsFast());
+        rebuilt.append(*segment);
+    }
+    if (closed) {
+        rebuilt.close();
     }
+
+    path = std::move(rebuilt);
+    return area;
 }
 
 /** Construct a node type string to store in the sodipodi:nodetypes attribute. */
@@ -1557,8 +1746,10 @@ std::string PathManipulator::_createTypeString()
     return tstr.str();
 }
 
-/** Update the path outline. */
-void PathManipulator::_updateOutline()
+/** Update the path outline.
+ * \param changed if given, the area in item coordinates outside of which the outline is unchanged
+ */
+void PathManipulator::_updateOutline(Geom::OptRect const &changed)
 {
     if (!_show_outline) {
         _outline->set_visible(false);
@@ -1566,6 +1757,10 @@ void PathManipulator::_updateOutline()
     }
 
     auto pv = _spcurve.get_pathvector() * _getTransform();
+    if (changed && !_show_path_direction) {
+        _outline->set_bpath(std::move(pv), *changed * _getTransform());
+        return;
+    }
     // This SPCurve thing has to be killed with extreme prejudice
     if (_show_path_direction) {
         // To show the direction, we append additional subpaths which consist of a single
@@ -1596,6 +1791,7 @@ void PathManipulator::_updateOutline()
 void PathManipulator::_getGeometry()
 {
     using namespace Inkscape::LivePathEffect;
+    _built_subpaths.clear();
     auto lpeobj = cast<LivePathEffectObject>(_path);
     auto path = cast<SPPath>(_path);
     if (lpeobj) {
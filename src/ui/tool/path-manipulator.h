@@ -14,9 +14,13 @@
 
 #include <string>
 #include <memory>
+#include <optional>
+#include <span>
+#include <vector>
 #include <2geom/pathvector.h>
 #include <2geom/path-sink.h>
 #include <2geom/affine.h>
+#include <2geom/rect.h>
 #include "ui/tool/node.h"
 #include "ui/tool/manipulator.h"
 #include "display/curve.h"
@@ -58,6 +62,22 @@ enum class NodeDeleteMode
     gap_lines     // Remove the connection between the selected lines, leaving a gap
 };
 
+/// The part of a node the geometry of a path is built from.
+struct NodeGeometry
+{
+    Geom::Point position;
+    Geom::Point front;
+    Geom::Point back;
+    bool front_degenerate;
+    bool back_degenerate;
+    static NodeGeometry of(Node &node);
+    bool operator==(NodeGeometry const &) const = default;
+};
+
+void build_segment(Geom::PathBuilder &builder, NodeGeometry const &prev, NodeGeometry const &cur);
+Geom::OptRect rebuild_segments(Geom::Path &path, std::span<NodeGeometry const> nodes, bool closed,
+                               std::vector<bool> const &moved, Geom::Affine const &to_item);
+
 /**
  * Manipulator that edits a single path using nodes with handles.
  * Currently only cubic bezier and linear segments are supported, but this might change
@@ -136,9 +156,11 @@ private:
     Geom::Point _bsplineHandleReposition(Handle *h, bool check_other = true);
     Geom::Point _bsplineHandleReposition(Handle *h, double pos);
     void _createGeometryFromControlPoints(bool alert_LPE = false);
+    bool _updateGeometryFromMovedNodes();
+    void _storeBuiltGeometry();
     unsigned _deleteStretch(NodeList::iterator first, NodeList::iterator last, NodeDeleteMode mode);
     std::string _createTypeString();
-    void _updateOutline();
+    void _updateOutline(Geom::OptRect const &changed = {});
     //void _setOutline(Geom::PathVector const &);
     void _getGeometry();
     void _setGeometry();
@@ -180,6 +202,19 @@ private:
     bool _is_bspline = false;
     Glib::ustring _lpe_key;
 
+    /// A subpath _spcurve was last built from.
+    struct BuiltSubpath
+    {
+        unsigned size;
+        bool closed;
+        std::optional<unsigned> path; ///< Index of its path in _spcurve, unless it built none.
+    };
+    // What _spcurve was built from, so that a drag only rebuilds the segments next to the nodes
+    // it moves. Cleared when _spcurve is set some other way.
+    std::vector<NodeGeometry> _built_nodes;
+    std::vector<BuiltSubpath> _built_subpaths;
+    Geom::Affine _built_transform;
+
     friend class PathManipulatorObserver;
     friend class CurveDragPoint;
     friend class Node;
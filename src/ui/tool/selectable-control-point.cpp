@@ -17,11 +17,12 @@ namespace UI {
 SelectableControlPoint::SelectableControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAnchorType anchor,
                                                Inkscape::CanvasItemCtrlType type,
                                                ControlPointSelection &sel,
-                                               Inkscape::CanvasItemGroup *group)
-    : ControlPoint(d, initial_pos, anchor, type, group)
+                                               Inkscape::CanvasItemGroup *group,
+                                               ControlPointBatch *batch)
+    : ControlPoint(d, initial_pos, anchor, type, group, batch)
     , _selection(sel)
 {
-    _canvas_item_ctrl->set_name("CanvasItemCtrl:SelectableControlPoint");
+    _setName("CanvasItemCtrl:SelectableControlPoint");
     _selection.allPoints().insert(this);
 }
 
@@ -96,17 +97,7 @@ void SelectableControlPoint::_setState(State state)
     if (!selected()) {
         ControlPoint::_setState(state);
     } else {
-        _canvas_item_ctrl->set_normal(true);
-        switch (state) {
-            case STATE_NORMAL:
-                break;
-            case STATE_MOUSEOVER:
-                _canvas_item_ctrl->set_hover();
-                break;
-            case STATE_CLICKED:
-                _canvas_item_ctrl->set_click();
-                break;
-        }
+        _setAppearance(true, state);
         _state = state;
     }
 }
@@ -36,7 +36,8 @@ protected:
     SelectableControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAnchorType anchor,
                            Inkscape::CanvasItemCtrlType type,
                            ControlPointSelection &sel,
-                           Inkscape::CanvasItemGroup *group = nullptr);
+                           Inkscape::CanvasItemGroup *group = nullptr,
+                           ControlPointBatch *batch = nullptr);
 
     void _setState(State state) override;
 
@@ -76,6 +76,7 @@
 #include <glibmm/stringutils.h>
 #include <gdk/gdkkeysyms.h>
 
+#include "conn-router.h"
 #include "context-fns.h"
 #include "desktop-style.h"
 #include "desktop.h"
@@ -90,8 +91,6 @@
 #include "display/control/canvas-item-ctrl.h"
 #include "display/curve.h"
 
-#include "3rdparty/adaptagrams/libavoid/router.h"
-
 #include "object/sp-conn-end.h"
 #include "object/sp-flowtext.h"
 #include "object/sp-namedview.h"
@@ -225,7 +224,7 @@ ConnectorTool::~ConnectorTool()
         this->shref = nullptr;
     }
 
-    g_assert(this->newConnRef == nullptr);
+    g_assert(this->newConnId == 0);
 }
 
 void ConnectorTool::set(const Inkscape::Preferences::Entry &val)
@@ -753,23 +752,19 @@ void ConnectorTool::_setSubsequentPoint(Geom::Point const p)
     Avoid::Point src(o[Geom::X], o[Geom::Y]);
     Avoid::Point dst(d[Geom::X], d[Geom::Y]);
 
-    if (!this->newConnRef) {
-        Avoid::Router *router = _desktop->getDocument()->getRouter();
-        this->newConnRef = new Avoid::ConnRef(router);
-        this->newConnRef->setEndpoint(Avoid::VertID::src, src);
-        if (this->isOrthogonal) {
-            this->newConnRef->setRoutingType(Avoid::ConnType_Orthogonal);
-        } else {
-            this->newConnRef->setRoutingType(Avoid::ConnType_PolyLine);
-        }
+    auto router = _desktop->getDocument()->getRouter();
+    if (!this->newConnId) {
+        this->newConnId = router->addConnector(this->isOrthogonal ? Avoid::ConnType_Orthogonal
+                                                                  : Avoid::ConnType_PolyLine,
+                                               nullptr, nullptr);
     }
     // Set new endpoint.
-    this->newConnRef->setEndpoint(Avoid::VertID::tar, dst);
+    router->setEndpoints(this->newConnId, src, dst);
     // Immediately generate new routes for connector.
-    this->newConnRef->makePathInvalid();
-    this->newConnRef->router()->processTransaction();
+    router->invalidate(this->newConnId);
+    router->finish();
     // Recreate curve from libavoid route.
-    red_curve = SPConnEndPair::createCurve(newConnRef, curvature);
+    red_curve = SPConnEndPair::createCurve(router->route(this->newConnId), curvature);
     red_curve->transform(_desktop->doc2dt());
     red_bpath->set_bpath(&*red_curve, true);
 }
@@ -892,9 +887,9 @@ void ConnectorTool::_finish()
 
     this->npoints = 0;
 
-    if (this->newConnRef) {
-        this->newConnRef->router()->deleteConnector(this->newConnRef);
-        this->newConnRef = nullptr;
+    if (this->newConnId) {
+        _desktop->getDocument()->getRouter()->removeConnector(this->newConnId);
+        this->newConnId = 0;
     }
 }
 
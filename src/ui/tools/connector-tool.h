@@ -30,10 +30,6 @@ class SPItem;
 class SPCurve;
 class SPKnot;
 
-namespace Avoid {
-    class ConnRef;
-}
-
 namespace Inkscape {
 class CanvasItemBpath;
 class Selection;
@@ -102,7 +98,7 @@ public:
 
     // The new connector
     SPItem *newconn{nullptr};
-    Avoid::ConnRef *newConnRef{nullptr};
+    unsigned newConnId{0};
     gdouble curvature{0.0};
     bool isOrthogonal{false};
 
@@ -37,6 +37,7 @@
 #include "ui/knot/knot-holder.h"
 #include "ui/modifiers.h"
 #include "ui/shape-editor.h" // temporary!
+#include "ui/tool/control-point-batch.h"
 #include "ui/tool/control-point-selection.h"
 #include "ui/tool/curve-drag-point.h"
 #include "ui/tool/multi-path-manipulator.h"
@@ -132,6 +133,9 @@ NodeTool::NodeTool(SPDesktop *desktop)
 
     data.node_data.handle_line_group->set_name("CanvasItemGroup:NodeTool:handle_line_group");
 
+    // Draw the nodes of all edited paths in one pass, rather than as a canvas item each.
+    data.node_data.node_batch = new Inkscape::UI::ControlPointBatch(desktop, data.node_data.node_group);
+
     Inkscape::Selection *selection = desktop->getSelection();
 
     this->_selection_changed_connection.disconnect();
@@ -202,6 +206,7 @@ NodeTool::~NodeTool()
 
     delete this->_multipath;
     delete this->_selected_nodes;
+    delete _path_data->node_data.node_batch;
 
     _path_data->node_data.node_group->unlink();
     _path_data->node_data.handle_group->unlink();
@@ -39,8 +39,10 @@
 #include "message-context.h"
 #include "selection.h"
 
+#include "display/color-sampler.h"
 #include "display/curve.h"
 #include "display/drawing.h"
+#include "display/drawing-context.h"
 #include "display/control/canvas-item-bpath.h"
 #include "display/control/canvas-item-drawing.h"
 
@@ -392,14 +394,8 @@ double randomize01(double val, double rand)
     return CLAMP(val, 0, 1); // this should be unnecessary with the above provisions, but just in case...
 }
 
-static guint32 getPickerData(Geom::IntRect area, SPDesktop *desktop)
+static guint32 getPickerColor(Colors::Color avg)
 {
-    Inkscape::CanvasItemDrawing *canvas_item_drawing = desktop->getCanvasDrawing();
-    Inkscape::Drawing *drawing = canvas_item_drawing->get_drawing();
-
-    // Get average color.
-    auto avg = drawing->averageColor(area);
-
     //this can fix the bug #1511998 if confirmed
     if (avg.getOpacity() < 1e-6) {
         avg.set(0, 1.0);
@@ -410,6 +406,37 @@ static guint32 getPickerData(Geom::IntRect area, SPDesktop *desktop)
     return avg.toRGBA();
 }
 
+/*
+ * Pick the average colors under the center pixel and, unless it is empty, under the sprayed
+ * area, rendering the canvas only once for both.
+ */
+static void getPickerData(Geom::IntRect const &center, Geom::Rect const &sprayed, SPDesktop *desktop,
+                          guint32 &rgba, guint32 &rgba2)
+{
+    Inkscape::CanvasItemDrawing *canvas_item_drawing = desktop->getCanvasDrawing();
+    Inkscape::Drawing *drawing = canvas_item_drawing->get_drawing();
+
+    auto area = center;
+    Geom::OptIntRect sprayed_area;
+    if (!sprayed.hasZeroArea()) {
+        sprayed_area = sprayed.roundOutwards();
+        area.unionWith(*sprayed_area);
+    }
+
+    auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, area.width(), area.height());
+    auto dc = Inkscape::DrawingContext(surface->cobj(), area.min());
+    drawing->render(dc, area);
+    auto const table = Inkscape::SummedAreaTable(surface->cobj(), area.min());
+
+    auto const average = [&] (Geom::IntRect const &r) {
+        return Inkscape::SummedAreaTable::average(table.sum(r), std::uint64_t(r.width()) * r.height());
+    };
+    rgba = getPickerColor(average(center));
+    if (sprayed_area) {
+        rgba2 = getPickerColor(average(*sprayed_area));
+    }
+}
+
 static void showHidden(std::vector<SPItem *> items_down){
     for (auto item_hidden : items_down) {
         item_hidden->setHidden(false);
@@ -488,12 +515,10 @@ static bool fit_item(SPDesktop *desktop,
     double height_transformed = bbox_procesed->height();
     Geom::Point mid_point = desktop->d2w(bbox_procesed->midpoint());
     Geom::IntRect area = Geom::IntRect::from_xywh(floor(mid_point[Geom::X]), floor(mid_point[Geom::Y]), 1, 1);
-    guint32 rgba = getPickerData(area, desktop);
+    guint32 rgba = 0;
     guint32 rgba2 = 0xffffff00;
     Geom::Rect rect_sprayed(desktop->d2w(Geom::Point(bbox_left_main,bbox_top_main)), desktop->d2w(Geom::Point(bbox_right_main,bbox_bottom_main)));
-    if (!rect_sprayed.hasZeroArea()) {
-        rgba2 = getPickerData(rect_sprayed.roundOutwards(), desktop);
-    }
+    getPickerData(area, rect_sprayed, desktop, rgba, rgba2);
     if(pick_no_overlap) {
         if(rgba != rgba2) {
             if(mode != SPRAY_MODE_ERASER) {
@@ -571,10 +596,7 @@ static bool fit_item(SPDesktop *desktop,
     if(picker || over_transparent || over_no_transparent){
         if(!no_overlap){
             doc->ensureUpToDate();
-            rgba = getPickerData(area, desktop);
-            if (!rect_sprayed.hasZeroArea()) {
-                rgba2 = getPickerData(rect_sprayed.roundOutwards(), desktop);
-            }
+            getPickerData(area, rect_sprayed, desktop, rgba, rgba2);
         }
         if(pick_no_overlap){
             if(rgba != rgba2){
@@ -45,11 +45,13 @@
 #include "colors/cms/system.h"
 #include "desktop.h"
 #include "desktop-events.h"
+#include "debug/trace.h"
 #include "display/control/canvas-item-drawing.h"
 #include "display/control/canvas-item-group.h"
 #include "display/control/snap-indicator.h"
 #include "display/drawing.h"
 #include "display/drawing-item.h"
+#include "display/drawing-profiler.h"
 #include "document.h"
 #include "events/canvas-event.h"
 #include "helper/geom.h"
@@ -246,6 +248,10 @@ public:
     void schedule_redraw(bool instant = false);
     void launch_redraw();
     void after_redraw();
+
+    // Render time heat map.
+    std::shared_ptr<DrawingProfiler> profiler;
+    void update_profiler();
     void commit_tiles();
 
     // Event handling.
@@ -364,6 +370,7 @@ Canvas::Canvas()
     d->prefs.debug_disable_redraw.action = [this] { d->schedule_redraw(); };
     d->prefs.debug_sticky_decoupled.action = [this] { d->schedule_redraw(); };
     d->prefs.debug_animate.action = [this] { queue_draw(); };
+    d->prefs.debug_show_profile.action = [this] { d->update_profiler(); };
     d->prefs.outline_overlay_opacity.action = [this] { queue_draw(); };
     d->prefs.softproof.action = [this] { set_cms_transform(); redraw_all(); };
     d->prefs.displayprofile.action = [this] { set_cms_transform(); redraw_all(); };
@@ -526,6 +533,8 @@ void Canvas::set_drawing(Drawing *drawing)
         _drawing->setOutlineOverlay(d->outlines_required());
         _drawing->setAntialiasingOverride(get_antialiasing_override(_antialiasing_enabled));
     }
+    d->profiler.reset();
+    d->update_profiler();
     if (!d->active && get_realized() && drawing) d->activate();
 }
 
@@ -603,6 +612,10 @@ void CanvasPrivate::launch_redraw()
 {
     assert(redraw_active);
 
+    if (auto drawing_profiler = q->_drawing->profiler()) {
+        drawing_profiler->beginFrame();
+    }
+
     if (q->_render_mode != render_mode) {
         if ((render_mode == RenderMode::OUTLINE_OVERLAY) != (q->_render_mode == RenderMode::OUTLINE_OVERLAY) && !q->get_opengl_enabled()) {
             q->queue_draw(); // Clear the whitewash effect, an artifact of cairo mode.
@@ -735,6 +748,10 @@ void CanvasPrivate::after_redraw()
     canvasitem_ctx->unsnapshot();
     q->_drawing->unsnapshot();
 
+    if (auto drawing_profiler = q->_drawing->profiler()) {
+        drawing_profiler->endFrame();
+    }
+
     // OpenGL context needed for commit_tiles(), stores.finished_draw(), and launch_redraw().
     if (q->get_opengl_enabled()) {
         q->make_current();
@@ -764,6 +781,23 @@ void CanvasPrivate::after_redraw()
     }
 }
 
+/**
+ * Give the drawing a profiler painting a heat map of render times if the preference asks for
+ * it, and take it away otherwise.
+ */
+void CanvasPrivate::update_profiler()
+{
+    if (prefs.debug_show_profile && !profiler) {
+        profiler = std::make_shared<DrawingProfiler>();
+        profiler->setOverlay(true);
+    } else if (!prefs.debug_show_profile) {
+        profiler.reset();
+    }
+    if (q->_drawing) {
+        q->_drawing->setProfiler(profiler);
+    }
+}
+
 void CanvasPrivate::handle_stores_action(Stores::Action action)
 {
     switch (action) {
@@ -2220,6 +2254,8 @@ void CanvasPrivate::process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Ca
                        std::min<int>(rd.coarsener_glue_size, rd.tile_size / 2),
                        rd.coarsener_min_fullness);
 
+    Debug::Trace::counter("canvas", "redraw rects", rd.rects.size());
+
     // Put the rectangles into a heap sorted by distance from mouse.
     std::make_heap(rd.rects.begin(), rd.rects.end(), rd.getcmp());
 
@@ -2232,6 +2268,10 @@ void CanvasPrivate::process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Ca
 // Process rectangles until none left or timed out.
 void CanvasPrivate::render_tile(int debug_id)
 {
+    if (Debug::Trace::active()) {
+        Debug::Trace::setThreadName("canvas render");
+    }
+
     rd.mutex.lock();
 
     std::string fc_str;
@@ -2310,7 +2350,10 @@ void CanvasPrivate::render_tile(int debug_id)
         rd.mutex.unlock();
 
         // Paint the rectangle.
-        paint_rect(rect);
+        {
+            auto span = Debug::Trace::Span("canvas", "paint tile");
+            paint_rect(rect);
+        }
 
         rd.mutex.lock();
 
@@ -55,6 +55,7 @@ public:
     Pref<bool>   debug_disable_redraw     = { "/options/rendering/debug_disable_redraw" };
     Pref<bool>   debug_sticky_decoupled   = { "/options/rendering/debug_sticky_decoupled" };
     Pref<bool>   debug_animate            = { "/options/rendering/debug_animate" };
+    Pref<bool>   debug_show_profile       = { "/options/rendering/debug_show_profile" };
 
 private:
     // Developer mode
@@ -82,6 +83,7 @@ private:
         debug_disable_redraw.set_enabled(on);
         debug_sticky_decoupled.set_enabled(on);
         debug_animate.set_enabled(on);
+        debug_show_profile.set_enabled(on);
     }
 };
 
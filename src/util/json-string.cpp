@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Writing strings as JSON string literals.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "json-string.h"
+
+#include <iomanip>
+#include <ostream>
+
+namespace Inkscape::Util {
+
+void write_json_string(std::ostream &os, std::string_view s)
+{
+    os << '"';
+    for (char c : s) {
+        switch (c) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    auto const fill = os.fill('0');
+                    os << "\\u" << std::hex << std::setw(4) << int(c) << std::dec;
+                    os.fill(fill);
+                } else {
+                    os << c;
+                }
+        }
+    }
+    os << '"';
+}
+
+} // namespace Inkscape::Util
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
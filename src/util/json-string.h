@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Writing strings as JSON string literals.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_UTIL_JSON_STRING_H
+#define INKSCAPE_UTIL_JSON_STRING_H
+
+#include <iosfwd>
+#include <string_view>
+
+namespace Inkscape::Util {
+
+/**
+ * Write a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+ * Other bytes are written as they are, so UTF-8 stays UTF-8.
+ */
+void write_json_string(std::ostream &os, std::string_view s);
+
+} // namespace Inkscape::Util
+
+#endif // INKSCAPE_UTIL_JSON_STRING_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -19,6 +19,7 @@ namespace Inkscape {
 namespace XML {
 
 class Event;
+class NotificationQueue;
 
 /**
  * @brief Interface for XML documents
@@ -85,6 +86,29 @@ public:
     virtual Event *commitUndoable()=0;
     /*@}*/
 
+    /**
+     * @name Batched notifications
+     * @{
+     */
+    /**
+     * @brief Start holding back node observer notifications
+     *
+     * Use MutationBatch instead of calling this directly. Batches nest, and every call
+     * must be matched by a call to endBatch().
+     */
+    virtual void beginBatch()=0;
+    /**
+     * @brief End a batch, delivering the held back notifications if it was the outermost one
+     */
+    virtual void endBatch()=0;
+    /**
+     * @brief Get the queue holding back notifications, or NULL if no batch is open
+     *
+     * Like logger(), this is an implementation detail of nodes.
+     */
+    virtual NotificationQueue *notificationQueue()=0;
+    /*@}*/
+
     /**
      * @name Create new nodes
      * @{
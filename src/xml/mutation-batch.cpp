@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Deferred and coalesced node observer notifications for bulk changes.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "xml/mutation-batch.h"
+
+#include <cstring>
+#include <map>
+#include <unordered_set>
+#include <utility>
+
+#include "xml/document.h"
+#include "xml/node.h"
+#include "xml/node-observer.h"
+
+namespace Inkscape {
+namespace XML {
+
+namespace {
+
+bool same_value(Util::ptr_shared a, Util::ptr_shared b)
+{
+    return a == b || (a && b && !std::strcmp(a, b));
+}
+
+} // namespace
+
+void NotificationQueue::childAdded(NodeObserver &observers, Node &node, Node &child, Node *prev)
+{
+    _records.push_back({.kind = Kind::CHILD_ADDED, .observers = &observers, .node = &node, .child = &child, .prev = prev});
+}
+
+void NotificationQueue::childRemoved(NodeObserver &observers, Node &node, Node &child, Node *prev)
+{
+    _records.push_back({.kind = Kind::CHILD_REMOVED, .observers = &observers, .node = &node, .child = &child, .prev = prev});
+}
+
+void NotificationQueue::childOrderChanged(NodeObserver &observers, Node &node, Node &child,
+                                          Node *old_prev, Node *new_prev)
+{
+    _records.push_back({.kind = Kind::CHILD_ORDER_CHANGED, .observers = &observers, .node = &node, .child = &child,
+                        .prev = old_prev, .new_prev = new_prev});
+}
+
+void NotificationQueue::contentChanged(NodeObserver &observers, Node &node,
+                                       Util::ptr_shared old_content, Util::ptr_shared new_content)
+{
+    _records.push_back({.kind = Kind::CONTENT_CHANGED, .observers = &observers, .node = &node,
+                        .old_value = old_content, .new_value = new_content});
+}
+
+void NotificationQueue::attributeChanged(NodeObserver &observers, Node &node, GQuark name,
+                                         Util::ptr_shared old_value, Util::ptr_shared new_value)
+{
+    _records.push_back({.kind = Kind::ATTRIBUTE_CHANGED, .observers = &observers, .node = &node, .name = name,
+                        .old_value = old_value, .new_value = new_value});
+}
+
+void NotificationQueue::elementNameChanged(NodeObserver &observers, Node &node, GQuark old_name, GQuark new_name)
+{
+    _records.push_back({.kind = Kind::ELEMENT_NAME_CHANGED, .observers = &observers, .node = &node,
+                        .name = old_name, .new_name = new_name});
+}
+
+/**
+ * Mark the notifications which don't need to be delivered, see NotificationQueue.
+ */
+void NotificationQueue::_coalesce()
+{
+    std::unordered_set<Node const *> added;
+    for (auto const &r : _records) {
+        if (r.kind == Kind::CHILD_ADDED) {
+            added.insert(r.child);
+        }
+    }
+
+    auto const inside_added = [&] (Node const *node) {
+        for (; node; node = node->parent()) {
+            if (added.contains(node)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // The last change of each attribute (name != 0) or content (name == 0). It takes over the
+    // old value of the earlier ones, which are dropped.
+    std::map<std::pair<Node const *, GQuark>, Record *> last;
+
+    for (auto &r : _records) {
+        if (!added.empty() && inside_added(r.node)) {
+            r.dropped = true;
+            continue;
+        }
+        if (r.kind != Kind::ATTRIBUTE_CHANGED && r.kind != Kind::CONTENT_CHANGED) {
+            continue;
+        }
+        auto const key = std::pair<Node const *, GQuark>(r.node, r.kind == Kind::ATTRIBUTE_CHANGED ? r.name : 0);
+        auto [it, inserted] = last.emplace(key, &r);
+        if (!inserted) {
+            r.old_value = it->second->old_value;
+            it->second->dropped = true;
+            it->second = &r;
+        }
+    }
+
+    for (auto const &[key, r] : last) {
+        if (same_value(r->old_value, r->new_value)) {
+            r->dropped = true;
+        }
+    }
+}
+
+/**
+ * Send the coalesced notifications to the current observers of their nodes.
+ * @return The number of notifications sent.
+ */
+std::size_t NotificationQueue::deliver()
+{
+    _coalesce();
+
+    std::size_t count = 0;
+    for (auto const &r : _records) {
+        if (r.dropped) {
+            continue;
+        }
+        switch (r.kind) {
+            case Kind::CHILD_ADDED:
+                r.observers->notifyChildAdded(*r.node, *r.child, r.prev);
+                break;
+            case Kind::CHILD_REMOVED:
+                r.observers->notifyChildRemoved(*r.node, *r.child, r.prev);
+                break;
+            case Kind::CHILD_ORDER_CHANGED:
+                r.observers->notifyChildOrderChanged(*r.node, *r.child, r.prev, r.new_prev);
+                break;
+            case Kind::CONTENT_CHANGED:
+                r.observers->notifyContentChanged(*r.node, r.old_value, r.new_value);
+                break;
+            case Kind::ATTRIBUTE_CHANGED:
+                r.observers->notifyAttributeChanged(*r.node, r.name, r.old_value, r.new_value);
+                break;
+            case Kind::ELEMENT_NAME_CHANGED:
+                r.observers->notifyElementNameChanged(*r.node, r.name, r.new_name);
+                break;
+        }
+        count++;
+    }
+
+    _records.clear();
+    return count;
+}
+
+MutationBatch::MutationBatch(Document *document)
+    : _document(document)
+{
+    _document->beginBatch();
+}
+
+MutationBatch::~MutationBatch()
+{
+    _document->endBatch();
+}
+
+} // namespace XML
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
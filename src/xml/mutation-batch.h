@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Deferred and coalesced node observer notifications for bulk changes.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_XML_MUTATION_BATCH_H
+#define SEEN_INKSCAPE_XML_MUTATION_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "inkgc/gc-alloc.h"
+#include "util/share.h"
+
+typedef unsigned int GQuark;
+
+namespace Inkscape {
+namespace XML {
+
+struct Document;
+class Node;
+class NodeObserver;
+
+/**
+ * @brief Node observer notifications held back until the end of a batch
+ *
+ * Nodes hand their notifications to the queue instead of their observers while a
+ * MutationBatch is open on their document. When the batch ends, the queue reduces them
+ * to a single change set and sends that, in the original order, to the observers the
+ * nodes have at that point:
+ *
+ * - Changes inside a subtree which was added during the batch are dropped, since
+ *   observers reading the added subtree find it in its final state.
+ * - Repeated changes of the same attribute or content are merged into the last of
+ *   them, and dropped if the value ends up unchanged. Keeping the last one in place
+ *   means observers only see a value once the nodes it refers to exist, as in setting
+ *   an href, adding the element it points to and then pointing the href at it.
+ *
+ * The event log used for undo is not affected and still sees every change.
+ */
+class NotificationQueue
+{
+public:
+    void childAdded(NodeObserver &observers, Node &node, Node &child, Node *prev);
+    void childRemoved(NodeObserver &observers, Node &node, Node &child, Node *prev);
+    void childOrderChanged(NodeObserver &observers, Node &node, Node &child, Node *old_prev, Node *new_prev);
+    void contentChanged(NodeObserver &observers, Node &node,
+                        Util::ptr_shared old_content, Util::ptr_shared new_content);
+    void attributeChanged(NodeObserver &observers, Node &node, GQuark name,
+                          Util::ptr_shared old_value, Util::ptr_shared new_value);
+    void elementNameChanged(NodeObserver &observers, Node &node, GQuark old_name, GQuark new_name);
+
+    /// The number of notifications held back so far.
+    std::size_t size() const { return _records.size(); }
+
+    std::size_t deliver();
+
+private:
+    enum class Kind
+    {
+        CHILD_ADDED,
+        CHILD_REMOVED,
+        CHILD_ORDER_CHANGED,
+        CONTENT_CHANGED,
+        ATTRIBUTE_CHANGED,
+        ELEMENT_NAME_CHANGED
+    };
+
+    struct Record
+    {
+        Kind kind;
+        bool dropped = false;
+        NodeObserver *observers;
+        Node *node;
+        Node *child = nullptr;
+        Node *prev = nullptr;
+        Node *new_prev = nullptr;
+        GQuark name = 0;
+        GQuark new_name = 0;
+        Util::ptr_shared old_value;
+        Util::ptr_shared new_value;
+    };
+
+    void _coalesce();
+
+    // Scanned by the collector, so the nodes and strings stay alive until they are delivered.
+    std::vector<Record, GC::Alloc<Record, GC::SCANNED>> _records;
+};
+
+/**
+ * @brief Scope in which node observer notifications are deferred and coalesced
+ *
+ * Use this around bulk changes such as pasting or importing many objects, so that
+ * observers like the object tree and the dialogs react once to the final state instead
+ * of to every single step. Batches nest, and the notifications are delivered when the
+ * outermost one ends.
+ *
+ * While a batch is open, observers have not seen the changes yet: SPObjects for added
+ * nodes don't exist, and existing ones don't reflect their new attributes. Code inside
+ * the batch should therefore stick to the XML tree.
+ */
+class MutationBatch
+{
+public:
+    explicit MutationBatch(Document *document);
+    ~MutationBatch();
+
+    MutationBatch(MutationBatch const &) = delete;
+    MutationBatch &operator=(MutationBatch const &) = delete;
+
+private:
+    Document *_document;
+};
+
+} // namespace XML
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_XML_MUTATION_BATCH_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
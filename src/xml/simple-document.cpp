@@ -11,6 +11,7 @@
  */
 
 #include <glib.h> // g_assert()
+#include <utility>
 
 #include "xml/simple-document.h"
 #include "xml/event-fns.h"
@@ -48,6 +49,19 @@ Inkscape::XML::Event *SimpleDocument::commitUndoable() {
     return _log_builder.detach();
 }
 
+void SimpleDocument::beginBatch() {
+    _batch_depth++;
+}
+
+void SimpleDocument::endBatch() {
+    g_assert(_batch_depth > 0);
+    if (--_batch_depth == 0) {
+        // Observers may change the document again while being notified, which must not be held back.
+        auto queue = std::move(_queue);
+        queue.deliver();
+    }
+}
+
 Node *SimpleDocument::createElement(char const *name) {
     return new ElementNode(g_quark_from_string(name), this);
 }
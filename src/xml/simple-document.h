@@ -17,6 +17,7 @@
 #include "xml/simple-node.h"
 #include "xml/node-observer.h"
 #include "xml/log-builder.h"
+#include "xml/mutation-batch.h"
 
 namespace Inkscape {
 
@@ -40,6 +41,10 @@ public:
     void commit() override;
     Inkscape::XML::Event *commitUndoable() override;
 
+    void beginBatch() override;
+    void endBatch() override;
+    NotificationQueue *notificationQueue() override { return _batch_depth ? &_queue : nullptr; }
+
     Node *createElement(char const *name) override;
     Node *createTextNode(char const *content) override;
     Node *createTextNode(char const *content, bool const is_CData) override;
@@ -78,6 +83,8 @@ protected:
 private:
     bool _in_transaction;
     LogBuilder _log_builder;
+    unsigned _batch_depth = 0;
+    NotificationQueue _queue;
 };
 
 }
@@ -26,6 +26,8 @@
 
 #include "preferences.h"
 
+#include "xml/document.h"
+#include "xml/mutation-batch.h"
 #include "xml/node-fns.h"
 #include "debug/event-tracker.h"
 #include "debug/simple-event.h"
@@ -306,7 +308,11 @@ void SimpleNode::setContent(gchar const *content) {
 
     if ( _content != old_content ) {
         _document->logger()->notifyContentChanged(*this, old_content, _content);
-        _observers.notifyContentChanged(*this, old_content, _content);
+        if (auto queue = _document->notificationQueue()) {
+            queue->contentChanged(_observers, *this, old_content, _content);
+        } else {
+            _observers.notifyContentChanged(*this, old_content, _content);
+        }
     }
 }
 
@@ -390,7 +396,11 @@ SimpleNode::setAttributeImpl(gchar const *name, gchar const *value)
 
     if ( new_value != old_value && (!old_value || !new_value || strcmp(old_value, new_value))) {
         _document->logger()->notifyAttributeChanged(*this, key, old_value, new_value);
-        _observers.notifyAttributeChanged(*this, key, old_value, new_value);
+        if (auto queue = _document->notificationQueue()) {
+            queue->attributeChanged(_observers, *this, key, old_value, new_value);
+        } else {
+            _observers.notifyAttributeChanged(*this, key, old_value, new_value);
+        }
         //g_warning( "setAttribute notified: %s: %s: %s: %s", name, element.c_str(), old_value, new_value ); 
     }
     g_free( cleaned_value );
@@ -407,7 +417,11 @@ void SimpleNode::setCodeUnsafe(int code) {
 
     if (new_code != old_code) {
         _document->logger()->notifyElementNameChanged(*this, old_code, new_code);
-        _observers.notifyElementNameChanged(*this, old_code, new_code);
+        if (auto queue = _document->notificationQueue()) {
+            queue->elementNameChanged(_observers, *this, old_code, new_code);
+        } else {
+            _observers.notifyElementNameChanged(*this, old_code, new_code);
+        }
     }
 }
 
@@ -457,7 +471,11 @@ void SimpleNode::addChild(Node *generic_child, Node *generic_ref) {
     _child_count++;
 
     _document->logger()->notifyChildAdded(*this, *child, ref);
-    _observers.notifyChildAdded(*this, *child, ref);
+    if (auto queue = _document->notificationQueue()) {
+        queue->childAdded(_observers, *this, *child, ref);
+    } else {
+        _observers.notifyChildAdded(*this, *child, ref);
+    }
 }
 
 void SimpleNode::removeChild(Node *generic_child) {
@@ -491,7 +509,11 @@ void SimpleNode::removeChild(Node *generic_child) {
     _child_count--;
 
     _document->logger()->notifyChildRemoved(*this, *child, ref);
-    _observers.notifyChildRemoved(*this, *child, ref);
+    if (auto queue = _document->notificationQueue()) {
+        queue->childRemoved(_observers, *this, *child, ref);
+    } else {
+        _observers.notifyChildRemoved(*this, *child, ref);
+    }
 }
 
 void SimpleNode::changeOrder(Node *generic_child, Node *generic_ref) {
@@ -548,7 +570,11 @@ void SimpleNode::changeOrder(Node *generic_child, Node *generic_ref) {
     _cached_positions_valid = false;
 
     _document->logger()->notifyChildOrderChanged(*this, *child, prev, ref);
-    _observers.notifyChildOrderChanged(*this, *child, prev, ref);
+    if (auto queue = _document->notificationQueue()) {
+        queue->childOrderChanged(_observers, *this, *child, prev, ref);
+    } else {
+        _observers.notifyChildOrderChanged(*this, *child, prev, ref);
+    }
 }
 
 void SimpleNode::setPosition(int pos) {
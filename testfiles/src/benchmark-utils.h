@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Shared header for the benchmarks, which are built with WITH_BENCHMARKS and not run by ctest.
+ *
+ * Timings are recorded as properties of the running test rather than printed, so they end up
+ * in the report asked for with --gtest_output=json:<file> or --gtest_output=xml:<file>.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_TESTFILES_BENCHMARK_UTILS_H
+#define INKSCAPE_TESTFILES_BENCHMARK_UTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <gtest/gtest.h>
+
+namespace Inkscape {
+
+/**
+ * Run a function a number of times, returning the fastest run in milliseconds.
+ */
+template <typename F>
+double time_ms(F &&f, int runs = 5)
+{
+    auto best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < runs; i++) {
+        auto const start = std::chrono::steady_clock::now();
+        f();
+        auto const elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/**
+ * Record a measurement in the report of the current test.
+ */
+inline void record_value(std::string const &key, double value)
+{
+    ::testing::Test::RecordProperty(key, std::to_string(value));
+}
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_TESTFILES_BENCHMARK_UTILS_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
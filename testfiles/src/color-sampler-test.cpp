@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for averaging colors with summed-area tables.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+
+#include "inkscape.h"
+#include "document.h"
+#include "object/sp-root.h"
+#include "display/cairo-utils.h"
+#include "display/color-sampler.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+
+using namespace std::literals;
+
+namespace Inkscape {
+
+namespace {
+
+/// An image with a different premultiplied color in every pixel.
+Cairo::RefPtr<Cairo::ImageSurface> make_gradient(int width, int height)
+{
+    auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, width, height);
+    auto data = surface->get_data();
+    for (int y = 0; y < height; y++) {
+        auto px = reinterpret_cast<guint32 *>(data + y * surface->get_stride());
+        for (int x = 0; x < width; x++) {
+            guint32 a = (x * 7 + y * 3) % 256;
+            guint32 r = a * x / width;
+            guint32 g = a * y / height;
+            guint32 b = a / 2;
+            px[x] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+    surface->mark_dirty();
+    return surface;
+}
+
+void expect_same_color(Colors::Color const &a, Colors::Color const &b)
+{
+    for (unsigned i = 0; i < 4; i++) {
+        EXPECT_NEAR(a[i], b[i], 1e-9);
+    }
+}
+
+} // namespace
+
+TEST(ColorSamplerTest, SumsMatchDirectAverage)
+{
+    auto image = make_gradient(40, 30);
+    auto const origin = Geom::IntPoint(-10, 5);
+    auto const table = SummedAreaTable(image->cobj(), origin);
+    EXPECT_EQ(table.area(), Geom::IntRect::from_xywh(-10, 5, 40, 30));
+
+    for (auto const &rect : {Geom::IntRect::from_xywh(-10, 5, 40, 30),
+                             Geom::IntRect::from_xywh(0, 10, 1, 1),
+                             Geom::IntRect::from_xywh(3, 7, 17, 11),
+                             Geom::IntRect::from_xywh(29, 34, 1, 1)})
+    {
+        // Copy the same area out and average it the old way.
+        auto part = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, rect.width(), rect.height());
+        auto cr = Cairo::Context::create(part);
+        cr->set_source(image, origin.x() - rect.left(), origin.y() - rect.top());
+        cr->set_operator(Cairo::Context::Operator::SOURCE);
+        cr->paint();
+
+        auto const expected = ink_cairo_surface_average_color(part->cobj());
+        auto const actual = SummedAreaTable::average(table.sum(rect), rect.width() * rect.height());
+        expect_same_color(actual, expected);
+    }
+
+    // Areas outside the image contribute nothing.
+    auto const outside = table.sum(Geom::IntRect::from_xywh(100, 100, 5, 5));
+    EXPECT_EQ(outside, SummedAreaTable::Sums{});
+    EXPECT_EQ(SummedAreaTable::average(outside, 25).getOpacity(), 0.0);
+}
+
+TEST(ColorSamplerTest, AreasAcrossTiles)
+{
+    if (!Inkscape::Application::exists()) {
+        Inkscape::Application::create(false);
+    }
+
+    constexpr auto docString = R"A(
+<svg xmlns="http://www.w3.org/2000/svg" width="64" height="64" viewBox="0 0 64 64">
+  <rect x="0" y="0" width="32" height="64" fill="#ff0000"/>
+  <rect x="32" y="0" width="32" height="32" fill="#0000ff" opacity="0.5"/>
+</svg>
+    )A"sv;
+    auto doc = SPDocument::createNewDocFromMem(docString, false);
+    ASSERT_TRUE(doc);
+    ASSERT_TRUE(doc->getRoot());
+    doc->ensureUpToDate();
+
+    Drawing drawing;
+    auto const dkey = SPItem::display_key_new(1);
+    auto root = doc->getRoot();
+    drawing.setRoot(root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+    drawing.update();
+
+    // Tiles much smaller than the areas, and at most a few of them kept.
+    ColorSampler sampler(drawing, 10, 3);
+
+    for (auto const &rect : {Geom::IntRect::from_xywh(0, 0, 64, 64),
+                             Geom::IntRect::from_xywh(-5, -5, 20, 20),
+                             Geom::IntRect::from_xywh(25, 13, 17, 31),
+                             Geom::IntRect::from_xywh(40, 20, 3, 3)})
+    {
+        expect_same_color(sampler.average(rect), drawing.averageColor(rect));
+    }
+
+    root->invoke_hide(dkey);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -11,6 +11,7 @@
 #include <cairomm/surface.h>
 #include <gtest/gtest.h>
 
+#include "colors/cms/lut.h"
 #include "colors/cms/profile.h"
 #include "colors/cms/system.h"
 #include "colors/cms/transform.h"
@@ -336,6 +337,59 @@ TEST(ColorCmsTransform, applyWithGamutWarn)
     ASSERT_TRUE(CairoPixelIs(cs, 0xd42279ff));
 }
 
+TEST(ColorCmsTransform, applyTransformCairoLut)
+{
+    auto srgb = CMS::Profile::create_srgb();
+    auto profile = CMS::Profile::create_from_uri(grb_profile);
+    auto tr = CMS::Transform::create_for_cairo(srgb, profile);
+    ASSERT_TRUE(tr->enable_lut(33));
+    ASSERT_TRUE(tr->get_lut());
+
+    auto cs = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, 1, 1);
+    auto cr = Cairo::Context::create(cs);
+
+    cr->set_source_rgb(0.5, 0, 0);
+    cr->paint();
+    tr->do_transform(cs, cs);
+    ASSERT_TRUE(CairoPixelIs(cs, 0x008000ff));
+
+    ASSERT_FALSE(tr->enable_lut(0));
+    ASSERT_FALSE(tr->get_lut());
+}
+
+TEST(ColorCmsTransform, lutAccuracy)
+{
+    auto srgb = CMS::Profile::create_srgb();
+    auto profile = CMS::Profile::create_from_uri(cmyk_profile);
+    auto proofed = CMS::Transform::create_for_cairo(srgb, srgb, profile, RenderingIntent::AUTO, false);
+
+    EXPECT_EQ(CMS::Lut3D::default_tolerance(33), 4);
+    EXPECT_EQ(CMS::Lut3D::default_tolerance(65), 2);
+
+    for (unsigned size : {33, 65}) {
+        auto lut = CMS::Lut3D(proofed->getHandle(), size);
+        int const tolerance = CMS::Lut3D::default_tolerance(size);
+        EXPECT_LE(lut.max_error(), tolerance) << "size " << size;
+        // Both sizes offered in the preferences are accepted with the default tolerance.
+        EXPECT_TRUE(proofed->enable_lut(size)) << "size " << size;
+
+        // Every grey level and a scattering of colors, compared to lcms2 itself.
+        std::vector<unsigned char> in;
+        for (int v = 0; v < 256; v++) {
+            in.insert(in.end(), {(unsigned char)v, (unsigned char)v, (unsigned char)v, 255});
+            in.insert(in.end(), {(unsigned char)(v * 37), (unsigned char)(v * 101), (unsigned char)(v * 13), 255});
+        }
+        auto expected = in;
+        auto actual = in;
+        cmsDoTransform(proofed->getHandle(), in.data(), expected.data(), in.size() / 4);
+        lut.apply(in.data(), actual.data(), in.size() / 4);
+
+        for (unsigned i = 0; i < in.size(); i++) {
+            ASSERT_NEAR(expected[i], actual[i], tolerance) << "size " << size << " byte " << i;
+        }
+    }
+}
+
 } // namespace
 
 /*
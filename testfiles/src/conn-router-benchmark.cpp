@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of dragging an obstacle with connectors routed on a background thread.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <regex>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "conn-router.h"
+#include "inkscape.h"
+#include "3rdparty/adaptagrams/libavoid/router.h"
+#include "3rdparty/adaptagrams/libavoid/shape.h"
+
+#include "benchmark-utils.h"
+#include "conn-router-test-utils.h"
+
+using namespace Inkscape;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+/// The obstacles and connectors of a libavoid test program.
+struct Scene
+{
+    struct Connector
+    {
+        Avoid::Point src;
+        Avoid::Point dst;
+        Avoid::ConnType type;
+    };
+
+    std::vector<Avoid::Polygon> shapes;
+    std::vector<Connector> connectors;
+};
+
+/*
+ * Read the scene built by one of the libavoid test programs from its source, which
+ * consists of blocks like
+ *
+ *     polygon = Polygon(4);
+ *     polygon.ps[0] = Point(1015.25, 612.918);
+ *     ...
+ *     new ShapeRef(router, polygon, 1);
+ *
+ *     connRef = new ConnRef(router, 952);
+ *     srcPt = ConnEnd(Point(319.219, -7.08205), 15);
+ *     ...
+ *     connRef->setRoutingType((ConnType)2);
+ */
+Scene read_libavoid_test(std::string const &name)
+{
+    auto const filename = std::string(INKSCAPE_TESTS_DIR) + "/../src/3rdparty/adaptagrams/libavoid/tests/" + name + ".cpp";
+    auto file = std::ifstream(filename);
+    EXPECT_TRUE(file.good()) << filename;
+
+    static auto const polygon = std::regex(R"(polygon = Polygon\((\d+)\);)");
+    static auto const point = std::regex(R"(polygon\.ps\[(\d+)\] = Point\(([-\d.e]+), ([-\d.e]+)\);)");
+    static auto const shape = std::regex(R"(new ShapeRef\(router, polygon)");
+    static auto const end = std::regex(R"((src|dst)Pt = ConnEnd\(Point\(([-\d.e]+), ([-\d.e]+)\))");
+    static auto const type = std::regex(R"(connRef->setRoutingType\(\(ConnType\)(\d)\);)");
+
+    Scene scene;
+    Avoid::Polygon poly;
+    Scene::Connector connector{};
+    std::string line;
+    std::smatch m;
+    while (std::getline(file, line)) {
+        if (std::regex_search(line, m, polygon)) {
+            poly = Avoid::Polygon(std::stoi(m[1]));
+        } else if (std::regex_search(line, m, point)) {
+            poly.ps.at(std::stoi(m[1])) = Avoid::Point(std::stod(m[2]), std::stod(m[3]));
+        } else if (std::regex_search(line, m, shape)) {
+            scene.shapes.push_back(poly);
+        } else if (std::regex_search(line, m, end)) {
+            (m[1] == "src" ? connector.src : connector.dst) = Avoid::Point(std::stod(m[2]), std::stod(m[3]));
+        } else if (std::regex_search(line, m, type)) {
+            connector.type = static_cast<Avoid::ConnType>(std::stoi(m[1]));
+            scene.connectors.push_back(connector);
+        }
+    }
+    return scene;
+}
+
+double ms_since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// The time the main thread spends on the steps of a drag.
+struct DragTimes
+{
+    double total = 0.0;
+    double worst = 0.0;
+
+    void add(double ms)
+    {
+        total += ms;
+        worst = std::max(worst, ms);
+    }
+};
+
+} // namespace
+
+/*
+ * Drag an obstacle of the libavoid performance test, routing after every step as on the
+ * canvas, once synchronously with a plain libavoid Router as before, and once with the
+ * ConnectorRouter.
+ */
+TEST(ConnectorRouterBenchmark, Drag)
+{
+    if (!Application::exists()) {
+        Application::create(false);
+    }
+
+    auto const scene = read_libavoid_test("performance01");
+    ASSERT_FALSE(scene.shapes.empty());
+    ASSERT_FALSE(scene.connectors.empty());
+    record_value("obstacles", scene.shapes.size());
+    record_value("connectors", scene.connectors.size());
+
+    constexpr int steps = 5;
+    constexpr double step = 4.0;
+
+    // Synchronous.
+    {
+        Avoid::Router router(Avoid::PolyLineRouting | Avoid::OrthogonalRouting);
+        router.setRoutingPenalty(Avoid::segmentPenalty);
+        std::vector<Avoid::ShapeRef *> shapes;
+        for (auto poly : scene.shapes) {
+            shapes.push_back(new Avoid::ShapeRef(&router, poly));
+        }
+        for (auto const &c : scene.connectors) {
+            auto conn = new Avoid::ConnRef(&router, c.src, c.dst);
+            conn->setRoutingType(c.type);
+        }
+        router.processTransaction();
+
+        DragTimes times;
+        for (int i = 1; i <= steps; i++) {
+            auto const start = Clock::now();
+            router.moveShape(shapes.front(), moved(scene.shapes.front(), i * step, i * step));
+            router.processTransaction();
+            times.add(ms_since(start));
+        }
+        record_value("synchronous_total_ms", times.total);
+        record_value("synchronous_worst_step_ms", times.worst);
+    }
+
+    // In the background.
+    {
+        ConnectorRouter router;
+        std::vector<unsigned> shapes;
+        for (auto const &poly : scene.shapes) {
+            shapes.push_back(router.addShape(poly));
+        }
+        std::vector<Counter> counters(scene.connectors.size());
+        for (std::size_t i = 0; i < scene.connectors.size(); i++) {
+            auto const &c = scene.connectors[i];
+            router.setEndpoints(router.addConnector(c.type, &Counter::callback, &counters[i]), c.src, c.dst);
+        }
+        router.finish();
+
+        DragTimes times;
+        for (int i = 1; i <= steps; i++) {
+            auto const start = Clock::now();
+            router.moveShape(shapes.front(), moved(scene.shapes.front(), i * step, i * step));
+            router.reroute();
+            times.add(ms_since(start));
+        }
+        auto const start = Clock::now();
+        router.finish();
+        record_value("background_total_ms", times.total);
+        record_value("background_worst_step_ms", times.worst);
+        record_value("background_finish_ms", ms_since(start));
+        record_value("redrawn", std::count_if(counters.begin(), counters.end(), [] (auto &c) { return c.count > 1; }));
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
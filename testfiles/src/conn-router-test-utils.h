@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Shared test header for the connector routing tests and benchmarks.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_TESTFILES_CONN_ROUTER_TEST_UTILS_H
+#define INKSCAPE_TESTFILES_CONN_ROUTER_TEST_UTILS_H
+
+#include "3rdparty/adaptagrams/libavoid/geomtypes.h"
+
+namespace Inkscape {
+
+/// Counts the routes delivered for a connector.
+struct Counter
+{
+    int count = 0;
+    static void callback(void *data) { static_cast<Counter *>(data)->count++; }
+};
+
+/// A copy of a polygon moved by the given offset.
+inline Avoid::Polygon moved(Avoid::Polygon poly, double dx, double dy)
+{
+    for (auto &p : poly.ps) {
+        p.x += dx;
+        p.y += dy;
+    }
+    return poly;
+}
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_TESTFILES_CONN_ROUTER_TEST_UTILS_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
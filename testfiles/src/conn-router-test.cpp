@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for connector routing on a background thread.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "conn-router.h"
+#include "inkscape.h"
+
+#include "conn-router-test-utils.h"
+
+using namespace Inkscape;
+
+namespace {
+
+Avoid::Polygon box(double x0, double y0, double x1, double y1)
+{
+    // In the same order as the libavoid tests.
+    Avoid::Polygon poly(4);
+    poly.ps[0] = Avoid::Point(x1, y0);
+    poly.ps[1] = Avoid::Point(x1, y1);
+    poly.ps[2] = Avoid::Point(x0, y1);
+    poly.ps[3] = Avoid::Point(x0, y0);
+    return poly;
+}
+
+class ConnectorRouterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!Inkscape::Application::exists()) {
+            Inkscape::Application::create(false);
+        }
+    }
+};
+
+} // namespace
+
+TEST_F(ConnectorRouterTest, PreviewUntilRouted)
+{
+    ConnectorRouter router;
+    router.addShape(box(40, -10, 60, 10));
+
+    Counter counter;
+    auto const conn = router.addConnector(Avoid::ConnType_Orthogonal, &Counter::callback, &counter);
+    EXPECT_FALSE(router.isInitialised(conn));
+    router.setEndpoints(conn, {0, 0}, {100, 0});
+    EXPECT_TRUE(router.isInitialised(conn));
+
+    // A straight line through the obstacle until the route is there.
+    EXPECT_TRUE(router.isPreview(conn));
+    EXPECT_EQ(router.route(conn).size(), 2);
+
+    router.finish();
+    EXPECT_FALSE(router.isPreview(conn));
+    EXPECT_EQ(counter.count, 1);
+    auto const &route = router.route(conn);
+    ASSERT_GT(route.size(), 2);
+    EXPECT_EQ(route.ps.front(), Avoid::Point(0, 0));
+    EXPECT_EQ(route.ps.back(), Avoid::Point(100, 0));
+
+    // Setting the same endpoints again changes nothing.
+    router.setEndpoints(conn, {0, 0}, {100, 0});
+    EXPECT_FALSE(router.isPreview(conn));
+    router.finish();
+    EXPECT_EQ(counter.count, 1);
+
+    // Moving them does.
+    router.setEndpoints(conn, {0, 50}, {100, 50});
+    EXPECT_TRUE(router.isPreview(conn));
+    router.finish();
+    EXPECT_FALSE(router.isPreview(conn));
+    EXPECT_EQ(counter.count, 2);
+    EXPECT_EQ(router.route(conn).ps.back(), Avoid::Point(100, 50));
+}
+
+TEST_F(ConnectorRouterTest, OnlyAffectedConnectorsAreRerouted)
+{
+    ConnectorRouter router;
+    auto const shape = router.addShape(box(40, -10, 60, 10));
+
+    Counter near, far;
+    auto const a = router.addConnector(Avoid::ConnType_PolyLine, &Counter::callback, &near);
+    auto const b = router.addConnector(Avoid::ConnType_PolyLine, &Counter::callback, &far);
+    router.setEndpoints(a, {0, 0}, {100, 0});
+    router.setEndpoints(b, {0, 1000}, {100, 1000});
+    router.finish();
+    EXPECT_EQ(near.count, 1);
+    EXPECT_EQ(far.count, 1);
+
+    // Moving the obstacle out of the way straightens a, and leaves b alone.
+    router.moveShape(shape, box(40, 100, 60, 120));
+    router.finish();
+    EXPECT_EQ(near.count, 2);
+    EXPECT_EQ(far.count, 1);
+    EXPECT_EQ(router.route(a).size(), 2);
+
+    // Removed connectors get no more routes.
+    router.setEndpoints(a, {0, 10}, {100, 10});
+    router.reroute();
+    auto const count = near.count;
+    router.setEndpoints(a, {0, 20}, {100, 20});
+    router.reroute();
+    router.removeConnector(a);
+    router.finish();
+    EXPECT_LE(near.count, count + 1);
+    EXPECT_FALSE(router.isInitialised(a));
+    EXPECT_EQ(far.count, 1);
+}
+
+TEST_F(ConnectorRouterTest, LatestTransactionWins)
+{
+    ConnectorRouter router;
+    for (int i = 0; i < 20; i++) {
+        router.addShape(box(i * 30, -10, i * 30 + 20, 10));
+    }
+    Counter counter;
+    auto const conn = router.addConnector(Avoid::ConnType_Orthogonal, &Counter::callback, &counter);
+
+    // Hand over many transactions without waiting for any of them.
+    constexpr int steps = 50;
+    for (int i = 0; i < steps; i++) {
+        router.setEndpoints(conn, {-20.0, -30.0 + i}, {620, 30.0 - i});
+        router.reroute();
+    }
+    router.finish();
+
+    EXPECT_FALSE(router.isPreview(conn));
+    EXPECT_GE(counter.count, 1);
+    EXPECT_LE(counter.count, steps);
+    EXPECT_EQ(router.route(conn).ps.front(), Avoid::Point(-20, -30 + steps - 1));
+    EXPECT_EQ(router.route(conn).ps.back(), Avoid::Point(620, 30 - steps + 1));
+}
+
+/*
+ * Drag an obstacle through a grid of them, routing after every step as on the canvas.
+ * Once the drag is over, every connector has its final route. See conn-router-benchmark.cpp
+ * for the time the main thread spends per step.
+ */
+TEST_F(ConnectorRouterTest, DragEndsWithAllRoutes)
+{
+    ConnectorRouter router;
+    std::vector<Avoid::Polygon> polys;
+    std::vector<unsigned> shapes;
+    for (int y = 0; y < 5; y++) {
+        for (int x = 0; x < 5; x++) {
+            polys.push_back(box(x * 50, y * 50, x * 50 + 30, y * 50 + 30));
+            shapes.push_back(router.addShape(polys.back()));
+        }
+    }
+
+    std::vector<Counter> counters(8);
+    std::vector<unsigned> conns;
+    std::vector<std::pair<Avoid::Point, Avoid::Point>> ends;
+    for (int i = 0; i < 8; i++) {
+        auto const type = i % 2 ? Avoid::ConnType_Orthogonal : Avoid::ConnType_PolyLine;
+        conns.push_back(router.addConnector(type, &Counter::callback, &counters[i]));
+        ends.emplace_back(Avoid::Point(-20, i * 30 + 5), Avoid::Point(270, 235 - i * 30));
+        router.setEndpoints(conns.back(), ends.back().first, ends.back().second);
+    }
+    router.finish();
+    for (auto const &counter : counters) {
+        ASSERT_EQ(counter.count, 1);
+    }
+
+    for (int i = 1; i <= 10; i++) {
+        router.moveShape(shapes.front(), moved(polys.front(), i * 4.0, i * 4.0));
+        router.reroute();
+    }
+    router.finish();
+
+    for (std::size_t i = 0; i < conns.size(); i++) {
+        EXPECT_FALSE(router.isPreview(conns[i]));
+        EXPECT_EQ(router.route(conns[i]).ps.front(), ends[i].first);
+        EXPECT_EQ(router.route(conns[i]).ps.back(), ends[i].second);
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
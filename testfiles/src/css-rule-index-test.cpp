@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the index of style sheet rules, which must match elements exactly like libcroco.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "3rdparty/libcroco/src/cr-sel-eng.h"
+#include "css/rule-index.h"
+#include "document.h"
+#include "inkscape.h"
+#include "object/sp-root.h"
+#include "style.h"
+#include "xml/croco-node-iface.h"
+#include "xml/node.h"
+
+using namespace std::literals;
+
+namespace Inkscape::CSS {
+namespace {
+
+constexpr auto svg = R"(
+<svg xmlns="http://www.w3.org/2000/svg" xmlns:svg="http://www.w3.org/2000/svg" width="100" height="100">
+  <style id="sheet1">
+    * { stroke-width: 1; }
+    rect { fill: red; opacity: 0.5; }
+    RECT { fill: purple; }
+    #r1, .a { fill: green; stroke: blue; }
+    .a.b { fill: yellow; }
+    g > rect { stroke: black; }
+    g .b { opacity: 0.25 !important; }
+    rect:first-child { stroke-dasharray: 1 2; }
+    rect[data-x] { stroke-linecap: round; }
+    circle.c#c1 { fill: orange; }
+    @font-face { font-family: Foo; src: url(foo.woff); }
+  </style>
+  <style id="sheet2">
+    .a { opacity: 0.75; }
+    rect.b { fill: navy; opacity: 1; }
+    svg rect { stroke-width: 3; }
+  </style>
+  <rect id="r1" x="0" y="0" width="10" height="10"/>
+  <rect class="a" x="0" y="0" width="10" height="10"/>
+  <rect class=" a   b " x="0" y="0" width="10" height="10"/>
+  <g id="g1">
+    <rect class="b" x="0" y="0" width="10" height="10"/>
+    <svg:rect class="a b" data-x="1" x="0" y="0" width="10" height="10"/>
+    <g><rect class="A" x="0" y="0" width="10" height="10"/></g>
+  </g>
+  <circle id="c1" class="c" r="5"/>
+  <circle class="c" r="5"/>
+  <ellipse class="a" rx="5" ry="5"/>
+</svg>)"sv;
+
+std::unique_ptr<SPDocument> load(std::string_view source)
+{
+    if (!Application::exists()) {
+        Application::create(false);
+    }
+    auto doc = SPDocument::createNewDocFromMem(source, false);
+    doc->ensureUpToDate();
+    return doc;
+}
+
+CRSelEng *sel_eng()
+{
+    static auto const eng = cr_sel_eng_new(&XML::croco_node_iface);
+    return eng;
+}
+
+std::vector<CRDeclaration *> match_with_libcroco(SPDocument *doc, XML::Node const *node)
+{
+    std::vector<CRDeclaration *> result;
+    CRPropList *props = nullptr;
+    cr_sel_eng_get_matched_properties_from_cascade(sel_eng(), doc->getStyleCascade(), node, &props);
+    for (auto p = props; p; p = cr_prop_list_get_next(p)) {
+        CRDeclaration *decl = nullptr;
+        cr_prop_list_get_decl(p, &decl);
+        result.push_back(decl);
+    }
+    cr_prop_list_destroy(props);
+    return result;
+}
+
+void for_each_element(XML::Node *node, auto &&f)
+{
+    if (node->type() == XML::NodeType::ELEMENT_NODE) {
+        f(node);
+    }
+    for (auto child = node->firstChild(); child; child = child->next()) {
+        for_each_element(child, f);
+    }
+}
+
+} // namespace
+
+TEST(CssRuleIndexTest, MatchesLikeLibcroco)
+{
+    auto doc = load(svg);
+    auto &index = doc->getStyleRuleIndex();
+
+    int elements = 0;
+    for_each_element(doc->getReprRoot(), [&] (XML::Node *node) {
+        auto const expected = match_with_libcroco(doc.get(), node);
+        auto const actual = index.match(doc->getStyleCascade(), sel_eng(), node);
+        ASSERT_TRUE(actual);
+        auto const id = node->attribute("id");
+        auto const classes = node->attribute("class");
+        EXPECT_EQ(*actual, expected) << node->name() << " #" << (id ? id : "") << " ." << (classes ? classes : "");
+        ++elements;
+    });
+    EXPECT_GT(elements, 10);
+
+    // Elements with the same name, id and classes share their result, unless a candidate rule
+    // looks at more than those.
+    EXPECT_GT(index.cachedResults(), 0);
+    EXPECT_LT(index.cachedResults(), elements);
+}
+
+TEST(CssRuleIndexTest, StylesFollowStyleSheetAndClassChanges)
+{
+    auto doc = load(R"(
+<svg xmlns="http://www.w3.org/2000/svg">
+  <style id="sheet">.a { opacity: 0.5; } .b { opacity: 0.25; }</style>
+  <rect id="r" class="a" width="10" height="10"/>
+</svg>)"sv);
+
+    auto rect = doc->getObjectById("r");
+    ASSERT_TRUE(rect);
+    EXPECT_EQ(rect->style->opacity.get_value(), Glib::ustring("0.5"));
+
+    rect->setAttribute("class", "b");
+    doc->ensureUpToDate();
+    EXPECT_EQ(rect->style->opacity.get_value(), Glib::ustring("0.25"));
+
+    auto sheet = doc->getObjectById("sheet")->getRepr();
+    sheet->firstChild()->setContent(".b { opacity: 0.75; }");
+    doc->ensureUpToDate();
+    EXPECT_EQ(rect->style->opacity.get_value(), Glib::ustring("0.75"));
+}
+
+TEST(CssRuleIndexTest, LeavesMediaRulesToLibcroco)
+{
+    auto doc = load(R"(
+<svg xmlns="http://www.w3.org/2000/svg">
+  <style>@media screen { rect { opacity: 0.5; } } rect { fill: red; }</style>
+  <rect id="r" width="10" height="10"/>
+</svg>)"sv);
+
+    auto rect = doc->getObjectById("r");
+    ASSERT_TRUE(rect);
+    EXPECT_FALSE(doc->getStyleRuleIndex().match(doc->getStyleCascade(), sel_eng(), rect->getRepr()));
+    EXPECT_EQ(rect->style->fill.get_value(), Glib::ustring("red"));
+}
+
+} // namespace Inkscape::CSS
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
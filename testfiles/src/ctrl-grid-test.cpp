@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the grid in which CanvasItemCtrlSet keeps its ctrls.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <vector>
+#include <2geom/rect.h>
+
+#include "display/control/ctrl-grid.h"
+
+namespace Inkscape {
+namespace {
+
+/// A ctrl as CanvasItemCtrlSet places it.
+struct Ctrl
+{
+    Geom::OptRect box;
+    std::int64_t z = 0;
+};
+
+/// The topmost ctrl at a point, testing every ctrl.
+std::optional<unsigned> brute_force_find(std::vector<Ctrl> const &ctrls, Geom::Point const &p, double tolerance)
+{
+    std::optional<unsigned> found;
+    for (unsigned id = 0; id < ctrls.size(); id++) {
+        auto const &ctrl = ctrls[id];
+        if (!ctrl.box) {
+            continue;
+        }
+        bool const hit = tolerance == 0 ? ctrl.box->interiorContains(p)
+                                        : Geom::distance(p, ctrl.box->midpoint()) <= tolerance;
+        if (hit && (!found || ctrl.z > ctrls[*found].z)) {
+            found = id;
+        }
+    }
+    return found;
+}
+
+Geom::Rect ctrl_box(Geom::Point const &center, double width)
+{
+    return Geom::Rect(center, center).expandedBy(width / 2);
+}
+
+} // namespace
+
+TEST(CtrlGridTest, FindsTheTopmostAfterLowering)
+{
+    CtrlGrid grid;
+    grid.place(0, ctrl_box({100, 100}, 10), 1);
+    grid.place(1, ctrl_box({104, 100}, 10), 2);
+    grid.place(2, ctrl_box({300, 100}, 10), 3);
+
+    EXPECT_EQ(grid.find({102, 100}), 1);
+    EXPECT_EQ(grid.find({97, 100}), 0);
+    EXPECT_EQ(grid.find({103, 100}, 3), 1);
+
+    // Lowering to the bottom keeps the box and only changes the order.
+    grid.place(1, ctrl_box({104, 100}, 10), -1);
+    EXPECT_EQ(grid.find({102, 100}), 0);
+    EXPECT_EQ(grid.find({107, 100}), 1);
+    EXPECT_EQ(grid.query(Geom::Rect(90, 90, 120, 110)), (std::vector<unsigned>{1, 0}));
+}
+
+TEST(CtrlGridTest, ReusedIdsLeaveNothingBehind)
+{
+    CtrlGrid grid;
+    auto const old_box = ctrl_box({100, 100}, 10);
+    auto const new_box = ctrl_box({500, 20}, 10);
+    grid.place(0, old_box, 1);
+    grid.place(1, ctrl_box({130, 100}, 10), 2);
+
+    // A removed ctrl whose id goes to the next ctrl added, both before the next update: the
+    // update only sees the id move to the new box.
+    grid.place(0, new_box, 3);
+    EXPECT_EQ(grid.box(0), Geom::OptRect(new_box));
+    EXPECT_EQ(grid.find({100, 100}), std::nullopt);
+    EXPECT_EQ(grid.find({500, 20}), 0);
+    EXPECT_EQ(grid.query(old_box), std::vector<unsigned>{});
+    EXPECT_EQ(grid.query(Geom::Rect(0, 0, 1000, 1000)), (std::vector<unsigned>{1, 0}));
+
+    // A removed ctrl without a new one in its place.
+    grid.place(0, {}, 3);
+    EXPECT_FALSE(grid.box(0));
+    EXPECT_EQ(grid.find({500, 20}), std::nullopt);
+    EXPECT_EQ(grid.query(Geom::Rect(0, 0, 1000, 1000)), std::vector<unsigned>{1});
+
+    grid.clear();
+    EXPECT_EQ(grid.find({130, 100}), std::nullopt);
+    EXPECT_FALSE(grid.box(1));
+}
+
+TEST(CtrlGridTest, MatchesBruteForceAfterMoves)
+{
+    auto gen = std::mt19937(5);
+    auto coord = std::uniform_real_distribution(-200.0, 1200.0);
+    auto width = std::uniform_real_distribution(3.0, 40.0);
+    auto index = std::uniform_int_distribution(0, 299);
+
+    CtrlGrid grid;
+    std::vector<Ctrl> ctrls(300);
+    std::int64_t top = 0;
+    std::int64_t bottom = 0;
+    auto place = [&] (unsigned id, Geom::OptRect const &box, std::int64_t z) {
+        ctrls[id] = {box, z};
+        grid.place(id, box, z);
+    };
+    for (unsigned id = 0; id < ctrls.size(); id++) {
+        place(id, ctrl_box({coord(gen), coord(gen)}, width(gen)), ++top);
+    }
+
+    auto check = [&] {
+        for (int i = 0; i < 500; i++) {
+            auto const p = Geom::Point(coord(gen), coord(gen));
+            ASSERT_EQ(grid.find(p), brute_force_find(ctrls, p, 0)) << p;
+            ASSERT_EQ(grid.find(p, 8), brute_force_find(ctrls, p, 8)) << p;
+
+            // The ctrls in an area are among those queried, from the bottom up.
+            auto const area = ctrl_box(p, width(gen) * 3);
+            auto const queried = grid.query(area);
+            for (unsigned id = 0; id < ctrls.size(); id++) {
+                if (ctrls[id].box && ctrls[id].box->intersects(area)) {
+                    ASSERT_NE(std::find(queried.begin(), queried.end(), id), queried.end()) << id;
+                }
+            }
+            for (std::size_t j = 1; j < queried.size(); j++) {
+                ASSERT_LT(ctrls[queried[j - 1]].z, ctrls[queried[j]].z);
+            }
+        }
+    };
+    check();
+
+    // Ctrls move a little, as when dragged, far, are hidden, are shown again, and are raised
+    // or lowered.
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 200; i++) {
+            auto const id = index(gen);
+            auto const &ctrl = ctrls[id];
+            switch (i % 5) {
+                case 0:
+                    if (ctrl.box) {
+                        place(id, *ctrl.box + Geom::Point(3, -2), ctrl.z);
+                    }
+                    break;
+                case 1:
+                    place(id, ctrl_box({coord(gen), coord(gen)}, width(gen)), ctrl.z);
+                    break;
+                case 2:
+                    place(id, {}, ctrl.z);
+                    break;
+                case 3:
+                    place(id, ctrl_box({coord(gen), coord(gen)}, width(gen)), ++top);
+                    break;
+                case 4:
+                    place(id, ctrl.box, --bottom);
+                    break;
+            }
+        }
+        check();
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the Chrome trace output of Debug::Trace.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "debug/trace.h"
+
+namespace Inkscape::Debug {
+namespace {
+
+std::string record(auto &&f)
+{
+    Trace::clear();
+    Trace::start();
+    f();
+    Trace::stop();
+    std::ostringstream out;
+    Trace::write(out);
+    Trace::clear();
+    return out.str();
+}
+
+bool contains(std::string const &s, std::string const &part)
+{
+    return s.find(part) != std::string::npos;
+}
+
+} // namespace
+
+TEST(DebugTraceTest, NothingRecordedWhileInactive)
+{
+    ASSERT_FALSE(Trace::active());
+    {
+        auto span = Trace::Span("test", "before");
+        Trace::counter("test", "ignored", 1);
+    }
+    auto const trace = record([] {});
+    EXPECT_FALSE(contains(trace, R"("name": "before")"));
+    EXPECT_FALSE(contains(trace, R"("name": "ignored")"));
+    EXPECT_TRUE(contains(trace, R"("traceEvents": [)"));
+}
+
+TEST(DebugTraceTest, RecordsSpansCountersAndThreads)
+{
+    auto const trace = record([] {
+        {
+            auto span = Trace::Span("test", "outer", "detail \"quoted\"");
+            auto inner = Trace::Span("test", "inner");
+            Trace::counter("test", "items", 42);
+            Trace::instant("test", "marker");
+        }
+        std::thread([] {
+            Trace::setThreadName("test worker");
+            auto span = Trace::Span("test", "on worker");
+        }).join();
+    });
+
+    EXPECT_TRUE(contains(trace, R"("ph": "X", "pid": 1, "tid": )"));
+    EXPECT_TRUE(contains(trace, R"("cat": "test", "name": "outer")"));
+    EXPECT_TRUE(contains(trace, R"("args": {"detail": "detail \"quoted\""})"));
+    EXPECT_TRUE(contains(trace, R"("name": "inner")"));
+    EXPECT_TRUE(contains(trace, R"("name": "items")"));
+    EXPECT_TRUE(contains(trace, R"("args": {"value": 42})"));
+    EXPECT_TRUE(contains(trace, R"("ph": "i")"));
+    EXPECT_TRUE(contains(trace, R"("name": "thread_name", "args": {"name": "test worker"})"));
+    EXPECT_TRUE(contains(trace, R"("name": "on worker")"));
+
+    // The worker records on a thread of its own.
+    auto tid = [&] (std::string const &name) {
+        auto const pos = trace.rfind("\"tid\": ", trace.find("\"name\": \"" + name + "\""));
+        return std::stoi(trace.substr(pos + 7));
+    };
+    EXPECT_EQ(tid("outer"), tid("inner"));
+    EXPECT_NE(tid("outer"), tid("on worker"));
+}
+
+TEST(DebugTraceTest, SpansOpenWhenStoppedAreDropped)
+{
+    std::string trace;
+    {
+        Trace::start();
+        auto span = Trace::Span("test", "unfinished");
+        Trace::stop();
+        std::ostringstream out;
+        Trace::write(out);
+        trace = out.str();
+    }
+    Trace::clear();
+    EXPECT_FALSE(contains(trace, R"("name": "unfinished")"));
+}
+
+} // namespace Inkscape::Debug
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
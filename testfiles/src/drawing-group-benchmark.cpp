@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of rendering and picking a flat layer of many shapes, with and without indexing
+ * the children of the layer.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <2geom/int-rect.h>
+
+#include "display/drawing.h"
+
+#include "benchmark-utils.h"
+#include "drawing-test-utils.h"
+
+namespace Inkscape {
+
+/*
+ * Renders a flat layer of 100000 squares in tiles, and picks in it. Before: every child is
+ * tested. After: only the children whose boxes are in the area.
+ */
+TEST(DrawingGroupBenchmark, FlatLayer)
+{
+    constexpr int tile = 250;
+    constexpr int picks = 10000;
+    auto doc = load_document(flat_layer(100000));
+
+    for (bool const indexed : {false, true}) {
+        TestDisplay display(doc.get(), true);
+        display.drawing().setChildIndexing(indexed);
+        display.drawing().update();
+        std::string const suffix = indexed ? "_indexed" : "_linear";
+
+        auto const render_ms = time_ms([&] {
+            for (int y = 0; y < 1000; y += tile) {
+                for (int x = 0; x < 1000; x += tile) {
+                    display.render(Geom::IntRect::from_xywh(x, y, tile, tile));
+                }
+            }
+        }, 3);
+        record_value("render_ms_per_tile" + suffix, render_ms / (1000 / tile * 1000 / tile));
+
+        int picked = 0;
+        auto const pick_ms = time_ms([&] {
+            auto gen = std::mt19937(1);
+            auto coord = std::uniform_real_distribution(0.0, 1000.0);
+            picked = 0;
+            for (int i = 0; i < picks; i++) {
+                picked += display.drawing().pick({coord(gen), coord(gen)}, 1, DrawingItem::PICK_NORMAL) != nullptr;
+            }
+        }, 3);
+        EXPECT_GT(picked, 0);
+        record_value("pick_us" + suffix, pick_ms * 1000 / picks);
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
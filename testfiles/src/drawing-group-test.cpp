@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the index of the children of large groups.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+#include <2geom/int-rect.h>
+
+#include "display/bounding-box-tree.h"
+
+#include "drawing-test-utils.h"
+
+namespace Inkscape {
+namespace {
+
+std::vector<unsigned> brute_force_query(std::vector<Geom::OptIntRect> const &boxes, Geom::IntRect const &area)
+{
+    std::vector<unsigned> result;
+    for (unsigned i = 0; i < boxes.size(); i++) {
+        if (boxes[i] && boxes[i]->intersects(area)) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+Geom::IntRect random_box(std::mt19937 &gen, int extent, int max_size)
+{
+    auto coord = std::uniform_int_distribution(0, extent);
+    auto size = std::uniform_int_distribution(1, max_size);
+    auto const min = Geom::IntPoint(coord(gen), coord(gen));
+    return {min, min + Geom::IntPoint(size(gen), size(gen))};
+}
+
+} // namespace
+
+TEST(DrawingGroupTest, BoundingBoxTreeMatchesBruteForce)
+{
+    auto gen = std::mt19937(42);
+    std::vector<Geom::OptIntRect> boxes;
+    for (int i = 0; i < 5000; i++) {
+        boxes.emplace_back(i % 17 ? Geom::OptIntRect(random_box(gen, 10000, 200)) : Geom::OptIntRect());
+    }
+
+    BoundingBoxTree tree;
+    auto check = [&] {
+        for (int i = 0; i < 200; i++) {
+            auto const area = random_box(gen, 10000, 1000);
+            ASSERT_EQ(tree.query(area), brute_force_query(boxes, area));
+        }
+    };
+
+    tree.setBoxes(boxes);
+    check();
+
+    // A few boxes move, and the tree is refitted.
+    for (int i = 0; i < 100; i++) {
+        boxes[i * 37] = random_box(gen, 10000, 200);
+    }
+    tree.setBoxes(boxes);
+    check();
+
+    // Most boxes move, and the tree is rebuilt.
+    for (auto &box : boxes) {
+        box = random_box(gen, 10000, 50);
+    }
+    tree.setBoxes(boxes);
+    check();
+
+    tree.clear();
+    EXPECT_TRUE(tree.query(Geom::IntRect(0, 0, 10000, 10000)).empty());
+}
+
+TEST(DrawingGroupTest, IndexedChildrenPickLikeLinearScan)
+{
+    auto doc = load_document(flat_layer(2000));
+    TestDisplay display(doc.get(), true);
+    display.drawing().update();
+
+    std::vector<DrawingItem *> children;
+    for (int i = 0; i < 2000; i++) {
+        children.push_back(find_drawing_item(doc.get(), "r" + std::to_string(i)));
+    }
+
+    auto gen = std::mt19937(7);
+    auto coord = std::uniform_real_distribution(-5.0, 1005.0);
+    for (int i = 0; i < 2000; i++) {
+        auto const p = Geom::Point(coord(gen), coord(gen) / 5);
+        DrawingItem *expected = nullptr;
+        for (auto child : children) {
+            if ((expected = child->pick(p, 1.5))) {
+                break;
+            }
+        }
+        EXPECT_EQ(display.drawing().pick(p, 1.5, DrawingItem::PICK_NORMAL), expected) << p;
+    }
+
+    // Moving a child is seen by the index after the next update.
+    auto const rect = cast<SPItem>(doc->getObjectById("r0"));
+    rect->setAttribute("x", "995");
+    rect->setAttribute("y", "195");
+    doc->ensureUpToDate();
+    display.drawing().update();
+    EXPECT_EQ(display.drawing().pick({999, 199}, 0, DrawingItem::PICK_NORMAL), children[0]);
+    EXPECT_EQ(display.drawing().pick({4, 4}, 0, DrawingItem::PICK_NORMAL), nullptr);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -24,6 +24,7 @@
 #include "display/drawing-pattern.h"
 #include "display/drawing-surface.h"
 #include "display/drawing-context.h"
+#include "display/pattern-cache.h"
 
 namespace Inkscape {
 
@@ -140,4 +141,62 @@ TEST(DrawingPatternTest, ZeroRankPatternMatrix)
 
     EXPECT_FALSE(testPattern.renderPattern(fakeContext, Geom::IntRect::from_xywh(0, 0, 1, 1), 1.0, 1));
 }
+
+TEST(DrawingPatternTest, TileCache)
+{
+    Drawing drawing1, drawing2;
+    auto const tile_bytes = std::size_t{100} * 100 * 4;
+
+    auto fill = [&] (PatternCache &cache, Drawing const &drawing, int resolution) -> PatternCache::Entry & {
+        auto const key = PatternCache::Key{ .drawing = &drawing, .resolution = {resolution, resolution} };
+        auto &entry = cache.get(key);
+        if (entry.surfaces.empty()) {
+            entry.surfaces.emplace_back(Geom::IntRect::from_xywh(0, 0, 100, 100), 1);
+            cache.commit(entry);
+        }
+        return entry;
+    };
+
+    auto const total_before = PatternCache::totalBytes();
+    PatternCache::setBudget(3 * tile_bytes);
+    {
+        PatternCache cache;
+        auto lock = cache.lock();
+
+        // Entries with the same key are shared.
+        auto &first = fill(cache, drawing1, 1);
+        EXPECT_EQ(&fill(cache, drawing1, 1), &first);
+        EXPECT_EQ(cache.bytes(), tile_bytes);
+
+        // Exceeding the budget evicts the least recently used entry.
+        fill(cache, drawing1, 2);
+        fill(cache, drawing2, 1);
+        fill(cache, drawing1, 1);
+        fill(cache, drawing1, 3);
+        EXPECT_EQ(cache.bytes(), 3 * tile_bytes);
+        EXPECT_TRUE(cache.get({ .drawing = &drawing1, .resolution = {2, 2} }).surfaces.empty());
+        EXPECT_FALSE(cache.get({ .drawing = &drawing1, .resolution = {1, 1} }).surfaces.empty());
+
+        // Content changes only drop the tiles of the drawing they happened in.
+        lock.unlock();
+        cache.drop(&drawing1);
+        lock.lock();
+        EXPECT_EQ(cache.bytes(), tile_bytes);
+        EXPECT_FALSE(cache.get({ .drawing = &drawing2, .resolution = {1, 1} }).surfaces.empty());
+
+        // Bumping the generation frees the tiles of older ones straight away.
+        auto &current = cache.get({ .drawing = &drawing2, .generation = 1, .resolution = {1, 1} });
+        current.surfaces.emplace_back(Geom::IntRect::from_xywh(0, 0, 100, 100), 1);
+        cache.commit(current);
+        EXPECT_EQ(cache.bytes(), 2 * tile_bytes);
+        lock.unlock();
+        PatternCache::dropStale(&drawing2, 1);
+        lock.lock();
+        EXPECT_EQ(cache.bytes(), tile_bytes);
+        EXPECT_TRUE(cache.get({ .drawing = &drawing2, .resolution = {1, 1} }).surfaces.empty());
+        EXPECT_FALSE(cache.get({ .drawing = &drawing2, .generation = 1, .resolution = {1, 1} }).surfaces.empty());
+    }
+    EXPECT_EQ(PatternCache::totalBytes(), total_before);
+    PatternCache::setBudget(std::size_t{64} << 20);
+}
 } // namespace Inkscape
\ No newline at end of file
@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for picking the items of a drawing from a buffer of item ids.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <2geom/int-rect.h>
+
+#include "display/drawing-pick-buffer.h"
+
+#include "drawing-test-utils.h"
+
+namespace Inkscape {
+namespace {
+
+constexpr auto svg = std::string_view(R"(
+<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+  <defs>
+    <clipPath id="clip"><circle cx="82" cy="77" r="4"/></clipPath>
+  </defs>
+  <rect id="back" x="0" y="0" width="100" height="70" fill="#eeeeee"/>
+  <g id="group">
+    <rect id="a" x="20" y="20" width="30" height="30" fill="blue"/>
+    <rect id="b" x="40" y="40" width="20" height="20" fill="red"/>
+  </g>
+  <rect id="transparent" x="5" y="5" width="10" height="10" fill="red" opacity="0"/>
+  <rect id="clipped" x="70" y="72" width="25" height="10" fill="black" clip-path="url(#clip)"/>
+  <path id="line" d="M10 85 H90" stroke="green" stroke-width="6" fill="none"/>
+  <path id="hairline" d="M22 25.3 H48" stroke="black" fill="none" style="-inkscape-stroke:hairline"/>
+  <path id="thin" d="M22 30.3 H48" stroke="black" stroke-width="0.2" fill="none"/>
+</svg>)");
+
+/// Give a display, picking the children of the root as the canvas does, a pick buffer.
+DrawingPickBuffer &add_pick_buffer(TestDisplay &display)
+{
+    display.drawing().setPickBuffer(true);
+    display.drawing().update();
+    return *display.drawing().pickBuffer();
+}
+
+/// The item picking the geometry returns.
+DrawingItem *geometric_pick(TestDisplay &display, Geom::Point const &p, double delta = 0)
+{
+    return display.drawing().root()->pick(p, delta, DrawingItem::PICK_NORMAL);
+}
+
+Geom::Point center(int x, int y)
+{
+    return {x + 0.5, y + 0.5};
+}
+
+} // namespace
+
+TEST(DrawingPickBufferTest, MatchesGeometricPicks)
+{
+    auto doc = load_document(svg);
+    TestDisplay display(doc.get(), true);
+    auto &buffer = add_pick_buffer(display);
+    auto const area = Geom::IntRect(0, 0, 100, 100);
+    display.drawing().renderPickIds(area);
+    EXPECT_EQ(buffer.pixels(), area.area());
+
+    // Anywhere in a pixel, not just at its center, where ids are painted.
+    int known = 0;
+    for (int y = 0; y < 100; y++) {
+        for (int x = 0; x < 100; x++) {
+            known += buffer.lookup(center(x, y)) != nullptr;
+            for (auto const offset : {Geom::Point(0.5, 0.5), Geom::Point(0.1, 0.1), Geom::Point(0.9, 0.3),
+                                      Geom::Point(0.3, 0.9), Geom::Point(0.9, 0.9)}) {
+                auto const p = Geom::Point(x, y) + offset;
+                if (auto const looked_up = buffer.lookup(p)) {
+                    EXPECT_EQ(looked_up, geometric_pick(display, p)) << "at " << p;
+                }
+                EXPECT_EQ(display.drawing().pick(p, 0, DrawingItem::PICK_NORMAL), geometric_pick(display, p));
+            }
+        }
+    }
+    EXPECT_GT(known, 60 * 100);
+
+    // Clipped items are left to the geometry, and transparent ones aren't picked at all.
+    EXPECT_EQ(buffer.lookup(center(82, 77)), nullptr);
+    EXPECT_EQ(geometric_pick(display, center(82, 77)), find_drawing_item(doc.get(), "clipped"));
+    EXPECT_EQ(buffer.lookup(center(10, 10)), geometric_pick(display, center(10, 10)));
+    EXPECT_NE(buffer.lookup(center(10, 10)), find_drawing_item(doc.get(), "transparent"));
+
+    // The group picks as a whole, and the stroke as far as its width reaches, less the border.
+    EXPECT_EQ(buffer.lookup(center(45, 45)), geometric_pick(display, center(30, 30)));
+    EXPECT_EQ(buffer.lookup(center(50, 86)), find_drawing_item(doc.get(), "line"));
+    EXPECT_EQ(buffer.lookup(center(50, 87)), nullptr);
+    EXPECT_EQ(geometric_pick(display, center(50, 87)), find_drawing_item(doc.get(), "line"));
+
+    // Lines thinner than a pixel don't cover the center of the pixels they go through, which
+    // are left to the geometry rather than showing the rect below.
+    for (auto const id : {"hairline", "thin"}) {
+        auto const line = find_drawing_item(doc.get(), id);
+        auto const y = std::string_view(id) == "thin" ? 30.3 : 25.3;
+        EXPECT_EQ(geometric_pick(display, {30.5, y}), line) << id;
+        EXPECT_EQ(buffer.lookup({30.5, y}), nullptr) << id;
+        EXPECT_EQ(display.drawing().pick({30.5, y}, 0, DrawingItem::PICK_NORMAL), line) << id;
+    }
+}
+
+TEST(DrawingPickBufferTest, OnlyKnowsUniformTolerance)
+{
+    auto doc = load_document(svg);
+    TestDisplay display(doc.get(), true);
+    auto &buffer = add_pick_buffer(display);
+    display.drawing().renderPickIds(Geom::IntRect(0, 0, 100, 100));
+
+    auto const line = find_drawing_item(doc.get(), "line");
+    EXPECT_EQ(buffer.lookup(center(50, 85), 1), line);
+    EXPECT_EQ(buffer.lookup(center(50, 86), 1), nullptr);
+    EXPECT_EQ(display.drawing().pick(center(50, 86), 1, DrawingItem::PICK_NORMAL), geometric_pick(display, center(50, 86), 1));
+}
+
+TEST(DrawingPickBufferTest, ForgetsChangedAreasAndItems)
+{
+    auto doc = load_document(svg);
+    TestDisplay display(doc.get(), true);
+    auto &buffer = add_pick_buffer(display);
+    for (int y = 0; y < 100; y += 50) {
+        for (int x = 0; x < 100; x += 50) {
+            display.drawing().renderPickIds(Geom::IntRect::from_xywh(x, y, 50, 50));
+        }
+    }
+    EXPECT_EQ(buffer.pixels(), 100 * 100);
+
+    // Known areas aren't rendered again.
+    display.drawing().renderPickIds(Geom::IntRect(10, 10, 40, 40));
+    EXPECT_EQ(buffer.pixels(), 100 * 100);
+
+    auto const line = find_drawing_item(doc.get(), "line");
+    ASSERT_EQ(buffer.lookup(center(20, 85)), line);
+    buffer.invalidate(Geom::IntRect(10, 80, 20, 90));
+    EXPECT_EQ(buffer.pixels(), 3 * 50 * 50);
+    EXPECT_EQ(buffer.lookup(center(20, 85)), nullptr);
+    EXPECT_EQ(buffer.lookup(center(70, 85)), line);
+
+    buffer.forget(line);
+    EXPECT_EQ(buffer.lookup(center(70, 85)), nullptr);
+
+    // Moving the drawing forgets everything.
+    display.drawing().update(Geom::IntRect::infinite(), Geom::Scale(2), DrawingItem::STATE_ALL, DrawingItem::STATE_ALL);
+    EXPECT_EQ(buffer.pixels(), 0);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the per-item render statistics of a drawing.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+
+#include "display/drawing-profiler.h"
+
+#include "drawing-test-utils.h"
+
+namespace Inkscape {
+namespace {
+
+constexpr auto svg = std::string_view(R"(
+<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+  <defs>
+    <filter id="blur" x="-0.5" y="-0.5" width="2" height="2">
+      <feGaussianBlur stdDeviation="6"/>
+    </filter>
+  </defs>
+  <rect id="plain" x="10" y="10" width="20" height="20" fill="blue"/>
+  <g id="group">
+    <rect id="blurred" x="50" y="50" width="30" height="30" fill="green" style="filter:url(#blur)"/>
+  </g>
+</svg>)");
+
+/// Render a frame of a display recording to a profiler.
+Cairo::RefPtr<Cairo::ImageSurface> frame(TestDisplay &display, Geom::IntRect const &area)
+{
+    auto profiler = display.drawing().profiler();
+    profiler->beginFrame();
+    auto surface = display.render(area);
+    profiler->endFrame();
+    return surface;
+}
+
+} // namespace
+
+TEST(DrawingProfilerTest, RecordsItemsPerFrame)
+{
+    auto doc = load_document(svg);
+    auto profiler = std::make_shared<DrawingProfiler>();
+    auto const area = Geom::IntRect(0, 0, 100, 100);
+
+    std::string report;
+    {
+        TestDisplay display(doc.get());
+        display.drawing().setProfiler(profiler);
+        frame(display, area);
+        frame(display, area);
+
+        auto const plain = profiler->itemStats(find_drawing_item(doc.get(), "plain"));
+        auto const blurred = profiler->itemStats(find_drawing_item(doc.get(), "blurred"));
+
+        ASSERT_EQ(profiler->frames().size(), 2);
+        EXPECT_EQ(plain.renders, 2);
+        EXPECT_EQ(plain.pixels, 2 * 20 * 20);
+        EXPECT_GE(plain.updates, 1);
+        EXPECT_EQ(plain.filter_time, 0);
+
+        // Filtered items are always cached, so the second frame is served from the cache.
+        EXPECT_EQ(blurred.renders, 2);
+        EXPECT_EQ(blurred.cache_hits, 1);
+        EXPECT_GT(blurred.filter_time, 0);
+        EXPECT_LE(blurred.filter_time, blurred.render_time);
+
+        // Times exclude those of children, so they add up to no more than the frames took.
+        auto const total = profiler->totalStats();
+        EXPECT_LE(total.render_time + total.update_time, profiler->totalDuration());
+
+        std::ostringstream out;
+        profiler->writeReport(out);
+        report = out.str();
+
+        // Hidden items are only counted in the total of the destroyed ones.
+        display.hide();
+        EXPECT_GE(profiler->destroyedItems(), 4);
+        EXPECT_EQ(profiler->destroyedStats().renders, total.renders);
+        EXPECT_EQ(profiler->destroyedStats().pixels, total.pixels);
+        std::ostringstream after;
+        profiler->writeReport(after);
+        EXPECT_EQ(after.str().find(R"("id": "plain")"), std::string::npos);
+    }
+
+    auto const blurred = report.find(R"("id": "blurred", "type": "svg:rect")");
+    auto const plain = report.find(R"("id": "plain", "type": "svg:rect")");
+    ASSERT_NE(blurred, std::string::npos);
+    ASSERT_NE(plain, std::string::npos);
+    EXPECT_LT(blurred, plain) << "The most expensive items come first";
+    EXPECT_NE(report.find(R"("id": "group", "type": "svg:g")"), std::string::npos);
+    EXPECT_NE(report.find(R"("bbox": [10, 10, 30, 30])"), std::string::npos);
+}
+
+TEST(DrawingProfilerTest, KeepsTheLastFrames)
+{
+    auto doc = load_document(svg);
+    auto profiler = std::make_shared<DrawingProfiler>();
+    auto const area = Geom::IntRect(0, 0, 100, 100);
+
+    TestDisplay display(doc.get());
+    display.drawing().setProfiler(profiler);
+    frame(display, area);
+    auto const first = profiler->totalStats();
+
+    // Frames in which nothing is drawn, to go round the ring cheaply.
+    for (std::size_t i = 0; i < DrawingProfiler::max_frames + 10; i++) {
+        profiler->beginFrame();
+        profiler->endFrame();
+    }
+    frame(display, area);
+
+    auto const frames = profiler->frames();
+    ASSERT_EQ(frames.size(), DrawingProfiler::max_frames);
+    EXPECT_EQ(profiler->frameCount(), DrawingProfiler::max_frames + 12);
+    EXPECT_GT(frames.back().items, 0) << "The newest frame comes last";
+    EXPECT_EQ(frames.front().items, 0);
+
+    // The totals still cover the frames that were dropped.
+    EXPECT_EQ(profiler->totalStats().renders, 2 * first.renders);
+
+    profiler->clear();
+    EXPECT_TRUE(profiler->frames().empty());
+    EXPECT_EQ(profiler->frameCount(), 0);
+    EXPECT_EQ(profiler->totalStats().renders, 0);
+    EXPECT_EQ(profiler->destroyedItems(), 0);
+}
+
+TEST(DrawingProfilerTest, OverlayHighlightsExpensiveItems)
+{
+    auto doc = load_document(svg);
+    auto profiler = std::make_shared<DrawingProfiler>();
+    auto const area = Geom::IntRect(0, 0, 100, 100);
+
+    TestDisplay display(doc.get());
+    display.drawing().setProfiler(profiler);
+    auto const plain = frame(display, area);
+    profiler->setOverlay(true);
+    auto const overlay = frame(display, area);
+
+    auto pixel = [] (Cairo::RefPtr<Cairo::ImageSurface> const &surface, int x, int y) {
+        surface->flush();
+        return *reinterpret_cast<guint32 const *>(surface->get_data() + y * surface->get_stride() + x * 4);
+    };
+
+    // The fringe of the blur has no red in it, until the overlay paints the drawbox of the
+    // blurred rectangle, the most expensive item, in red.
+    EXPECT_EQ(pixel(plain, 93, 93) >> 16 & 0xff, 0);
+    auto const heat = pixel(overlay, 93, 93);
+    EXPECT_GT(heat >> 16 & 0xff, heat >> 8 & 0xff);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmarks of redrawing long paths in tiles.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <memory>
+#include <gtest/gtest.h>
+#include <2geom/int-rect.h>
+
+#include "display/flattened-path.h"
+
+#include "benchmark-utils.h"
+#include "drawing-shape-test-utils.h"
+
+namespace Inkscape {
+
+/*
+ * Redraws a long wavy path in tiles, from its curves and from its lines, flattened once.
+ */
+TEST(DrawingShapeBenchmark, TiledRedraw)
+{
+    auto const pathv = wave(2000);
+    auto const ctm = Geom::Scale(0.5, 4);
+    auto const box = (pathv * ctm).boundsFast()->roundOutwards();
+    double const width = 2;
+
+    auto redraw = [&] (auto &&feed) {
+        int tiles = 0;
+        for (int y = box.top(); y < box.bottom(); y += 256) {
+            for (int x = box.left(); x < box.right(); x += 256) {
+                auto const area = Geom::IntRect::from_xywh(x, y, 256, 256);
+                draw(area, width, [&] (DrawingContext &dc) { feed(dc, area); });
+                tiles++;
+            }
+        }
+        return tiles;
+    };
+
+    int tiles = 0;
+    auto const curves_ms = time_ms([&] {
+        tiles = redraw([&] (DrawingContext &dc, Geom::IntRect const &) {
+            dc.transform(ctm);
+            dc.path(pathv);
+            dc.transform(ctm.inverse());
+        });
+    });
+    record_value("tiles", tiles);
+    record_value("curves", pathv.curveCount());
+    record_value("curves_ms_per_tile", curves_ms / tiles);
+
+    std::unique_ptr<FlattenedPath const> flattened;
+    record_value("flatten_ms", time_ms([&] { flattened = FlattenedPath::create(pathv, ctm); }));
+    ASSERT_TRUE(flattened);
+    record_value("points", flattened->size());
+
+    auto const lines_ms = time_ms([&] {
+        redraw([&] (DrawingContext &dc, Geom::IntRect const &area) {
+            flattened->feed(dc, Geom::Rect(area).expandedBy(1 + width / 2 * M_SQRT2));
+        });
+    });
+    record_value("flattened_ms_per_tile", lines_ms / tiles);
+}
+
+/*
+ * Redraws a wavy shape in tiles, rasterising it every time and painting it through its coverage
+ * masks, the first time making them.
+ */
+TEST(DrawingShapeBenchmark, MaskedRedraw)
+{
+    auto doc = load_document(wave_document(100, 300));
+    TestDisplay plain(doc.get());
+    TestDisplay masked(doc.get());
+    use_masks(plain, 0);
+    use_masks(masked, 64 << 20);
+
+    constexpr int tiles = 30;
+    auto redraw = [&] (TestDisplay &display) {
+        for (int y = 0; y < 300; y += 100) {
+            for (int x = 0; x < 1000; x += 100) {
+                display.render(Geom::IntRect::from_xywh(x, y, 100, 100));
+            }
+        }
+    };
+
+    record_value("rasterised_ms_per_tile", time_ms([&] { redraw(plain); }) / tiles);
+    record_value("first_masked_ms_per_tile", time_ms([&] { redraw(masked); }, 1) / tiles);
+    record_value("masked_ms_per_tile", time_ms([&] { redraw(masked); }) / tiles);
+    record_value("mask_bytes", masked.drawing().maskBytes());
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Shared test header drawing long paths and showing them, for the shape tests and benchmarks.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_TESTFILES_DRAWING_SHAPE_TEST_UTILS_H
+#define INKSCAPE_TESTFILES_DRAWING_SHAPE_TEST_UTILS_H
+
+#include <cstddef>
+#include <string>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+#include <2geom/path-sink.h>
+#include <2geom/pathvector.h>
+
+#include "display/drawing-context.h"
+
+#include "drawing-test-utils.h"
+
+namespace Inkscape {
+
+/**
+ * A closed wave of cubic Beziers and arcs, a hundred units per period.
+ */
+inline Geom::PathVector wave(int periods)
+{
+    Geom::PathBuilder builder;
+    builder.moveTo({0, 50});
+    for (int i = 0; i < periods; i++) {
+        double const x = i * 100;
+        builder.curveTo({x + 25, 0}, {x + 25, 100}, {x + 50, 50});
+        builder.arcTo(25, 40, 0, false, i % 2, {x + 100, 50});
+    }
+    builder.lineTo({periods * 100.0, 200});
+    builder.lineTo({0, 200});
+    builder.closePath();
+    builder.flush();
+    return builder.peek();
+}
+
+/**
+ * Fill and stroke a path given by a function feeding it to a context.
+ */
+template <typename F>
+Cairo::RefPtr<Cairo::ImageSurface> draw(Geom::IntRect const &area, double width, F &&feed)
+{
+    auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, area.width(), area.height());
+    auto dc = DrawingContext(surface->cobj(), area.min());
+    feed(dc);
+    dc.setSource(0.2, 0.4, 0.6, 0.5);
+    dc.fillPreserve();
+    dc.setSource(0.0, 0.0, 0.0, 1.0);
+    dc.setLineWidth(width);
+    dc.setLineCap(CAIRO_LINE_CAP_SQUARE);
+    dc.strokePreserve();
+    dc.newPath();
+    surface->flush();
+    return surface;
+}
+
+/**
+ * The path data of a closed wave of cubic Beziers, ten pixels per period.
+ */
+inline std::string wave_data(int periods, int amplitude)
+{
+    std::string d = "M 0,100";
+    for (int i = 0; i < periods; i++) {
+        d += " c 3," + std::to_string(-amplitude) + " 7," + std::to_string(amplitude) + " 10,0";
+    }
+    return d + " V 300 H 0 Z";
+}
+
+/**
+ * A document of a filled and stroked wave, a thousand pixels wide and three hundred high.
+ */
+inline std::string wave_document(int periods, int amplitude)
+{
+    return R"(<svg xmlns="http://www.w3.org/2000/svg" width="1000" height="300">
+<path id="wave" fill="#3465a4" fill-opacity="0.6" stroke="#000000" stroke-width="3" d=")" +
+           wave_data(periods, amplitude) + R"("/></svg>)";
+}
+
+/**
+ * Paint shapes through coverage masks within the given budget, or directly with zero.
+ */
+inline void use_masks(TestDisplay &display, std::size_t mask_budget)
+{
+    display.drawing().setMaskBudget(mask_budget);
+}
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_TESTFILES_DRAWING_SHAPE_TEST_UTILS_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
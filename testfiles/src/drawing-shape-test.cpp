@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for paths flattened once for all the tiles of a shape and for coverage masks.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+#include <2geom/path-sink.h>
+
+#include "display/coverage-mask.h"
+#include "display/flattened-path.h"
+
+#include "drawing-shape-test-utils.h"
+#include "drawing-test-utils.h"
+
+namespace Inkscape {
+namespace {
+
+/// The largest difference between the channels of two surfaces of the same size.
+int max_difference(Cairo::RefPtr<Cairo::ImageSurface> const &a, Cairo::RefPtr<Cairo::ImageSurface> const &b)
+{
+    int result = 0;
+    for (int y = 0; y < a->get_height(); y++) {
+        auto const row_a = a->get_data() + y * a->get_stride();
+        auto const row_b = b->get_data() + y * b->get_stride();
+        for (int x = 0; x < a->get_width() * 4; x++) {
+            result = std::max(result, std::abs(row_a[x] - row_b[x]));
+        }
+    }
+    return result;
+}
+
+/// Render a wave document in tiles, returning the largest difference between two displays.
+int compare(TestDisplay &a, TestDisplay &b)
+{
+    int result = 0;
+    for (int y = 0; y < 300; y += 100) {
+        for (int x = 0; x < 1000; x += 100) {
+            auto const area = Geom::IntRect::from_xywh(x, y, 100, 100);
+            result = std::max(result, max_difference(a.render(area), b.render(area)));
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(DrawingShapeTest, FlattenedPathIsWithinTolerance)
+{
+    auto const pathv = wave(4);
+    auto const ctm = Geom::Scale(3) * Geom::Rotate::from_degrees(20) * Geom::Translate(10, 20);
+    auto const flattened = FlattenedPath::create(pathv, ctm);
+    ASSERT_TRUE(flattened);
+
+    auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, 1, 1);
+    auto dc = DrawingContext(surface->cobj(), {});
+    flattened->feed(dc);
+
+    // Each line, checked at its ends and its middle, keeps close to the curves.
+    auto const screen = pathv * ctm;
+    auto const path = cairo_copy_path(dc.raw());
+    Geom::Point last;
+    for (int i = 0; i < path->num_data; i += path->data[i].header.length) {
+        auto const &data = path->data[i];
+        if (data.header.type == CAIRO_PATH_CLOSE_PATH) {
+            continue;
+        }
+        ASSERT_NE(data.header.type, CAIRO_PATH_CURVE_TO);
+        auto const p = Geom::Point(path->data[i + 1].point.x, path->data[i + 1].point.y);
+        for (auto q : {p, Geom::middle_point(last, p)}) {
+            if (data.header.type == CAIRO_PATH_MOVE_TO && q != p) {
+                continue;
+            }
+            auto const nearest = screen.nearestTime(q);
+            ASSERT_TRUE(nearest);
+            EXPECT_LE(Geom::distance(q, screen.pointAt(*nearest)), FlattenedPath::TOLERANCE * 1.01) << q;
+        }
+        last = p;
+    }
+    cairo_path_destroy(path);
+}
+
+TEST(DrawingShapeTest, CulledPathDrawsTheSame)
+{
+    auto const pathv = wave(50);
+    auto const ctm = Geom::Scale(2);
+    auto const flattened = FlattenedPath::create(pathv, ctm);
+    ASSERT_TRUE(flattened);
+
+    double const width = 6;
+    constexpr double cairo_tolerance = 0.1;
+    int const max_edge_difference = std::ceil((FlattenedPath::TOLERANCE + cairo_tolerance) * 255);
+    for (auto const &area : {Geom::IntRect(0, 0, 256, 256), Geom::IntRect(4000, 100, 4256, 356),
+                             Geom::IntRect(7000, 300, 7256, 556), Geom::IntRect(9900, 350, 10100, 420)}) {
+        auto const cull = Geom::Rect(area).expandedBy(1 + width / 2 * M_SQRT2);
+        auto const whole = draw(area, width, [&] (DrawingContext &dc) { flattened->feed(dc); });
+        auto const culled = draw(area, width, [&] (DrawingContext &dc) { flattened->feed(dc, cull); });
+        EXPECT_LE(max_difference(whole, culled), 1) << area;
+
+        // Cairo flattens the curves within 0.1 pixel too, so an edge moves by at most both
+        // tolerances, which changes the coverage of the pixels along it by as much.
+        auto const exact = draw(area, width, [&] (DrawingContext &dc) {
+            dc.transform(ctm);
+            dc.path(pathv);
+            dc.transform(ctm.inverse());
+        });
+        EXPECT_LE(max_difference(exact, culled), max_edge_difference) << area;
+    }
+}
+
+TEST(DrawingShapeTest, TooLongPathsAreRejected)
+{
+    Geom::PathBuilder builder;
+    builder.moveTo({0, 0});
+    builder.lineTo({1e9, 0});
+    builder.flush();
+
+    // A line needs no more points however long it is; a huge arc would need too many.
+    EXPECT_TRUE(FlattenedPath::create(builder.peek(), Geom::identity()));
+    auto arc = Geom::PathBuilder();
+    arc.moveTo({0, 0});
+    arc.arcTo(1e6, 1e6, 0, true, true, {1, 0});
+    arc.flush();
+    EXPECT_FALSE(FlattenedPath::create(arc.peek(), Geom::Scale(1e6)));
+}
+
+TEST(DrawingShapeTest, CoverageMasksDrawTheSame)
+{
+    auto doc = load_document(wave_document(100, 80));
+    TestDisplay plain(doc.get());
+    TestDisplay masked(doc.get());
+    use_masks(plain, 0);
+    use_masks(masked, 64 << 20);
+
+    // Once rasterising the masks, and once painting through them.
+    EXPECT_LE(compare(masked, plain), 2);
+    EXPECT_LE(compare(masked, plain), 2);
+
+    // The masks are thrown away when the path or the style change.
+    auto const path = doc->getObjectById("wave");
+    auto change = [&] (char const *key, std::string const &value) {
+        path->setAttribute(key, value);
+        doc->ensureUpToDate();
+        EXPECT_LE(compare(masked, plain), 2) << key;
+        EXPECT_LE(compare(masked, plain), 2) << key;
+    };
+    change("d", wave_data(100, 40));
+    change("stroke-width", "9");
+    change("d", wave_data(2, 40)); // Too short for masks.
+}
+
+TEST(DrawingShapeTest, CoverageMasksFollowWholePixelMoves)
+{
+    auto doc = load_document(wave_document(100, 80));
+    TestDisplay plain(doc.get());
+    TestDisplay masked(doc.get());
+    use_masks(plain, 0);
+    use_masks(masked, 64 << 20);
+    EXPECT_LE(compare(masked, plain), 2);
+    auto const bytes = masked.drawing().maskBytes();
+    EXPECT_GT(bytes, 0);
+
+    auto const path = doc->getObjectById("wave");
+    auto move = [&] (char const *transform) {
+        path->setAttribute("transform", transform);
+        doc->ensureUpToDate();
+        masked.drawing().update();
+    };
+
+    // Moving by whole pixels shifts the masks, while moving by a fraction of one makes them again.
+    move("translate(30,-20)");
+    EXPECT_EQ(masked.drawing().maskBytes(), bytes);
+    EXPECT_LE(compare(masked, plain), 2);
+    move("translate(30.5,-20)");
+    EXPECT_EQ(masked.drawing().maskBytes(), 0);
+    EXPECT_LE(compare(masked, plain), 2);
+}
+
+TEST(DrawingShapeTest, CoverageMasksOutliveScrolling)
+{
+    auto doc = load_document(wave_document(100, 80));
+    TestDisplay plain(doc.get());
+    TestDisplay masked(doc.get());
+    use_masks(plain, 0);
+    use_masks(masked, 64 << 20);
+    masked.drawing().setCacheLimit(Geom::IntRect(0, 0, 500, 300));
+    EXPECT_LE(compare(masked, plain), 2);
+    auto const bytes = masked.drawing().maskBytes();
+
+    // The canvas moves the cache limit along with its store.
+    masked.drawing().setCacheLimit(Geom::IntRect(500, 0, 1000, 300));
+    masked.drawing().update();
+    EXPECT_EQ(masked.drawing().maskBytes(), bytes);
+    EXPECT_LE(compare(masked, plain), 2);
+}
+
+TEST(DrawingShapeTest, CoverageMasksStayWithinBudget)
+{
+    auto doc = load_document(wave_document(100, 80));
+    TestDisplay plain(doc.get());
+    TestDisplay masked(doc.get());
+    use_masks(plain, 0);
+
+    // The wave meets eight chunks; the least recently used make room for the others.
+    auto const budget = 3 * CoverageMask::chunkBytes(1);
+    use_masks(masked, budget);
+    EXPECT_LE(compare(masked, plain), 2);
+    EXPECT_LE(compare(masked, plain), 2);
+    EXPECT_GT(masked.drawing().maskBytes(), 0);
+    EXPECT_LE(masked.drawing().maskBytes(), budget);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
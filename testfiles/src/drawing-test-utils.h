@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Shared test header for showing documents in a drawing and rendering them.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_TESTFILES_DRAWING_TEST_UTILS_H
+#define INKSCAPE_TESTFILES_DRAWING_TEST_UTILS_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-item.h"
+#include "display/drawing-surface.h"
+#include "object/sp-root.h"
+
+namespace Inkscape {
+
+/**
+ * Create a document from SVG source, ready to be shown.
+ */
+inline std::unique_ptr<SPDocument> load_document(std::string_view svg)
+{
+    if (!Application::exists()) {
+        Application::create(false);
+    }
+    auto doc = SPDocument::createNewDocFromMem(svg, false);
+    doc->ensureUpToDate();
+    return doc;
+}
+
+/**
+ * A document with a layer of squares in rows of a hundred, each ten pixels apart.
+ */
+inline std::string flat_layer(int count)
+{
+    std::string svg = R"(<svg xmlns="http://www.w3.org/2000/svg" xmlns:inkscape="http://www.inkscape.org/namespaces/inkscape" width="1000" height="1000">
+<g id="layer" inkscape:groupmode="layer">)";
+    for (int i = 0; i < count; i++) {
+        svg += "<rect id=\"r" + std::to_string(i) + "\" x=\"" + std::to_string(i % 100 * 10) + "\" y=\"" +
+               std::to_string(i / 100 * 10) + "\" width=\"8\" height=\"8\" fill=\"#3465a4\"/>";
+    }
+    return svg + "</g></svg>";
+}
+
+/**
+ * The drawing item showing the object with the given id, or null if it isn't shown.
+ */
+inline DrawingItem *find_drawing_item(SPDocument *doc, std::string const &id)
+{
+    auto const item = cast<SPItem>(doc->getObjectById(id));
+    return item && !item->views.empty() ? item->views.front().drawingitem.get() : nullptr;
+}
+
+/**
+ * A document shown in a drawing of its own, without a canvas. Nothing is cached, so that
+ * every render draws everything; tests wanting otherwise configure drawing() themselves.
+ */
+class TestDisplay
+{
+public:
+    /// With layers set, the children of the root are shown as layers, as the canvas does.
+    explicit TestDisplay(SPDocument *doc, bool layers = false)
+        : _root(doc->getRoot())
+        , _dkey(SPItem::display_key_new(1))
+    {
+        if (layers) {
+            _root->setLayerDisplayMode(_dkey, SPGroup::LAYER);
+        }
+        _drawing.setRoot(_root->invoke_show(_drawing, _dkey, SP_ITEM_SHOW_DISPLAY));
+        _drawing.setCacheBudget(0);
+    }
+
+    TestDisplay(TestDisplay const &) = delete;
+    TestDisplay &operator=(TestDisplay const &) = delete;
+    ~TestDisplay() { hide(); }
+
+    Drawing &drawing() { return _drawing; }
+
+    /// Update the drawing and render an area of it.
+    Cairo::RefPtr<Cairo::ImageSurface> render(Geom::IntRect const &area)
+    {
+        _drawing.update();
+        auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, area.width(), area.height());
+        auto ds = DrawingSurface(surface->cobj(), area.min());
+        auto dc = DrawingContext(ds);
+        _drawing.render(dc, area);
+        surface->flush();
+        return surface;
+    }
+
+    /// Remove the items from the drawing before the document goes away.
+    void hide()
+    {
+        if (_root) {
+            _root->invoke_hide(_dkey);
+            _root = nullptr;
+        }
+    }
+
+private:
+    Drawing _drawing;
+    SPRoot *_root;
+    unsigned _dkey;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_TESTFILES_DRAWING_TEST_UTILS_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
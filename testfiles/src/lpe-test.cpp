@@ -13,9 +13,12 @@
 #include <testfiles/lpespaths-test.h>
 #include <src/document.h>
 #include <src/inkscape.h>
+#include <src/display/curve.h>
 #include <src/live_effects/lpe-bool.h>
 #include <src/object/sp-ellipse.h>
 #include <src/object/sp-lpe-item.h>
+#include <src/object/sp-path.h>
+#include <src/svg/svg.h>
 
 using namespace Inkscape;
 using namespace Inkscape::LivePathEffect;
@@ -74,3 +77,123 @@ TEST_F(LPETest, Bool_canBeApplyedToNonSiblingPaths)
     auto circle = cast<SPGenericEllipse>(doc->getObjectById(operand_path.substr(1)));
     ASSERT_TRUE(circle);
 }
+
+// MEMOIZATION
+// Runs the effects of an item once, returning how many of them were recomputed and reused.
+static std::pair<unsigned, unsigned> runEffects(SPLPEItem *item)
+{
+    auto const before = item->document->path_effect_stats;
+    sp_lpe_item_update_patheffect(item, false, false);
+    auto const &after = item->document->path_effect_stats;
+    return {after.recomputed - before.recomputed, after.reused - before.reused};
+}
+
+TEST_F(LPETest, Memoization_reusesResultsUntilInputsChange)
+{
+    constexpr auto svg = R"A(
+<svg width='100' height='100'
+  xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>
+  <defs>
+    <inkscape:path-effect
+      id='path-effect1'
+      effect='skeletal'
+      copytype='single_stretched'
+      pattern='M 0,0 5,5 0,10'
+      prop_scale='1'
+      lpeversion='1' />
+  </defs>
+  <path id='path1'
+    inkscape:path-effect='#path-effect1'
+    inkscape:original-d='M 5,10 H 15'
+    d='M 5,10 H 15' />
+</svg>)A"sv;
+
+    auto doc = SPDocument::createNewDocFromMem(svg, true);
+    doc->ensureUpToDate();
+
+    auto path = cast<SPPath>(doc->getObjectById("path1"));
+    ASSERT_TRUE(path);
+    auto lpe = path->getFirstPathEffectOfType(EffectType::PATTERN_ALONG_PATH);
+    ASSERT_TRUE(lpe);
+
+    // The run while loading is never reused, and whether the update after it ran again depends
+    // on the document, so start from a known state.
+    runEffects(path);
+    auto const result = path->curve()->get_pathvector();
+
+    // Nothing changed: the previous result is reused.
+    EXPECT_EQ(runEffects(path), std::pair(0u, 1u));
+    EXPECT_EQ(runEffects(path), std::pair(0u, 1u));
+    EXPECT_EQ(path->curve()->get_pathvector(), result);
+    auto const key = lpe->getCacheKey(path);
+    ASSERT_TRUE(key);
+
+    // A parameter change invalidates the result, once.
+    lpe->getParameter("prop_scale")->param_readSVGValue("2");
+    EXPECT_NE(lpe->getCacheKey(path), key);
+    EXPECT_EQ(runEffects(path), std::pair(1u, 0u));
+    auto const scaled = path->curve()->get_pathvector();
+    EXPECT_NE(scaled, result);
+    EXPECT_EQ(runEffects(path), std::pair(0u, 1u));
+    EXPECT_EQ(path->curve()->get_pathvector(), scaled);
+
+    // So does a change of the input path, which is not part of the key.
+    auto const key_scaled = lpe->getCacheKey(path);
+    path->setCurveBeforeLPE(SPCurve(sp_svg_read_pathv("M 5,10 H 25")));
+    EXPECT_EQ(lpe->getCacheKey(path), key_scaled);
+    EXPECT_EQ(runEffects(path), std::pair(1u, 0u));
+    EXPECT_NE(path->curve()->get_pathvector(), scaled);
+    EXPECT_EQ(runEffects(path), std::pair(0u, 1u));
+
+    // Restoring both gives the first result again, recomputed.
+    lpe->getParameter("prop_scale")->param_readSVGValue("1");
+    path->setCurveBeforeLPE(SPCurve(sp_svg_read_pathv("M 5,10 H 15")));
+    EXPECT_EQ(runEffects(path), std::pair(1u, 0u));
+    EXPECT_EQ(path->curve()->get_pathvector(), result);
+}
+
+TEST_F(LPETest, Memoization_cloneOriginalFollowsSourceResult)
+{
+    constexpr auto svg = R"A(
+<svg width='100' height='100'
+  xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>
+  <defs>
+    <inkscape:path-effect
+      id='path-effect1'
+      effect='clone_original'
+      linkeditem='#source'
+      method='d'
+      attributes=''
+      css_properties=''
+      allow_transforms='true'
+      lpeversion='1' />
+  </defs>
+  <path id='source' d='M 0,0 H 10 V 10 Z' />
+  <path id='clone'
+    inkscape:path-effect='#path-effect1'
+    inkscape:original-d='M 0,0 H 10 V 10 Z'
+    d='M 0,0 H 10 V 10 Z' />
+</svg>)A"sv;
+
+    auto doc = SPDocument::createNewDocFromMem(svg, true);
+    doc->ensureUpToDate();
+
+    auto source = cast<SPPath>(doc->getObjectById("source"));
+    auto clone = cast<SPPath>(doc->getObjectById("clone"));
+    ASSERT_TRUE(source);
+    ASSERT_TRUE(clone);
+
+    runEffects(clone);
+    EXPECT_EQ(runEffects(clone), std::pair(0u, 1u));
+
+    // Modifying the source without changing what is cloned from it doesn't rerun the clone.
+    source->setAttribute("inkscape:label", "renamed");
+    doc->ensureUpToDate();
+    EXPECT_EQ(runEffects(clone), std::pair(0u, 1u));
+
+    // Changing its path does, once.
+    source->setAttribute("d", "M 0,0 H 20 V 20 Z");
+    EXPECT_EQ(runEffects(clone), std::pair(1u, 0u));
+    EXPECT_EQ(clone->curve()->get_pathvector(), source->curve()->get_pathvector());
+    EXPECT_EQ(runEffects(clone), std::pair(0u, 1u));
+}
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of pasting many objects with and without batching the XML notifications.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "document.h"
+#include "file.h"
+#include "inkscape.h"
+#include "object/sp-root.h"
+#include "xml/mutation-batch.h"
+
+#include "benchmark-utils.h"
+
+using namespace Inkscape;
+using namespace Inkscape::XML;
+
+static int count_elements(Node const *node)
+{
+    int count = 0;
+    for (auto child = node->firstChild(); child; child = child->next()) {
+        count += (child->type() == NodeType::ELEMENT_NODE) + count_elements(child);
+    }
+    return count;
+}
+
+/*
+ * Paste a document of many thousand objects into an empty one as sp_import_document does, with
+ * and without batching the notifications, up to the document being up to date again.
+ */
+TEST(MutationBatchBenchmark, LargePaste)
+{
+    if (!Application::exists()) {
+        Application::create(false);
+    }
+
+    auto clipdoc = SPDocument::createNewDoc(INKSCAPE_TESTS_DIR "/../share/tutorials/tutorial-tracing-pixelart.svg",
+                                            false);
+    ASSERT_TRUE(clipdoc);
+
+    record_value("elements", count_elements(clipdoc->getReprRoot()));
+
+    for (bool const batched : {false, true}) {
+        auto const ms = time_ms([&] {
+            auto doc = SPDocument::createNewDoc(nullptr, false, true);
+            doc->importDefs(clipdoc.get());
+
+            Node *clipboard = nullptr;
+            std::vector<Node *> copies;
+            {
+                std::unique_ptr<MutationBatch> batch;
+                if (batched) {
+                    batch = std::make_unique<MutationBatch>(doc->getReprDoc());
+                }
+                copies = sp_import_copy_objects(clipdoc.get(), doc.get(), doc->getReprRoot(), nullptr, clipboard);
+            }
+            sp_import_adjust_clones(doc.get(), copies);
+            doc->ensureUpToDate();
+        }, 3);
+        record_value(batched ? "batched_ms" : "one_by_one_ms", ms);
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
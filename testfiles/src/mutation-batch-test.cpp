@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for batched XML changes.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "object/sp-root.h"
+#include "xml/mutation-batch.h"
+#include "xml/node-observer.h"
+#include "xml/repr.h"
+
+using namespace Inkscape::XML;
+
+namespace {
+
+/// Records every notification as a line of text.
+class Recorder : public NodeObserver
+{
+public:
+    void notifyChildAdded(Node &node, Node &child, Node *) override
+    {
+        log.push_back("add " + id(node) + " " + id(child));
+    }
+    void notifyChildRemoved(Node &node, Node &child, Node *) override
+    {
+        log.push_back("remove " + id(node) + " " + id(child));
+    }
+    void notifyAttributeChanged(Node &node, GQuark name, Inkscape::Util::ptr_shared old_value,
+                                Inkscape::Util::ptr_shared new_value) override
+    {
+        log.push_back("set " + id(node) + " " + g_quark_to_string(name) + " " + str(old_value) + " " + str(new_value));
+    }
+
+    std::vector<std::string> log;
+
+private:
+    static std::string id(Node &node) { return str(node.attribute("id")); }
+    static std::string str(char const *s) { return s ? s : "-"; }
+};
+
+std::shared_ptr<Document> read(char const *svg)
+{
+    return std::shared_ptr<Document>(sp_repr_read_buf(svg, SP_SVG_NS_URI));
+}
+
+} // namespace
+
+TEST(MutationBatchTest, DeliversWhenOutermostBatchEnds)
+{
+    auto doc = read("<svg id='root'><g id='a'/></svg>");
+    Recorder recorder;
+    doc->root()->addSubtreeObserver(recorder);
+
+    {
+        MutationBatch outer(doc.get());
+        {
+            MutationBatch inner(doc.get());
+            doc->root()->firstChild()->setAttribute("x", "1");
+        }
+        EXPECT_TRUE(recorder.log.empty());
+        doc->root()->firstChild()->setAttribute("y", "2");
+        EXPECT_TRUE(recorder.log.empty());
+    }
+    EXPECT_EQ(recorder.log, (std::vector<std::string>{"set a x - 1", "set a y - 2"}));
+
+    // Without a batch, notifications are immediate again.
+    recorder.log.clear();
+    doc->root()->firstChild()->setAttribute("x", "3");
+    EXPECT_EQ(recorder.log, (std::vector<std::string>{"set a x 1 3"}));
+
+    doc->root()->removeSubtreeObserver(recorder);
+}
+
+TEST(MutationBatchTest, ChangesInsideAddedSubtreesAreFolded)
+{
+    auto doc = read("<svg id='root'><g id='a'/></svg>");
+    Recorder recorder;
+    doc->root()->addSubtreeObserver(recorder);
+
+    {
+        MutationBatch batch(doc.get());
+        auto g = doc->createElement("svg:g");
+        g->setAttribute("id", "b");
+        doc->root()->appendChild(g);
+        Inkscape::GC::release(g);
+
+        // Seen by observers as part of the addition of b.
+        auto rect = doc->createElement("svg:rect");
+        rect->setAttribute("id", "c");
+        g->appendChild(rect);
+        Inkscape::GC::release(rect);
+        g->setAttribute("transform", "scale(2)");
+        rect->setAttribute("width", "10");
+
+        // Not part of an added subtree.
+        doc->root()->firstChild()->setAttribute("x", "1");
+    }
+
+    EXPECT_EQ(recorder.log, (std::vector<std::string>{"add root b", "set a x - 1"}));
+    EXPECT_STREQ(doc->root()->lastChild()->firstChild()->attribute("width"), "10");
+
+    doc->root()->removeSubtreeObserver(recorder);
+}
+
+TEST(MutationBatchTest, RepeatedChangesAreMerged)
+{
+    auto doc = read("<svg id='root'><g id='a' x='0'/></svg>");
+    Recorder recorder;
+    doc->root()->addSubtreeObserver(recorder);
+    auto a = doc->root()->firstChild();
+
+    {
+        MutationBatch batch(doc.get());
+        a->setAttribute("x", "1");
+        a->setAttribute("y", "5");
+        a->setAttribute("x", "2");
+        a->setAttribute("z", "7");
+        a->removeAttribute("z");
+        a->setAttribute("y", "6");
+    }
+
+    // Merged into the last change of each attribute; z ends up as it was.
+    EXPECT_EQ(recorder.log, (std::vector<std::string>{"set a x 0 2", "set a y - 6"}));
+
+    recorder.log.clear();
+    {
+        MutationBatch batch(doc.get());
+        a->setAttribute("x", "3");
+        a->setAttribute("x", "2");
+    }
+    EXPECT_TRUE(recorder.log.empty());
+
+    doc->root()->removeSubtreeObserver(recorder);
+}
+
+TEST(MutationBatchTest, AddAndRemoveAreBothDelivered)
+{
+    auto doc = read("<svg id='root'><g id='a'/></svg>");
+    Recorder recorder;
+    doc->root()->addSubtreeObserver(recorder);
+
+    {
+        MutationBatch batch(doc.get());
+        auto g = doc->createElement("svg:g");
+        g->setAttribute("id", "b");
+        doc->root()->appendChild(g);
+        doc->root()->removeChild(g);
+        Inkscape::GC::release(g);
+        doc->root()->removeChild(doc->root()->firstChild());
+    }
+
+    EXPECT_EQ(recorder.log, (std::vector<std::string>{"add root b", "remove root b", "remove root a"}));
+    EXPECT_EQ(doc->root()->childCount(), 0);
+
+    doc->root()->removeSubtreeObserver(recorder);
+}
+
+TEST(MutationBatchTest, MergedChangesComeAfterWhatTheyReferTo)
+{
+    auto doc = read("<svg id='root'><use id='a'/></svg>");
+    Recorder recorder;
+    doc->root()->addSubtreeObserver(recorder);
+    auto a = doc->root()->firstChild();
+
+    {
+        MutationBatch batch(doc.get());
+        a->setAttribute("href", "#none");
+        auto g = doc->createElement("svg:g");
+        g->setAttribute("id", "b");
+        doc->root()->appendChild(g);
+        Inkscape::GC::release(g);
+        a->setAttribute("href", "#b");
+    }
+
+    // Observers following the href find b, as it was added before.
+    EXPECT_EQ(recorder.log, (std::vector<std::string>{"add root b", "set a href - #b"}));
+
+    doc->root()->removeSubtreeObserver(recorder);
+}
+
+/*
+ * Paste objects into a document, adjusting each of them after adding it as the paste code
+ * does, with and without a batch. The batch gives the same objects with one notification per
+ * object and one for the parent. See mutation-batch-benchmark.cpp for the time it saves.
+ */
+TEST(MutationBatchTest, PasteIsNotifiedOncePerObject)
+{
+    if (!Inkscape::Application::exists()) {
+        Inkscape::Application::create(false);
+    }
+
+    constexpr std::size_t count = 200;
+
+    auto paste = [&] (bool batched) {
+        constexpr auto svg = std::string_view("<svg xmlns='http://www.w3.org/2000/svg'/>");
+        auto doc = SPDocument::createNewDocFromMem(svg, false);
+        auto xml_doc = doc->getReprDoc();
+        auto parent = doc->getRoot()->getRepr();
+        Recorder recorder;
+        parent->addObserver(recorder);
+
+        {
+            std::unique_ptr<MutationBatch> batch;
+            if (batched) {
+                batch = std::make_unique<MutationBatch>(xml_doc);
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                auto rect = xml_doc->createElement("svg:rect");
+                parent->appendChild(rect);
+                Inkscape::GC::release(rect);
+                rect->setAttribute("id", "rect" + std::to_string(i));
+                rect->setAttribute("width", "10");
+                parent->setAttribute("inkscape:pasted", std::to_string(i));
+            }
+        }
+        doc->ensureUpToDate();
+
+        EXPECT_EQ(doc->getRoot()->children.size(), count);
+        EXPECT_TRUE(doc->getObjectById("rect" + std::to_string(count - 1)));
+
+        parent->removeObserver(recorder);
+        return recorder.log;
+    };
+
+    auto const unbatched = paste(false);
+    auto const batched = paste(true);
+    EXPECT_EQ(unbatched.size(), count * 2);
+    ASSERT_EQ(batched.size(), count + 1);
+    EXPECT_EQ(batched.back(), "set - inkscape:pasted - " + std::to_string(count - 1));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of rendering the bundled filter presets with and without planning the primitives.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include "benchmark-utils.h"
+#include "drawing-test-utils.h"
+#include "nr-filter-presets.h"
+
+namespace Inkscape {
+
+/*
+ * Renders every preset in one frame. Before: the primitives run one by one in document order,
+ * as they did before planning. After: unused results are skipped, per-pixel chains fused and
+ * images pooled. The cells are also timed one by one, to see which presets gain.
+ */
+TEST(FilterBenchmark, BundledPresets)
+{
+    auto const presets = load_filter_presets();
+    ASSERT_FALSE(presets.ids.empty());
+    record_value("presets", presets.ids.size());
+
+    for (bool const planned : {false, true}) {
+        auto display = TestDisplay(presets.doc.get());
+        display.drawing().setFilterPlanning(planned);
+        std::string const suffix = planned ? "_planned_ms" : "_in_order_ms";
+
+        record_value("all" + suffix, time_ms([&] { display.render(presets.area()); }));
+        for (std::size_t i = 0; i < presets.ids.size(); i++) {
+            record_value(presets.ids[i] + suffix, time_ms([&] { display.render(presets.cellRect(i)); }));
+        }
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Pixel accuracy tests for the row-based feConvolveMatrix, feDiffuseLighting and
+ * feSpecularLighting renderers, against per-pixel double precision references.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include <cairomm/surface.h>
+
+#include "display/cairo-templates.h"
+#include "display/cairo-utils.h"
+#include "display/drawing-context.h"
+#include "display/nr-filter-convolve-matrix.h"
+#include "display/nr-filter-diffuselighting.h"
+#include "display/nr-filter-slot.h"
+#include "display/nr-filter-specularlighting.h"
+#include "display/nr-filter-units.h"
+#include "display/nr-filter-utils.h"
+#include "display/nr-light.h"
+
+namespace Inkscape {
+namespace Filters {
+namespace {
+
+constexpr int width = 97;
+constexpr int height = 61;
+
+int max_channel_difference(guint32 a, guint32 b)
+{
+    int result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        result = std::max(result, std::abs(int(a >> shift & 0xff) - int(b >> shift & 0xff)));
+    }
+    return result;
+}
+
+/// A premultiplied image with smooth bumps in its alpha and some noise in its colors.
+Cairo::RefPtr<Cairo::ImageSurface> create_source()
+{
+    auto source = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, width, height);
+    auto const data = source->get_data();
+    auto const stride = source->get_stride();
+    unsigned seed = 1;
+    for (int y = 0; y < height; y++) {
+        auto const row = reinterpret_cast<guint32 *>(data + y * stride);
+        for (int x = 0; x < width; x++) {
+            seed = seed * 1103515245 + 12345;
+            guint32 const a = 127.5 + 127.5 * std::sin(x * 0.21) * std::cos(y * 0.17 + x * 0.05);
+            guint32 const r = premul_alpha(seed >> 8 & 0xff, a);
+            guint32 const g = premul_alpha(seed >> 16 & 0xff, a);
+            guint32 const b = premul_alpha((x * 5 + y * 3) & 0xff, a);
+            row[x] = a << 24 | r << 16 | g << 8 | b;
+        }
+    }
+    source->mark_dirty();
+    return source;
+}
+
+/**
+ * Render the primitive with the source image as its input, and compare the result to
+ * reference(input, x, y) pixel by pixel.
+ * @return The largest difference of a channel.
+ */
+int render_and_compare(FilterPrimitive const &primitive,
+                       std::function<guint32 (cairo_surface_t *, FilterSlot &, int, int)> const &reference)
+{
+    auto source = create_source();
+    auto dc = DrawingContext(source->cobj(), Geom::Point(0, 0));
+    FilterUnits units;
+    units.set_filter_area(Geom::Rect::from_xywh(0, 0, width, height));
+    units.set_resolution(width, height);
+    RenderContext rc{.outline_color = 0};
+    FilterSlot slot(nullptr, dc, units, rc, 0);
+
+    primitive.render_cairo(slot);
+
+    auto const input = slot.getcairo(NR_FILTER_SOURCEGRAPHIC);
+    auto const result = slot.getcairo(NR_FILTER_SLOT_NOT_SET);
+    EXPECT_NE(input, result);
+    cairo_surface_flush(result);
+    auto const data = cairo_image_surface_get_data(result);
+    auto const stride = cairo_image_surface_get_stride(result);
+
+    int worst = 0;
+    for (int y = 0; y < height; y++) {
+        auto const row = reinterpret_cast<guint32 const *>(data + y * stride);
+        for (int x = 0; x < width; x++) {
+            worst = std::max(worst, max_channel_difference(reference(input, slot, x, y), row[x]));
+        }
+    }
+    return worst;
+}
+
+/// The per-pixel convolution the row-based one replaced.
+guint32 convolve(cairo_surface_t *input, std::vector<double> kernel,
+                 int orderX, int orderY, int targetX, int targetY, double divisor, double bias,
+                 bool preserve_alpha, int x, int y)
+{
+    SurfaceSynth synth(input);
+    std::reverse(kernel.begin(), kernel.end());
+    int const startx = std::max(0, x - targetX);
+    int const starty = std::max(0, y - targetY);
+    int const limitx = std::min(width, startx + orderX) - startx;
+    int const limity = std::min(height, starty + orderY) - starty;
+    double suma = 0, sumr = 0, sumg = 0, sumb = 0;
+    for (int i = 0; i < limity; i++) {
+        for (int j = 0; j < limitx; j++) {
+            EXTRACT_ARGB32(synth.pixelAt(startx + j, starty + i), a, r, g, b)
+            double const coeff = kernel[i * orderX + j] / divisor;
+            suma += a * coeff;
+            sumr += r * coeff;
+            sumg += g * coeff;
+            sumb += b * coeff;
+        }
+    }
+    suma = preserve_alpha ? synth.alphaAt(x, y) : suma + bias * 255;
+
+    guint32 const ao = pxclamp(std::round(suma), 0, 255);
+    guint32 const ro = pxclamp(std::round(sumr + ao * bias), 0, ao);
+    guint32 const go = pxclamp(std::round(sumg + ao * bias), 0, ao);
+    guint32 const bo = pxclamp(std::round(sumb + ao * bias), 0, ao);
+    return ao << 24 | ro << 16 | go << 8 | bo;
+}
+
+/**
+ * The surface normal, light vector and light components at a pixel, as the per-pixel
+ * renderers computed them.
+ */
+template <typename Primitive>
+void light_at(Primitive const &primitive, cairo_surface_t *input, FilterSlot &slot, int x, int y,
+              NR::Fvector &normal, NR::Fvector &light, NR::Fvector &components)
+{
+    SurfaceSynth synth(input);
+    auto const trans = slot.get_units().get_matrix_primitiveunits2pb();
+    auto const origin = slot.get_slot_area().min();
+    double const scale = primitive.surfaceScale * trans.descrim() * slot.get_device_scale();
+    double const z = scale * synth.alphaAt(x, y) / 255.0;
+    normal = synth.surfaceNormalAt(x, y, scale);
+    switch (primitive.light_type) {
+    case DISTANT_LIGHT: {
+        DistantLight distant(primitive.light.distant, primitive.lighting_color);
+        distant.light_vector(light);
+        distant.light_components(components);
+        break;
+    }
+    case POINT_LIGHT: {
+        PointLight point(primitive.light.point, primitive.lighting_color, trans);
+        point.light_vector(light, origin.x() + x, origin.y() + y, z);
+        point.light_components(components);
+        break;
+    }
+    case SPOT_LIGHT: {
+        SpotLight spot(primitive.light.spot, primitive.lighting_color, trans);
+        spot.light_vector(light, origin.x() + x, origin.y() + y, z);
+        spot.light_components(components, light);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+template <typename Primitive>
+void set_light(Primitive &primitive, LightType type)
+{
+    primitive.light_type = type;
+    switch (type) {
+    case DISTANT_LIGHT:
+        primitive.light.distant = {.azimuth = 30, .elevation = 40};
+        break;
+    case POINT_LIGHT:
+        primitive.light.point = {.x = 30, .y = -10, .z = 40};
+        break;
+    case SPOT_LIGHT:
+        // A right cone angle, so that pixels on its edge are black whichever side they fall on.
+        primitive.light.spot = {.x = 10, .y = 5, .z = 60, .pointsAtX = 60, .pointsAtY = 40, .pointsAtZ = 0,
+                                .limitingConeAngle = 90, .specularExponent = 3};
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+TEST(FilterConvolveLightingTest, ConvolveMatrixMatchesReference)
+{
+    struct Kernel
+    {
+        int orderX, orderY, targetX, targetY;
+        std::vector<double> values;
+        double bias;
+    };
+    std::vector<Kernel> const kernels = {
+        // Not separable.
+        {3, 3, 1, 1, {0, -1, 0, -1, 5, -1, 0, -1, 0}, 0},
+        {4, 2, 3, 0, {1, 2, 0, -1, 3, -2, 1, 1}, 0},
+        // Separable.
+        {3, 3, 1, 1, {1, 2, 1, 2, 4, 2, 1, 2, 1}, 0},
+        {5, 5, 0, 4, {1, 4, 6, 4, 1, 2, 8, 12, 8, 2, -1, -4, -6, -4, -1, 2, 8, 12, 8, 2, 1, 4, 6, 4, 1}, 0},
+        {3, 5, 2, 1, {1, 0, -1, 2, 0, -2, 3, 0, -3, 2, 0, -2, 1, 0, -1}, 0.25},
+    };
+
+    for (auto const &kernel : kernels) {
+        for (bool preserve_alpha : {false, true}) {
+            FilterConvolveMatrix matrix;
+            matrix.set_orderX(kernel.orderX);
+            matrix.set_orderY(kernel.orderY);
+            matrix.set_targetX(kernel.targetX);
+            matrix.set_targetY(kernel.targetY);
+            matrix.set_kernelMatrix(kernel.values);
+            matrix.set_bias(kernel.bias);
+            double divisor = 0;
+            for (auto value : kernel.values) {
+                divisor += value;
+            }
+            divisor = divisor == 0 ? 1 : divisor;
+            matrix.set_divisor(divisor);
+            matrix.set_preserveAlpha(preserve_alpha);
+
+            int const worst = render_and_compare(matrix, [&] (cairo_surface_t *input, FilterSlot &, int x, int y) {
+                return convolve(input, kernel.values, kernel.orderX, kernel.orderY, kernel.targetX,
+                                kernel.targetY, divisor, kernel.bias, preserve_alpha, x, y);
+            });
+            EXPECT_LE(worst, 1) << kernel.orderX << "x" << kernel.orderY << " preserveAlpha " << preserve_alpha;
+        }
+    }
+}
+
+TEST(FilterConvolveLightingTest, DiffuseLightingMatchesReference)
+{
+    for (auto type : {DISTANT_LIGHT, POINT_LIGHT, SPOT_LIGHT}) {
+        FilterDiffuseLighting diffuse;
+        set_light(diffuse, type);
+        diffuse.diffuseConstant = 1.3;
+        diffuse.surfaceScale = 2.5;
+        diffuse.lighting_color = 0xffc080ff;
+
+        int const worst = render_and_compare(diffuse, [&] (cairo_surface_t *input, FilterSlot &slot, int x, int y) {
+            NR::Fvector normal, light, components;
+            light_at(diffuse, input, slot, x, y, normal, light, components);
+            double const k = diffuse.diffuseConstant * NR::scalar_product(normal, light);
+            guint32 const r = CLAMP_D_TO_U8(k * components[LIGHT_RED]);
+            guint32 const g = CLAMP_D_TO_U8(k * components[LIGHT_GREEN]);
+            guint32 const b = CLAMP_D_TO_U8(k * components[LIGHT_BLUE]);
+            return 0xff000000 | r << 16 | g << 8 | b;
+        });
+        EXPECT_LE(worst, 1) << "light type " << type;
+    }
+}
+
+TEST(FilterConvolveLightingTest, SpecularLightingMatchesReference)
+{
+    for (auto type : {DISTANT_LIGHT, POINT_LIGHT, SPOT_LIGHT}) {
+        FilterSpecularLighting specular;
+        set_light(specular, type);
+        specular.specularConstant = 1.1;
+        specular.specularExponent = 12;
+        specular.surfaceScale = 3;
+        specular.lighting_color = 0x80ffc0ff;
+
+        int const worst = render_and_compare(specular, [&] (cairo_surface_t *input, FilterSlot &slot, int x, int y) {
+            NR::Fvector normal, light, components, halfway;
+            light_at(specular, input, slot, x, y, normal, light, components);
+            NR::normalized_sum(halfway, light, NR::EYE_VECTOR);
+            double const sp = NR::scalar_product(normal, halfway);
+            double const k = sp <= 0 ? 0 : specular.specularConstant * std::pow(sp, specular.specularExponent);
+            guint32 const r = CLAMP_D_TO_U8(k * components[LIGHT_RED]);
+            guint32 const g = CLAMP_D_TO_U8(k * components[LIGHT_GREEN]);
+            guint32 const b = CLAMP_D_TO_U8(k * components[LIGHT_BLUE]);
+            guint32 const a = std::max(std::max(r, g), b);
+            return a << 24 | premul_alpha(r, a) << 16 | premul_alpha(g, a) << 8 | premul_alpha(b, a);
+        });
+        EXPECT_LE(worst, 1) << "light type " << type;
+    }
+}
+
+} // namespace Filters
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
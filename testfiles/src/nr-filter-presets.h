@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Shared test header showing the bundled filter presets, for the filter tests and benchmarks.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_TESTFILES_NR_FILTER_PRESETS_H
+#define INKSCAPE_TESTFILES_NR_FILTER_PRESETS_H
+
+#include <fstream>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <2geom/int-rect.h>
+
+#include "drawing-test-utils.h"
+
+namespace Inkscape {
+
+/**
+ * A document with a square for every filter in share/filters/filters.svg, in a grid of cells.
+ * The squares are filled with a gradient through partly transparent colors and stroked, so
+ * the filters have colors, alpha and edges to work on.
+ */
+struct FilterPresets
+{
+    static constexpr int cell = 48;
+    static constexpr int columns = 16;
+
+    std::unique_ptr<SPDocument> doc;
+    std::vector<std::string> ids; ///< The filters, in the order of the cells.
+
+    Geom::IntRect cellRect(int index) const
+    {
+        return Geom::IntRect::from_xywh(index % columns * cell, index / columns * cell, cell, cell);
+    }
+
+    Geom::IntRect area() const
+    {
+        int const rows = (ids.size() + columns - 1) / columns;
+        return Geom::IntRect(0, 0, columns * cell, rows * cell);
+    }
+};
+
+inline FilterPresets load_filter_presets()
+{
+    auto file = std::ifstream(INKSCAPE_TESTS_DIR "/../share/filters/filters.svg");
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    auto const source = buffer.str();
+
+    auto const defs_begin = source.find('>', source.find("<defs")) + 1;
+    auto const defs = source.substr(defs_begin, source.find("</defs>") - defs_begin);
+
+    FilterPresets presets;
+    auto const filter_id = std::regex(R"(<filter\s+id="([^"]+)")");
+    for (auto it = std::sregex_iterator(defs.begin(), defs.end(), filter_id); it != std::sregex_iterator(); ++it) {
+        presets.ids.push_back((*it)[1]);
+    }
+
+    auto const area = presets.area();
+    auto svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+               "xmlns:inkscape=\"http://www.inkscape.org/namespaces/inkscape\" width=\"" +
+               std::to_string(area.width()) + "\" height=\"" + std::to_string(area.height()) + "\">"
+               R"(<defs><linearGradient id="source-fill" x1="0" y1="0" x2="1" y2="1">
+<stop offset="0" stop-color="#ef2929"/><stop offset="0.5" stop-color="#73d216" stop-opacity="0.5"/>
+<stop offset="1" stop-color="#3465a4"/></linearGradient>)" + defs + "</defs>";
+    for (std::size_t i = 0; i < presets.ids.size(); i++) {
+        auto const rect = presets.cellRect(i);
+        svg += "<rect x=\"" + std::to_string(rect.left() + FilterPresets::cell / 4) + "\" y=\"" +
+               std::to_string(rect.top() + FilterPresets::cell / 4) + "\" width=\"" +
+               std::to_string(FilterPresets::cell / 2) + "\" height=\"" + std::to_string(FilterPresets::cell / 2) +
+               "\" fill=\"url(#source-fill)\" stroke=\"#2e3436\" stroke-width=\"2\" filter=\"url(#" +
+               presets.ids[i] + ")\"/>";
+    }
+    presets.doc = load_document(svg + "</svg>");
+    return presets;
+}
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_TESTFILES_NR_FILTER_PRESETS_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,340 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for filter slots and the order filter primitives are rendered in, and for planned
+ * rendering matching the primitives run one by one.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+
+#include "inkscape.h"
+#include "document.h"
+#include "object/sp-root.h"
+#include "display/cairo-utils.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-item.h"
+#include "display/drawing-surface.h"
+#include "display/nr-filter.h"
+#include "display/nr-filter-slot.h"
+#include "display/nr-filter-types.h"
+#include "display/nr-filter-units.h"
+
+#include "drawing-test-utils.h"
+#include "nr-filter-presets.h"
+
+using namespace std::literals;
+
+namespace Inkscape {
+namespace Filters {
+namespace {
+
+/// Render a document with its filters planned, or with their primitives run in document order.
+Cairo::RefPtr<Cairo::ImageSurface> render_filtered(SPDocument *doc, Geom::IntRect const &area, bool planned)
+{
+    auto display = TestDisplay(doc);
+    display.drawing().setFilterPlanning(planned);
+    return display.render(area);
+}
+
+/// Whether two renderings of the same area are the same in a part of it, to the bit.
+bool same_pixels(Cairo::RefPtr<Cairo::ImageSurface> const &a, Cairo::RefPtr<Cairo::ImageSurface> const &b,
+                 Geom::IntRect const &rect)
+{
+    for (int y = rect.top(); y < rect.bottom(); y++) {
+        auto const offset = y * a->get_stride() + rect.left() * 4;
+        if (!std::equal(a->get_data() + offset, a->get_data() + offset + rect.width() * 4, b->get_data() + offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(FilterSlotTest, InputsAndResults)
+{
+    auto source = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, 16, 16);
+    auto dc = DrawingContext(source->cobj(), Geom::Point());
+    FilterUnits units;
+    units.set_filter_area(Geom::Rect(0, 0, 16, 16));
+    units.set_resolution(16, 16);
+    RenderContext rc{.outline_color = 0};
+    FilterSlot slot(nullptr, dc, units, rc, 0);
+
+    // Until something is written, an unset input is the source graphic.
+    EXPECT_EQ(slot.getcairo(NR_FILTER_SLOT_NOT_SET), source->cobj());
+
+    // A named result can be read back, and becomes the unset input of the next primitive.
+    auto a = ink_cairo_surface_create_identical(source->cobj());
+    slot.set(1, a);
+    EXPECT_EQ(slot.getcairo(1), a);
+    EXPECT_EQ(slot.getcairo(NR_FILTER_SLOT_NOT_SET), a);
+
+    // An unnamed result goes to a slot of its own, and doesn't touch the named ones.
+    auto b = ink_cairo_surface_create_identical(source->cobj());
+    slot.set(NR_FILTER_SLOT_NOT_SET, b);
+    EXPECT_EQ(slot.getcairo(NR_FILTER_UNNAMED_SLOT), b);
+    EXPECT_EQ(slot.getcairo(NR_FILTER_SLOT_NOT_SET), b);
+    EXPECT_EQ(slot.getcairo(1), a);
+
+    // Writing a named result again replaces it.
+    slot.set(1, b);
+    EXPECT_EQ(slot.getcairo(1), b);
+
+    slot.set_last_out(NR_FILTER_SOURCEGRAPHIC);
+    EXPECT_EQ(slot.getcairo(NR_FILTER_SLOT_NOT_SET), source->cobj());
+
+    // Results which were never written read as empty images of the slot size.
+    auto empty = slot.getcairo(7);
+    EXPECT_NE(empty, a);
+    EXPECT_NE(empty, b);
+    EXPECT_EQ(cairo_image_surface_get_width(empty), 16);
+    EXPECT_EQ(cairo_image_surface_get_height(empty), 16);
+
+    cairo_surface_destroy(a);
+    cairo_surface_destroy(b);
+}
+
+TEST(FilterSlotTest, ReleasedImagesAreReused)
+{
+    auto source = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, 16, 16);
+    auto dc = DrawingContext(source->cobj(), Geom::Point());
+    FilterUnits units;
+    units.set_filter_area(Geom::Rect(0, 0, 16, 16));
+    units.set_resolution(16, 16);
+    RenderContext rc{.outline_color = 0};
+    FilterSlot slot(nullptr, dc, units, rc, 0);
+
+    auto c = slot.create_surface(source->cobj(), CAIRO_CONTENT_COLOR_ALPHA);
+    auto cr = cairo_create(c);
+    cairo_set_source_rgba(cr, 1, 0, 0, 1);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    set_cairo_surface_ci(c, SP_CSS_COLOR_INTERPOLATION_LINEARRGB);
+    slot.set(2, c);
+    cairo_surface_destroy(c);
+
+    // A released image comes back cleared, and the slot reads as empty again.
+    slot.release(2);
+    auto d = slot.create_surface(source->cobj(), CAIRO_CONTENT_COLOR_ALPHA);
+    EXPECT_EQ(d, c);
+    EXPECT_EQ(get_cairo_surface_ci(d), SP_CSS_COLOR_INTERPOLATION_AUTO);
+    cairo_surface_flush(d);
+    auto data = cairo_image_surface_get_data(d);
+    EXPECT_TRUE(std::all_of(data, data + cairo_image_surface_get_stride(d) * 16, [] (auto v) { return v == 0; }));
+    EXPECT_NE(slot.getcairo(2), d);
+
+    // Alpha images are not handed out for color ones.
+    auto alpha = slot.create_surface(source->cobj(), CAIRO_CONTENT_ALPHA);
+    slot.set(3, alpha);
+    cairo_surface_destroy(alpha);
+    slot.release(3);
+    auto e = slot.create_surface(source->cobj(), CAIRO_CONTENT_COLOR_ALPHA);
+    EXPECT_NE(e, alpha);
+
+    // Images still used by another slot are not reused.
+    slot.set(4, d);
+    slot.set(5, d);
+    cairo_surface_destroy(d);
+    slot.release(4);
+    auto f = slot.create_surface(source->cobj(), CAIRO_CONTENT_COLOR_ALPHA);
+    EXPECT_NE(f, d);
+    EXPECT_EQ(slot.getcairo(5), d);
+
+    cairo_surface_destroy(e);
+    cairo_surface_destroy(f);
+}
+
+/*
+ * Each rectangle has a filter exercising the in, in2 and result attributes, and is expected to
+ * come out in a solid color. Some primitives are independent of each other, so they may be
+ * rendered concurrently, and some results are never used.
+ */
+TEST(FilterTest, SlotSemantics)
+{
+    if (!Inkscape::Application::exists()) {
+        Inkscape::Application::create(false);
+    }
+
+    constexpr auto docString = R"A(
+<svg xmlns="http://www.w3.org/2000/svg" width="70" height="10" viewBox="0 0 70 10">
+  <defs>
+    <filter id="in-over-in2" x="0" y="0" width="1" height="1" color-interpolation-filters="sRGB">
+      <feFlood flood-color="#ff0000" result="a"/>
+      <feFlood flood-color="#0000ff" result="b"/>
+      <feComposite in="a" in2="b" operator="over"/>
+    </filter>
+    <filter id="in2-over-in" x="0" y="0" width="1" height="1" color-interpolation-filters="sRGB">
+      <feFlood flood-color="#ff0000" result="a"/>
+      <feFlood flood-color="#0000ff" result="b"/>
+      <feComposite in="b" in2="a" operator="over"/>
+    </filter>
+    <filter id="implicit-input" x="0" y="0" width="1" height="1" color-interpolation-filters="sRGB">
+      <feFlood flood-color="#ff0000" result="a"/>
+      <feFlood flood-color="#0000ff"/>
+      <feOffset dx="0" dy="0"/>
+    </filter>
+    <filter id="redefined-result" x="0" y="0" width="1" height="1" color-interpolation-filters="sRGB">
+      <feFlood flood-color="#ff0000" result="x"/>
+      <feFlood flood-color="#0000ff" result="x"/>
+      <feFlood flood-color="#ff0000" result="y"/>
+      <feMerge><feMergeNode in="x"/></feMerge>
+    </filter>
+    <filter id="source-graphic" x="0" y="0" width="1" height="1" color-interpolation-filters="sRGB">
+      <feOffset dx="0" dy="0"/>
+    </filter>
+    <filter id="branches" x="0" y="0" width="1" height="1" color-interpolation-filters="sRGB">
+      <feOffset in="SourceAlpha" dx="0" dy="0" result="s1"/>
+      <feColorMatrix in="SourceAlpha" type="matrix" values="0 0 0 0 0  0 0 0 0 0  0 0 0 1 0  0 0 0 1 0" result="s2"/>
+      <feFlood flood-color="#ff0000" result="unused"/>
+      <feComposite in="s2" in2="s1" operator="in"/>
+    </filter>
+    <filter id="pixel-chain" x="0" y="0" width="1" height="1" color-interpolation-filters="sRGB">
+      <feColorMatrix type="matrix" values="0 0 0 0 0  0 0 0 0 0  0 1 0 0 0  0 0 0 1 0" result="m"/>
+      <feComponentTransfer in="m"><feFuncR type="linear" slope="0" intercept="1"/></feComponentTransfer>
+      <feColorMatrix type="matrix" values="1 0 0 0 0  0 0 0 0 0  0 0 1 0 0  0 0 0 1 0"/>
+    </filter>
+  </defs>
+  <rect x="0" y="0" width="10" height="10" fill="#00ff00" filter="url(#in-over-in2)"/>
+  <rect x="10" y="0" width="10" height="10" fill="#00ff00" filter="url(#in2-over-in)"/>
+  <rect x="20" y="0" width="10" height="10" fill="#00ff00" filter="url(#implicit-input)"/>
+  <rect x="30" y="0" width="10" height="10" fill="#00ff00" filter="url(#redefined-result)"/>
+  <rect x="40" y="0" width="10" height="10" fill="#00ff00" filter="url(#source-graphic)"/>
+  <rect x="50" y="0" width="10" height="10" fill="#00ff00" filter="url(#branches)"/>
+  <rect x="60" y="0" width="10" height="10" fill="#00ff00" filter="url(#pixel-chain)"/>
+</svg>
+    )A"sv;
+    auto doc = SPDocument::createNewDocFromMem(docString, false);
+    ASSERT_TRUE(doc);
+    ASSERT_TRUE(doc->getRoot());
+    doc->ensureUpToDate();
+
+    Drawing drawing;
+    auto const dkey = SPItem::display_key_new(1);
+    auto root = doc->getRoot();
+    drawing.setRoot(root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+    drawing.update();
+
+    auto const area = Geom::IntRect::from_xywh(0, 0, 70, 10);
+    auto cs = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, area.width(), area.height());
+    auto ds = DrawingSurface(cs->cobj(), area.min());
+    auto dc = DrawingContext(ds);
+    drawing.render(dc, area);
+    cs->flush();
+
+    auto const pixel = [&] (int x, int y) {
+        return *reinterpret_cast<std::uint32_t const *>(cs->get_data() + y * cs->get_stride() + x * 4);
+    };
+
+    EXPECT_EQ(pixel(5, 5), 0xffff0000);  // in-over-in2
+    EXPECT_EQ(pixel(15, 5), 0xff0000ff); // in2-over-in
+    EXPECT_EQ(pixel(25, 5), 0xff0000ff); // implicit-input
+    EXPECT_EQ(pixel(35, 5), 0xff0000ff); // redefined-result
+    EXPECT_EQ(pixel(45, 5), 0xff00ff00); // source-graphic
+    EXPECT_EQ(pixel(55, 5), 0xff0000ff); // branches
+    EXPECT_EQ(pixel(65, 5), 0xffff00ff); // pixel-chain
+
+    root->invoke_hide(dkey);
+}
+
+/*
+ * Chains of color matrices and component transfers are fused into one pass, and results which
+ * are not used are not rendered at all. Neither may change a single bit of the output, also when
+ * the chains feed composites and merges, or are broken by a change of color interpolation.
+ */
+TEST(FilterTest, PlannedRenderingMatchesPrimitiveOrder)
+{
+    constexpr auto docString = R"A(
+<svg xmlns="http://www.w3.org/2000/svg" width="120" height="40" viewBox="0 0 120 40">
+  <defs>
+    <linearGradient id="fill" x1="0" y1="0" x2="1" y2="1">
+      <stop offset="0" stop-color="#ef2929"/>
+      <stop offset="0.5" stop-color="#73d216" stop-opacity="0.5"/>
+      <stop offset="1" stop-color="#3465a4"/>
+    </linearGradient>
+    <filter id="chain-composite" x="0" y="0" width="1" height="1" color-interpolation-filters="sRGB">
+      <feColorMatrix type="saturate" values="0.3"/>
+      <feComponentTransfer>
+        <feFuncR type="gamma" amplitude="1.2" exponent="0.7" offset="0.05"/>
+        <feFuncG type="table" tableValues="0 0.6 0.8 1"/>
+        <feFuncA type="linear" slope="0.8" intercept="0.1"/>
+      </feComponentTransfer>
+      <feColorMatrix type="hueRotate" values="40" result="chain"/>
+      <feFlood flood-color="#fce94f" result="unused"/>
+      <feComposite in="chain" in2="SourceGraphic" operator="arithmetic" k1="0.3" k2="0.5" k3="0.4" k4="0"/>
+    </filter>
+    <filter id="chain-merge" x="0" y="0" width="1" height="1" color-interpolation-filters="linearRGB">
+      <feColorMatrix type="matrix" values="0.5 0.2 0 0 0.1  0 1 0 0 0  0.2 0 0.7 0 0  0 0 0 0.9 0"/>
+      <feComponentTransfer result="a">
+        <feFuncB type="discrete" tableValues="0 0.5 1"/>
+      </feComponentTransfer>
+      <feGaussianBlur in="SourceAlpha" stdDeviation="2" result="unused"/>
+      <feColorMatrix in="SourceGraphic" type="luminanceToAlpha" result="b"/>
+      <feMerge><feMergeNode in="b"/><feMergeNode in="a"/></feMerge>
+    </filter>
+    <filter id="broken-chain" x="0" y="0" width="1" height="1">
+      <feColorMatrix type="saturate" values="0.5" color-interpolation-filters="sRGB"/>
+      <feComponentTransfer color-interpolation-filters="linearRGB">
+        <feFuncR type="linear" slope="1.5"/>
+      </feComponentTransfer>
+      <feColorMatrix type="hueRotate" values="90" color-interpolation-filters="sRGB" result="c"/>
+      <feComposite in="c" in2="SourceAlpha" operator="in"/>
+    </filter>
+  </defs>
+  <rect x="5" y="5" width="30" height="30" fill="url(#fill)" stroke="#2e3436" stroke-width="2" filter="url(#chain-composite)"/>
+  <rect x="45" y="5" width="30" height="30" fill="url(#fill)" stroke="#2e3436" stroke-width="2" filter="url(#chain-merge)"/>
+  <rect x="85" y="5" width="30" height="30" fill="url(#fill)" stroke="#2e3436" stroke-width="2" filter="url(#broken-chain)"/>
+</svg>
+    )A"sv;
+    auto doc = load_document(docString);
+    ASSERT_TRUE(doc);
+
+    auto const area = Geom::IntRect(0, 0, 120, 40);
+    auto const planned = render_filtered(doc.get(), area, true);
+    auto const in_order = render_filtered(doc.get(), area, false);
+    EXPECT_TRUE(same_pixels(planned, in_order, Geom::IntRect(0, 0, 40, 40))) << "chain-composite";
+    EXPECT_TRUE(same_pixels(planned, in_order, Geom::IntRect(40, 0, 80, 40))) << "chain-merge";
+    EXPECT_TRUE(same_pixels(planned, in_order, Geom::IntRect(80, 0, 120, 40))) << "broken-chain";
+}
+
+/*
+ * The same for every bundled preset, many of which are chains of color matrices, component
+ * transfers, composites and merges.
+ */
+TEST(FilterTest, PlannedPresetsMatchPrimitiveOrder)
+{
+    auto const presets = load_filter_presets();
+    ASSERT_FALSE(presets.ids.empty());
+
+    auto const planned = render_filtered(presets.doc.get(), presets.area(), true);
+    auto const in_order = render_filtered(presets.doc.get(), presets.area(), false);
+    for (std::size_t i = 0; i < presets.ids.size(); i++) {
+        EXPECT_TRUE(same_pixels(planned, in_order, presets.cellRect(i))) << presets.ids[i];
+    }
+}
+
+} // namespace Filters
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
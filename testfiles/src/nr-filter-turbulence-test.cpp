@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the feTurbulence renderer: single precision rows against the reference,
+ * and reuse of cached noise tiles.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <cairomm/surface.h>
+#include <2geom/int-point.h>
+
+#include "display/drawing-context.h"
+#include "display/nr-filter-slot.h"
+#include "display/nr-filter-turbulence.h"
+#include "display/nr-filter-units.h"
+
+namespace Inkscape {
+namespace Filters {
+namespace {
+
+int max_channel_difference(guint32 a, guint32 b)
+{
+    int result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        result = std::max(result, std::abs(int(a >> shift & 0xff) - int(b >> shift & 0xff)));
+    }
+    return result;
+}
+
+/// Render the primitive for a 256×256 pixel area at origin, and return the pixels.
+std::vector<guint32> render(FilterTurbulence const &turbulence, Geom::IntPoint const &origin)
+{
+    auto source = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, 256, 256);
+    auto dc = DrawingContext(source->cobj(), Geom::Point(origin));
+    FilterUnits units;
+    units.set_filter_area(Geom::Rect::from_xywh(Geom::Point(origin), Geom::Point(256, 256)));
+    units.set_resolution(256, 256);
+    RenderContext rc{.outline_color = 0};
+    FilterSlot slot(nullptr, dc, units, rc, 0);
+
+    turbulence.render_cairo(slot);
+
+    auto result = slot.getcairo(NR_FILTER_SLOT_NOT_SET);
+    cairo_surface_flush(result);
+    auto const data = cairo_image_surface_get_data(result);
+    auto const stride = cairo_image_surface_get_stride(result);
+    std::vector<guint32> pixels;
+    for (int y = 0; y < 256; y++) {
+        auto const row = reinterpret_cast<guint32 const *>(data + y * stride);
+        pixels.insert(pixels.end(), row, row + 256);
+    }
+    return pixels;
+}
+
+void setup(FilterTurbulence &turbulence)
+{
+    turbulence.set_baseFrequency(0, 0.05);
+    turbulence.set_baseFrequency(1, 0.03);
+    turbulence.set_numOctaves(4);
+    turbulence.set_seed(3);
+    turbulence.set_stitchTiles(false);
+    turbulence.set_type(TURBULENCE_TURBULENCE);
+}
+
+} // namespace
+
+TEST(FilterTurbulenceTest, RowsMatchReference)
+{
+    // A rotated and scaled pixel grid with negative coordinates.
+    auto const step = Geom::Point(0.8, 0.3);
+    auto const down = Geom::Point(-0.25, 0.9);
+    auto const offset = Geom::Point(13.5, -40.25);
+
+    for (bool fractalnoise : {false, true}) {
+        for (bool stitch : {false, true}) {
+            for (int octaves : {1, 4, 8}) {
+                TurbulenceGenerator gen;
+                gen.init({.seed = 7, .tile = Geom::Rect(1, 1, 11, 11), .freq = Geom::Point(0.05, 0.03),
+                          .stitch = stitch, .fractalnoise = fractalnoise, .octaves = octaves});
+
+                int worst = 0;
+                for (int y = -100; y < 300; y += 7) {
+                    auto const origin = offset + y * down;
+                    int const begin = -137, end = 500;
+                    std::vector<guint32> row(end - begin);
+                    gen.turbulenceRow(origin, step, begin, end, row.data());
+                    for (int x = begin; x < end; x++) {
+                        auto const expected = gen.turbulencePixel(origin + x * step);
+                        worst = std::max(worst, max_channel_difference(expected, row[x - begin]));
+                    }
+
+                    // Pixels don't depend on the run they are computed in.
+                    std::vector<guint32> split(end - begin);
+                    gen.turbulenceRow(origin, step, begin, 3, split.data());
+                    gen.turbulenceRow(origin, step, 3, end, split.data() + 3 - begin);
+                    EXPECT_EQ(split, row);
+                }
+                EXPECT_LE(worst, 1) << "fractalnoise " << fractalnoise << " stitch " << stitch
+                                    << " octaves " << octaves;
+            }
+        }
+    }
+}
+
+TEST(FilterTurbulenceTest, ScrollingReusesTiles)
+{
+    FilterTurbulence turbulence;
+    setup(turbulence);
+
+    // The whole area is made of 16 cache tiles.
+    auto const before = FilterTurbulence::cacheBytes();
+    auto const first = render(turbulence, {0, 0});
+    auto const tile = (FilterTurbulence::cacheBytes() - before) / 16;
+    ASSERT_GT(tile, 0);
+
+    // Scrolling by a tile to the right and half a tile down only adds the new column.
+    auto const second = render(turbulence, {64, 32});
+    EXPECT_EQ(FilterTurbulence::cacheBytes() - before, 19 * tile);
+
+    for (int y = 32; y < 256; y++) {
+        for (int x = 64; x < 256; x++) {
+            ASSERT_EQ(first[y * 256 + x], second[(y - 32) * 256 + x - 64]) << x << ", " << y;
+        }
+    }
+
+    // Another primitive with the same parameters shares the tiles.
+    FilterTurbulence other;
+    setup(other);
+    EXPECT_EQ(render(other, {0, 0}), first);
+    EXPECT_EQ(FilterTurbulence::cacheBytes() - before, 19 * tile);
+
+    // Different parameters don't.
+    other.set_seed(4);
+    auto const reseeded = render(other, {0, 0});
+    EXPECT_NE(reseeded, first);
+    EXPECT_EQ(FilterTurbulence::cacheBytes() - before, 35 * tile);
+
+    FilterTurbulence::setCacheBudget(0);
+    EXPECT_EQ(FilterTurbulence::cacheBytes(), 0);
+}
+
+} // namespace Filters
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
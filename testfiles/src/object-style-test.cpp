@@ -195,3 +195,55 @@ TEST_F(ObjectTest, StyleFontSizes) {
     // 50% is 118.59 == ((300^2 + 150^2) / 2)^0.5 * 0.5
     EXPECT_FLOAT_EQ(eight->style->stroke_width.computed, 118.58541);
 }
+
+/*
+ * Objects with the same style attribute share its parsed declarations. Their computed styles
+ * must still be their own, and the same as reading the attribute into a style of its own.
+ */
+TEST_F(ObjectTest, SharedStyleAttributes) {
+    constexpr auto docString = R"A(
+<svg xmlns='http://www.w3.org/2000/svg'>
+<g id='g1' style='font-size:10px;stroke-width:2px'>
+  <rect id='r1' style='fill:red;stroke:blue;stroke-width:1em;opacity:0.5'/>
+  <rect id='r2' style='fill:red;stroke:blue;stroke-width:1em;opacity:0.5'/>
+  <rect id='r3' style='fill:green !important;fill:red;-inkscape-custom:x'/>
+</g>
+<g id='g2' style='font-size:20px;fill:yellow'>
+  <rect id='r4' style='fill:red;stroke:blue;stroke-width:1em;opacity:0.5'/>
+  <rect id='r5' style='fill:green !important;fill:red;-inkscape-custom:x'/>
+  <rect id='r6' style='stroke:blue'/>
+</g>
+</svg>)A"sv;
+    auto const shared = SPDocument::createNewDocFromMem(docString, false);
+    ASSERT_TRUE(shared);
+    shared->ensureUpToDate();
+
+    for (auto id : {"r1", "r2", "r3", "r4", "r5", "r6"}) {
+        auto const object = shared->getObjectById(id);
+        ASSERT_TRUE(object) << id;
+
+        SPStyle expected(shared.get());
+        expected.mergeString(object->getRepr()->attribute("style"));
+        expected.cascade(object->parent->style);
+
+        EXPECT_TRUE(*object->style == expected) << id;
+        EXPECT_EQ(object->style->write(), expected.write()) << id;
+    }
+
+    auto style = [&] (char const *id) { return shared->getObjectById(id)->style; };
+
+    // The same declarations computed against different parents.
+    EXPECT_FLOAT_EQ(style("r1")->stroke_width.computed, 10);
+    EXPECT_FLOAT_EQ(style("r4")->stroke_width.computed, 20);
+    EXPECT_EQ(style("r3")->fill.get_value(), Glib::ustring("green"));
+    EXPECT_EQ(style("r3")->extended_properties.at("-inkscape-custom"), "x");
+    EXPECT_EQ(style("r6")->fill.get_value(), Glib::ustring("yellow"));
+
+    // Changing one object leaves the others that shared its style attribute alone.
+    shared->getObjectById("r1")->setAttribute("style", "fill:blue");
+    shared->ensureUpToDate();
+    EXPECT_EQ(style("r1")->fill.get_value(), Glib::ustring("blue"));
+    EXPECT_FALSE(style("r1")->stroke.set);
+    EXPECT_EQ(style("r2")->fill.get_value(), Glib::ustring("red"));
+    EXPECT_EQ(style("r2")->stroke.get_value(), Glib::ustring("blue"));
+}
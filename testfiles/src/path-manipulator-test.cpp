@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for rebuilding the segments next to dragged nodes of an edited path.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <typeinfo>
+#include <vector>
+#include <2geom/path-sink.h>
+#include <2geom/transforms.h>
+
+#include "ui/tool/path-manipulator.h"
+
+namespace Inkscape::UI {
+namespace {
+
+NodeGeometry cusp(Geom::Point const &p)
+{
+    return {p, p, p, true, true};
+}
+
+NodeGeometry smooth(Geom::Point const &p, Geom::Point const &handle)
+{
+    return {p, p + handle, p - handle, false, false};
+}
+
+/// Build a whole subpath, as PathManipulator does when it isn't dragging.
+Geom::Path build(std::span<NodeGeometry const> nodes, bool closed, Geom::Affine const &to_item)
+{
+    Geom::PathBuilder builder;
+    builder.moveTo(nodes.front().position);
+    for (std::size_t i = 1; i < nodes.size(); i++) {
+        build_segment(builder, nodes[i - 1], nodes[i]);
+    }
+    if (closed) {
+        if (!nodes.back().front_degenerate || !nodes.front().back_degenerate) {
+            build_segment(builder, nodes.back(), nodes.front());
+        }
+        builder.closePath();
+    }
+    builder.flush();
+    return (builder.peek() * to_item).front();
+}
+
+::testing::AssertionResult same_path(Geom::Path const &a, Geom::Path const &b)
+{
+    if (a.closed() != b.closed() || a.size_closed() != b.size_closed()) {
+        return ::testing::AssertionFailure() << "closed " << a.closed() << " with " << a.size_closed()
+                                             << " curves, expected closed " << b.closed() << " with "
+                                             << b.size_closed() << " curves";
+    }
+    for (std::size_t i = 0; i < a.size_closed(); i++) {
+        if (typeid(a[i]) != typeid(b[i]) || !a[i].isNear(b[i], 1e-9)) {
+            return ::testing::AssertionFailure() << "curve " << i << " differs";
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+using Change = std::function<void(NodeGeometry &)>;
+
+void shift(NodeGeometry &node)
+{
+    auto const d = Geom::Point(1.5, -2.5);
+    node.position += d;
+    node.front += d;
+    node.back += d;
+}
+
+/// Retract the handles of a smooth node, or pull them out of a cusp.
+void toggle_handles(NodeGeometry &node)
+{
+    node = node.front_degenerate ? smooth(node.position, {2, 3}) : cusp(node.position);
+}
+
+/**
+ * Change every node, every pair of neighbours and all nodes of a subpath in turn, and check that
+ * rebuilding the segments next to them gives the same path as building it anew, and that the
+ * area returned covers every segment that changed.
+ */
+void check_rebuild(std::vector<NodeGeometry> const &nodes, bool closed)
+{
+    auto const n = nodes.size();
+    auto const to_item = Geom::Affine(Geom::Scale(0.5, 2) * Geom::Translate(3, -7));
+
+    std::vector<std::vector<std::size_t>> selections;
+    for (std::size_t i = 0; i < n; i++) {
+        selections.push_back({i});
+        if (closed || i + 1 < n) {
+            selections.push_back({i, (i + 1) % n});
+        }
+    }
+    selections.emplace_back();
+    for (std::size_t i = 0; i < n; i++) {
+        selections.back().push_back(i);
+    }
+
+    for (auto const &change : {Change(shift), Change(toggle_handles)}) {
+        for (auto const &selection : selections) {
+            auto changed = nodes;
+            auto moved = std::vector<bool>(n, false);
+            for (auto i : selection) {
+                change(changed[i]);
+                moved[i] = true;
+            }
+
+            auto const old = build(nodes, closed, to_item);
+            auto const expected = build(changed, closed, to_item);
+            auto path = old;
+            auto area = rebuild_segments(path, changed, closed, moved, to_item);
+
+            SCOPED_TRACE(::testing::Message() << "first changed node " << selection.front() << " of "
+                                              << selection.size());
+            EXPECT_TRUE(same_path(path, expected));
+
+            ASSERT_TRUE(area);
+            area->expandBy(1e-6);
+            for (std::size_t i = 0; i < std::max(old.size_closed(), expected.size_closed()); i++) {
+                bool const kept = i < old.size_closed() && i < expected.size_closed() &&
+                                  typeid(old[i]) == typeid(expected[i]) && old[i].isNear(expected[i], 1e-9);
+                if (kept) {
+                    continue;
+                }
+                if (i < old.size_closed()) {
+                    EXPECT_TRUE(area->contains(old[i].boundsFast())) << "old curve " << i;
+                }
+                if (i < expected.size_closed()) {
+                    EXPECT_TRUE(area->contains(expected[i].boundsFast())) << "new curve " << i;
+                }
+            }
+        }
+    }
+}
+
+std::vector<NodeGeometry> mixed_nodes()
+{
+    return {cusp({0, 0}), smooth({10, 0}, {3, 2}), cusp({20, 5}), cusp({30, 0}), smooth({40, 10}, {0, 4}),
+            cusp({30, 20})};
+}
+
+} // namespace
+
+TEST(PathManipulatorTest, RebuildsSegmentsOfOpenSubpath)
+{
+    check_rebuild(mixed_nodes(), false);
+}
+
+TEST(PathManipulatorTest, RebuildsLinearClosingSegment)
+{
+    // The last and the first node are cusps, so the closing segment is made by closePath().
+    check_rebuild(mixed_nodes(), true);
+}
+
+TEST(PathManipulatorTest, RebuildsCurvedClosingSegment)
+{
+    auto nodes = mixed_nodes();
+    nodes.front() = smooth(nodes.front().position, {-2, 3});
+    check_rebuild(nodes, true);
+}
+
+TEST(PathManipulatorTest, RebuildsTwoNodeSubpaths)
+{
+    check_rebuild({cusp({0, 0}), cusp({10, 10})}, false);
+    check_rebuild({cusp({0, 0}), smooth({10, 10}, {4, 0})}, true);
+}
+
+} // namespace Inkscape::UI
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of batch exports of PNG files with and without sharing one drawing.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "benchmark-utils.h"
+#include "drawing-test-utils.h"
+#include "png-export-test-utils.h"
+
+namespace Inkscape {
+
+/*
+ * Exports icons of a large sheet at several sizes, as a batch export of a selection does.
+ * Before: a drawing for each export. After: one shared drawing.
+ */
+TEST(PngExportBenchmark, BatchExport)
+{
+    auto doc = load_document(icon_sheet(1600));
+    TempDir dir;
+
+    std::vector<Export> exports;
+    for (int i = 0; i < 1600; i += 16) {
+        for (int size : {16, 32, 64}) {
+            exports.push_back({cast<SPItem>(doc->getObjectById("icon" + std::to_string(i))), size});
+        }
+    }
+    record_value("exports", exports.size());
+
+    for (bool const shared : {false, true}) {
+        int exported = 0;
+        auto const ms = time_ms([&] {
+            std::unique_ptr<PngExportDrawing> drawing;
+            if (shared) {
+                drawing = std::make_unique<PngExportDrawing>(doc.get());
+            }
+            exported = 0;
+            for (std::size_t i = 0; i < exports.size(); i++) {
+                auto const filename = dir.file((shared ? "shared" : "separate") + std::to_string(i) + ".png");
+                exported += export_item(drawing.get(), doc.get(), filename, exports[i]) == EXPORT_OK;
+            }
+        }, 3);
+        EXPECT_EQ(exported, exports.size());
+        record_value(shared ? "shared_ms" : "one_by_one_ms", ms);
+        record_value(shared ? "shared_exports_per_s" : "one_by_one_exports_per_s", exports.size() / ms * 1000);
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
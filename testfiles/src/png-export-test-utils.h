@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Shared test header for the PNG export tests and benchmarks.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_TESTFILES_PNG_EXPORT_TEST_UTILS_H
+#define INKSCAPE_TESTFILES_PNG_EXPORT_TEST_UTILS_H
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <glib.h>
+
+#include "document.h"
+#include "helper/png-write.h"
+#include "object/sp-item.h"
+
+namespace Inkscape {
+
+/// A sheet of icons, each a group of a few shapes, one in four of them blurred.
+inline std::string icon_sheet(int count)
+{
+    std::string svg = R"(<svg xmlns="http://www.w3.org/2000/svg" width="1000" height="1000">
+<defs><filter id="blur"><feGaussianBlur stdDeviation="1.5"/></filter></defs>)";
+    for (int i = 0; i < count; i++) {
+        auto const x = std::to_string(i % 40 * 25);
+        auto const y = std::to_string(i / 40 * 25);
+        svg += "<g id=\"icon" + std::to_string(i) + "\" transform=\"translate(" + x + "," + y + ")\">";
+        svg += "<rect width=\"20\" height=\"20\" rx=\"3\" fill=\"#3465a4\"/>";
+        svg += "<circle cx=\"10\" cy=\"10\" r=\"6\" fill=\"#fce94f\"";
+        svg += i % 4 == 0 ? " filter=\"url(#blur)\"/>" : "/>";
+        svg += "<path d=\"M4 16 L10 4 L16 16 Z\" fill=\"none\" stroke=\"#2e3436\"/></g>";
+    }
+    return svg + "</svg>";
+}
+
+inline std::string read_file(std::string const &filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+/// A temporary directory, removed with everything in it.
+class TempDir
+{
+public:
+    TempDir() : _path(g_dir_make_tmp("ink_png_export_XXXXXX", nullptr)) {}
+    ~TempDir() { std::filesystem::remove_all(_path); }
+
+    std::string file(std::string const &name) { return _path + G_DIR_SEPARATOR_S + name; }
+
+private:
+    std::string _path;
+};
+
+/// An item to export as a square image of the given size.
+struct Export
+{
+    SPItem const *item;
+    int size;
+};
+
+/// Export an item from a shared drawing, or on its own as before when the drawing is null.
+inline ExportResult export_item(PngExportDrawing *drawing, SPDocument *doc, std::string const &filename,
+                                Export const &e)
+{
+    auto const area = *e.item->documentVisualBounds();
+    auto const items = std::vector<SPItem const *>{e.item};
+    if (drawing) {
+        return drawing->exportFile(filename.c_str(), area, e.size, e.size, 96, 96, 0xffffff00, nullptr, nullptr,
+                                   true, items);
+    }
+    return sp_export_png_file(doc, filename.c_str(), area, e.size, e.size, 96, 96, 0xffffff00, nullptr, nullptr,
+                              true, items);
+}
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_TESTFILES_PNG_EXPORT_TEST_UTILS_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for PNG exports sharing one drawing, of several sizes and of tile pyramids.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glib.h>
+#include <gtest/gtest.h>
+
+#include "drawing-test-utils.h"
+#include "png-export-test-utils.h"
+
+using namespace Inkscape;
+
+namespace {
+
+/// The width and height in the header of a PNG file, or zeros if it isn't one.
+std::pair<int, int> png_size(std::string const &filename)
+{
+    auto const data = read_file(filename);
+    if (data.size() < 24 || data.compare(1, 3, "PNG") != 0) {
+        return {0, 0};
+    }
+    auto be32 = [&] (int offset) {
+        int value = 0;
+        for (int i = 0; i < 4; i++) {
+            value = value << 8 | static_cast<unsigned char>(data[offset + i]);
+        }
+        return value;
+    };
+    return {be32(16), be32(20)};
+}
+
+int count_files(std::string const &dir)
+{
+    int count = 0;
+    for (auto const &entry : std::filesystem::recursive_directory_iterator(dir)) {
+        count += entry.is_regular_file();
+    }
+    return count;
+}
+
+/// Two squares in opposite corners of a 1000 by 500 page.
+constexpr auto corners = R"(<svg xmlns="http://www.w3.org/2000/svg" width="1000" height="500">
+<rect width="100" height="100" fill="#3465a4"/>
+<g><rect x="900" y="400" width="100" height="100" fill="#fce94f"/></g>
+</svg>)";
+
+} // namespace
+
+TEST(PngExportTest, SharedDrawingMatchesSeparateExports)
+{
+    auto doc = load_document(icon_sheet(12));
+    TempDir dir;
+
+    std::vector<Export> exports;
+    for (auto id : {"icon0", "icon1", "icon5", "icon0"}) {
+        for (int size : {16, 48, 300}) {
+            exports.push_back({cast<SPItem>(doc->getObjectById(id)), size});
+        }
+    }
+
+    PngExportDrawing drawing(doc.get());
+    for (std::size_t i = 0; i < exports.size(); i++) {
+        auto const separate = dir.file("separate" + std::to_string(i) + ".png");
+        auto const shared = dir.file("shared" + std::to_string(i) + ".png");
+        ASSERT_EQ(export_item(nullptr, doc.get(), separate, exports[i]), EXPORT_OK);
+        ASSERT_EQ(export_item(&drawing, doc.get(), shared, exports[i]), EXPORT_OK);
+        EXPECT_EQ(read_file(separate), read_file(shared)) << "export " << i;
+    }
+
+    // Items hidden for one export are shown again for the next.
+    auto const area = Geom::Rect(0, 0, 100, 100);
+    auto const separate = dir.file("separate-all.png");
+    auto const shared = dir.file("shared-all.png");
+    ASSERT_EQ(sp_export_png_file(doc.get(), separate.c_str(), area, 400, 400, 384, 384, 0xffffffff, nullptr,
+                                 nullptr, true), EXPORT_OK);
+    ASSERT_EQ(drawing.exportFile(shared.c_str(), area, 400, 400, 384, 384, 0xffffffff, nullptr, nullptr, true),
+              EXPORT_OK);
+    EXPECT_EQ(read_file(separate), read_file(shared));
+}
+
+TEST(PngExportTest, SizesMatchSeparateExports)
+{
+    auto doc = load_document(icon_sheet(12));
+    TempDir dir;
+    PngExportDrawing drawing(doc.get());
+    auto const area = *cast<SPItem>(doc->getObjectById("icon0"))->documentVisualBounds();
+
+    std::vector<PngExportTarget> targets;
+    for (int size : {16, 32, 48, 1024, 4500}) {
+        targets.push_back({dir.file("sizes" + std::to_string(size) + ".png"), (unsigned long)size,
+                           (unsigned long)size, 96.0 * size / 20});
+    }
+    ASSERT_EQ(drawing.exportFiles(targets, area, 0xffffffff), EXPORT_OK);
+
+    for (auto const &target : targets) {
+        auto const separate = dir.file("separate" + std::to_string(target.width) + ".png");
+        ASSERT_EQ(drawing.exportFile(separate.c_str(), area, target.width, target.height, target.dpi, target.dpi,
+                                     0xffffffff, nullptr, nullptr, true), EXPORT_OK);
+        EXPECT_EQ(read_file(target.filename), read_file(separate)) << target.width << " pixels";
+    }
+}
+
+TEST(PngExportTest, XyzTiles)
+{
+    auto doc = load_document(corners);
+    TempDir dir;
+    PngExportDrawing drawing(doc.get());
+    auto const area = Geom::Rect(0, 0, 1000, 500);
+
+    // Three levels of 256 pixel tiles reach 1000 pixels. Only the tiles the squares are in
+    // are written on a transparent background.
+    auto const sparse = dir.file("sparse");
+    ASSERT_EQ(drawing.exportTiles(sparse, TileLayout::XYZ, area, 1000, 500, 96, 256, 0xffffff00), EXPORT_OK);
+    EXPECT_EQ(png_size(sparse + "/0/0/0.png"), std::make_pair(256, 256));
+    EXPECT_EQ(png_size(sparse + "/2/0/0.png"), std::make_pair(256, 256));
+    EXPECT_EQ(png_size(sparse + "/2/3/1.png"), std::make_pair(256, 256));
+    EXPECT_FALSE(g_file_test((sparse + "/2/1/0.png").c_str(), G_FILE_TEST_EXISTS));
+    EXPECT_FALSE(g_file_test((sparse + "/3").c_str(), G_FILE_TEST_EXISTS));
+    EXPECT_EQ(count_files(sparse), 1 + 2 + 2);
+
+    // All tiles are written on an opaque background.
+    auto const full = dir.file("full");
+    ASSERT_EQ(drawing.exportTiles(full, TileLayout::XYZ, area, 1000, 500, 96, 256, 0xffffffff), EXPORT_OK);
+    EXPECT_EQ(count_files(full), 1 + 2 + 8);
+}
+
+TEST(PngExportTest, DeepZoomTiles)
+{
+    auto doc = load_document(corners);
+    TempDir dir;
+    PngExportDrawing drawing(doc.get());
+
+    auto const name = dir.file("image");
+    ASSERT_EQ(drawing.exportTiles(name, TileLayout::DEEP_ZOOM, Geom::Rect(0, 0, 1000, 500), 1000, 500, 96, 256,
+                                  0xffffffff), EXPORT_OK);
+
+    auto const dzi = read_file(name + ".dzi");
+    EXPECT_NE(dzi.find("TileSize=\"256\""), std::string::npos);
+    EXPECT_NE(dzi.find("<Size Width=\"1000\" Height=\"500\"/>"), std::string::npos);
+
+    // Levels halve the image down to a single pixel, and the tiles at its edges are cropped.
+    auto const files = name + "_files";
+    EXPECT_EQ(png_size(files + "/0/0_0.png"), std::make_pair(1, 1));
+    EXPECT_EQ(png_size(files + "/9/1_0.png"), std::make_pair(500 - 256, 250));
+    EXPECT_EQ(png_size(files + "/10/0_0.png"), std::make_pair(256, 256));
+    EXPECT_EQ(png_size(files + "/10/3_1.png"), std::make_pair(1000 - 768, 500 - 256));
+    EXPECT_FALSE(g_file_test((files + "/11").c_str(), G_FILE_TEST_EXISTS));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of the memory taken by the styles of a large document, with and without interning
+ * the style attributes.
+ *
+ * Resident memory only grows within a process, so run each test in a process of its own:
+ *
+ *     benchmark_style-memory --gtest_filter=*.NotInterned --gtest_output=json:before.json
+ *     benchmark_style-memory --gtest_filter=*.Interned --gtest_output=json:after.json
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "document.h"
+#include "inkscape.h"
+#include "style.h"
+#include "object/sp-root.h"
+
+#include "benchmark-utils.h"
+
+using namespace Inkscape;
+
+namespace {
+
+constexpr int object_count = 100000;
+
+/// Resident memory of the process in bytes, or 0 where it isn't known.
+std::int64_t resident_bytes()
+{
+    auto statm = std::ifstream("/proc/self/statm");
+    std::int64_t size = 0;
+    std::int64_t resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/// Bytes allocated with malloc and not freed yet, or 0 where it isn't known.
+std::int64_t allocated_bytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * A document with many objects whose style attributes repeat a few distinct strings, like
+ * the output of drawing programs and plotting libraries.
+ */
+std::string large_document()
+{
+    static char const *const fills[] = {"#ef2929", "#73d216", "#3465a4", "#edd400", "#75507b", "#c17d11", "#2e3436", "#ffffff"};
+    static char const *const widths[] = {"0.5", "1", "2", "4"};
+
+    std::string svg = R"(<svg xmlns="http://www.w3.org/2000/svg" width="1000" height="1000">)";
+    for (int i = 0; i < object_count; i++) {
+        svg += "<rect x=\"" + std::to_string(i % 1000) + "\" y=\"" + std::to_string(i / 100) + "\" width=\"5\" height=\"5\" "
+               "style=\"fill:" + fills[i % 8] + ";fill-opacity:1;fill-rule:evenodd;stroke:#000000;stroke-width:" +
+               widths[i / 8 % 4] + ";stroke-linecap:round;stroke-linejoin:round;stroke-miterlimit:4;"
+               "stroke-dasharray:none;stroke-opacity:1\"/>";
+    }
+    return svg + "</svg>";
+}
+
+/// Load the document and record what it took, as it is and per object.
+void measure(bool interned)
+{
+    if (!Application::exists()) {
+        Application::create(false);
+    }
+    SPStyle::set_interning(interned);
+    auto const svg = large_document();
+
+    auto const resident = resident_bytes();
+    auto const allocated = allocated_bytes();
+    auto doc = SPDocument::createNewDocFromMem(svg, false);
+    doc->ensureUpToDate();
+    ASSERT_EQ(doc->getRoot()->children.size(), object_count);
+
+    auto const resident_growth = resident_bytes() - resident;
+    auto const allocated_growth = allocated_bytes() - allocated;
+    record_value("objects", object_count);
+    record_value("resident_bytes", resident_growth);
+    record_value("resident_bytes_per_object", double(resident_growth) / object_count);
+    record_value("allocated_bytes", allocated_growth);
+    record_value("allocated_bytes_per_object", double(allocated_growth) / object_count);
+
+    doc.reset();
+    SPStyle::set_interning(true);
+}
+
+} // namespace
+
+/// Before: every style parses its own style attribute.
+TEST(StyleMemoryBenchmark, NotInterned)
+{
+    measure(false);
+}
+
+/// After: the parsed declarations of every distinct style attribute are shared.
+TEST(StyleMemoryBenchmark, Interned)
+{
+    measure(true);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 
 #include "style.h"
+#include "3rdparty/libcroco/src/cr-statement.h"
 
 namespace {
 
@@ -278,6 +279,27 @@ TEST(StyleTest, Read) {
 }
 
 
+// Style strings are parsed into declarations that are merged into styles later, and shared
+// between styles read from the same style attribute. The result must be the same as merging
+// the parsed CSS directly, as style sheets do.
+TEST(StyleTest, ReadMatchesStyleSheetMerge) {
+  for (auto const &i : getStyleData()) {
+
+    SPStyle style;
+    style.mergeString(i.src.c_str());
+
+    auto const css = "x {" + i.src + "}";
+    CRStatement *statement = cr_statement_parse_from_buf(reinterpret_cast<guchar const *>(css.c_str()), CR_UTF_8);
+    ASSERT_TRUE(statement) << i.src;
+    SPStyle direct;
+    direct.mergeStatement(statement);
+    cr_statement_destroy(statement);
+
+    EXPECT_EQ(std::string(style.write()), std::string(direct.write())) << i.src;
+    EXPECT_TRUE(style == direct) << i.src;
+  }
+}
+
 // ------------------------------------------------------------------------------------
 
 class StyleMatch {
@@ -17,6 +17,10 @@
 #include "util/longest-common-suffix.h"
 #include "util/parse-int-range.h"
 #include "util/delete-with.h"
+#include "util/json-string.h"
+
+#include <iomanip>
+#include <sstream>
 
 TEST(UtilTest, NearestCommonAncestor)
 {
@@ -151,4 +155,26 @@ TEST(UtilTest, DeleteWithTest)
     ASSERT_EQ(flag, false);
 }
 
+TEST(UtilTest, WriteJsonString)
+{
+    auto json = [] (std::string_view s) {
+        std::ostringstream os;
+        Inkscape::Util::write_json_string(os, s);
+        return os.str();
+    };
+
+    EXPECT_EQ(json(""), R"("")");
+    EXPECT_EQ(json("rect1"), R"("rect1")");
+    EXPECT_EQ(json("a \"b\"\\c"), R"("a \"b\"\\c")");
+    EXPECT_EQ(json("line\n\tnext"), R"("line\n\tnext")");
+    EXPECT_EQ(json(std::string_view("\x01\x1f", 2)), R"("\u0001\u001f")");
+    EXPECT_EQ(json("caf\xc3\xa9"), "\"caf\xc3\xa9\"");
+
+    // The fill of the stream is left alone.
+    std::ostringstream os;
+    Inkscape::Util::write_json_string(os, "\x02");
+    os << std::setw(3) << 7;
+    EXPECT_EQ(os.str(), R"("\u0002"  7)");
+}
+
 // vim: filetype=cpp:expandtab:shiftwidth=4:softtabstop=4:fileencoding=utf-8:textwidth=99 :